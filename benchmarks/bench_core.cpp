@@ -0,0 +1,201 @@
+/**
+ * @file bench_core.cpp
+ * @brief Data structure microbenchmarks: B-Tree, HashMap, LRU eviction
+ */
+
+#include "benchmark.h"
+#include "minidb/core/btree.h"
+#include "minidb/core/hashmap.h"
+#include "minidb/storage/page_manager.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace minidb;
+using namespace minidb::bench;
+
+namespace {
+
+    // The order the table indexes use
+    using IndexTree = core::BTree<int, 64>;
+
+    std::vector<int> shuffled_keys(size_t count, uint64_t seed) {
+        std::vector<int> keys(count);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::mt19937_64 random(seed);
+        std::shuffle(keys.begin(), keys.end(), random);
+        return keys;
+    }
+
+    bool fill_tree(IndexTree& tree, const std::vector<int>& keys) {
+        for (int key : keys) {
+            if (!tree.insert(key)) return false;
+        }
+        return true;
+    }
+
+    // Replays accesses to pages [0, universe) against an LRU pool holding
+    // capacity of them; a miss evicts the victim and brings the page in
+    bool run_lru(State& state, const std::vector<storage::PageId>& accesses, size_t capacity) {
+        storage::LRUPolicy lru;
+        std::unordered_set<storage::PageId> resident;
+        auto all_pages = [](storage::PageId) { return true; };
+        uint64_t hits = 0;
+
+        state.start();
+        for (storage::PageId page_id : accesses) {
+            if (resident.count(page_id)) {
+                lru.page_accessed(page_id);
+                hits++;
+                continue;
+            }
+            if (resident.size() == capacity) {
+                storage::PageId victim = lru.select_victim(all_pages);
+                if (victim == storage::INVALID_PAGE_ID) return state.fail("no victim in a full pool");
+                lru.page_removed(victim);
+                resident.erase(victim);
+            }
+            lru.page_added(page_id);
+            resident.insert(page_id);
+        }
+        state.stop(accesses.size());
+
+        state.set_counter("hit_ratio", static_cast<double>(hits) / static_cast<double>(accesses.size()));
+        return true;
+    }
+
+} // anonymous namespace
+
+bool bench_btree_insert_sequential(State& state) {
+    const size_t count = 200000 * state.scale();
+    IndexTree tree;
+    state.start();
+    for (size_t i = 0; i < count; i++) {
+        if (!tree.insert(static_cast<int>(i))) return state.fail("insert rejected");
+    }
+    state.stop(count);
+    return tree.size() == count || state.fail("wrong size");
+}
+
+bool bench_btree_insert_random(State& state) {
+    const size_t count = 200000 * state.scale();
+    std::vector<int> keys = shuffled_keys(count, 1);
+    IndexTree tree;
+    state.start();
+    bool inserted = fill_tree(tree, keys);
+    state.stop(count);
+    return inserted || state.fail("insert rejected");
+}
+
+bool bench_btree_search(State& state) {
+    const size_t count = 200000 * state.scale();
+    IndexTree tree;
+    if (!fill_tree(tree, shuffled_keys(count, 1))) return state.fail("insert rejected");
+
+    // Half the probes miss: keys run past the end of the tree
+    std::vector<int> probes = shuffled_keys(count * 2, 2);
+    uint64_t found = 0;
+    state.start();
+    for (int key : probes) {
+        found += tree.search(key) ? 1 : 0;
+    }
+    state.stop(probes.size());
+    return found == count || state.fail("wrong number of keys found");
+}
+
+bool bench_btree_range(State& state) {
+    const size_t count = 200000 * state.scale();
+    const size_t queries = 20000 * state.scale();
+    const int width = 100;
+    IndexTree tree;
+    if (!fill_tree(tree, shuffled_keys(count, 1))) return state.fail("insert rejected");
+
+    std::mt19937_64 random(3);
+    std::uniform_int_distribution<int> start_key(0, static_cast<int>(count) - width);
+    uint64_t returned = 0;
+    state.start();
+    for (size_t i = 0; i < queries; i++) {
+        int start = start_key(random);
+        returned += tree.range_query(start, start + width - 1).size();
+    }
+    state.stop(queries);
+    state.keep(returned);
+    return returned == queries * width || state.fail("ranges returned the wrong number of keys");
+}
+
+bool bench_hashmap_insert(State& state) {
+    const size_t count = 200000 * state.scale();
+    std::vector<int> keys = shuffled_keys(count, 4);
+    core::HashMap<int, int> map;
+    state.start();
+    for (int key : keys) {
+        if (!map.insert(key, key)) return state.fail("insert rejected");
+    }
+    state.stop(count);
+    return true;
+}
+
+bool bench_hashmap_find(State& state) {
+    const size_t count = 200000 * state.scale();
+    core::HashMap<int, int> map;
+    for (int key : shuffled_keys(count, 4)) {
+        map.insert(key, key);
+    }
+
+    // Half the probes miss
+    std::vector<int> probes = shuffled_keys(count * 2, 5);
+    uint64_t found = 0;
+    state.start();
+    for (int key : probes) {
+        found += map.find(key) ? 1 : 0;
+    }
+    state.stop(probes.size());
+    return found == count || state.fail("wrong number of keys found");
+}
+
+bool bench_hashmap_rehash(State& state) {
+    // One doubling of a full map, the step insert() takes when it outgrows
+    // its buckets; reported per entry moved
+    const size_t count = 200000 * state.scale();
+    const int rounds = 5;
+    for (int round = 0; round < rounds; round++) {
+        core::HashMap<int, int> map;
+        for (int key : shuffled_keys(count, 6)) {
+            map.insert(key, key);
+        }
+        auto buckets = static_cast<size_t>(static_cast<double>(map.size()) / map.load_factor());
+        state.start();
+        map.rehash(buckets * 2);
+        state.stop(count);
+        if (map.size() != count || !map.find(0)) return state.fail("rehash lost entries");
+    }
+    return true;
+}
+
+bool bench_lru_eviction(State& state) {
+    // Skewed accesses over eight times as many pages as fit
+    const size_t capacity = 1024;
+    const size_t universe = capacity * 8;
+    const size_t count = 1000000 * state.scale();
+    ZipfGenerator zipf(universe);
+    std::mt19937_64 random(7);
+    std::vector<storage::PageId> accesses(count);
+    for (auto& page_id : accesses) {
+        page_id = 1 + scramble(zipf.next(random), universe);
+    }
+    return run_lru(state, accesses, capacity);
+}
+
+bool bench_lru_eviction_sequential(State& state) {
+    // Repeated sequential scans larger than the pool: every access misses
+    const size_t capacity = 1024;
+    const size_t universe = capacity + capacity / 2;
+    const size_t count = 1000000 * state.scale();
+    std::vector<storage::PageId> accesses(count);
+    for (size_t i = 0; i < count; i++) {
+        accesses[i] = 1 + i % universe;
+    }
+    return run_lru(state, accesses, capacity);
+}
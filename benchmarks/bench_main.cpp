@@ -0,0 +1,320 @@
+/**
+ * @file bench_main.cpp
+ * @brief Benchmark runner for MiniDB
+ *
+ * Usage: minidb_bench [--filter=text] [--scale=n] [--repetitions=n]
+ *                     [--format=json|csv] [--output=file] [--list]
+ *
+ * Results go to stdout (or --output) as JSON or CSV, so runs can be kept
+ * and compared; progress goes to stderr. The exit status is 1 if any
+ * benchmark failed.
+ */
+
+#include "benchmark.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MINIDB_BENCH_BUILD_TYPE
+#define MINIDB_BENCH_BUILD_TYPE ""
+#endif
+
+using namespace minidb::bench;
+
+// Data structure benchmarks
+extern bool bench_btree_insert_sequential(State& state);
+extern bool bench_btree_insert_random(State& state);
+extern bool bench_btree_search(State& state);
+extern bool bench_btree_range(State& state);
+extern bool bench_hashmap_insert(State& state);
+extern bool bench_hashmap_find(State& state);
+extern bool bench_hashmap_rehash(State& state);
+extern bool bench_lru_eviction(State& state);
+extern bool bench_lru_eviction_sequential(State& state);
+
+// SQL front end benchmarks
+extern bool bench_tokenizer(State& state);
+extern bool bench_parser(State& state);
+
+// Workload benchmarks
+extern bool bench_ycsb_a(State& state);
+extern bool bench_ycsb_b(State& state);
+extern bool bench_ycsb_c(State& state);
+extern bool bench_ycsb_e(State& state);
+extern bool bench_scan_filter(State& state);
+extern bool bench_scan_aggregate(State& state);
+
+namespace {
+
+    struct Benchmark {
+        std::string name;
+        BenchmarkFunction function;
+    };
+
+    const std::vector<Benchmark> BENCHMARKS = {
+        {"btree_insert_sequential", bench_btree_insert_sequential},
+        {"btree_insert_random", bench_btree_insert_random},
+        {"btree_search", bench_btree_search},
+        {"btree_range", bench_btree_range},
+        {"hashmap_insert", bench_hashmap_insert},
+        {"hashmap_find", bench_hashmap_find},
+        {"hashmap_rehash", bench_hashmap_rehash},
+        {"lru_eviction", bench_lru_eviction},
+        {"lru_eviction_sequential", bench_lru_eviction_sequential},
+        {"tokenizer", bench_tokenizer},
+        {"parser", bench_parser},
+        {"ycsb_a", bench_ycsb_a},
+        {"ycsb_b", bench_ycsb_b},
+        {"ycsb_c", bench_ycsb_c},
+        {"ycsb_e", bench_ycsb_e},
+        {"scan_filter", bench_scan_filter},
+        {"scan_aggregate", bench_scan_aggregate},
+    };
+
+    struct Options {
+        std::string filter;
+        size_t scale = 1;
+        size_t repetitions = 3;
+        std::string format = "json";
+        std::string output;
+        bool list = false;
+    };
+
+    /**
+     * @brief The median of a benchmark's runs
+     */
+    struct Result {
+        std::string name;
+        size_t repetitions = 0;
+        uint64_t operations = 0;
+        uint64_t bytes = 0;
+        double seconds = 0.0;  // Median run
+        double min_seconds = 0.0;
+        double max_seconds = 0.0;
+        std::vector<uint64_t> latency_ns;  // p50, p95, p99, max; empty if not recorded
+        std::map<std::string, double> counters;
+        std::string error;
+
+        double ops_per_second() const { return seconds > 0.0 ? static_cast<double>(operations) / seconds : 0.0; }
+        double ns_per_op() const { return operations > 0 ? seconds * 1e9 / static_cast<double>(operations) : 0.0; }
+    };
+
+    bool parse_size(const std::string& text, size_t& value) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || parsed == 0) {
+            return false;
+        }
+        value = static_cast<size_t>(parsed);
+        return true;
+    }
+
+    bool parse_options(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            std::string name = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            if (name == "--filter") {
+                options.filter = value;
+            } else if (name == "--scale") {
+                if (!parse_size(value, options.scale)) return false;
+            } else if (name == "--repetitions") {
+                if (!parse_size(value, options.repetitions)) return false;
+            } else if (name == "--format" && (value == "json" || value == "csv")) {
+                options.format = value;
+            } else if (name == "--output" && !value.empty()) {
+                options.output = value;
+            } else if (arg == "--list") {
+                options.list = true;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Nearest-rank percentile of sorted samples
+    uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) {
+        size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size()) + 0.999999);
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    Result run_benchmark(const Benchmark& benchmark, const Options& options) {
+        Result result;
+        result.name = benchmark.name;
+        result.repetitions = options.repetitions;
+
+        std::vector<State> runs;
+        for (size_t repetition = 0; repetition < options.repetitions; repetition++) {
+            runs.emplace_back(options.scale);
+            if (!benchmark.function(runs.back())) {
+                result.error = runs.back().error().empty() ? "failed" : runs.back().error();
+                return result;
+            }
+        }
+
+        std::sort(runs.begin(), runs.end(), [](const State& a, const State& b) { return a.seconds() < b.seconds(); });
+        State& median = runs[runs.size() / 2];
+        result.operations = median.operations();
+        result.bytes = median.bytes();
+        result.seconds = median.seconds();
+        result.min_seconds = runs.front().seconds();
+        result.max_seconds = runs.back().seconds();
+        result.counters = median.counters();
+
+        std::vector<uint64_t>& latencies = median.latencies();
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            result.latency_ns = {percentile(latencies, 0.50), percentile(latencies, 0.95),
+                                 percentile(latencies, 0.99), latencies.back()};
+        }
+        return result;
+    }
+
+    std::string json_string(const std::string& text) {
+        std::ostringstream out;
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+        return out.str();
+    }
+
+    std::string timestamp() {
+        std::time_t now = std::time(nullptr);
+        char text[32];
+        std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return text;
+    }
+
+    void write_json(const std::vector<Result>& results, const Options& options, std::ostream& out) {
+        out << std::setprecision(6);
+        out << "{\n";
+        out << "  \"context\": {\"timestamp\": " << json_string(timestamp())
+            << ", \"build_type\": " << json_string(MINIDB_BENCH_BUILD_TYPE)
+            << ", \"hardware_threads\": " << std::thread::hardware_concurrency()
+            << ", \"scale\": " << options.scale << ", \"repetitions\": " << options.repetitions << "},\n";
+        out << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << json_string(result.name);
+            if (!result.error.empty()) {
+                out << ", \"error\": " << json_string(result.error) << "}";
+                continue;
+            }
+            out << ", \"operations\": " << result.operations << ", \"seconds\": " << result.seconds
+                << ", \"min_seconds\": " << result.min_seconds << ", \"max_seconds\": " << result.max_seconds
+                << ", \"ops_per_second\": " << result.ops_per_second() << ", \"ns_per_op\": " << result.ns_per_op();
+            if (result.bytes > 0) {
+                out << ", \"bytes_per_second\": " << static_cast<double>(result.bytes) / result.seconds;
+            }
+            if (!result.latency_ns.empty()) {
+                out << ", \"latency_ns\": {\"p50\": " << result.latency_ns[0] << ", \"p95\": " << result.latency_ns[1]
+                    << ", \"p99\": " << result.latency_ns[2] << ", \"max\": " << result.latency_ns[3] << "}";
+            }
+            if (!result.counters.empty()) {
+                out << ", \"counters\": {";
+                bool first = true;
+                for (const auto& [name, value] : result.counters) {
+                    out << (first ? "" : ", ") << json_string(name) << ": " << value;
+                    first = false;
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void write_csv(const std::vector<Result>& results, std::ostream& out) {
+        // Counters vary by benchmark and are left to the JSON output
+        out << std::setprecision(6);
+        out << "name,operations,seconds,ops_per_second,ns_per_op,p50_ns,p95_ns,p99_ns,error\n";
+        for (const Result& result : results) {
+            out << result.name << ",";
+            if (!result.error.empty()) {
+                out << ",,,,,,,\"" << result.error << "\"\n";
+                continue;
+            }
+            out << result.operations << "," << result.seconds << "," << result.ops_per_second() << ","
+                << result.ns_per_op() << ",";
+            if (!result.latency_ns.empty()) {
+                out << result.latency_ns[0] << "," << result.latency_ns[1] << "," << result.latency_ns[2];
+            } else {
+                out << ",,";
+            }
+            out << ",\n";
+        }
+    }
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--filter=text] [--scale=n] [--repetitions=n]"
+                  << " [--format=json|csv] [--output=file] [--list]" << std::endl;
+        return 2;
+    }
+
+    std::vector<const Benchmark*> selected;
+    for (const auto& benchmark : BENCHMARKS) {
+        if (benchmark.name.find(options.filter) != std::string::npos) {
+            selected.push_back(&benchmark);
+        }
+    }
+    if (options.list) {
+        for (const Benchmark* benchmark : selected) {
+            std::cout << benchmark->name << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<Result> results;
+    bool failed = false;
+    for (const Benchmark* benchmark : selected) {
+        std::cerr << std::left << std::setw(26) << benchmark->name << std::flush;
+        results.push_back(run_benchmark(*benchmark, options));
+        const Result& result = results.back();
+        if (!result.error.empty()) {
+            std::cerr << "FAILED: " << result.error << std::endl;
+            failed = true;
+        } else {
+            std::cerr << std::right << std::fixed << std::setprecision(1) << std::setw(12)
+                      << result.ns_per_op() << " ns/op" << std::setw(14) << result.ops_per_second() << " ops/s"
+                      << std::defaultfloat << std::endl;
+        }
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 2;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if (options.format == "csv") {
+        write_csv(results, out);
+    } else {
+        write_json(results, options, out);
+    }
+
+    return failed ? 1 : 0;
+}
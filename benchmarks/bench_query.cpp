@@ -0,0 +1,74 @@
+/**
+ * @file bench_query.cpp
+ * @brief SQL front end microbenchmarks: tokenizer and parser throughput
+ */
+
+#include "benchmark.h"
+#include "minidb/query/parser.h"
+#include <string>
+#include <vector>
+
+using namespace minidb;
+using namespace minidb::bench;
+
+namespace {
+
+    // A mix of the statement shapes the executor sees most
+    const std::vector<std::string>& statements() {
+        static const std::vector<std::string> mix = {
+            "SELECT * FROM usertable WHERE ycsb_key = 4711",
+            "SELECT field0, field1 FROM usertable WHERE ycsb_key >= 100 ORDER BY ycsb_key LIMIT 50",
+            "UPDATE usertable SET field0 = 'a fairly ordinary value' WHERE ycsb_key = 99",
+            "INSERT INTO usertable VALUES (1, 'alpha', 'beta', 3), (2, 'gamma', 'delta', 4)",
+            "DELETE FROM usertable WHERE ycsb_key < 10",
+            "SELECT region, COUNT(*), SUM(amount) FROM sales GROUP BY region",
+            "SELECT o.id, c.name FROM orders o JOIN customers c ON o.customer_id = c.id WHERE o.total > 10.5",
+            "CREATE TABLE usertable (ycsb_key INTEGER, field0 TEXT, field1 TEXT, field2 INTEGER)",
+        };
+        return mix;
+    }
+
+    uint64_t mix_bytes() {
+        uint64_t bytes = 0;
+        for (const auto& sql : statements()) {
+            bytes += sql.size();
+        }
+        return bytes;
+    }
+
+} // anonymous namespace
+
+bool bench_tokenizer(State& state) {
+    const size_t rounds = 50000 * state.scale();
+    query::Tokenizer tokenizer;
+    uint64_t tokens = 0;
+    state.start();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const auto& sql : statements()) {
+            if (!tokenizer.tokenize(sql)) return state.fail("tokenize failed: " + sql);
+            for (; !tokenizer.at_end(); tokenizer.next_token()) {
+                tokens++;
+            }
+        }
+    }
+    state.stop(rounds * statements().size());
+    state.add_bytes(rounds * mix_bytes());
+    state.set_counter("tokens_per_statement",
+                      static_cast<double>(tokens) / static_cast<double>(rounds * statements().size()));
+    return true;
+}
+
+bool bench_parser(State& state) {
+    // A fresh Parser per statement, as the executor does
+    const size_t rounds = 20000 * state.scale();
+    state.start();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const auto& sql : statements()) {
+            query::Parser parser;
+            if (!parser.parse(sql)) return state.fail("parse failed: " + sql + ": " + parser.get_error());
+        }
+    }
+    state.stop(rounds * statements().size());
+    state.add_bytes(rounds * mix_bytes());
+    return true;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file bench_workload.cpp
+ * @brief End-to-end workloads through Database::execute_query
+ *
+ * The YCSB core workloads over one table, usertable, keyed by an indexed
+ * ycsb_key, plus scans no index can help with. Keys are drawn from a
+ * scrambled zipfian distribution, as YCSB does by default. Commits are not
+ * synchronous, so the figures are the engine's and not the disk's flush
+ * latency.
+ */
+
+#include "benchmark.h"
+#include "minidb/minidb.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace minidb;
+using namespace minidb::bench;
+
+namespace {
+
+    const char* const DATABASE_NAME = "minidb_bench_workload";
+    const size_t INSERT_BATCH = 500;
+
+    void remove_database_files() {
+        std::remove((std::string(DATABASE_NAME) + ".db").c_str());
+        std::remove((std::string(DATABASE_NAME) + ".wal").c_str());
+        std::remove((std::string(DATABASE_NAME) + ".snap").c_str());
+    }
+
+    std::string field_value(uint64_t key, uint64_t version) {
+        return "value_" + std::to_string(key) + "_" + std::to_string(version) + std::string(24, 'x');
+    }
+
+    /**
+     * @brief A fresh database holding usertable, removed again when done
+     */
+    class Workload {
+    public:
+        Workload(State& state, size_t rows) : state_(state), db_(DATABASE_NAME), rows_(rows) {}
+
+        ~Workload() {
+            db_.close();
+            remove_database_files();
+        }
+
+        bool load() {
+            remove_database_files();
+            if (!db_.open()) return state_.fail("cannot open the database");
+            db_.set_synchronous_commit(false);
+            if (!run("CREATE TABLE usertable (ycsb_key INTEGER, field0 TEXT, field1 TEXT, field2 INTEGER)")) {
+                return false;
+            }
+            for (size_t first = 0; first < rows_; first += INSERT_BATCH) {
+                std::string sql = "INSERT INTO usertable VALUES ";
+                for (size_t key = first; key < rows_ && key < first + INSERT_BATCH; key++) {
+                    if (key != first) sql += ", ";
+                    sql += "(" + std::to_string(key) + ", '" + field_value(key, 0) + "', '" +
+                           field_value(key, 1) + "', " + std::to_string(key % 100) + ")";
+                }
+                if (!run(sql)) return false;
+            }
+            storage::Table* table = db_.get_table("USERTABLE");
+            if (!table || !table->create_index("YCSB_KEY", "btree")) return state_.fail("cannot index ycsb_key");
+            return true;
+        }
+
+        size_t rows() const { return rows_; }
+
+        // Next key from the request distribution
+        uint64_t next_key(ZipfGenerator& zipf, std::mt19937_64& random) const {
+            return scramble(zipf.next(random), rows_);
+        }
+
+        // Runs each statement once, timing each; rows_expected is checked
+        // against the rows of statements that return them
+        bool run_timed(const std::vector<std::string>& statements, const std::vector<long long>& rows_expected) {
+            state_.start();
+            for (size_t i = 0; i < statements.size(); i++) {
+                auto begin = State::Clock::now();
+                QueryResult result = db_.execute_query(statements[i]);
+                state_.record_latency(State::Clock::now() - begin);
+                if (!result.is_success()) {
+                    state_.stop(i);
+                    return state_.fail(statements[i] + ": " + result.get_error());
+                }
+                if (rows_expected[i] >= 0 && result.get_rows().size() != static_cast<size_t>(rows_expected[i])) {
+                    state_.stop(i);
+                    return state_.fail(statements[i] + ": wrong number of rows");
+                }
+            }
+            state_.stop(statements.size());
+            return true;
+        }
+
+        bool run(const std::string& sql) {
+            QueryResult result = db_.execute_query(sql);
+            return result.is_success() || state_.fail(sql + ": " + result.get_error());
+        }
+
+    private:
+        State& state_;
+        Database db_;
+        size_t rows_;
+    };
+
+    size_t workload_rows(const State& state) {
+        return 20000 * state.scale();
+    }
+
+    // Point reads and updates, read_fraction of them reads
+    bool run_read_update(State& state, double read_fraction) {
+        Workload workload(state, workload_rows(state));
+        if (!workload.load()) return false;
+
+        const size_t count = 20000 * state.scale();
+        ZipfGenerator zipf(workload.rows());
+        std::mt19937_64 random(11);
+        std::bernoulli_distribution is_read(read_fraction);
+        std::vector<std::string> statements;
+        std::vector<long long> rows_expected;
+        uint64_t reads = 0;
+        for (size_t i = 0; i < count; i++) {
+            std::string key = std::to_string(workload.next_key(zipf, random));
+            if (is_read(random)) {
+                statements.push_back("SELECT * FROM usertable WHERE ycsb_key = " + key);
+                rows_expected.push_back(1);
+                reads++;
+            } else {
+                statements.push_back("UPDATE usertable SET field0 = '" + field_value(i, 2) +
+                                     "' WHERE ycsb_key = " + key);
+                rows_expected.push_back(-1);
+            }
+        }
+        state.set_counter("read_fraction", static_cast<double>(reads) / static_cast<double>(count));
+        return workload.run_timed(statements, rows_expected);
+    }
+
+} // anonymous namespace
+
+bool bench_ycsb_a(State& state) {
+    return run_read_update(state, 0.5);  // Update heavy
+}
+
+bool bench_ycsb_b(State& state) {
+    return run_read_update(state, 0.95);  // Read mostly
+}
+
+bool bench_ycsb_c(State& state) {
+    return run_read_update(state, 1.0);  // Read only
+}
+
+bool bench_ycsb_e(State& state) {
+    // Short ranges: 95% scans of up to 100 keys in key order, 5% inserts
+    // of new keys past the end
+    Workload workload(state, workload_rows(state));
+    if (!workload.load()) return false;
+
+    const size_t count = 5000 * state.scale();
+    ZipfGenerator zipf(workload.rows());
+    std::mt19937_64 random(12);
+    std::bernoulli_distribution is_scan(0.95);
+    std::uniform_int_distribution<int> scan_length(1, 100);
+    std::vector<std::string> statements;
+    std::vector<long long> rows_expected;
+    uint64_t next_insert = workload.rows();
+    for (size_t i = 0; i < count; i++) {
+        if (is_scan(random)) {
+            statements.push_back("SELECT * FROM usertable WHERE ycsb_key >= " +
+                                 std::to_string(workload.next_key(zipf, random)) +
+                                 " ORDER BY ycsb_key LIMIT " + std::to_string(scan_length(random)));
+            rows_expected.push_back(-1);  // Ranges near the end run short
+        } else {
+            uint64_t key = next_insert++;
+            statements.push_back("INSERT INTO usertable VALUES (" + std::to_string(key) + ", '" +
+                                 field_value(key, 0) + "', '" + field_value(key, 1) + "', " +
+                                 std::to_string(key % 100) + ")");
+            rows_expected.push_back(-1);
+        }
+    }
+    return workload.run_timed(statements, rows_expected);
+}
+
+bool bench_scan_filter(State& state) {
+    // Full scans: the filter is on an unindexed column and keeps half the rows
+    Workload workload(state, workload_rows(state));
+    if (!workload.load()) return false;
+
+    const size_t count = 50;
+    std::vector<std::string> statements(count, "SELECT ycsb_key, field0 FROM usertable WHERE field2 < 50");
+    std::vector<long long> rows_expected(count, static_cast<long long>(workload.rows() / 2));
+    state.set_counter("rows_per_scan", static_cast<double>(workload.rows()));
+    return workload.run_timed(statements, rows_expected);
+}
+
+bool bench_scan_aggregate(State& state) {
+    // Full scans folded into 100 groups
+    Workload workload(state, workload_rows(state));
+    if (!workload.load()) return false;
+
+    const size_t count = 50;
+    std::vector<std::string> statements(count, "SELECT field2, COUNT(*), MAX(ycsb_key) FROM usertable GROUP BY field2");
+    std::vector<long long> rows_expected(count, 100);
+    state.set_counter("rows_per_scan", static_cast<double>(workload.rows()));
+    return workload.run_timed(statements, rows_expected);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file benchmark.cpp
+ * @brief Benchmark harness state and key generators
+ */
+
+#include "benchmark.h"
+#include <cmath>
+
+namespace minidb {
+namespace bench {
+
+    State::State(size_t scale)
+        : scale_(scale), elapsed_(Clock::duration::zero()), operations_(0), bytes_(0), sink_(0) {
+    }
+
+    void State::start() {
+        started_ = Clock::now();
+    }
+
+    void State::stop(uint64_t operations) {
+        elapsed_ += Clock::now() - started_;
+        operations_ += operations;
+    }
+
+    void State::record_latency(Clock::duration latency) {
+        latencies_.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+    }
+
+    bool State::fail(const std::string& message) {
+        error_ = message;
+        return false;
+    }
+
+    ZipfGenerator::ZipfGenerator(uint64_t n, double theta)
+        : n_(n), theta_(theta), alpha_(1.0 / (1.0 - theta)), zetan_(0.0), uniform_(0.0, 1.0) {
+        for (uint64_t i = 1; i <= n_; i++) {
+            zetan_ += 1.0 / std::pow(static_cast<double>(i), theta_);
+        }
+        double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta_);
+        eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n_), 1.0 - theta_)) / (1.0 - zeta2 / zetan_);
+    }
+
+    uint64_t ZipfGenerator::next(std::mt19937_64& random) {
+        double u = uniform_(random);
+        double uz = u * zetan_;
+        if (uz < 1.0 || n_ < 2) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta_)) {
+            return 1;
+        }
+        auto rank = static_cast<uint64_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return rank < n_ ? rank : n_ - 1;
+    }
+
+    uint64_t scramble(uint64_t rank, uint64_t n) {
+        // 64-bit FNV-1a over the rank's bytes
+        uint64_t hash = 14695981039346656037ULL;
+        for (int byte = 0; byte < 8; byte++) {
+            hash ^= (rank >> (byte * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+        return hash % n;
+    }
+
+} // namespace bench
+} // namespace minidb
@@ -0,0 +1,111 @@
+/**
+ * @file benchmark.h
+ * @brief Minimal benchmark harness for minidb_bench
+ *
+ * A benchmark is a function that sets up its data, brackets the work it
+ * wants measured with State::start() and State::stop(), and returns false
+ * (through State::fail()) if something went wrong. Setup outside the
+ * brackets is not timed. Each benchmark runs several times and the median
+ * run is reported.
+ */
+
+#ifndef MINIDB_BENCHMARKS_BENCHMARK_H
+#define MINIDB_BENCHMARKS_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace minidb {
+namespace bench {
+
+    /**
+     * @brief What one run of a benchmark measured
+     */
+    class State {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit State(size_t scale);
+
+        // Multiplier on every benchmark's data and operation counts
+        size_t scale() const { return scale_; }
+
+        // Timed regions may be entered any number of times; they add up
+        void start();
+        void stop(uint64_t operations);
+
+        // Bytes processed, for benchmarks where throughput is per byte
+        void add_bytes(uint64_t bytes) { bytes_ += bytes; }
+
+        // One operation's latency, for percentiles
+        void record_latency(Clock::duration latency);
+
+        // A named figure reported alongside the timings, such as a hit ratio
+        void set_counter(const std::string& name, double value) { counters_[name] = value; }
+
+        // Keeps the compiler from discarding work whose result is unused
+        void keep(uint64_t value) { sink_ += value; }
+
+        bool fail(const std::string& message);
+
+        double seconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+        uint64_t operations() const { return operations_; }
+        uint64_t bytes() const { return bytes_; }
+        std::vector<uint64_t>& latencies() { return latencies_; }  // Nanoseconds
+        const std::map<std::string, double>& counters() const { return counters_; }
+        const std::string& error() const { return error_; }
+
+    private:
+        size_t scale_;
+        Clock::time_point started_;
+        Clock::duration elapsed_;
+        uint64_t operations_;
+        uint64_t bytes_;
+        std::vector<uint64_t> latencies_;
+        std::map<std::string, double> counters_;
+        std::string error_;
+        volatile uint64_t sink_;
+    };
+
+    using BenchmarkFunction = bool (*)(State&);
+
+    /**
+     * @brief Zipfian ranks in [0, n), rank 0 the most frequent
+     *
+     * The generator of Gray et al., "Quickly Generating Billion-Record
+     * Synthetic Databases", as YCSB uses it. Construction is O(n); each
+     * draw is O(1).
+     */
+    class ZipfGenerator {
+    public:
+        static constexpr double DEFAULT_THETA = 0.99;  // YCSB's default skew
+
+        ZipfGenerator(uint64_t n, double theta = DEFAULT_THETA);
+
+        uint64_t next(std::mt19937_64& random);
+
+    private:
+        uint64_t n_;
+        double theta_;
+        double alpha_;
+        double zetan_;
+        double eta_;
+        std::uniform_real_distribution<double> uniform_;
+    };
+
+    /**
+     * @brief Spreads ranks over [0, n) so the hot keys are not adjacent
+     *
+     * Like YCSB's scrambled zipfian: several ranks may land on one key.
+     */
+    uint64_t scramble(uint64_t rank, uint64_t n);
+
+} // namespace bench
+} // namespace minidb
+
+#endif // MINIDB_BENCHMARKS_BENCHMARK_H
@@ -0,0 +1,740 @@
+/**
+ * @file bplus_tree.h
+ * @brief B+Tree with sibling-linked leaves
+ *
+ * Unlike BTree, every key lives in a leaf; inner nodes only hold separator
+ * copies used for routing. Leaves are chained left to right, so a range
+ * query is one root-to-leaf descent followed by a walk along the chain.
+ *
+ * Nodes are flat: keys sit in an inline fixed-capacity array and children
+ * are raw pointers into a NodeArena, so a descent touches one contiguous
+ * key array per level and does no reference counting. With the default
+ * order a node's key array is about a page.
+ *
+ * The tree is header-only so it can be instantiated for key types defined
+ * outside core (e.g. storage::Value index entries).
+ *
+ * Bulk loads skip the per-key descent entirely: bulk_load packs sorted keys
+ * into leaves and builds each inner level from the one below it.
+ */
+
+#ifndef MINIDB_CORE_BPLUS_TREE_H
+#define MINIDB_CORE_BPLUS_TREE_H
+
+#include "minidb/core/tree_node.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace minidb {
+namespace core {
+
+    /**
+     * @brief Default fan-out: as many keys as fit in NODE_BYTES, kept within [16, 256]
+     */
+    template<typename T>
+    struct BPlusTreeDefaultOrder {
+        static constexpr size_t NODE_BYTES = 4096;
+        static constexpr size_t fit = NODE_BYTES / sizeof(T);
+        static constexpr size_t value = fit < 16 ? 16 : (fit > 256 ? 256 : fit);
+    };
+    
+    /**
+     * @brief Ordered set of unique keys stored in a B+Tree
+     * @tparam T Key type (default-constructible)
+     * @tparam Order Maximum number of children of an inner node; nodes hold
+     *         at most Order - 1 keys
+     * @tparam Less Strict weak ordering on T
+     */
+    template<typename T, size_t Order = BPlusTreeDefaultOrder<T>::value, typename Less = std::less<T>>
+    class BPlusTree {
+        static_assert(Order >= 4, "BPlusTree order must be at least 4");
+    
+    public:
+        static constexpr size_t MAX_KEYS = Order - 1;
+        static constexpr size_t MIN_KEYS = MAX_KEYS / 2;  // Except at the root
+    
+    private:
+        // Nodes get one spare key slot so an insert can overflow a node
+        // before it is split.
+        struct Node {
+            bool is_leaf;
+            uint32_t count;
+            std::array<T, MAX_KEYS + 1> keys;
+            
+            Node() : is_leaf(true), count(0) {}
+        };
+        
+        struct Leaf : Node {
+            Leaf* next;
+            
+            Leaf() : next(nullptr) {}
+        };
+        
+        struct Inner : Node {
+            std::array<Node*, Order + 1> children;
+        };
+    
+    public:
+        /**
+         * @brief Forward iterator over keys in ascending order
+         *
+         * Invalidated by any modification of the tree.
+         */
+        class Iterator {
+        public:
+            Iterator() : leaf_(nullptr), index_(0) {}
+            
+            bool valid() const { return leaf_ != nullptr; }
+            const T& key() const { return leaf_->keys[index_]; }
+            
+            void next() {
+                if (++index_ >= leaf_->count) {
+                    leaf_ = leaf_->next;
+                    index_ = 0;
+                    skip_empty();
+                }
+            }
+            
+            const T& operator*() const { return key(); }
+            const T* operator->() const { return &key(); }
+            Iterator& operator++() { next(); return *this; }
+            bool operator==(const Iterator& other) const {
+                return leaf_ == other.leaf_ && (leaf_ == nullptr || index_ == other.index_);
+            }
+            bool operator!=(const Iterator& other) const { return !(*this == other); }
+        
+        private:
+            friend class BPlusTree;
+            
+            Iterator(const Leaf* leaf, size_t index) : leaf_(leaf), index_(index) {
+                if (leaf_ != nullptr && index_ >= leaf_->count) {
+                    leaf_ = leaf_->next;
+                    index_ = 0;
+                }
+                skip_empty();
+            }
+            
+            void skip_empty() {
+                while (leaf_ != nullptr && leaf_->count == 0) {
+                    leaf_ = leaf_->next;
+                }
+            }
+            
+            const Leaf* leaf_;
+            size_t index_;
+        };
+        
+        BPlusTree() : root_(nullptr), size_(0), less_() { clear(); }
+        explicit BPlusTree(Less less) : root_(nullptr), size_(0), less_(less) { clear(); }
+        
+        BPlusTree(const BPlusTree&) = delete;
+        BPlusTree& operator=(const BPlusTree&) = delete;
+        
+        /**
+         * @brief Insert a key
+         * @return false if the key is already present
+         */
+        bool insert(const T& key);
+        
+        /**
+         * @brief Remove a key, borrowing from or merging with a sibling when
+         *        a node drops below MIN_KEYS
+         * @return false if the key was not present
+         */
+        bool remove(const T& key);
+        
+        /**
+         * @brief Check whether a key is present
+         */
+        bool search(const T& key) const;
+        
+        /**
+         * @brief Position at the first key not less than key
+         */
+        Iterator seek(const T& key) const;
+        
+        /**
+         * @brief Position at the largest key less than key; invalid if there is none
+         *
+         * Leaves are only linked left to right, so a backward walk costs one
+         * descent per step.
+         */
+        Iterator seek_before(const T& key) const;
+        
+        Iterator begin() const { return Iterator(leftmost_leaf(), 0); }
+        Iterator end() const { return Iterator(); }
+        
+        /**
+         * @brief Position at the largest key; invalid when the tree is empty
+         */
+        Iterator last() const {
+            const Leaf* leaf = rightmost_leaf();
+            return Iterator(leaf, leaf->count > 0 ? leaf->count - 1 : 0);
+        }
+        
+        /**
+         * @brief Visit keys in [start, end] in order
+         * @param visitor Called per key; return false to stop early
+         */
+        template<typename Visitor>
+        void range_scan(const T& start, const T& end, Visitor visitor) const;
+        
+        /**
+         * @brief Collect keys in [start, end]
+         */
+        std::vector<T> range_query(const T& start, const T& end) const;
+        
+        /**
+         * @brief Replace the contents with keys, building the tree bottom-up
+         * @param keys Strictly ascending under Less
+         *
+         * Leaves are filled to capacity and linked in one pass, then each
+         * inner level is built from the smallest keys of the level below.
+         * Keys are spread evenly across each level so no node but the root
+         * ends up below MIN_KEYS.
+         */
+        void bulk_load(std::vector<T> keys);
+        
+        /**
+         * @brief Add keys by merging them with the current contents and
+         *        rebuilding with bulk_load
+         * @param keys Ascending under Less; duplicates are skipped
+         * @return Number of keys that were not already present
+         *
+         * Costs O(size() + keys.size()) regardless of where the new keys
+         * land, which beats repeated insert once the batch is a sizeable
+         * fraction of the tree.
+         */
+        size_t merge(const std::vector<T>& keys);
+        
+        void clear();
+        
+        bool empty() const { return size_ == 0; }
+        size_t size() const { return size_; }
+        
+        /**
+         * @brief Number of levels, 1 for a tree that is a single leaf
+         */
+        size_t height() const;
+        
+        /**
+         * @brief Nodes currently in use (leaves plus inner nodes)
+         */
+        size_t node_count() const { return leaves_.live_count() + inners_.live_count(); }
+    
+    private:
+        Node* root_;
+        size_t size_;
+        Less less_;
+        NodeArena<Leaf> leaves_;
+        NodeArena<Inner> inners_;
+        
+        Leaf* new_leaf();
+        Inner* new_inner();
+        bool insert_helper(Node* node, const T& key, T& separator, Node*& split);
+        Node* split_leaf(Leaf* leaf, T& separator);
+        Node* split_inner(Inner* node, T& separator);
+        bool remove_helper(Node* node, const T& key);
+        void rebalance_child(Inner* parent, size_t index);
+        void merge_children(Inner* parent, size_t index);
+        void release_node(Node* node);
+        const Leaf* find_leaf(const T& key) const;
+        const Leaf* leftmost_leaf() const;
+        const Leaf* rightmost_leaf() const;
+        
+        size_t child_index(const Node* node, const T& key) const {
+            // Separator i is the smallest key of child i + 1, so equal keys go right
+            return upper_bound_index(node->keys.data(), node->count, key, less_);
+        }
+        
+        size_t lower_bound(const Node* node, const T& key) const {
+            return lower_bound_index(node->keys.data(), node->count, key, less_);
+        }
+        
+        // Size of part index when count items are split into parts near-equal runs
+        static size_t share(size_t count, size_t parts, size_t index) {
+            return count / parts + (index < count % parts ? 1 : 0);
+        }
+        
+        static Inner* as_inner(Node* node) { return static_cast<Inner*>(node); }
+        static const Inner* as_inner(const Node* node) { return static_cast<const Inner*>(node); }
+    };
+    
+    // BPlusTree implementation
+    template<typename T, size_t Order, typename Less>
+    bool BPlusTree<T, Order, Less>::insert(const T& key) {
+        T separator;
+        Node* split = nullptr;
+        if (!insert_helper(root_, key, separator, split)) {
+            return false;  // Key already exists
+        }
+        
+        // The root split: grow the tree by one level
+        if (split != nullptr) {
+            Inner* new_root = new_inner();
+            new_root->keys[0] = std::move(separator);
+            new_root->children[0] = root_;
+            new_root->children[1] = split;
+            new_root->count = 1;
+            root_ = new_root;
+        }
+        
+        size_++;
+        return true;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    bool BPlusTree<T, Order, Less>::insert_helper(Node* node, const T& key, T& separator, Node*& split) {
+        if (node->is_leaf) {
+            size_t pos = lower_bound(node, key);
+            if (pos < node->count && !less_(key, node->keys[pos])) {
+                return false;
+            }
+            
+            for (size_t i = node->count; i > pos; i--) {
+                node->keys[i] = std::move(node->keys[i - 1]);
+            }
+            node->keys[pos] = key;
+            node->count++;
+            
+            if (node->count > MAX_KEYS) {
+                split = split_leaf(static_cast<Leaf*>(node), separator);
+            }
+            return true;
+        }
+        
+        Inner* inner = as_inner(node);
+        size_t index = child_index(node, key);
+        T child_separator;
+        Node* child_split = nullptr;
+        if (!insert_helper(inner->children[index], key, child_separator, child_split)) {
+            return false;
+        }
+        
+        if (child_split != nullptr) {
+            for (size_t i = inner->count; i > index; i--) {
+                inner->keys[i] = std::move(inner->keys[i - 1]);
+                inner->children[i + 1] = inner->children[i];
+            }
+            inner->keys[index] = std::move(child_separator);
+            inner->children[index + 1] = child_split;
+            inner->count++;
+            
+            if (inner->count > MAX_KEYS) {
+                split = split_inner(inner, separator);
+            }
+        }
+        return true;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::split_leaf(Leaf* leaf, T& separator) -> Node* {
+        Leaf* right = new_leaf();
+        size_t mid = leaf->count / 2;
+        
+        // The right half keeps its keys; its first key is copied up as separator
+        for (size_t i = mid; i < leaf->count; i++) {
+            right->keys[i - mid] = std::move(leaf->keys[i]);
+        }
+        right->count = leaf->count - static_cast<uint32_t>(mid);
+        leaf->count = static_cast<uint32_t>(mid);
+        
+        right->next = leaf->next;
+        leaf->next = right;
+        
+        separator = right->keys[0];
+        return right;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::split_inner(Inner* node, T& separator) -> Node* {
+        Inner* right = new_inner();
+        size_t mid = node->count / 2;
+        
+        // The middle separator moves up; keys and children right of it move over
+        separator = std::move(node->keys[mid]);
+        for (size_t i = mid + 1; i < node->count; i++) {
+            right->keys[i - mid - 1] = std::move(node->keys[i]);
+        }
+        for (size_t i = mid + 1; i <= node->count; i++) {
+            right->children[i - mid - 1] = node->children[i];
+        }
+        right->count = node->count - static_cast<uint32_t>(mid) - 1;
+        node->count = static_cast<uint32_t>(mid);
+        
+        return right;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    bool BPlusTree<T, Order, Less>::remove(const T& key) {
+        if (!remove_helper(root_, key)) {
+            return false;
+        }
+        
+        // An inner root left with a single child: shrink the tree by one level
+        if (!root_->is_leaf && root_->count == 0) {
+            Node* old_root = root_;
+            root_ = as_inner(old_root)->children[0];
+            release_node(old_root);
+        }
+        
+        size_--;
+        return true;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    bool BPlusTree<T, Order, Less>::remove_helper(Node* node, const T& key) {
+        if (node->is_leaf) {
+            size_t pos = lower_bound(node, key);
+            if (pos >= node->count || less_(key, node->keys[pos])) {
+                return false;
+            }
+            
+            for (size_t i = pos + 1; i < node->count; i++) {
+                node->keys[i - 1] = std::move(node->keys[i]);
+            }
+            node->count--;
+            return true;
+        }
+        
+        // Separators may name keys that were since removed; they still route
+        // correctly, so they are left alone
+        Inner* inner = as_inner(node);
+        size_t index = child_index(node, key);
+        if (!remove_helper(inner->children[index], key)) {
+            return false;
+        }
+        
+        if (inner->children[index]->count < MIN_KEYS) {
+            rebalance_child(inner, index);
+        }
+        return true;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    void BPlusTree<T, Order, Less>::rebalance_child(Inner* parent, size_t index) {
+        Node* child = parent->children[index];
+        Node* left = index > 0 ? parent->children[index - 1] : nullptr;
+        Node* right = index < parent->count ? parent->children[index + 1] : nullptr;
+        
+        if (left != nullptr && left->count > MIN_KEYS) {
+            // Borrow the left sibling's last entry
+            for (size_t i = child->count; i > 0; i--) {
+                child->keys[i] = std::move(child->keys[i - 1]);
+            }
+            
+            if (child->is_leaf) {
+                child->keys[0] = std::move(left->keys[left->count - 1]);
+                parent->keys[index - 1] = child->keys[0];
+            } else {
+                Inner* inner_child = as_inner(child);
+                Inner* inner_left = as_inner(left);
+                for (size_t i = child->count + 1; i > 0; i--) {
+                    inner_child->children[i] = inner_child->children[i - 1];
+                }
+                child->keys[0] = std::move(parent->keys[index - 1]);
+                inner_child->children[0] = inner_left->children[left->count];
+                parent->keys[index - 1] = std::move(left->keys[left->count - 1]);
+            }
+            
+            left->count--;
+            child->count++;
+        } else if (right != nullptr && right->count > MIN_KEYS) {
+            // Borrow the right sibling's first entry
+            if (child->is_leaf) {
+                child->keys[child->count] = std::move(right->keys[0]);
+                for (size_t i = 1; i < right->count; i++) {
+                    right->keys[i - 1] = std::move(right->keys[i]);
+                }
+                parent->keys[index] = right->keys[0];
+            } else {
+                Inner* inner_child = as_inner(child);
+                Inner* inner_right = as_inner(right);
+                child->keys[child->count] = std::move(parent->keys[index]);
+                inner_child->children[child->count + 1] = inner_right->children[0];
+                parent->keys[index] = std::move(right->keys[0]);
+                for (size_t i = 1; i < right->count; i++) {
+                    right->keys[i - 1] = std::move(right->keys[i]);
+                }
+                for (size_t i = 1; i <= right->count; i++) {
+                    inner_right->children[i - 1] = inner_right->children[i];
+                }
+            }
+            
+            right->count--;
+            child->count++;
+        } else if (left != nullptr) {
+            merge_children(parent, index - 1);
+        } else if (right != nullptr) {
+            merge_children(parent, index);
+        }
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    void BPlusTree<T, Order, Less>::merge_children(Inner* parent, size_t index) {
+        // Fold child index + 1 into child index and drop their separator
+        Node* left = parent->children[index];
+        Node* right = parent->children[index + 1];
+        
+        if (left->is_leaf) {
+            for (size_t i = 0; i < right->count; i++) {
+                left->keys[left->count + i] = std::move(right->keys[i]);
+            }
+            left->count += right->count;
+            static_cast<Leaf*>(left)->next = static_cast<Leaf*>(right)->next;
+        } else {
+            Inner* inner_left = as_inner(left);
+            Inner* inner_right = as_inner(right);
+            left->keys[left->count] = std::move(parent->keys[index]);
+            for (size_t i = 0; i < right->count; i++) {
+                left->keys[left->count + 1 + i] = std::move(right->keys[i]);
+            }
+            for (size_t i = 0; i <= right->count; i++) {
+                inner_left->children[left->count + 1 + i] = inner_right->children[i];
+            }
+            left->count += right->count + 1;
+        }
+        
+        for (size_t i = index + 1; i < parent->count; i++) {
+            parent->keys[i - 1] = std::move(parent->keys[i]);
+            parent->children[i] = parent->children[i + 1];
+        }
+        parent->count--;
+        
+        release_node(right);
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    void BPlusTree<T, Order, Less>::release_node(Node* node) {
+        if (node->is_leaf) {
+            leaves_.release(static_cast<Leaf*>(node));
+        } else {
+            inners_.release(as_inner(node));
+        }
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    bool BPlusTree<T, Order, Less>::search(const T& key) const {
+        const Leaf* leaf = find_leaf(key);
+        size_t pos = lower_bound(leaf, key);
+        return pos < leaf->count && !less_(key, leaf->keys[pos]);
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::seek(const T& key) const -> Iterator {
+        const Leaf* leaf = find_leaf(key);
+        return Iterator(leaf, lower_bound(leaf, key));
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::seek_before(const T& key) const -> Iterator {
+        // The predecessor is in key's leaf, or else it is the last key of
+        // the nearest subtree to the left of the descent path
+        const Node* node = root_;
+        const Node* left = nullptr;
+        while (!node->is_leaf) {
+            size_t index = child_index(node, key);
+            if (index > 0) {
+                left = as_inner(node)->children[index - 1];
+            }
+            node = as_inner(node)->children[index];
+        }
+        
+        size_t pos = lower_bound(node, key);
+        if (pos > 0) {
+            return Iterator(static_cast<const Leaf*>(node), pos - 1);
+        }
+        if (left == nullptr) {
+            return Iterator();
+        }
+        while (!left->is_leaf) {
+            left = as_inner(left)->children[left->count];
+        }
+        
+        // Only the root may be empty, and left is never the root
+        return Iterator(static_cast<const Leaf*>(left), left->count - 1);
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    template<typename Visitor>
+    void BPlusTree<T, Order, Less>::range_scan(const T& start, const T& end, Visitor visitor) const {
+        for (Iterator it = seek(start); it.valid() && !less_(end, it.key()); it.next()) {
+            if (!visitor(it.key())) {
+                return;
+            }
+        }
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    std::vector<T> BPlusTree<T, Order, Less>::range_query(const T& start, const T& end) const {
+        std::vector<T> result;
+        range_scan(start, end, [&result](const T& key) {
+            result.push_back(key);
+            return true;
+        });
+        return result;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    void BPlusTree<T, Order, Less>::bulk_load(std::vector<T> keys) {
+        clear();
+        if (keys.empty()) {
+            return;
+        }
+        size_ = keys.size();
+        
+        // Leaf level; low[i] is the smallest key under level[i]
+        std::vector<Node*> level;
+        std::vector<T> low;
+        size_t leaf_count = (keys.size() + MAX_KEYS - 1) / MAX_KEYS;
+        level.reserve(leaf_count);
+        low.reserve(leaf_count);
+        
+        Leaf* previous = nullptr;
+        size_t pos = 0;
+        for (size_t i = 0; i < leaf_count; i++) {
+            Leaf* leaf = previous == nullptr ? static_cast<Leaf*>(root_) : new_leaf();
+            size_t count = share(keys.size(), leaf_count, i);
+            for (size_t k = 0; k < count; k++) {
+                leaf->keys[k] = std::move(keys[pos + k]);
+            }
+            leaf->count = static_cast<uint32_t>(count);
+            pos += count;
+            
+            if (previous != nullptr) {
+                previous->next = leaf;
+            }
+            previous = leaf;
+            level.push_back(leaf);
+            low.push_back(leaf->keys[0]);
+        }
+        
+        // Inner levels until a single node remains; separator j of a node is
+        // the smallest key under its child j + 1
+        while (level.size() > 1) {
+            size_t parent_count = (level.size() + Order - 1) / Order;
+            std::vector<Node*> parents;
+            std::vector<T> parent_low;
+            parents.reserve(parent_count);
+            parent_low.reserve(parent_count);
+            
+            size_t child = 0;
+            for (size_t i = 0; i < parent_count; i++) {
+                Inner* inner = new_inner();
+                size_t count = share(level.size(), parent_count, i);
+                for (size_t c = 0; c < count; c++) {
+                    inner->children[c] = level[child + c];
+                    if (c > 0) {
+                        inner->keys[c - 1] = std::move(low[child + c]);
+                    }
+                }
+                inner->count = static_cast<uint32_t>(count - 1);
+                
+                parents.push_back(inner);
+                parent_low.push_back(std::move(low[child]));
+                child += count;
+            }
+            
+            level = std::move(parents);
+            low = std::move(parent_low);
+        }
+        
+        root_ = level[0];
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    size_t BPlusTree<T, Order, Less>::merge(const std::vector<T>& keys) {
+        std::vector<T> merged;
+        merged.reserve(size_ + keys.size());
+        
+        auto append = [this, &merged](const T& key) {
+            if (merged.empty() || less_(merged.back(), key)) {
+                merged.push_back(key);
+            }
+        };
+        
+        Iterator it = begin();
+        size_t next = 0;
+        while (it.valid() || next < keys.size()) {
+            if (next == keys.size() || (it.valid() && !less_(keys[next], it.key()))) {
+                append(it.key());
+                it.next();
+            } else {
+                append(keys[next++]);
+            }
+        }
+        
+        size_t added = merged.size() - size_;
+        bulk_load(std::move(merged));
+        return added;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    void BPlusTree<T, Order, Less>::clear() {
+        leaves_.clear();
+        inners_.clear();
+        root_ = new_leaf();
+        size_ = 0;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    size_t BPlusTree<T, Order, Less>::height() const {
+        size_t levels = 1;
+        for (const Node* node = root_; !node->is_leaf; node = as_inner(node)->children[0]) {
+            levels++;
+        }
+        return levels;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::new_leaf() -> Leaf* {
+        Leaf* leaf = leaves_.allocate();
+        leaf->is_leaf = true;
+        leaf->count = 0;
+        leaf->next = nullptr;
+        return leaf;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::new_inner() -> Inner* {
+        Inner* inner = inners_.allocate();
+        inner->is_leaf = false;
+        inner->count = 0;
+        return inner;
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::find_leaf(const T& key) const -> const Leaf* {
+        const Node* node = root_;
+        while (!node->is_leaf) {
+            node = as_inner(node)->children[child_index(node, key)];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::leftmost_leaf() const -> const Leaf* {
+        const Node* node = root_;
+        while (!node->is_leaf) {
+            node = as_inner(node)->children[0];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+    
+    template<typename T, size_t Order, typename Less>
+    auto BPlusTree<T, Order, Less>::rightmost_leaf() const -> const Leaf* {
+        const Node* node = root_;
+        while (!node->is_leaf) {
+            node = as_inner(node)->children[node->count];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+} // namespace core
+} // namespace minidb
+
+#endif // MINIDB_CORE_BPLUS_TREE_H
@@ -0,0 +1,559 @@
+/**
+ * @file flat_hash_map.h
+ * @brief Open-addressing hash map with Swiss-table style control bytes
+ *
+ * Entries live directly in one slot array; a parallel array of one-byte
+ * control words marks each slot empty, deleted, or full with 7 bits of the
+ * key's hash. Lookups compare a whole 16-byte group of control words at a
+ * time (SSE2 where available) and only touch slots whose hash bits match,
+ * so a typical hit costs one control-group load and one key comparison.
+ *
+ * Header-only so it can be instantiated for key types defined outside core.
+ */
+
+#ifndef MINIDB_CORE_FLAT_HASH_MAP_H
+#define MINIDB_CORE_FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MINIDB_FLAT_HASH_MAP_SSE2 1
+#endif
+
+namespace minidb {
+namespace core {
+
+    namespace flat_hash {
+
+        using Ctrl = int8_t;
+        
+        // Full slots hold the low 7 hash bits (0..127); the others are negative
+        constexpr Ctrl EMPTY = -128;
+        constexpr Ctrl DELETED = -2;
+        
+        inline bool is_full(Ctrl ctrl) { return ctrl >= 0; }
+        
+        inline uint32_t trailing_zeros(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+            uint32_t count = 0;
+            while ((mask & 1u) == 0) {
+                mask >>= 1;
+                count++;
+            }
+            return count;
+#endif
+        }
+        
+        /**
+         * @brief Sixteen control bytes examined together
+         */
+        class Group {
+        public:
+            static constexpr size_t WIDTH = 16;
+            
+            explicit Group(const Ctrl* pos) {
+#ifdef MINIDB_FLAT_HASH_MAP_SSE2
+                ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+#else
+                std::memcpy(ctrl_, pos, WIDTH);
+#endif
+            }
+            
+            // Bit i set if byte i equals h2
+            uint32_t match(Ctrl h2) const {
+#ifdef MINIDB_FLAT_HASH_MAP_SSE2
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+                uint32_t mask = 0;
+                for (size_t i = 0; i < WIDTH; i++) {
+                    mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+                }
+                return mask;
+#endif
+            }
+            
+            uint32_t match_empty() const { return match(EMPTY); }
+            
+            // Empty and deleted are the only negative control bytes
+            uint32_t match_empty_or_deleted() const {
+#ifdef MINIDB_FLAT_HASH_MAP_SSE2
+                return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+                uint32_t mask = 0;
+                for (size_t i = 0; i < WIDTH; i++) {
+                    mask |= static_cast<uint32_t>(ctrl_[i] < 0) << i;
+                }
+                return mask;
+#endif
+            }
+            
+        private:
+#ifdef MINIDB_FLAT_HASH_MAP_SSE2
+            __m128i ctrl_;
+#else
+            Ctrl ctrl_[WIDTH];
+#endif
+        };
+        
+        // Spread std::hash output (the identity for integers) over all bits
+        inline uint64_t mix(uint64_t h) {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+    } // namespace flat_hash
+    
+    /**
+     * @brief Unordered map with open addressing and group probing
+     *
+     * Pointers and iterators are invalidated by any insert that grows the
+     * table and by rehash(). Capacity is always a power of two; the table is
+     * grown once it is 7/8 full, counting deleted slots.
+     */
+    template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class FlatHashMap {
+    public:
+        struct Entry {
+            K key;
+            V value;
+            
+            template<typename KeyArg, typename... Args>
+            Entry(KeyArg&& k, Args&&... args)
+                : key(std::forward<KeyArg>(k)), value(std::forward<Args>(args)...) {}
+        };
+        
+        class Iterator {
+        public:
+            Entry& operator*() const { return map_->slots_[index_]; }
+            Entry* operator->() const { return &map_->slots_[index_]; }
+            
+            Iterator& operator++() {
+                index_++;
+                skip_free();
+                return *this;
+            }
+            
+            bool operator==(const Iterator& other) const { return index_ == other.index_ && map_ == other.map_; }
+            bool operator!=(const Iterator& other) const { return !(*this == other); }
+            
+        private:
+            friend class FlatHashMap;
+            
+            Iterator(const FlatHashMap* map, size_t index) : map_(map), index_(index) { skip_free(); }
+            
+            void skip_free() {
+                while (index_ < map_->capacity_ && !flat_hash::is_full(map_->ctrl_[index_])) {
+                    index_++;
+                }
+            }
+            
+            const FlatHashMap* map_;
+            size_t index_;
+        };
+        
+        explicit FlatHashMap(size_t initial_capacity = 16)
+            : ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), deleted_(0) {
+            allocate(normalize_capacity(initial_capacity));
+        }
+        
+        ~FlatHashMap() {
+            destroy_slots();
+            deallocate();
+        }
+        
+        FlatHashMap(const FlatHashMap&) = delete;
+        FlatHashMap& operator=(const FlatHashMap&) = delete;
+        
+        FlatHashMap(FlatHashMap&& other) noexcept
+            : ctrl_(other.ctrl_), slots_(other.slots_), capacity_(other.capacity_),
+              size_(other.size_), deleted_(other.deleted_) {
+            other.ctrl_ = nullptr;
+            other.slots_ = nullptr;
+            other.capacity_ = 0;
+            other.size_ = 0;
+            other.deleted_ = 0;
+            other.allocate(16);
+        }
+        
+        /**
+         * @brief Insert key if absent, constructing the value from args
+         * @return Pointer to the entry's value, and whether it was inserted.
+         *         The table is probed once either way.
+         */
+        template<typename KeyArg, typename... Args>
+        std::pair<V*, bool> try_emplace(KeyArg&& key, Args&&... args) {
+            reserve_one();
+            
+            uint64_t h = hash_of(key);
+            std::pair<size_t, bool> slot = find_or_prepare_insert(key, h);
+            if (slot.second) {
+                return std::make_pair(&slots_[slot.first].value, false);
+            }
+            
+            if (ctrl_[slot.first] == flat_hash::DELETED) {
+                deleted_--;
+            }
+            new (&slots_[slot.first]) Entry(std::forward<KeyArg>(key), std::forward<Args>(args)...);
+            set_ctrl(slot.first, h2(h));
+            size_++;
+            return std::make_pair(&slots_[slot.first].value, true);
+        }
+        
+        /**
+         * @brief Insert a new entry
+         * @return false if the key already exists (the value is left alone)
+         */
+        bool insert(const K& key, const V& value) {
+            return try_emplace(key, value).second;
+        }
+        
+        /**
+         * @brief Insert or overwrite
+         * @return true if a new entry was inserted
+         */
+        bool upsert(const K& key, const V& value) {
+            std::pair<V*, bool> result = try_emplace(key, value);
+            if (!result.second) {
+                *result.first = value;
+            }
+            return result.second;
+        }
+        
+        /**
+         * @brief Overwrite an existing entry
+         * @return false if the key is absent
+         */
+        bool update(const K& key, const V& value) {
+            V* existing = find(key);
+            if (existing == nullptr) {
+                return false;
+            }
+            *existing = value;
+            return true;
+        }
+        
+        V* find(const K& key) {
+            size_t index = find_index(key, hash_of(key));
+            return index == NOT_FOUND ? nullptr : &slots_[index].value;
+        }
+        
+        const V* find(const K& key) const {
+            size_t index = find_index(key, hash_of(key));
+            return index == NOT_FOUND ? nullptr : &slots_[index].value;
+        }
+        
+        bool contains(const K& key) const { return find(key) != nullptr; }
+        
+        bool remove(const K& key) {
+            size_t index = find_index(key, hash_of(key));
+            if (index == NOT_FOUND) {
+                return false;
+            }
+            erase_at(index);
+            return true;
+        }
+        
+        V& operator[](const K& key) { return *try_emplace(key).first; }
+        
+        void clear() {
+            destroy_slots();
+            reset_ctrl();
+            size_ = 0;
+            deleted_ = 0;
+        }
+        
+        /**
+         * @brief Make room for count entries without further growth
+         */
+        void reserve(size_t count) {
+            size_t needed = normalize_capacity(count + count / 7 + 1);
+            if (needed > capacity_) {
+                resize(needed);
+            }
+        }
+        
+        /**
+         * @brief Rebuild the table with at least new_capacity slots
+         *
+         * Entries are moved straight into their new slots; keys are not
+         * re-compared since they are already known to be unique.
+         */
+        void rehash(size_t new_capacity) {
+            new_capacity = normalize_capacity(new_capacity);
+            if (new_capacity < min_capacity_for(size_)) {
+                new_capacity = min_capacity_for(size_);
+            }
+            resize(new_capacity);
+        }
+        
+        Iterator begin() const { return Iterator(this, 0); }
+        Iterator end() const { return Iterator(this, capacity_); }
+        
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        size_t capacity() const { return capacity_; }
+        double load_factor() const { return static_cast<double>(size_) / capacity_; }
+        
+        void print_stats() const {
+            std::cout << "FlatHashMap Statistics:" << std::endl;
+            std::cout << "  Size: " << size_ << std::endl;
+            std::cout << "  Capacity: " << capacity_ << std::endl;
+            std::cout << "  Deleted Slots: " << deleted_ << std::endl;
+            std::cout << "  Load Factor: " << load_factor() << std::endl;
+        }
+        
+    private:
+        using Ctrl = flat_hash::Ctrl;
+        using Group = flat_hash::Group;
+        static constexpr size_t WIDTH = Group::WIDTH;
+        static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+        
+        // capacity_ slots plus WIDTH mirrored control bytes, so a group load
+        // starting anywhere in the table never wraps
+        Ctrl* ctrl_;
+        Entry* slots_;
+        size_t capacity_;
+        size_t size_;
+        size_t deleted_;
+        Hash hasher_;
+        KeyEqual equal_;
+        
+        static size_t normalize_capacity(size_t capacity) {
+            size_t result = WIDTH;
+            while (result < capacity) {
+                result *= 2;
+            }
+            return result;
+        }
+        
+        static size_t min_capacity_for(size_t count) {
+            return normalize_capacity(count + count / 7 + 1);
+        }
+        
+        size_t max_fill() const { return capacity_ - capacity_ / 8; }
+        
+        uint64_t hash_of(const K& key) const { return flat_hash::mix(static_cast<uint64_t>(hasher_(key))); }
+        static size_t h1(uint64_t h) { return static_cast<size_t>(h >> 7); }
+        static Ctrl h2(uint64_t h) { return static_cast<Ctrl>(h & 0x7F); }
+        
+        void set_ctrl(size_t index, Ctrl value) {
+            ctrl_[index] = value;
+            if (index < WIDTH) {
+                ctrl_[capacity_ + index] = value;  // Mirror
+            }
+        }
+        
+        void allocate(size_t capacity) {
+            capacity_ = capacity;
+            ctrl_ = new Ctrl[capacity_ + WIDTH];
+            slots_ = std::allocator<Entry>().allocate(capacity_);
+            reset_ctrl();
+        }
+        
+        void deallocate() {
+            if (slots_ != nullptr) {
+                std::allocator<Entry>().deallocate(slots_, capacity_);
+            }
+            delete[] ctrl_;
+            ctrl_ = nullptr;
+            slots_ = nullptr;
+        }
+        
+        void reset_ctrl() {
+            std::memset(ctrl_, static_cast<unsigned char>(flat_hash::EMPTY), capacity_ + WIDTH);
+        }
+        
+        void destroy_slots() {
+            for (size_t i = 0; i < capacity_; i++) {
+                if (flat_hash::is_full(ctrl_[i])) {
+                    slots_[i].~Entry();
+                }
+            }
+        }
+        
+        size_t find_index(const K& key, uint64_t h) const {
+            size_t mask = capacity_ - 1;
+            size_t pos = h1(h) & mask;
+            Ctrl tag = h2(h);
+            
+            for (size_t step = WIDTH; ; step += WIDTH) {
+                Group group(ctrl_ + pos);
+                for (uint32_t match = group.match(tag); match != 0; match &= match - 1) {
+                    size_t index = (pos + flat_hash::trailing_zeros(match)) & mask;
+                    if (equal_(slots_[index].key, key)) {
+                        return index;
+                    }
+                }
+                if (group.match_empty() != 0) {
+                    return NOT_FOUND;
+                }
+                pos = (pos + step) & mask;
+            }
+        }
+        
+        // Returns (index of key, true) or (slot to insert into, false) in a
+        // single probe: the first free slot seen is remembered while the
+        // probe runs on to an empty group to rule the key out.
+        std::pair<size_t, bool> find_or_prepare_insert(const K& key, uint64_t h) const {
+            size_t mask = capacity_ - 1;
+            size_t pos = h1(h) & mask;
+            Ctrl tag = h2(h);
+            size_t free_slot = NOT_FOUND;
+            
+            for (size_t step = WIDTH; ; step += WIDTH) {
+                Group group(ctrl_ + pos);
+                for (uint32_t match = group.match(tag); match != 0; match &= match - 1) {
+                    size_t index = (pos + flat_hash::trailing_zeros(match)) & mask;
+                    if (equal_(slots_[index].key, key)) {
+                        return std::make_pair(index, true);
+                    }
+                }
+                
+                uint32_t free_mask = group.match_empty_or_deleted();
+                if (free_slot == NOT_FOUND && free_mask != 0) {
+                    free_slot = (pos + flat_hash::trailing_zeros(free_mask)) & mask;
+                }
+                if (group.match_empty() != 0) {
+                    return std::make_pair(free_slot, false);
+                }
+                pos = (pos + step) & mask;
+            }
+        }
+        
+        size_t find_first_free(uint64_t h) const {
+            size_t mask = capacity_ - 1;
+            size_t pos = h1(h) & mask;
+            
+            for (size_t step = WIDTH; ; step += WIDTH) {
+                uint32_t free_mask = Group(ctrl_ + pos).match_empty_or_deleted();
+                if (free_mask != 0) {
+                    return (pos + flat_hash::trailing_zeros(free_mask)) & mask;
+                }
+                pos = (pos + step) & mask;
+            }
+        }
+        
+        void erase_at(size_t index) {
+            slots_[index].~Entry();
+            size_--;
+            
+            // If no probe window can span this slot without meeting an empty
+            // slot, it can go straight back to empty instead of a tombstone
+            size_t mask = capacity_ - 1;
+            size_t before = (index - WIDTH) & mask;
+            uint32_t empty_after = Group(ctrl_ + index).match_empty();
+            uint32_t empty_before = Group(ctrl_ + before).match_empty();
+            bool was_never_full = empty_after != 0 && empty_before != 0 &&
+                                  flat_hash::trailing_zeros(empty_after) + leading_zeros16(empty_before) < WIDTH;
+            
+            if (was_never_full) {
+                set_ctrl(index, flat_hash::EMPTY);
+            } else {
+                set_ctrl(index, flat_hash::DELETED);
+                deleted_++;
+            }
+        }
+        
+        static uint32_t leading_zeros16(uint32_t mask) {
+            uint32_t count = 0;
+            for (uint32_t bit = 1u << (WIDTH - 1); bit != 0 && (mask & bit) == 0; bit >>= 1) {
+                count++;
+            }
+            return count;
+        }
+        
+        void reserve_one() {
+            if (size_ + deleted_ + 1 <= max_fill()) {
+                return;
+            }
+            
+            // Enough of the fill is tombstones: clean up at the same size
+            // rather than grow (a 25/32 live ratio still leaves headroom
+            // before the next cleanup)
+            if (size_ * 32 <= capacity_ * 25) {
+                drop_deleted_in_place();
+            } else {
+                resize(capacity_ * 2);
+            }
+        }
+        
+        void resize(size_t new_capacity) {
+            Ctrl* old_ctrl = ctrl_;
+            Entry* old_slots = slots_;
+            size_t old_capacity = capacity_;
+            
+            allocate(new_capacity);
+            for (size_t i = 0; i < old_capacity; i++) {
+                if (!flat_hash::is_full(old_ctrl[i])) {
+                    continue;
+                }
+                uint64_t h = hash_of(old_slots[i].key);
+                size_t target = find_first_free(h);
+                new (&slots_[target]) Entry(std::move(old_slots[i]));
+                set_ctrl(target, h2(h));
+                old_slots[i].~Entry();
+            }
+            deleted_ = 0;
+            
+            std::allocator<Entry>().deallocate(old_slots, old_capacity);
+            delete[] old_ctrl;
+        }
+        
+        // Same-capacity rehash that reuses the slot array: every live entry is
+        // moved (or swapped) to the first free slot of its probe sequence
+        void drop_deleted_in_place() {
+            // Full -> DELETED (still to place), everything else -> EMPTY
+            for (size_t i = 0; i < capacity_; i++) {
+                ctrl_[i] = flat_hash::is_full(ctrl_[i]) ? flat_hash::DELETED : flat_hash::EMPTY;
+            }
+            std::memcpy(ctrl_ + capacity_, ctrl_, WIDTH);
+            
+            size_t mask = capacity_ - 1;
+            for (size_t i = 0; i < capacity_; i++) {
+                if (ctrl_[i] != flat_hash::DELETED) {
+                    continue;
+                }
+                
+                uint64_t h = hash_of(slots_[i].key);
+                size_t target = find_first_free(h);
+                size_t probe_start = h1(h) & mask;
+                
+                // Already within the first group of its probe: stays put
+                if (((i - probe_start) & mask) / WIDTH == ((target - probe_start) & mask) / WIDTH) {
+                    set_ctrl(i, h2(h));
+                    continue;
+                }
+                
+                if (ctrl_[target] == flat_hash::EMPTY) {
+                    new (&slots_[target]) Entry(std::move(slots_[i]));
+                    slots_[i].~Entry();
+                    set_ctrl(target, h2(h));
+                    set_ctrl(i, flat_hash::EMPTY);
+                } else {
+                    // Target holds another entry still to be placed: swap and
+                    // process the displaced entry from slot i again
+                    std::swap(slots_[i], slots_[target]);
+                    set_ctrl(target, h2(h));
+                    i--;
+                }
+            }
+            deleted_ = 0;
+        }
+    };
+
+} // namespace core
+} // namespace minidb
+
+#endif // MINIDB_CORE_FLAT_HASH_MAP_H
@@ -0,0 +1,116 @@
+/**
+ * @file tree_node.h
+ * @brief Node allocation and in-node search shared by BTree and BPlusTree
+ */
+
+#ifndef MINIDB_CORE_TREE_NODE_H
+#define MINIDB_CORE_TREE_NODE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace minidb {
+namespace core {
+
+    /**
+     * @brief Hands out nodes from contiguous blocks instead of one heap
+     *        allocation per node
+     *
+     * Nodes are default-constructed when their block is created and stay
+     * alive until clear() or destruction; release() only puts a node on a
+     * free list for reuse. Callers reset node fields after allocate().
+     * Node addresses are stable for the arena's lifetime.
+     *
+     * @tparam Node Default-constructible node type
+     * @tparam BlockSize Nodes per block
+     */
+    template<typename Node, size_t BlockSize = 64>
+    class NodeArena {
+    public:
+        NodeArena() : block_used_(BlockSize), live_count_(0) {}
+        
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+        
+        Node* allocate() {
+            live_count_++;
+            if (!free_nodes_.empty()) {
+                Node* node = free_nodes_.back();
+                free_nodes_.pop_back();
+                return node;
+            }
+            
+            if (block_used_ == BlockSize) {
+                blocks_.push_back(std::make_unique<Node[]>(BlockSize));
+                block_used_ = 0;
+            }
+            return &blocks_.back()[block_used_++];
+        }
+        
+        void release(Node* node) {
+            free_nodes_.push_back(node);
+            live_count_--;
+        }
+        
+        void clear() {
+            blocks_.clear();
+            free_nodes_.clear();
+            block_used_ = BlockSize;
+            live_count_ = 0;
+        }
+        
+        size_t live_count() const { return live_count_; }
+        size_t capacity() const { return blocks_.size() * BlockSize; }
+        
+    private:
+        std::vector<std::unique_ptr<Node[]>> blocks_;
+        std::vector<Node*> free_nodes_;
+        size_t block_used_;
+        size_t live_count_;
+    };
+    
+    /**
+     * @brief Index of the first of count sorted keys that is not less than key
+     *
+     * Branch-free binary search: the loop has a fixed trip count for a given
+     * count and the comparison compiles to a conditional move, so node
+     * searches don't pay for mispredicted branches.
+     */
+    template<typename T, typename Less>
+    size_t lower_bound_index(const T* keys, size_t count, const T& key, const Less& less) {
+        if (count == 0) {
+            return 0;
+        }
+        
+        const T* base = keys;
+        while (count > 1) {
+            size_t half = count / 2;
+            base = less(base[half - 1], key) ? base + half : base;
+            count -= half;
+        }
+        return static_cast<size_t>(base - keys) + (less(*base, key) ? 1 : 0);
+    }
+    
+    /**
+     * @brief Index of the first of count sorted keys that is greater than key
+     */
+    template<typename T, typename Less>
+    size_t upper_bound_index(const T* keys, size_t count, const T& key, const Less& less) {
+        if (count == 0) {
+            return 0;
+        }
+        
+        const T* base = keys;
+        while (count > 1) {
+            size_t half = count / 2;
+            base = less(key, base[half - 1]) ? base : base + half;
+            count -= half;
+        }
+        return static_cast<size_t>(base - keys) + (less(key, *base) ? 0 : 1);
+    }
+
+} // namespace core
+} // namespace minidb
+
+#endif // MINIDB_CORE_TREE_NODE_H
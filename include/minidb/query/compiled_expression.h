@@ -0,0 +1,49 @@
+/**
+ * @file compiled_expression.h
+ * @brief WHERE clauses bound to a schema and compiled to predicates
+ *
+ * Binding resolves column names to ordinals once per query. Comparisons
+ * against a literal become closures specialized on the literal's type
+ * and the operator, so a row costs one value load and one native compare
+ * instead of a name lookup and a Value::compare type switch.
+ */
+
+#ifndef MINIDB_QUERY_COMPILED_EXPRESSION_H
+#define MINIDB_QUERY_COMPILED_EXPRESSION_H
+
+#include "minidb/query/parser.h"
+#include "minidb/storage/table.h"
+#include <functional>
+
+namespace minidb {
+namespace query {
+
+    /**
+     * @brief Row filter with the same result as evaluating the expression
+     *        and testing for a non-zero INTEGER
+     */
+    class CompiledPredicate {
+    public:
+        using Function = std::function<bool(const storage::Row&)>;
+        
+        // Accepts every row
+        CompiledPredicate() = default;
+        
+        /**
+         * @brief Bind expr to schema and compile it
+         * @param expr May be null, which accepts every row
+         */
+        static CompiledPredicate compile(const Expression* expr, const storage::TableSchema& schema);
+        
+        bool operator()(const storage::Row& row) const { return !function_ || function_(row); }
+        
+    private:
+        explicit CompiledPredicate(Function function) : function_(std::move(function)) {}
+        
+        Function function_;
+    };
+
+} // namespace query
+} // namespace minidb
+
+#endif // MINIDB_QUERY_COMPILED_EXPRESSION_H
@@ -0,0 +1,77 @@
+/**
+ * @file plan_cache.h
+ * @brief LRU cache of prepared statements keyed by normalized SQL
+ *
+ * QueryExecutor::execute_sql looks statements up here before parsing, so
+ * repeating the same SQL skips tokenizing, parsing and (while the catalog
+ * is unchanged) planning.
+ */
+
+#ifndef MINIDB_QUERY_PLAN_CACHE_H
+#define MINIDB_QUERY_PLAN_CACHE_H
+
+#include "minidb/query/prepared_statement.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace minidb {
+namespace query {
+
+    /**
+     * @brief Thread-safe LRU of prepared statements
+     *
+     * A statement is checked out with take() and returned with put(), so
+     * two threads running the same SQL never share a plan: the second one
+     * misses and prepares its own.
+     */
+    class PlanCache {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 128;
+        
+        explicit PlanCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+        
+        /**
+         * @brief Cache key for sql
+         *
+         * Upper-cases everything outside quotes, collapses whitespace runs
+         * and drops trailing semicolons, all of which the tokenizer ignores.
+         */
+        static std::string normalize(const std::string& sql);
+        
+        // Remove and return the statement cached under key, or null
+        std::unique_ptr<PreparedStatement> take(const std::string& key);
+        
+        // Cache statement under key as the most recently used entry
+        void put(const std::string& key, std::unique_ptr<PreparedStatement> statement);
+        
+        // Zero disables caching
+        void set_capacity(size_t capacity);
+        size_t capacity() const;
+        size_t size() const;
+        void clear();
+        
+        uint64_t hits() const;
+        uint64_t misses() const;
+    
+    private:
+        struct Entry {
+            std::string key;
+            std::unique_ptr<PreparedStatement> statement;
+        };
+        
+        void evict_unlocked();
+        
+        mutable std::mutex mutex_;
+        size_t capacity_;
+        std::list<Entry> entries_;  // Most recently used first
+        std::unordered_map<std::string, std::list<Entry>::iterator> positions_;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+    };
+
+} // namespace query
+} // namespace minidb
+
+#endif // MINIDB_QUERY_PLAN_CACHE_H
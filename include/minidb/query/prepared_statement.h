@@ -0,0 +1,70 @@
+/**
+ * @file prepared_statement.h
+ * @brief Statements parsed once and executed many times
+ *
+ * A prepared statement owns its parsed Statement and the last plan built
+ * for it. "?" placeholders are bound to values between executions; the
+ * plan is kept until a binding changes or the catalog it was built
+ * against does (a table or index created or dropped).
+ */
+
+#ifndef MINIDB_QUERY_PREPARED_STATEMENT_H
+#define MINIDB_QUERY_PREPARED_STATEMENT_H
+
+#include "minidb/query/parser.h"
+#include <memory>
+#include <vector>
+
+namespace minidb {
+namespace query {
+
+    class PlanNode;
+    class QueryExecutor;
+    
+    /**
+     * @brief A parsed statement with bindable parameters and a cached plan
+     *
+     * Not safe for concurrent use; give each thread its own.
+     */
+    class PreparedStatement {
+    public:
+        PreparedStatement(std::unique_ptr<Statement> statement, std::vector<ParameterSlot> parameters);
+        ~PreparedStatement();
+        
+        PreparedStatement(const PreparedStatement&) = delete;
+        PreparedStatement& operator=(const PreparedStatement&) = delete;
+        
+        size_t parameter_count() const { return parameters_.size(); }
+        
+        /**
+         * @brief Bind the value of a "?" placeholder
+         * @param index Zero-based, in the order the placeholders appear
+         * @return false if there is no such parameter
+         */
+        bool bind(size_t index, const storage::Value& value);
+        
+        // Unbind every parameter; executing then fails until they are bound again
+        void clear_bindings();
+        
+        // Index of the first unbound parameter, or SIZE_MAX if all are bound
+        size_t first_unbound() const;
+        
+        const Statement* get_statement() const { return statement_.get(); }
+    
+    private:
+        friend class QueryExecutor;
+        
+        std::unique_ptr<Statement> statement_;
+        std::vector<ParameterSlot> parameters_;
+        std::vector<bool> bound_;
+        
+        // Plan for the current bindings, and the catalog it was built against
+        std::unique_ptr<PlanNode> plan_;
+        uint64_t plan_catalog_version_ = 0;
+        uint64_t plan_index_version_ = 0;
+    };
+
+} // namespace query
+} // namespace minidb
+
+#endif // MINIDB_QUERY_PREPARED_STATEMENT_H
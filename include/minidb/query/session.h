@@ -0,0 +1,59 @@
+/**
+ * @file session.h
+ * @brief Per-connection state that outlives a single statement
+ *
+ * A session carries the transaction opened by BEGIN until COMMIT or
+ * ROLLBACK. Statements executed without a session, or in a session with no
+ * transaction open, each run in a transaction of their own.
+ */
+
+#ifndef MINIDB_QUERY_SESSION_H
+#define MINIDB_QUERY_SESSION_H
+
+#include "minidb/storage/transaction.h"
+#include <memory>
+
+namespace minidb {
+namespace query {
+
+    class QueryExecutor;
+    
+    /**
+     * @brief One client's open transaction, if any
+     *
+     * Not safe for concurrent use; each connection needs its own. A session
+     * destroyed with a transaction still open rolls it back.
+     */
+    class Session {
+    public:
+        Session() : manager_(nullptr) {}
+        
+        ~Session() {
+            rollback();
+        }
+        
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+        
+        bool in_transaction() const { return txn_ != nullptr; }
+        storage::Transaction* transaction() const { return txn_.get(); }
+        
+        // Abandon the open transaction, e.g. when the connection goes away
+        void rollback() {
+            if (txn_ && manager_ != nullptr) {
+                manager_->rollback(*txn_);
+            }
+            txn_.reset();
+        }
+    
+    private:
+        friend class QueryExecutor;
+        
+        std::unique_ptr<storage::Transaction> txn_;
+        storage::TransactionManager* manager_;
+    };
+
+} // namespace query
+} // namespace minidb
+
+#endif // MINIDB_QUERY_SESSION_H
@@ -0,0 +1,91 @@
+/**
+ * @file vector_batch.h
+ * @brief Column vectors and comparison kernels for batch filtering
+ *
+ * A scan that filters on "column op literal" copies the column out of a
+ * batch of rows into a contiguous vector, compares the whole vector at
+ * once, and keeps the positions that passed in a selection vector. The
+ * int64 and double kernels use AVX2 when the CPU has it.
+ */
+
+#ifndef MINIDB_QUERY_VECTOR_BATCH_H
+#define MINIDB_QUERY_VECTOR_BATCH_H
+
+#include "minidb/storage/table.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace minidb {
+namespace query {
+
+    // Rows per batch; large enough to amortize the per-batch setup
+    constexpr size_t BATCH_SIZE = 1024;
+    
+    enum class CompareOp : uint8_t {
+        EQUAL,
+        NOT_EQUAL,
+        LESS_THAN,
+        LESS_EQUAL,
+        GREATER_THAN,
+        GREATER_EQUAL
+    };
+    
+    /**
+     * @brief One column of a batch, stored as a flat vector of one type
+     *
+     * Values of another type (or NULL) are marked untyped and keep a
+     * pointer to the original value so they can be compared the slow way.
+     * String entries view the source rows, which must outlive the vector.
+     */
+    class ColumnVector {
+    public:
+        void reset(storage::ColumnType type);
+        void append(const storage::Value& value);
+        
+        storage::ColumnType type() const { return type_; }
+        size_t size() const { return sources_.size(); }
+        
+        const int64_t* ints() const { return ints_.data(); }
+        const double* reals() const { return reals_.data(); }
+        const std::string_view* strings() const { return strings_.data(); }
+        bool is_typed(size_t i) const { return typed_[i] != 0; }
+        size_t untyped_count() const { return untyped_count_; }
+        const storage::Value& source(size_t i) const { return *sources_[i]; }
+        
+    private:
+        storage::ColumnType type_ = storage::ColumnType::NULL_TYPE;
+        std::vector<int64_t> ints_;
+        std::vector<double> reals_;
+        std::vector<std::string_view> strings_;
+        std::vector<uint8_t> typed_;
+        std::vector<const storage::Value*> sources_;
+        size_t untyped_count_ = 0;
+    };
+    
+    // Set mask[i] to 1 where values[i] op literal holds, 0 otherwise.
+    // Doubles follow Value::compare: unordered values compare equal.
+    void compare_int64(const int64_t* values, size_t count, CompareOp op, int64_t literal, uint8_t* mask);
+    void compare_double(const double* values, size_t count, CompareOp op, double literal, uint8_t* mask);
+    void compare_string(const std::string_view* values, size_t count, CompareOp op,
+                        std::string_view literal, uint8_t* mask);
+                        
+    /**
+     * @brief Compact a 0/1 mask into the positions that are set
+     * @return Number of positions written to selection
+     */
+    size_t mask_to_selection(const uint8_t* mask, size_t count, uint32_t* selection);
+    
+    /**
+     * @brief Evaluate "column op literal" over a column vector
+     * @param selection Receives the positions that pass, in order
+     * @return Number of selected positions
+     */
+    size_t select_rows(const ColumnVector& column, CompareOp op, const storage::Value& literal,
+                       std::vector<uint32_t>& selection);
+
+} // namespace query
+} // namespace minidb
+
+#endif // MINIDB_QUERY_VECTOR_BATCH_H
@@ -0,0 +1,139 @@
+/**
+ * @file server.h
+ * @brief Multi-client network front end over one shared Database
+ *
+ * Clients speak a line protocol over TCP. Each line is one SQL statement,
+ * and a client may send any number of them without waiting for the
+ * replies (pipelining). Replies come back in the order the statements
+ * were sent:
+ *
+ *   COLUMNS name<TAB>name...   column names, for statements that return rows
+ *   ROW value<TAB>value...     one per row
+ *   OK n                       end of a successful reply: rows returned or affected
+ *   ERROR message              end of a failed reply
+ *
+ * In values, backslash, tab, newline and carriage return are escaped as
+ * \\, \t, \n and \r, and NULL is sent as \N.
+ *
+ * One thread runs an epoll event loop over every socket and does all the
+ * reading and writing. Statements run on a pool of worker threads. One
+ * connection's statements run one at a time, in order, in that
+ * connection's own session, so BEGIN ... COMMIT spans lines the way it
+ * would over a CLI. Different connections run in parallel.
+ */
+
+#ifndef MINIDB_SERVER_SERVER_H
+#define MINIDB_SERVER_SERVER_H
+
+#include "minidb/minidb.h"
+#include "minidb/utils/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace minidb {
+namespace server {
+
+    struct ServerConfig {
+        std::string host = "127.0.0.1";
+        uint16_t port = 5433;  // 0 picks a free port; see Server::port()
+        size_t workers = 0;  // 0 means one per hardware thread
+        
+        // A connection whose unsent replies grow past this stops being
+        // read, and its running statement waits, until the client catches up
+        size_t max_output_bytes = 4 * 1024 * 1024;
+        
+        // A statement kept waiting this long for the client to catch up is
+        // stopped and the connection closed, so a client that never reads
+        // cannot hold a worker, its transaction and the catalog forever
+        std::chrono::milliseconds stall_timeout = std::chrono::seconds(30);
+        
+        // Longest statement line accepted; longer ones close the connection
+        size_t max_line_bytes = 1024 * 1024;
+    };
+    
+    /**
+     * @brief TCP server running statements from many clients concurrently
+     *
+     * The Database must be open before start() and stay open until stop()
+     * returns. A client that disconnects with a transaction open has it
+     * rolled back.
+     */
+    class Server {
+    public:
+        struct Stats {
+            size_t connections_accepted;
+            size_t connections_open;
+            size_t statements;
+        };
+        
+        Server(Database& database, const ServerConfig& config = ServerConfig());
+        ~Server();
+        
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+        
+        /**
+         * @brief Bind, listen and start the event loop and workers
+         * @param error Set to the reason on failure, if not null
+         */
+        bool start(std::string* error = nullptr);
+        
+        // Close every connection and wait for running statements to finish
+        void stop();
+        
+        bool is_running() const { return loop_.joinable(); }
+        
+        // Port actually bound, which differs from the config's when that was 0
+        uint16_t port() const { return bound_port_; }
+        
+        Stats get_stats() const;
+    
+    private:
+        struct Connection;
+        class ReplySink;
+        
+        void event_loop();
+        void accept_clients();
+        void read_client(const std::shared_ptr<Connection>& connection);
+        void flush_client(const std::shared_ptr<Connection>& connection);
+        void close_client(const std::shared_ptr<Connection>& connection);
+        void watch(Connection& connection, bool readable, bool writable);
+        
+        // Worker side: run queued statements until the connection has none
+        void run_statements(const std::shared_ptr<Connection>& connection);
+        void wake(int fd);
+        
+        Database& database_;
+        ServerConfig config_;
+        uint16_t bound_port_;
+        
+        int listen_fd_;
+        int epoll_fd_;
+        int wake_fd_;  // eventfd workers use to hand replies to the loop
+        std::thread loop_;
+        std::atomic<bool> stopping_;
+        std::unique_ptr<utils::ThreadPool> workers_;
+        
+        // Owned by the event loop thread
+        std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+        
+        // Connections with replies to send; guarded by ready_mutex_
+        std::vector<int> ready_;
+        std::mutex ready_mutex_;
+        
+        std::atomic<size_t> connections_accepted_;
+        std::atomic<size_t> connections_open_;
+        std::atomic<size_t> statements_;
+    };
+
+} // namespace server
+} // namespace minidb
+
+#endif // MINIDB_SERVER_SERVER_H
@@ -0,0 +1,95 @@
+/**
+ * @file column_store.h
+ * @brief Column-oriented storage for analytic tables
+ *
+ * A table created with USING COLUMNAR keeps each column in its own typed
+ * array instead of slotted heap pages. NULLs live in a bitmap and TEXT
+ * columns are dictionary encoded, so a scan that needs two columns of a
+ * wide table only touches those two arrays.
+ */
+
+#ifndef MINIDB_STORAGE_COLUMN_STORE_H
+#define MINIDB_STORAGE_COLUMN_STORE_H
+
+#include "minidb/core/flat_hash_map.h"
+#include "minidb/storage/table.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    /**
+     * @brief Rows stored as one array per column
+     *
+     * Rows are addressed by position; deleted positions are marked and
+     * reclaimed in bulk once they make up half of the store. Not thread
+     * safe: the owning Table's latch serializes access.
+     */
+    class ColumnStore {
+    public:
+        // Positions per segment; scans read a segment at a time
+        static constexpr size_t SEGMENT_ROWS = 1024;
+        
+        explicit ColumnStore(const TableSchema& schema);
+        
+        // False if row_id is already present
+        bool append(const Row& row, uint64_t row_id);
+        bool update(uint64_t row_id, const Row& row);
+        bool erase(uint64_t row_id);
+        bool get(uint64_t row_id, Row& row) const;
+        bool contains(uint64_t row_id) const { return positions_.find(row_id) != nullptr; }
+        void clear();
+        
+        size_t size() const { return positions_.size(); }
+        size_t segment_count() const { return (row_ids_.size() + SEGMENT_ROWS - 1) / SEGMENT_ROWS; }
+        
+        /**
+         * @brief Materialize the live rows of one segment
+         * @param columns Ordinals to read, or null for all of them. Columns
+         *        not listed are left NULL so ordinals still line up.
+         * @return False once segment is past the end
+         */
+        bool read_segment(size_t segment, const std::vector<size_t>* columns, std::vector<Row>& rows) const;
+        
+        // Distinct strings held for a TEXT column (0 for other types)
+        size_t dictionary_size(size_t column) const;
+        
+    private:
+        // Values whose type differs from the column's are kept aside, so
+        // anything the row format accepts round-trips unchanged
+        struct ColumnData {
+            ColumnType type;
+            std::vector<int64_t> ints;
+            std::vector<double> reals;
+            std::vector<uint32_t> codes;
+            std::vector<std::string> dictionary;
+            core::FlatHashMap<std::string, uint32_t> dictionary_codes;
+            std::vector<uint64_t> nulls;
+            std::vector<uint64_t> mismatched;
+            std::unordered_map<size_t, Value> others;
+            
+            explicit ColumnData(ColumnType t) : type(t) {}
+        };
+        
+        void push_slot(ColumnData& column);
+        void store(ColumnData& column, size_t position, const Value& value);
+        Value load(const ColumnData& column, size_t position) const;
+        void fill_row(size_t position, const std::vector<size_t>* columns, Row& row) const;
+        void compact();
+        
+        std::vector<ColumnType> types_;
+        std::vector<ColumnData> columns_;
+        std::vector<uint64_t> row_ids_;
+        std::vector<uint64_t> deleted_;
+        size_t deleted_count_;
+        core::FlatHashMap<uint64_t, size_t> positions_;
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_COLUMN_STORE_H
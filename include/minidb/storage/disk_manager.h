@@ -0,0 +1,103 @@
+/**
+ * @file disk_manager.h
+ * @brief Positioned page I/O against a single database file
+ */
+
+#ifndef MINIDB_STORAGE_DISK_MANAGER_H
+#define MINIDB_STORAGE_DISK_MANAGER_H
+
+#include "minidb/storage/page_manager.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace minidb {
+namespace storage {
+
+    /**
+     * @brief Reads and writes fixed-size pages of a database file
+     *
+     * Page N lives at byte offset N * page_size. Page 0 is never handed out
+     * by the PageManager (it is INVALID_PAGE_ID) and is reserved for a file
+     * header. Reads past the end of the file return a zero-filled page.
+     *
+     * read_page() and write_page() may be called concurrently for different
+     * pages on POSIX systems (they use pread/pwrite and keep no file offset).
+     *
+     * A read-only base image (a memory-mapped snapshot) can sit underneath
+     * the file: base pages not written since are served straight from it,
+     * so each is only paged in when first touched.
+     */
+    class DiskManager {
+    public:
+        explicit DiskManager(PageSize page_size = DEFAULT_PAGE_SIZE);
+        ~DiskManager();
+        
+        DiskManager(const DiskManager&) = delete;
+        DiskManager& operator=(const DiskManager&) = delete;
+        
+        /**
+         * @brief Open (or create) the database file
+         * @param path File path
+         * @param truncate Discard any existing contents
+         * @return true on success
+         */
+        bool open(const std::string& path, bool truncate = false);
+        
+        /**
+         * @brief Close the database file
+         */
+        void close();
+        
+        bool is_open() const { return fd_ >= 0; }
+        const std::string& get_path() const { return path_; }
+        
+        /**
+         * @brief Read one page into buffer (page_size bytes)
+         */
+        bool read_page(PageId page_id, char* buffer);
+        
+        /**
+         * @brief Write one page from buffer (page_size bytes)
+         */
+        bool write_page(PageId page_id, const char* buffer);
+        
+        /**
+         * @brief Flush written pages to stable storage
+         */
+        bool sync();
+        
+        /**
+         * @brief Number of page slots currently in the file (including page 0)
+         *
+         * Pages of the base image count too.
+         */
+        PageId get_page_count() const;
+        
+        /**
+         * @brief Serve pages below page_count from data until they are written
+         * @param data page_count * page_size bytes; must stay valid until the
+         *        manager is destroyed or the image is replaced
+         */
+        void set_base_image(const char* data, PageId page_count);
+        
+        size_t get_read_count() const { return read_count_.load(); }
+        size_t get_write_count() const { return write_count_.load(); }
+        
+    private:
+        int fd_;
+        std::string path_;
+        PageSize page_size_;
+        std::atomic<size_t> read_count_;
+        std::atomic<size_t> write_count_;
+        
+        const char* base_data_;
+        PageId base_page_count_;
+        std::unique_ptr<std::atomic<bool>[]> base_replaced_;  // Written to the file since
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_DISK_MANAGER_H
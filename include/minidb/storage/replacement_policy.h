@@ -0,0 +1,133 @@
+/**
+ * @file replacement_policy.h
+ * @brief Additional buffer pool replacement policies (CLOCK, 2Q, LRU-K)
+ *
+ * LRUPolicy, the default, lives next to PageManager in page_manager.h.
+ * Every policy here answers select_victim() in O(1) amortized time while few
+ * pages are pinned; none of them scan the whole pool per eviction.
+ */
+
+#ifndef MINIDB_STORAGE_REPLACEMENT_POLICY_H
+#define MINIDB_STORAGE_REPLACEMENT_POLICY_H
+
+#include "minidb/storage/page_manager.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace minidb {
+namespace storage {
+
+    /**
+     * @brief Second-chance CLOCK: a ring of pages with one reference bit each
+     */
+    class ClockPolicy : public ReplacementPolicy {
+    public:
+        ClockPolicy();
+        
+        PageId select_victim(const EvictablePredicate& can_evict) override;
+        void page_accessed(PageId page_id) override;
+        void page_added(PageId page_id) override;
+        void page_removed(PageId page_id) override;
+        
+    private:
+        struct Frame {
+            PageId page_id;
+            bool referenced;
+        };
+        
+        std::list<Frame> ring_;
+        std::unordered_map<PageId, std::list<Frame>::iterator> frames_;
+        std::list<Frame>::iterator hand_;
+        
+        void advance_hand();
+    };
+    
+    /**
+     * @brief Simplified 2Q (Johnson & Shasha)
+     *
+     * New pages enter a FIFO probation queue (A1in). Pages evicted from
+     * probation are remembered in a ghost list (A1out); if such a page comes
+     * back it goes straight into the main LRU queue (Am). A one-pass
+     * sequential scan therefore only churns A1in and leaves the hot set alone.
+     */
+    class TwoQueuePolicy : public ReplacementPolicy {
+    public:
+        /**
+         * @param capacity Buffer pool size in pages; sizes A1in (25%) and A1out (50%)
+         */
+        explicit TwoQueuePolicy(size_t capacity);
+        
+        PageId select_victim(const EvictablePredicate& can_evict) override;
+        void page_accessed(PageId page_id) override;
+        void page_added(PageId page_id) override;
+        void page_removed(PageId page_id) override;
+        
+    private:
+        enum class Queue { A1_IN, AM };
+        
+        struct Entry {
+            Queue queue;
+            std::list<PageId>::iterator position;
+        };
+        
+        size_t a1in_limit_;
+        size_t a1out_limit_;
+        std::list<PageId> a1in_;   // FIFO, front is oldest
+        std::list<PageId> am_;     // LRU, front is least recent
+        std::list<PageId> a1out_;  // Ghost ids, front is oldest
+        std::unordered_map<PageId, Entry> resident_;
+        std::unordered_map<PageId, std::list<PageId>::iterator> ghosts_;
+        
+        void remember_ghost(PageId page_id);
+        PageId pick_from(std::list<PageId>& queue, const EvictablePredicate& can_evict) const;
+    };
+    
+    /**
+     * @brief LRU-K: evict the page whose K-th most recent access is oldest
+     *
+     * Pages with fewer than K recorded accesses have infinite backward
+     * K-distance and are evicted first, oldest first access first.
+     */
+    class LRUKPolicy : public ReplacementPolicy {
+    public:
+        explicit LRUKPolicy(size_t k = 2);
+        
+        PageId select_victim(const EvictablePredicate& can_evict) override;
+        void page_accessed(PageId page_id) override;
+        void page_added(PageId page_id) override;
+        void page_removed(PageId page_id) override;
+        
+    private:
+        struct History {
+            std::list<uint64_t> timestamps;  // Most recent at back, at most K
+        };
+        
+        size_t k_;
+        uint64_t clock_;
+        std::unordered_map<PageId, History> history_;
+        std::set<std::pair<uint64_t, PageId>> young_;  // < K accesses, by first access
+        std::set<std::pair<uint64_t, PageId>> mature_; // K accesses, by K-th most recent
+        
+        std::pair<uint64_t, PageId> order_key(PageId page_id, const History& history) const;
+        void erase_order(PageId page_id, const History& history);
+        void insert_order(PageId page_id, const History& history);
+    };
+    
+    /**
+     * @brief Create a replacement policy by name
+     * @param name "lru", "clock", "2q" or "lru-k"
+     * @param capacity Buffer pool size in pages (used by 2Q)
+     * @return Policy, or nullptr for an unknown name
+     */
+    std::unique_ptr<ReplacementPolicy> create_replacement_policy(const std::string& name,
+                                                                 size_t capacity);
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_REPLACEMENT_POLICY_H
@@ -0,0 +1,158 @@
+/**
+ * @file serialization.h
+ * @brief Binary encodings for rows and schemas
+ *
+ * Shared by heap pages, the write-ahead log and anything else that needs to
+ * put rows on disk. Integers are stored in host byte order.
+ */
+
+#ifndef MINIDB_STORAGE_SERIALIZATION_H
+#define MINIDB_STORAGE_SERIALIZATION_H
+
+#include "minidb/storage/table.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    /**
+     * @brief Appends fixed-size values and length-prefixed strings to a buffer
+     */
+    class ByteWriter {
+    public:
+        explicit ByteWriter(std::vector<char>& out) : out_(out) {}
+        
+        template<typename T>
+        void write(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "POD values only");
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            out_.insert(out_.end(), bytes, bytes + sizeof(T));
+        }
+        
+        void write_bytes(const char* data, size_t length) {
+            out_.insert(out_.end(), data, data + length);
+        }
+        
+        void write_string(std::string_view str) {
+            write(static_cast<uint32_t>(str.size()));
+            write_bytes(str.data(), str.size());
+        }
+        
+    private:
+        std::vector<char>& out_;
+    };
+    
+    /**
+     * @brief Bounds-checked reader over a byte range produced by ByteWriter
+     */
+    class ByteReader {
+    public:
+        ByteReader(const char* data, size_t size) : data_(data), size_(size), pos_(0) {}
+        
+        template<typename T>
+        bool read(T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "POD values only");
+            if (pos_ + sizeof(T) > size_) {
+                return false;
+            }
+            std::memcpy(&value, data_ + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return true;
+        }
+        
+        bool read_string(std::string& str) {
+            uint32_t length = 0;
+            if (!read(length) || pos_ + length > size_) {
+                return false;
+            }
+            str.assign(data_ + pos_, length);
+            pos_ += length;
+            return true;
+        }
+        
+        bool read_bytes(char* data, size_t length) {
+            if (pos_ + length > size_) {
+                return false;
+            }
+            std::memcpy(data, data_ + pos_, length);
+            pos_ += length;
+            return true;
+        }
+        
+        // View into the reader's buffer, valid as long as that is
+        bool read_string(std::string_view& str) {
+            uint32_t length = 0;
+            if (!read(length) || pos_ + length > size_) {
+                return false;
+            }
+            str = std::string_view(data_ + pos_, length);
+            pos_ += length;
+            return true;
+        }
+        
+        size_t position() const { return pos_; }
+        size_t remaining() const { return size_ - pos_; }
+        const char* current() const { return data_ + pos_; }
+        
+    private:
+        const char* data_;
+        size_t size_;
+        size_t pos_;
+    };
+    
+    /**
+     * @brief Encode one value as [type:u8][payload], the per-value format of encode_row()
+     */
+    void write_value(ByteWriter& writer, const Value& value);
+    
+    /**
+     * @brief Decode a value written by write_value(); TEXT is copied out of the buffer
+     */
+    bool read_value(ByteReader& reader, Value& value);
+    
+    /**
+     * @brief Encode a row as [row_id:u64][value_count:u16] then per value [type:u8][payload]
+     *
+     * INTEGER and REAL payloads are 8 bytes, TEXT is a length-prefixed string,
+     * NULL has no payload.
+     */
+    void encode_row(const Row& row, uint64_t row_id, std::vector<char>& out);
+    
+    /**
+     * @brief Decode a row produced by encode_row(); sets the row id
+     */
+    bool decode_row(const char* data, size_t length, Row& row);
+    
+    /**
+     * @brief Read just the row id of an encoded row
+     * @return Row id, or 0 if the record is truncated
+     */
+    uint64_t decode_row_id(const char* data, size_t length);
+    
+    /**
+     * @brief Encode a schema: table name, then per column name, type and constraint flags
+     *
+     * The storage format follows, then the statistics of the last ANALYZE
+     * if the schema carries any.
+     */
+    void encode_schema(const TableSchema& schema, std::vector<char>& out);
+    
+    /**
+     * @brief Decode a schema produced by encode_schema()
+     */
+    bool decode_schema(const char* data, size_t length, TableSchema& schema);
+    
+    /**
+     * @brief CRC-32 (IEEE) of a byte range, used to detect torn or corrupt files
+     */
+    uint32_t crc32(const char* data, size_t length);
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_SERIALIZATION_H
@@ -0,0 +1,115 @@
+/**
+ * @file slotted_page.h
+ * @brief Slotted-page record layout on top of a buffer pool Page
+ */
+
+#ifndef MINIDB_STORAGE_SLOTTED_PAGE_H
+#define MINIDB_STORAGE_SLOTTED_PAGE_H
+
+#include "minidb/storage/page_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    using SlotId = uint16_t;
+    constexpr SlotId INVALID_SLOT_ID = 0xFFFF;
+    
+    /**
+     * @brief Physical address of a record: heap page plus slot number
+     */
+    struct RecordId {
+        PageId page_id = INVALID_PAGE_ID;
+        SlotId slot = INVALID_SLOT_ID;
+        
+        bool is_valid() const { return page_id != INVALID_PAGE_ID && slot != INVALID_SLOT_ID; }
+        bool operator==(const RecordId& other) const {
+            return page_id == other.page_id && slot == other.slot;
+        }
+    };
+    
+    /**
+     * @brief View over a Page formatted as a slotted heap page
+     *
+     * Layout: a fixed header, then the slot directory growing forward, then
+     * free space, then record bytes growing backward from the end of the page.
+     *
+     *   [slot_count | free_end | live_bytes][slot 0][slot 1]...  ...[rec 1][rec 0]
+     *
+     * Each slot holds (offset, length); a zero length marks a deleted slot that
+     * can be reused. Offsets are 16-bit, so pages are limited to 64 KB.
+     * The view does not own the page; the caller keeps it pinned while in use.
+     */
+    class SlottedPage {
+    public:
+        static constexpr size_t HEADER_SIZE = 3 * sizeof(uint16_t);
+        static constexpr size_t SLOT_SIZE = 2 * sizeof(uint16_t);
+        
+        explicit SlottedPage(Page* page) : page_(page) {}
+        
+        /**
+         * @brief Format the page as an empty slotted page
+         */
+        void init();
+        
+        /**
+         * @brief Store a record
+         * @return Slot number, or INVALID_SLOT_ID if it does not fit
+         */
+        SlotId insert(const char* data, size_t length);
+        
+        /**
+         * @brief Copy a record out of the page
+         * @return false if the slot is empty or out of range
+         */
+        bool read(SlotId slot, std::vector<char>& record) const;
+        
+        /**
+         * @brief Replace a record, keeping its slot number
+         * @return false if the new version does not fit in this page
+         */
+        bool update(SlotId slot, const char* data, size_t length);
+        
+        /**
+         * @brief Delete a record; its slot becomes reusable
+         */
+        bool erase(SlotId slot);
+        
+        bool is_live(SlotId slot) const;
+        SlotId slot_count() const { return get_u16(0); }
+        
+        /**
+         * @brief Largest record insert() is guaranteed to accept right now
+         *
+         * Counts space held by deleted records, which insert() reclaims by
+         * compacting the page when needed.
+         */
+        size_t available_space() const;
+        
+        /**
+         * @brief Largest record an empty page of the given size can hold
+         */
+        static size_t max_record_size(PageSize page_size) {
+            return page_size - HEADER_SIZE - SLOT_SIZE;
+        }
+        
+    private:
+        Page* page_;
+        
+        uint16_t get_u16(size_t offset) const;
+        void put_u16(size_t offset, uint16_t value);
+        
+        uint16_t free_end() const { return get_u16(sizeof(uint16_t)); }
+        uint16_t live_bytes() const { return get_u16(2 * sizeof(uint16_t)); }
+        size_t slot_offset(SlotId slot) const { return HEADER_SIZE + slot * SLOT_SIZE; }
+        size_t contiguous_free() const;
+        SlotId find_free_slot() const;
+        void compact();
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_SLOTTED_PAGE_H
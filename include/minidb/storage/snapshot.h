@@ -0,0 +1,124 @@
+/**
+ * @file snapshot.h
+ * @brief Checkpoint file that Database::open maps instead of replaying the log
+ *
+ * Layout, with page N at byte offset N * page_size as in the database file:
+ *
+ *   page 0     header: magic, version, page size, page count, checkpoint LSN,
+ *              catalog offset and length, catalog CRC
+ *   pages 1..  heap page images, numbered densely in the order they were added
+ *   catalog    after the last page: per table its schema, row directory,
+ *              columnar rows and index entries (see Table::write_snapshot)
+ *
+ * The catalog is read into memory at open. Page images are only touched when
+ * the buffer pool first asks for them, so opening costs the catalog, not the
+ * data.
+ */
+
+#ifndef MINIDB_STORAGE_SNAPSHOT_H
+#define MINIDB_STORAGE_SNAPSHOT_H
+
+#include "minidb/storage/page_manager.h"
+#include "minidb/storage/serialization.h"
+#include "minidb/storage/wal.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    /**
+     * @brief Builds a snapshot file
+     *
+     * Everything goes to path + ".tmp"; commit() syncs it and renames it over
+     * path, so a crash leaves either the previous snapshot or the new one.
+     * A writer destroyed without commit() removes its temporary file.
+     */
+    class SnapshotWriter {
+    public:
+        explicit SnapshotWriter(PageSize page_size);
+        ~SnapshotWriter();
+        
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+        
+        bool open(const std::string& path);
+        
+        /**
+         * @brief Append a page image
+         * @return Its page id in the snapshot, or INVALID_PAGE_ID on a write error
+         */
+        PageId add_page(const char* data);
+        
+        // Catalog bytes, written after the pages by commit()
+        std::vector<char>& catalog() { return catalog_; }
+        
+        /**
+         * @brief Write the catalog and header, sync, and replace the snapshot
+         * @param lsn Last log record the snapshot reflects
+         * @return true only once the rename itself is durable, so the log
+         *         records it covers may be dropped
+         */
+        bool commit(Lsn lsn);
+    
+    private:
+        void abandon();
+        
+        PageSize page_size_;
+        std::string path_;
+        std::string temp_path_;
+        std::FILE* file_;
+        PageId page_count_;
+        std::vector<char> catalog_;
+        bool failed_;
+    };
+    
+    /**
+     * @brief Read-only memory mapping of a snapshot file
+     *
+     * Page images are checked only for size; the catalog is verified against
+     * its CRC at open.
+     */
+    class Snapshot {
+    public:
+        Snapshot();
+        ~Snapshot();
+        
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        
+        static bool exists(const std::string& path);
+        
+        /**
+         * @brief Map the file and validate its header and catalog
+         * @param page_size Must match the size the snapshot was written with
+         */
+        bool open(const std::string& path, PageSize page_size);
+        void close();
+        
+        bool is_open() const { return data_ != nullptr; }
+        
+        // Base of page 0; page N starts N * page_size bytes in
+        const char* page_data() const { return data_; }
+        PageId page_count() const { return page_count_; }
+        Lsn get_lsn() const { return lsn_; }
+        
+        ByteReader catalog() const { return ByteReader(data_ + catalog_offset_, catalog_size_); }
+    
+    private:
+        const char* data_;
+        size_t size_;
+        PageId page_count_;
+        Lsn lsn_;
+        size_t catalog_offset_;
+        size_t catalog_size_;
+#ifdef _WIN32
+        std::vector<char> contents_;  // No mmap: the file is read whole
+#endif
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_SNAPSHOT_H
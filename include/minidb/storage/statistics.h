@@ -0,0 +1,90 @@
+/**
+ * @file statistics.h
+ * @brief Column statistics gathered by ANALYZE for the planner's estimates
+ *
+ * Statistics are a picture of the table when it was analyzed. They are
+ * kept as fractions of the rows, so estimates scale with the table's
+ * current row count as it grows or shrinks, but a changed distribution
+ * only shows up after the next ANALYZE.
+ */
+
+#ifndef MINIDB_STORAGE_STATISTICS_H
+#define MINIDB_STORAGE_STATISTICS_H
+
+#include "minidb/storage/table.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    /**
+     * @brief Distribution of one column's values
+     */
+    struct ColumnStatistics {
+        uint64_t distinct_count = 0;  // Distinct non-NULL values
+        double null_fraction = 0.0;
+        Value min;  // NULL when the column holds only NULLs
+        Value max;
+        
+        // Values that alone fill at least a histogram bucket, most frequent
+        // first, with the fraction of rows holding each
+        std::vector<std::pair<Value, double>> most_common;
+        
+        // Equi-depth histogram bounds: front() is the min, back() the max,
+        // and the size() - 1 buckets between them hold about equally many
+        // of the non-NULL values
+        std::vector<Value> histogram;
+        
+        /**
+         * @brief Fraction of rows equal to key; 0 for a NULL key
+         */
+        double equal_fraction(const Value& key) const;
+        
+        /**
+         * @brief Fraction of rows between the bounds, both inclusive
+         * @param lower Lower bound, or null for none
+         * @param upper Upper bound, or null for none
+         */
+        double range_fraction(const Value* lower, const Value* upper) const;
+    
+    private:
+        // Fraction of the non-NULL values below key, from the histogram
+        double fraction_below(const Value& key) const;
+    };
+    
+    /**
+     * @brief Statistics for every column of a table, in schema order
+     */
+    struct TableStatistics {
+        uint64_t row_count = 0;
+        std::vector<ColumnStatistics> columns;
+    };
+    
+    /**
+     * @brief Builds TableStatistics from every row of a table
+     *
+     * Exact rather than sampled: the builder keeps each column's non-NULL
+     * values and sorts them in finish().
+     */
+    class StatisticsBuilder {
+    public:
+        static constexpr size_t DEFAULT_HISTOGRAM_BUCKETS = 64;
+        static constexpr size_t MAX_MOST_COMMON = 16;
+        
+        explicit StatisticsBuilder(size_t column_count);
+        
+        void add(const Row& row);
+        TableStatistics finish(size_t histogram_buckets = DEFAULT_HISTOGRAM_BUCKETS);
+    
+    private:
+        std::vector<std::vector<Value>> values_;
+        uint64_t rows_;
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_STATISTICS_H
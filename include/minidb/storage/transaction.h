@@ -0,0 +1,238 @@
+/**
+ * @file transaction.h
+ * @brief Transactions and timestamps for multi-version snapshot isolation
+ *
+ * Every transaction reads the database as of its read timestamp: the
+ * commit timestamp of the last transaction that had committed when it
+ * began. Writers never overwrite a row another transaction may still read;
+ * they add a new version of it (see Table), and the old one stays until no
+ * open transaction can see it.
+ */
+
+#ifndef MINIDB_STORAGE_TRANSACTION_H
+#define MINIDB_STORAGE_TRANSACTION_H
+
+#include "minidb/storage/wal.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    class Table;
+    class Transaction;
+    
+    using Timestamp = uint64_t;
+    
+    // Commit timestamp of a writer that has not committed (or never will)
+    constexpr Timestamp TS_NEVER = UINT64_MAX;
+    
+    // Read timestamp of reads outside any transaction: every commit so far
+    constexpr Timestamp TS_LATEST = UINT64_MAX - 1;
+    
+    /**
+     * @brief Outcome of a writing transaction, shared by every version it wrote
+     *
+     * Commit is a single store of the commit timestamp, so all of a
+     * transaction's versions become visible at once.
+     */
+    struct TransactionStatus {
+        std::atomic<Timestamp> commit_ts{TS_NEVER};
+    };
+    
+    /**
+     * @brief When a row version started or stopped existing
+     *
+     * While the writer may still be running, the stamp points at its status;
+     * once the writer is known to have committed, garbage collection copies
+     * the timestamp in and drops the pointer.
+     */
+    struct VersionStamp {
+        Timestamp ts = TS_NEVER;
+        std::shared_ptr<TransactionStatus> writer;
+        
+        // Visible to everyone, e.g. rows that predate any open transaction
+        static VersionStamp frozen() { return VersionStamp{0, nullptr}; }
+        
+        bool is_set() const { return writer != nullptr || ts != TS_NEVER; }
+        Timestamp commit_ts() const { return writer ? writer->commit_ts.load(std::memory_order_acquire) : ts; }
+        bool written_by(const Transaction* txn) const;
+        
+        // Whether the change has happened as far as reader is concerned;
+        // a null reader sees every committed change
+        bool visible_to(const Transaction* reader) const;
+    };
+    
+    /**
+     * @brief One transaction's snapshot, write set and pending log records
+     *
+     * Log records are held back until commit, so the log never contains a
+     * change that was rolled back.
+     */
+    class Transaction {
+    public:
+        Transaction(uint64_t id, Timestamp read_ts);
+        
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+        
+        uint64_t get_id() const { return id_; }
+        Timestamp get_read_ts() const { return read_ts_; }
+        
+        // Stamp for versions this transaction writes
+        VersionStamp stamp();
+        const TransactionStatus* status() const { return status_.get(); }
+        
+        void record_write(Table* table, uint64_t row_id) { writes_.emplace_back(table, row_id); }
+        void log(LogRecordType type, const std::string& table_name, const std::vector<char>& payload);
+        
+        /**
+         * @brief Note that a write lost to a concurrent transaction
+         *
+         * Set when a row this transaction tried to change was changed by a
+         * transaction it cannot see; the transaction can only roll back.
+         */
+        void mark_conflict() { conflict_ = true; }
+        bool has_conflict() const { return conflict_; }
+        
+        bool has_writes() const { return !writes_.empty() || !log_.empty(); }
+        
+        // Transaction the calling thread is running statements for, if any
+        static Transaction* current();
+    
+    private:
+        friend class TransactionManager;
+        friend class TransactionScope;
+        
+        struct PendingRecord {
+            LogRecordType type;
+            std::string table_name;
+            std::vector<char> payload;
+        };
+        
+        uint64_t id_;
+        Timestamp read_ts_;
+        std::shared_ptr<TransactionStatus> status_;  // Created by the first write
+        std::vector<std::pair<Table*, uint64_t>> writes_;
+        std::vector<PendingRecord> log_;
+        std::multiset<Timestamp>::iterator active_entry_;
+        bool conflict_;
+    };
+    
+    /**
+     * @brief Makes txn the calling thread's current transaction until destroyed
+     */
+    class TransactionScope {
+    public:
+        explicit TransactionScope(Transaction* txn);
+        ~TransactionScope();
+        
+        TransactionScope(const TransactionScope&) = delete;
+        TransactionScope& operator=(const TransactionScope&) = delete;
+    
+    private:
+        Transaction* previous_;
+    };
+    
+    /**
+     * @brief Hands out timestamps and tracks open transactions
+     *
+     * A commit is durable before it is visible: its log records are appended
+     * and synced first, and only then is its commit timestamp published, so
+     * a transaction that begins sees either all of a commit or none of it,
+     * and, unless synchronous commit is off, nothing it sees can be lost in
+     * a crash. Concurrent commits may reach the log in any order, but a row
+     * can only be written again once the transaction holding it has
+     * published, so the log order of writes to one row follows that row's
+     * version order.
+     *
+     * The collector is a background thread that periodically hands the
+     * oldest read timestamp still in use to a callback (the executor's
+     * garbage collection), after any commit or rollback that wrote.
+     */
+    class TransactionManager {
+    public:
+        struct Stats {
+            size_t begun;
+            size_t committed;
+            size_t rolled_back;
+            size_t collections;
+        };
+        
+        static constexpr std::chrono::milliseconds DEFAULT_COLLECT_INTERVAL{100};
+        
+        TransactionManager();
+        ~TransactionManager();
+        
+        TransactionManager(const TransactionManager&) = delete;
+        TransactionManager& operator=(const TransactionManager&) = delete;
+        
+        std::unique_ptr<Transaction> begin();
+        
+        /**
+         * @brief Log txn's changes, wait for them to be durable, then publish them
+         * @return false if the log refused the records; txn is rolled back
+         */
+        bool commit(Transaction& txn);
+        
+        // Undo txn's changes in every table it wrote
+        void rollback(Transaction& txn);
+        
+        // Log that commit() appends to; may be null
+        void set_wal(WriteAheadLog* wal);
+        
+        size_t active_count() const;
+        
+        /**
+         * @brief Oldest read timestamp of any open transaction
+         *
+         * Versions that stopped existing at or before it can be dropped:
+         * nobody can see them any more.
+         */
+        Timestamp horizon() const;
+        
+        void start_collector(std::function<void()> collect,
+                             std::chrono::milliseconds interval = DEFAULT_COLLECT_INTERVAL);
+        void stop_collector();
+        
+        Stats get_stats() const;
+    
+    private:
+        void finish(Transaction& txn);
+        void collector_loop(std::chrono::milliseconds interval);
+        
+        std::atomic<Timestamp> clock_;
+        std::atomic<uint64_t> next_id_;
+        WriteAheadLog* wal_;
+        
+        // Read timestamps of open transactions; guarded by mutex_
+        std::multiset<Timestamp> active_;
+        mutable std::mutex mutex_;
+        std::mutex commit_mutex_;
+        
+        std::function<void()> collect_;
+        std::thread collector_;
+        std::condition_variable collect_requested_;
+        bool collect_pending_;
+        bool stopping_;
+        
+        std::atomic<size_t> begun_;
+        std::atomic<size_t> committed_;
+        std::atomic<size_t> rolled_back_;
+        std::atomic<size_t> collections_;
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_TRANSACTION_H
@@ -0,0 +1,187 @@
+/**
+ * @file wal.h
+ * @brief Write-ahead log with group commit
+ */
+
+#ifndef MINIDB_STORAGE_WAL_H
+#define MINIDB_STORAGE_WAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace minidb {
+namespace storage {
+
+    using Lsn = uint64_t;
+    constexpr Lsn INVALID_LSN = 0;
+    
+    /**
+     * @brief Logical change recorded in the log
+     */
+    enum class LogRecordType : uint8_t {
+        CREATE_TABLE = 1,   // payload: encoded schema
+        DROP_TABLE,         // payload: empty
+        TRUNCATE_TABLE,     // payload: empty
+        INSERT,             // payload: encoded row (carries the row id)
+        UPDATE,             // payload: encoded row with the new values
+        DELETE,             // payload: row id (u64)
+        CREATE_INDEX,       // payload: column name, index type
+        DROP_INDEX          // payload: column name
+    };
+    
+    struct LogRecord {
+        Lsn lsn;
+        LogRecordType type;
+        std::string table_name;
+        std::vector<char> payload;
+    };
+    
+    /**
+     * @brief Append-only redo log
+     *
+     * Changes are appended to an in-memory buffer and written out by a
+     * background flusher thread. commit() blocks until everything appended so
+     * far is on disk; commits that arrive while a sync is in progress are
+     * batched into the next one, so concurrent writers share a single fsync.
+     * With synchronous commit disabled, commit() returns immediately and the
+     * flusher syncs at least every flush interval.
+     *
+     * Each record is framed as [length:u32][crc32:u32][body] where the body is
+     * [lsn:u64][type:u8][table name][payload]. On open, a torn or corrupt
+     * tail left by a crash is truncated away.
+     */
+    class WriteAheadLog {
+    public:
+        struct Stats {
+            size_t records_appended;
+            size_t bytes_written;
+            size_t commits;
+            size_t syncs;
+        };
+        
+        WriteAheadLog();
+        ~WriteAheadLog();
+        
+        WriteAheadLog(const WriteAheadLog&) = delete;
+        WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+        
+        /**
+         * @brief Open (or create) the log file and start the flusher
+         * @param path Log file path
+         * @return true on success
+         */
+        bool open(const std::string& path);
+        
+        /**
+         * @brief Flush outstanding records, stop the flusher and close the file
+         */
+        void close();
+        
+        bool is_open() const { return fd_ >= 0; }
+        
+        /**
+         * @brief Visit every intact record in the log, oldest first
+         * @param visitor Called per record; return false to stop
+         * @return false if the log could not be read
+         */
+        bool replay(const std::function<bool(const LogRecord&)>& visitor);
+        
+        /**
+         * @brief Append a record to the log buffer
+         * @return LSN of the record, or INVALID_LSN if the log is closed
+         */
+        Lsn append(LogRecordType type, const std::string& table_name, const std::vector<char>& payload);
+        
+        /**
+         * @brief Make records up to lsn durable
+         * @param lsn Record to wait for; INVALID_LSN means everything appended so far
+         * @return false if the log has failed to write. A failure is sticky:
+         *         nothing more is written and every later commit() and
+         *         flush() fails until the log is reopened.
+         */
+        bool commit(Lsn lsn = INVALID_LSN);
+        
+        /**
+         * @brief Write and sync everything appended so far, regardless of sync mode
+         */
+        bool flush();
+        
+        /**
+         * @brief Empty the log once everything in it is covered by a checkpoint
+         *
+         * Flushes first. LSNs keep counting from where they were, so records
+         * appended afterwards still sort after the checkpoint.
+         * @return false if the log could not be flushed or truncated
+         */
+        bool truncate();
+        
+        /**
+         * @brief Continue numbering at lsn if that is past the end of the log
+         *
+         * Called after open() when a checkpoint newer than the log's last
+         * record exists, e.g. because the log was truncated.
+         */
+        void set_next_lsn(Lsn lsn);
+        
+        /**
+         * @brief Whether commit() waits for the fsync (default true)
+         */
+        void set_synchronous_commit(bool synchronous) { synchronous_commit_ = synchronous; }
+        bool is_synchronous_commit() const { return synchronous_commit_; }
+        
+        /**
+         * @brief Upper bound on how long appended records stay unsynced
+         * @note Takes effect for the flusher started by the next open()
+         */
+        void set_flush_interval(std::chrono::milliseconds interval) { flush_interval_ = interval; }
+        
+        Lsn get_last_lsn() const { return next_lsn_ - 1; }
+        Lsn get_durable_lsn() const { return durable_lsn_; }
+        Stats get_stats() const;
+        
+    private:
+        int fd_;
+        std::string path_;
+        
+        std::atomic<Lsn> next_lsn_;
+        std::atomic<Lsn> durable_lsn_;
+        std::atomic<bool> synchronous_commit_;
+        std::chrono::milliseconds flush_interval_;
+        
+        // Records appended but not yet handed to the flusher
+        std::vector<char> buffer_;
+        Lsn buffered_lsn_;
+        size_t sync_requests_;
+        uint64_t durable_size_;  // File length through the last synced batch
+        bool failed_;
+        bool stopping_;
+        
+        mutable std::mutex mutex_;
+        std::condition_variable flush_requested_;
+        std::condition_variable durable_advanced_;
+        std::thread flusher_;
+        
+        std::atomic<size_t> records_appended_;
+        std::atomic<size_t> bytes_written_;
+        std::atomic<size_t> commits_;
+        std::atomic<size_t> syncs_;
+        
+        void flusher_loop();
+        bool wait_durable(std::unique_lock<std::mutex>& lock, Lsn lsn);
+        bool write_fully(const std::vector<char>& data);
+        bool sync_file();
+        bool read_records(const std::function<bool(const LogRecord&)>* visitor,
+                          uint64_t& valid_end, Lsn& last_lsn);
+    };
+
+} // namespace storage
+} // namespace minidb
+
+#endif // MINIDB_STORAGE_WAL_H
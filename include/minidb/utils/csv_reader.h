@@ -0,0 +1,88 @@
+/**
+ * @file csv_reader.h
+ * @brief Streaming CSV record reader for bulk import
+ */
+
+#ifndef MINIDB_UTILS_CSV_READER_H
+#define MINIDB_UTILS_CSV_READER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace minidb {
+namespace utils {
+
+    /**
+     * @brief One field of a CSV record
+     *
+     * quoted tells an empty quoted field ("") apart from an empty unquoted
+     * one, which COPY loads as NULL.
+     */
+    struct CsvField {
+        std::string_view text;
+        bool quoted;
+    };
+    
+    /**
+     * @brief Reads RFC 4180 style records from a file in fixed-size chunks
+     *
+     * Fields are separated by the delimiter; a field in double quotes may
+     * hold delimiters, newlines and "" for a literal quote. Blank lines are
+     * skipped and a trailing \r is dropped. Only the current record is ever
+     * held in memory.
+     */
+    class CsvReader {
+    public:
+        static constexpr size_t CHUNK_BYTES = 1 << 16;
+        
+        explicit CsvReader(char delimiter = ',');
+        ~CsvReader();
+        
+        CsvReader(const CsvReader&) = delete;
+        CsvReader& operator=(const CsvReader&) = delete;
+        
+        bool open(const std::string& path);
+        void close();
+        
+        /**
+         * @brief Read the next record
+         * @param fields Replaced with the record's fields; they stay valid
+         *        until the next call
+         * @return false at end of file or on a malformed record (see error())
+         */
+        bool next(std::vector<CsvField>& fields);
+        
+        // 1-based line the last record started on
+        size_t line() const { return record_line_; }
+        
+        // Empty unless next() stopped on a malformed record or a read error
+        const std::string& error() const { return error_; }
+    
+    private:
+        struct Span {
+            size_t begin;
+            size_t end;
+            bool quoted;
+        };
+        
+        bool fill();
+        
+        char delimiter_;
+        std::FILE* file_;
+        std::vector<char> buffer_;
+        size_t pos_;
+        size_t end_;
+        size_t line_;
+        size_t record_line_;
+        std::string record_;  // Unescaped text of the current record's fields
+        std::vector<Span> spans_;
+        std::string error_;
+    };
+
+} // namespace utils
+} // namespace minidb
+
+#endif // MINIDB_UTILS_CSV_READER_H
@@ -0,0 +1,144 @@
+/**
+ * @file metrics.h
+ * @brief Process-wide counters and latency histograms
+ *
+ * Metrics are looked up by name once and then updated without locking;
+ * a hot path keeps the reference in a function-local static. Components
+ * that already count for themselves (the buffer pool) register a source
+ * instead, which is asked for its figures only when a snapshot is taken.
+ */
+
+#ifndef MINIDB_UTILS_METRICS_H
+#define MINIDB_UTILS_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace minidb {
+namespace utils {
+
+    /**
+     * @brief Count of events, safe to bump from any thread
+     */
+    class Counter {
+    public:
+        void add(uint64_t count = 1) { value_.fetch_add(count, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+        void reset() { value_.store(0, std::memory_order_relaxed); }
+    
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+    
+    /**
+     * @brief Latency distribution in power-of-two nanosecond buckets
+     *
+     * Percentiles are read off the buckets, so they are upper bounds at
+     * most twice the true value; the mean and max are exact.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr size_t BUCKETS = 40;  // The last holds everything from about 9 minutes up
+        
+        struct Summary {
+            uint64_t count = 0;
+            double mean_us = 0.0;
+            double p50_us = 0.0;
+            double p95_us = 0.0;
+            double p99_us = 0.0;
+            double max_us = 0.0;
+        };
+        
+        void record(std::chrono::nanoseconds latency);
+        Summary summarize() const;
+        void reset();
+    
+    private:
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> total_ns_{0};
+        std::atomic<uint64_t> max_ns_{0};
+        
+        double percentile(double fraction, uint64_t count) const;
+    };
+    
+    /**
+     * @brief Records the time from construction to destruction
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(LatencyHistogram& histogram)
+            : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_));
+        }
+        
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    
+    private:
+        LatencyHistogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+    
+    /**
+     * @brief Every metric's value at one moment, by name
+     */
+    struct MetricsSnapshot {
+        std::map<std::string, uint64_t> counters;
+        std::map<std::string, LatencyHistogram::Summary> histograms;
+        
+        // One line per metric, counters first
+        std::string to_string() const;
+    };
+    
+    /**
+     * @brief Named metrics for the whole process
+     */
+    class MetricsRegistry {
+    public:
+        // Adds its figures to a snapshot; same-named counters are summed
+        using Source = std::function<void(MetricsSnapshot&)>;
+        
+        static MetricsRegistry& global();
+        
+        // Created on first use; the reference stays valid for the registry's life
+        Counter& counter(const std::string& name);
+        LatencyHistogram& histogram(const std::string& name);
+        
+        /**
+         * @brief Have source contribute to every snapshot until removed
+         *
+         * Sources run under the registry's lock, so they must not call back
+         * into it; remove_source() waits for a running snapshot to finish.
+         */
+        void add_source(const void* owner, Source source);
+        void remove_source(const void* owner);
+        
+        MetricsSnapshot snapshot() const;
+        
+        // Zeroes counters and histograms; sources keep their own figures
+        void reset();
+    
+    private:
+        mutable std::mutex mutex_;
+        std::map<std::string, std::unique_ptr<Counter>> counters_;
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;
+        std::vector<std::pair<const void*, Source>> sources_;
+    };
+
+} // namespace utils
+} // namespace minidb
+
+#endif // MINIDB_UTILS_METRICS_H
@@ -0,0 +1,67 @@
+/**
+ * @file thread_pool.h
+ * @brief Fixed worker pool for intra-query parallelism and server requests
+ */
+
+#ifndef MINIDB_UTILS_THREAD_POOL_H
+#define MINIDB_UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace minidb {
+namespace utils {
+
+    /**
+     * @brief Long-lived worker threads shared by queries
+     *
+     * parallel_for hands out task indices from a shared counter, so a
+     * worker that finishes early simply takes the next morsel. The calling
+     * thread works too, which keeps a pool of size 0 correct.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t threads);
+        ~ThreadPool();
+        
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        
+        size_t size() const { return workers_.size(); }
+        
+        /**
+         * @brief Run task(i) for every i in [0, count) and wait for all of them
+         * @param max_threads Upper bound on threads used, the caller included
+         */
+        void parallel_for(size_t count, size_t max_threads, const std::function<void(size_t)>& task);
+        
+        /**
+         * @brief Queue job for the next free worker and return immediately
+         *
+         * Jobs still queued when the pool is destroyed run before it
+         * finishes; a pool of size 0 never runs them.
+         */
+        void submit(std::function<void()> job);
+        
+        // Process-wide pool with one worker per hardware thread but the caller's
+        static ThreadPool& shared();
+    
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> jobs_;
+        std::mutex mutex_;
+        std::condition_variable job_ready_;
+        bool stopping_;
+        
+        void worker_loop();
+    };
+
+} // namespace utils
+} // namespace minidb
+
+#endif // MINIDB_UTILS_THREAD_POOL_H
@@ -4,19 +4,40 @@
  */
 
 #include "minidb/core/btree.h"
+#include "minidb/core/tree_node.h"
 #include <algorithm>
 #include <iostream>
 
 namespace minidb {
 namespace core {
 
-    // Explicit template instantiations for common types
-    template class BTree<int, 5>;
-    template class BTree<std::string, 5>;
-    template class BTree<std::pair<int, uint64_t>, 5>;
-    template class BTree<std::pair<std::string, uint64_t>, 5>;
-    
     // BTree implementation
+    template<typename T, size_t Order>
+    BTree<T, Order>::BTree() : root_(nullptr), size_(0), compare_(DefaultCompare<T>()) {
+        root_ = allocate_node(true);
+    }
+    
+    template<typename T, size_t Order>
+    BTree<T, Order>::BTree(Compare compare) : root_(nullptr), size_(0), compare_(compare) {
+        root_ = allocate_node(true);
+    }
+    
+    template<typename T, size_t Order>
+    auto BTree<T, Order>::allocate_node(bool is_leaf) -> NodePtr {
+        NodePtr node = arena_.allocate();
+        node->is_leaf = is_leaf;
+        node->key_count = 0;
+        node->children.fill(nullptr);
+        return node;
+    }
+    
+    template<typename T, size_t Order>
+    size_t BTree<T, Order>::find_index(NodePtr node, const T& key) const {
+        // Binary search for the first key >= key
+        return lower_bound_index(node->keys.data(), node->key_count, key,
+                                 [this](const T& a, const T& b) { return compare_(a, b) < 0; });
+    }
+    
     template<typename T, size_t Order>
     bool BTree<T, Order>::insert(const T& key) {
         // Check if key already exists
@@ -24,13 +45,10 @@ namespace core {
             return false;  // Key already exists
         }
         
-        NodePtr root = root_;
-        
         // If root is full, create new root and split
-        if (root->is_full()) {
-            NodePtr new_root = std::make_shared<BTreeNode<T, Order>>(false);
-            new_root->children.push_back(root_);
-            root_->parent = new_root;
+        if (root_->is_full()) {
+            NodePtr new_root = allocate_node(false);
+            new_root->children[0] = root_;
             
             split_child(new_root, 0);
             root_ = new_root;
@@ -49,67 +67,50 @@ namespace core {
     template<typename T, size_t Order>
     void BTree<T, Order>::split_child(NodePtr parent, size_t child_index) {
         NodePtr full_child = parent->children[child_index];
-        NodePtr new_child = std::make_shared<BTreeNode<T, Order>>(full_child->is_leaf);
+        NodePtr new_child = allocate_node(full_child->is_leaf);
         
         size_t mid_index = (Order - 1) / 2;
         
-        // Copy second half of keys to new child
-        for (size_t i = mid_index + 1; i < Order - 1; i++) {
-            new_child->keys.push_back(full_child->keys[i]);
-            new_child->key_count++;
+        // Move second half of keys to new child
+        for (size_t i = mid_index + 1; i < full_child->key_count; i++) {
+            new_child->keys[new_child->key_count++] = std::move(full_child->keys[i]);
         }
         
-        // If not leaf, copy second half of children
+        // If not leaf, move second half of children
         if (!full_child->is_leaf) {
-            for (size_t i = mid_index + 1; i < Order; i++) {
-                new_child->children.push_back(full_child->children[i]);
-                full_child->children[i]->parent = new_child;
+            for (size_t i = mid_index + 1; i <= full_child->key_count; i++) {
+                new_child->children[i - mid_index - 1] = full_child->children[i];
+                full_child->children[i] = nullptr;
             }
-            full_child->children.resize(mid_index + 1);
         }
         
-        // Shrink original child
-        full_child->keys.resize(mid_index);
+        // Shrink original child; the middle key moves up
+        T middle_key = std::move(full_child->keys[mid_index]);
         full_child->key_count = mid_index;
         
-        // Insert middle key into parent
-        T middle_key = full_child->keys.back();
-        full_child->keys.pop_back();
-        full_child->key_count--;
-        
-        // Insert new child into parent
-        parent->children.insert(parent->children.begin() + child_index + 1, new_child);
-        parent->keys.insert(parent->keys.begin() + child_index, middle_key);
+        // Make room in the parent for the middle key and the new child
+        for (size_t i = parent->key_count; i > child_index; i--) {
+            parent->keys[i] = std::move(parent->keys[i - 1]);
+            parent->children[i + 1] = parent->children[i];
+        }
+        parent->keys[child_index] = std::move(middle_key);
+        parent->children[child_index + 1] = new_child;
         parent->key_count++;
-        
-        // Set parent pointers
-        new_child->parent = parent;
-        full_child->parent = parent;
     }
     
     template<typename T, size_t Order>
     void BTree<T, Order>::insert_non_full(NodePtr node, const T& key) {
-        int i = static_cast<int>(node->key_count) - 1;
+        size_t i = find_index(node, key);
         
         if (node->is_leaf) {
-            // Insert into leaf node
-            node->keys.resize(node->key_count + 1);
-            
             // Shift keys to make room
-            while (i >= 0 && compare_(key, node->keys[i]) < 0) {
-                node->keys[i + 1] = node->keys[i];
-                i--;
+            for (size_t j = node->key_count; j > i; j--) {
+                node->keys[j] = std::move(node->keys[j - 1]);
             }
             
-            node->keys[i + 1] = key;
+            node->keys[i] = key;
             node->key_count++;
         } else {
-            // Find child to insert into
-            while (i >= 0 && compare_(key, node->keys[i]) < 0) {
-                i--;
-            }
-            i++;
-            
             // If child is full, split it
             if (node->children[i]->is_full()) {
                 split_child(node, i);
@@ -124,40 +125,154 @@ namespace core {
     
     template<typename T, size_t Order>
     auto BTree<T, Order>::search_helper(NodePtr node, const T& key) const -> NodePtr {
-        size_t i = 0;
-        
-        // Find first key >= search key
-        while (i < node->key_count && compare_(key, node->keys[i]) > 0) {
-            i++;
+        while (node != nullptr) {
+            // Find first key >= search key
+            size_t i = find_index(node, key);
+            
+            // If key found
+            if (i < node->key_count && compare_(key, node->keys[i]) == 0) {
+                return node;
+            }
+            
+            // If leaf, key not found
+            if (node->is_leaf) {
+                return nullptr;
+            }
+            
+            // Descend to appropriate child
+            node = node->children[i];
+        }
+        return nullptr;
+    }
+    
+    template<typename T, size_t Order>
+    bool BTree<T, Order>::remove(const T& key) {
+        if (!remove_helper(root_, key)) {
+            return false;
         }
         
-        // If key found
-        if (i < node->key_count && compare_(key, node->keys[i]) == 0) {
-            return node;
+        // Root emptied by a merge: its only child becomes the new root
+        if (root_->key_count == 0 && !root_->is_leaf) {
+            NodePtr old_root = root_;
+            root_ = old_root->children[0];
+            arena_.release(old_root);
         }
         
-        // If leaf, key not found
+        size_--;
+        return true;
+    }
+    
+    template<typename T, size_t Order>
+    bool BTree<T, Order>::remove_helper(NodePtr node, const T& key) {
+        size_t i = find_index(node, key);
+        bool found = i < node->key_count && compare_(key, node->keys[i]) == 0;
+        
         if (node->is_leaf) {
-            return nullptr;
+            if (!found) {
+                return false;
+            }
+            for (size_t j = i + 1; j < node->key_count; j++) {
+                node->keys[j - 1] = std::move(node->keys[j]);
+            }
+            node->key_count--;
+            return true;
         }
         
-        // Recurse to appropriate child
-        return search_helper(node->children[i], key);
+        if (found) {
+            // Replace with the in-order predecessor and delete that from the left subtree
+            NodePtr current = node->children[i];
+            while (!current->is_leaf) {
+                current = current->children[current->key_count];
+            }
+            T predecessor = current->keys[current->key_count - 1];
+            node->keys[i] = predecessor;
+            remove_helper(node->children[i], predecessor);
+        } else if (!remove_helper(node->children[i], key)) {
+            return false;
+        }
+        
+        if (node->children[i]->key_count < MIN_KEYS) {
+            fix_underflow(node, i);
+        }
+        return true;
     }
     
     template<typename T, size_t Order>
-    bool BTree<T, Order>::remove(const T& key) {
-        // Simplified remove implementation
-        // In a complete implementation, this would handle all cases
-        // including merging and borrowing
+    void BTree<T, Order>::fix_underflow(NodePtr parent, size_t child_index) {
+        NodePtr child = parent->children[child_index];
+        NodePtr left = child_index > 0 ? parent->children[child_index - 1] : nullptr;
+        NodePtr right = child_index < parent->key_count ? parent->children[child_index + 1] : nullptr;
         
-        // For now, just mark as not implemented
-        return false;
+        if (left != nullptr && left->key_count > MIN_KEYS) {
+            // Rotate right: parent key comes down, left sibling's last key goes up
+            for (size_t j = child->key_count; j > 0; j--) {
+                child->keys[j] = std::move(child->keys[j - 1]);
+            }
+            if (!child->is_leaf) {
+                for (size_t j = child->key_count + 1; j > 0; j--) {
+                    child->children[j] = child->children[j - 1];
+                }
+                child->children[0] = left->children[left->key_count];
+                left->children[left->key_count] = nullptr;
+            }
+            child->keys[0] = std::move(parent->keys[child_index - 1]);
+            parent->keys[child_index - 1] = std::move(left->keys[left->key_count - 1]);
+            child->key_count++;
+            left->key_count--;
+        } else if (right != nullptr && right->key_count > MIN_KEYS) {
+            // Rotate left: parent key comes down, right sibling's first key goes up
+            child->keys[child->key_count] = std::move(parent->keys[child_index]);
+            parent->keys[child_index] = std::move(right->keys[0]);
+            if (!child->is_leaf) {
+                child->children[child->key_count + 1] = right->children[0];
+                for (size_t j = 1; j <= right->key_count; j++) {
+                    right->children[j - 1] = right->children[j];
+                }
+                right->children[right->key_count] = nullptr;
+            }
+            for (size_t j = 1; j < right->key_count; j++) {
+                right->keys[j - 1] = std::move(right->keys[j]);
+            }
+            child->key_count++;
+            right->key_count--;
+        } else if (left != nullptr) {
+            merge_children(parent, child_index - 1);
+        } else if (right != nullptr) {
+            merge_children(parent, child_index);
+        }
+    }
+    
+    template<typename T, size_t Order>
+    void BTree<T, Order>::merge_children(NodePtr parent, size_t index) {
+        // Left child, separator and right child become one node
+        NodePtr left = parent->children[index];
+        NodePtr right = parent->children[index + 1];
+        
+        left->keys[left->key_count] = std::move(parent->keys[index]);
+        for (size_t j = 0; j < right->key_count; j++) {
+            left->keys[left->key_count + 1 + j] = std::move(right->keys[j]);
+        }
+        if (!left->is_leaf) {
+            for (size_t j = 0; j <= right->key_count; j++) {
+                left->children[left->key_count + 1 + j] = right->children[j];
+            }
+        }
+        left->key_count += right->key_count + 1;
+        
+        for (size_t j = index + 1; j < parent->key_count; j++) {
+            parent->keys[j - 1] = std::move(parent->keys[j]);
+            parent->children[j] = parent->children[j + 1];
+        }
+        parent->children[parent->key_count] = nullptr;
+        parent->key_count--;
+        
+        arena_.release(right);
     }
     
     template<typename T, size_t Order>
     void BTree<T, Order>::clear() {
-        root_ = std::make_shared<BTreeNode<T, Order>>(true);
+        arena_.clear();
+        root_ = allocate_node(true);
         size_ = 0;
     }
     
@@ -180,9 +295,7 @@ namespace core {
         
         if (!node->is_leaf) {
             for (size_t i = 0; i <= node->key_count; i++) {
-                if (i < node->children.size()) {
-                    print_helper(node->children[i], level + 1);
-                }
+                print_helper(node->children[i], level + 1);
             }
         }
     }
@@ -216,14 +329,32 @@ namespace core {
     template<typename T, size_t Order>
     std::vector<T> BTree<T, Order>::range_query(const T& start, const T& end) const {
         std::vector<T> result;
+        if (root_) {
+            range_helper(root_, start, end, result);
+        }
+        return result;
+    }
+    
+    template<typename T, size_t Order>
+    bool BTree<T, Order>::range_helper(NodePtr node, const T& start, const T& end, std::vector<T>& result) const {
+        // In-order walk that skips subtrees entirely outside [start, end].
+        // Returns false once a key past the end has been seen.
+        size_t i = find_index(node, start);
         
-        traverse([&](const T& key) {
-            if (compare_(key, start) >= 0 && compare_(key, end) <= 0) {
-                result.push_back(key);
+        for (; i < node->key_count; i++) {
+            if (!node->is_leaf && !range_helper(node->children[i], start, end, result)) {
+                return false;
+            }
+            if (compare_(node->keys[i], end) > 0) {
+                return false;
             }
-        });
+            result.push_back(node->keys[i]);
+        }
         
-        return result;
+        if (!node->is_leaf) {
+            return range_helper(node->children[node->key_count], start, end, result);
+        }
+        return true;
     }
     
     template<typename T, size_t Order>
@@ -253,6 +384,16 @@ namespace core {
         
         return current->keys[current->key_count - 1];
     }
+    
+    // Explicit template instantiations for common types, at the default
+    // order and at cache-friendly fan-outs
+    template class BTree<int, 5>;
+    template class BTree<std::string, 5>;
+    template class BTree<std::pair<int, uint64_t>, 5>;
+    template class BTree<std::pair<std::string, uint64_t>, 5>;
+    template class BTree<int, 64>;
+    template class BTree<int, 256>;
+    template class BTree<std::string, 64>;
 
 } // namespace core
 } // namespace minidb
@@ -9,12 +9,6 @@
 namespace minidb {
 namespace core {
 
-    // Explicit template instantiations
-    template class HashMap<std::string, std::string>;
-    template class HashMap<std::string, int>;
-    template class HashMap<int, std::string>;
-    template class HashMap<int, int>;
-    
     // HashMap Iterator implementation
     template<typename K, typename V>
     HashMap<K, V>::Iterator::Iterator(
@@ -79,7 +73,13 @@ namespace core {
             return false;  // Key already exists
         }
         
-        // Check if rehash is needed
+        insert_new(key, value);
+        return true;
+    }
+    
+    template<typename K, typename V>
+    V& HashMap<K, V>::insert_new(const K& key, const V& value) {
+        // Caller has already checked the key is absent
         if (needs_rehash()) {
             rehash(bucket_count_ * 2);
         }
@@ -88,7 +88,7 @@ namespace core {
         buckets_[bucket_index].emplace_back(key, value);
         size_++;
         
-        return true;
+        return buckets_[bucket_index].back().value;
     }
     
     template<typename K, typename V>
@@ -128,7 +128,7 @@ namespace core {
             [&](const Entry& entry) {
                 return equal_func_(entry.key, key);
             });
-        
+            
         if (it != bucket.end()) {
             bucket.erase(it);
             size_--;
@@ -155,7 +155,7 @@ namespace core {
             *existing = value;
             return false;  // Updated existing
         } else {
-            insert(key, value);
+            insert_new(key, value);
             return true;  // Inserted new
         }
     }
@@ -182,12 +182,12 @@ namespace core {
             return Iterator(bucket_it, bucket_end, bucket_it->begin());
         }
         
-        return Iterator(bucket_end, bucket_end, Bucket::iterator{});
+        return Iterator(bucket_end, bucket_end, typename Bucket::iterator{});
     }
     
     template<typename K, typename V>
     auto HashMap<K, V>::end() -> Iterator {
-        return Iterator(buckets_.end(), buckets_.end(), Bucket::iterator{});
+        return Iterator(buckets_.end(), buckets_.end(), typename Bucket::iterator{});
     }
     
     template<typename K, typename V>
@@ -198,8 +198,7 @@ namespace core {
         }
         
         // Insert default value and return reference
-        insert(key, V{});
-        return *find(key);
+        return insert_new(key, V{});
     }
     
     template<typename K, typename V>
@@ -215,12 +214,12 @@ namespace core {
         bucket_count_ = new_bucket_count;
         buckets_.clear();
         buckets_.resize(bucket_count_);
-        size_ = 0;
         
-        // Reinsert all entries
-        for (const auto& bucket : old_buckets) {
-            for (const auto& entry : bucket) {
-                insert(entry.key, entry.value);
+        // Move entries across; keys are already unique, so skip the
+        // duplicate check and load-factor test that insert() would do
+        for (auto& bucket : old_buckets) {
+            for (auto& entry : bucket) {
+                buckets_[hash(entry.key)].push_back(std::move(entry));
             }
         }
     }
@@ -245,6 +244,15 @@ namespace core {
         std::cout << "  Empty Buckets: " << empty_buckets << std::endl;
         std::cout << "  Max Bucket Size: " << max_bucket_size << std::endl;
     }
+    
+    // Explicit template instantiations (after the member definitions so
+    // that every member is instantiated)
+    template class HashMap<std::string, std::string>;
+    template class HashMap<std::string, int>;
+    template class HashMap<int, std::string>;
+    template class HashMap<int, int>;
+    template class HashMap<std::string, std::vector<size_t>>;  // Hash join build side
+    template class HashMap<std::string, size_t>;  // Hash aggregation groups
 
 } // namespace core
 } // namespace minidb
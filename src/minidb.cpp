@@ -4,6 +4,11 @@
  */
 
 #include "minidb/minidb.h"
+#include "minidb/query/prepared_statement.h"
+#include "minidb/storage/serialization.h"
+#include "minidb/storage/snapshot.h"
+#include "minidb/storage/transaction.h"
+#include "minidb/utils/metrics.h"
 #include <iostream>
 
 namespace minidb {
@@ -18,29 +23,252 @@ namespace minidb {
             return true;
         }
         
-        // Initialize components
+        // Initialize components. The heap file is scratch space: state comes
+        // from the last snapshot plus whatever the log recorded after it.
         page_manager_ = std::make_unique<PageManager>();
+        if (!page_manager_->open(db_name_ + ".db", true)) {
+            page_manager_.reset();
+            return false;
+        }
+        
         executor_ = std::make_unique<QueryExecutor>(page_manager_.get());
         
+        storage::Lsn snapshot_lsn = 0;
+        wal_ = std::make_unique<storage::WriteAheadLog>();
+        if (!load_snapshot(snapshot_lsn) || !wal_->open(db_name_ + ".wal")) {
+            wal_.reset();
+            executor_.reset();
+            page_manager_->close();
+            page_manager_.reset();
+            snapshot_.reset();
+            return false;
+        }
+        
+        // The log is truncated once a snapshot commits, so new records must
+        // still number after the ones the snapshot absorbed
+        wal_->set_next_lsn(snapshot_lsn + 1);
+        if (!replay_log(snapshot_lsn)) {
+            wal_.reset();
+            executor_.reset();
+            page_manager_->close();
+            page_manager_.reset();
+            snapshot_.reset();
+            return false;
+        }
+        executor_->set_wal(wal_.get());
+        
+        // Replay ran outside transactions; from here on every change is in one
+        transactions_ = std::make_unique<storage::TransactionManager>();
+        transactions_->set_wal(wal_.get());
+        executor_->set_transactions(transactions_.get());
+        transactions_->start_collector([this]() { executor_->collect_garbage(); });
+        
         is_open_ = true;
         return true;
     }
     
     void Database::close() {
         if (is_open_) {
+            session_.rollback();
+            transactions_->stop_collector();
+            executor_->collect_garbage();  // Snapshots hold no old versions
+            write_snapshot();  // On failure the log still holds everything
+            wal_->close();  // Flush outstanding commits
             executor_.reset();
+            transactions_.reset();
+            wal_.reset();
+            page_manager_->close();  // Write back dirty pages
             page_manager_.reset();
+            snapshot_.reset();  // Unmap only once no page can be read from it
             tables_.clear();
             is_open_ = false;
         }
     }
     
+    void Database::set_synchronous_commit(bool synchronous) {
+        if (wal_) {
+            wal_->set_synchronous_commit(synchronous);
+        }
+    }
+    
+    bool Database::load_snapshot(storage::Lsn& snapshot_lsn) {
+        std::string path = db_name_ + ".snap";
+        if (!storage::Snapshot::exists(path)) {
+            return true;  // Never closed cleanly yet; the log has everything
+        }
+        
+        snapshot_ = std::make_unique<storage::Snapshot>();
+        if (!snapshot_->open(path, page_manager_->get_stats().page_size) ||
+            !page_manager_->set_base_image(snapshot_->page_data(), snapshot_->page_count())) {
+            return false;
+        }
+        
+        storage::ByteReader catalog = snapshot_->catalog();
+        uint32_t table_count = 0;
+        if (!catalog.read(table_count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < table_count; i++) {
+            std::string name;
+            std::string_view encoded_schema;
+            TableSchema schema;
+            if (!catalog.read_string(name) || !catalog.read_string(encoded_schema) ||
+                !storage::decode_schema(encoded_schema.data(), encoded_schema.size(), schema) ||
+                !executor_->create_table(name, schema)) {
+                return false;
+            }
+            if (!executor_->get_table(name)->load_snapshot(catalog)) {
+                return false;
+            }
+        }
+        
+        snapshot_lsn = snapshot_->get_lsn();
+        return true;
+    }
+    
+    bool Database::write_snapshot() {
+        if (!wal_->flush()) {
+            return false;
+        }
+        
+        storage::SnapshotWriter writer(page_manager_->get_stats().page_size);
+        if (!writer.open(db_name_ + ".snap")) {
+            return false;
+        }
+        
+        storage::ByteWriter catalog(writer.catalog());
+        std::vector<std::string> names = executor_->get_table_names();
+        std::vector<char> encoded_schema;
+        catalog.write(static_cast<uint32_t>(names.size()));
+        for (const auto& name : names) {
+            Table* table = executor_->get_table(name);
+            storage::encode_schema(table->get_schema(), encoded_schema);
+            catalog.write_string(name);
+            catalog.write_string(std::string_view(encoded_schema.data(), encoded_schema.size()));
+            if (!table->write_snapshot(writer, catalog)) {
+                return false;
+            }
+        }
+        
+        // commit() returns once the renamed snapshot is durable, directory
+        // entry included, so the log is only emptied after that. Records up
+        // to the snapshot LSN are skipped on replay, so a crash between the
+        // rename and the truncate is harmless.
+        return writer.commit(wal_->get_last_lsn()) && wal_->truncate();
+    }
+    
+    bool Database::replay_log(storage::Lsn after_lsn) {
+        using storage::LogRecordType;
+        
+        return wal_->replay([this, after_lsn](const storage::LogRecord& record) {
+            if (record.lsn <= after_lsn) {
+                return true;  // Already reflected in the snapshot
+            }
+            
+            const char* data = record.payload.data();
+            size_t length = record.payload.size();
+            
+            if (record.type == LogRecordType::CREATE_TABLE) {
+                TableSchema schema;
+                if (storage::decode_schema(data, length, schema)) {
+                    executor_->create_table(record.table_name, schema);
+                }
+                return true;
+            }
+            if (record.type == LogRecordType::DROP_TABLE) {
+                executor_->drop_table(record.table_name);
+                return true;
+            }
+            
+            // Records for tables that were dropped later are skipped
+            Table* table = executor_->get_table(record.table_name);
+            if (table == nullptr) {
+                return true;
+            }
+            
+            storage::ByteReader reader(data, length);
+            switch (record.type) {
+                case LogRecordType::TRUNCATE_TABLE:
+                    table->clear();
+                    break;
+                case LogRecordType::INSERT:
+                case LogRecordType::UPDATE: {
+                    storage::Row row;
+                    if (!storage::decode_row(data, length, row)) {
+                        break;
+                    }
+                    if (record.type == LogRecordType::INSERT) {
+                        table->restore_row(row);
+                    } else {
+                        table->update_row(row.get_id(), row);
+                    }
+                    break;
+                }
+                case LogRecordType::DELETE: {
+                    uint64_t row_id = 0;
+                    if (reader.read(row_id)) {
+                        table->delete_row(row_id);
+                    }
+                    break;
+                }
+                case LogRecordType::CREATE_INDEX: {
+                    std::string column_name;
+                    std::string index_type;
+                    if (reader.read_string(column_name) && reader.read_string(index_type)) {
+                        table->create_index(column_name, index_type);
+                    }
+                    break;
+                }
+                case LogRecordType::DROP_INDEX: {
+                    std::string column_name;
+                    if (reader.read_string(column_name)) {
+                        table->drop_index(column_name);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            return true;
+        });
+    }
+    
     QueryResult Database::execute_query(const std::string& query) {
         if (!is_open_) {
             return query::QueryResult("Database is not open");
         }
         
-        return executor_->execute_sql(query);
+        return executor_->execute_sql(query, nullptr, &session_);
+    }
+    
+    QueryResult Database::execute_query(const std::string& query, query::Session& session, query::ResultSink* sink) {
+        if (!is_open_) {
+            return query::QueryResult("Database is not open");
+        }
+        
+        // Safe to call from several threads at once, one session each
+        return executor_->execute_sql(query, sink, &session);
+    }
+    
+    std::unique_ptr<query::PreparedStatement> Database::prepare(const std::string& sql, std::string* error) {
+        std::string message = "Database is not open";
+        std::unique_ptr<query::PreparedStatement> statement;
+        if (is_open_) {
+            statement = executor_->prepare(sql, message);
+        }
+        
+        if (!statement && error != nullptr) {
+            *error = message;
+        }
+        return statement;
+    }
+    
+    QueryResult Database::execute_query(query::PreparedStatement& statement) {
+        if (!is_open_) {
+            return query::QueryResult("Database is not open");
+        }
+        
+        return executor_->execute(statement, nullptr, &session_);
     }
     
     Table* Database::get_table(const std::string& name) {
@@ -56,7 +284,9 @@ namespace minidb {
             return false;
         }
         
-        return executor_->create_table(name, schema);
+        bool created = executor_->create_table(name, schema);
+        wal_->commit();
+        return created;
     }
     
     bool Database::drop_table(const std::string& name) {
@@ -64,7 +294,14 @@ namespace minidb {
             return false;
         }
         
-        return executor_->drop_table(name);
+        bool dropped = executor_->drop_table(name);
+        wal_->commit();
+        return dropped;
+    }
+    
+    utils::MetricsSnapshot Database::get_metrics() const {
+        // Metrics are process-wide, so this includes other open databases
+        return utils::MetricsRegistry::global().snapshot();
     }
     
     // Library functions
@@ -0,0 +1,217 @@
+/**
+ * @file compiled_expression.cpp
+ * @brief Expression binding and predicate specialization
+ */
+
+#include "minidb/query/compiled_expression.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace minidb {
+namespace query {
+
+    namespace {
+
+        using storage::ColumnType;
+        using storage::Row;
+        using storage::Value;
+        
+        // Whether "a op b" holds given order = a.compare(b)
+        template<Operator Op>
+        bool holds(int order) {
+            if constexpr (Op == Operator::EQUAL) return order == 0;
+            else if constexpr (Op == Operator::NOT_EQUAL) return order != 0;
+            else if constexpr (Op == Operator::LESS_THAN) return order < 0;
+            else if constexpr (Op == Operator::LESS_EQUAL) return order <= 0;
+            else if constexpr (Op == Operator::GREATER_THAN) return order > 0;
+            else return order >= 0;
+        }
+        
+        // Native comparison phrased with < only, matching Value::compare
+        // (unordered doubles compare equal)
+        template<Operator Op, typename A, typename B>
+        bool compare_native(const A& a, const B& b) {
+            if constexpr (Op == Operator::EQUAL) return !(a < b) && !(b < a);
+            else if constexpr (Op == Operator::NOT_EQUAL) return (a < b) || (b < a);
+            else if constexpr (Op == Operator::LESS_THAN) return a < b;
+            else if constexpr (Op == Operator::LESS_EQUAL) return !(b < a);
+            else if constexpr (Op == Operator::GREATER_THAN) return b < a;
+            else return !(a < b);
+        }
+        
+        template<ColumnType Type> struct NativeType;
+        template<> struct NativeType<ColumnType::INTEGER> {
+            using type = int64_t;
+            static int64_t get(const Value& v) { return v.get_int(); }
+        };
+        template<> struct NativeType<ColumnType::REAL> {
+            using type = double;
+            static double get(const Value& v) { return v.get_real(); }
+        };
+        template<> struct NativeType<ColumnType::TEXT> {
+            using type = std::string;  // Owned: the literal's text moves with the predicate
+            static std::string_view get(const Value& v) { return v.get_string(); }
+        };
+        
+        // "column op literal" where the literal has type Type
+        template<ColumnType Type, Operator Op>
+        class ColumnLiteralPredicate {
+        public:
+            ColumnLiteralPredicate(size_t column, const Value& literal)
+                : column_(column), literal_(literal), native_(NativeType<Type>::get(literal)),
+                  missing_(holds<Op>(Value().compare(literal))) {}
+            
+            bool operator()(const Row& row) const {
+                const auto& values = row.get_values();
+                if (column_ >= values.size()) {
+                    return missing_;  // Short rows read as NULL
+                }
+                const Value& value = values[column_];
+                if (value.get_type() == Type && !value.is_null()) {
+                    return compare_native<Op>(NativeType<Type>::get(value), native_);
+                }
+                return holds<Op>(value.compare(literal_));  // NULL or another type
+            }
+            
+        private:
+            size_t column_;
+            Value literal_;
+            typename NativeType<Type>::type native_;
+            bool missing_;
+        };
+        
+        template<Operator Op>
+        class ColumnColumnPredicate {
+        public:
+            ColumnColumnPredicate(size_t left, size_t right) : left_(left), right_(right) {}
+            
+            bool operator()(const Row& row) const {
+                static const Value null_value;
+                const auto& values = row.get_values();
+                const Value& a = left_ < values.size() ? values[left_] : null_value;
+                const Value& b = right_ < values.size() ? values[right_] : null_value;
+                return holds<Op>(a.compare(b));
+            }
+            
+        private:
+            size_t left_;
+            size_t right_;
+        };
+        
+        template<ColumnType Type>
+        CompiledPredicate::Function column_literal(Operator op, size_t column, const Value& literal) {
+            switch (op) {
+                case Operator::EQUAL: return ColumnLiteralPredicate<Type, Operator::EQUAL>(column, literal);
+                case Operator::NOT_EQUAL: return ColumnLiteralPredicate<Type, Operator::NOT_EQUAL>(column, literal);
+                case Operator::LESS_THAN: return ColumnLiteralPredicate<Type, Operator::LESS_THAN>(column, literal);
+                case Operator::LESS_EQUAL: return ColumnLiteralPredicate<Type, Operator::LESS_EQUAL>(column, literal);
+                case Operator::GREATER_THAN: return ColumnLiteralPredicate<Type, Operator::GREATER_THAN>(column, literal);
+                case Operator::GREATER_EQUAL: return ColumnLiteralPredicate<Type, Operator::GREATER_EQUAL>(column, literal);
+                default: return nullptr;
+            }
+        }
+        
+        CompiledPredicate::Function column_column(Operator op, size_t left, size_t right) {
+            switch (op) {
+                case Operator::EQUAL: return ColumnColumnPredicate<Operator::EQUAL>(left, right);
+                case Operator::NOT_EQUAL: return ColumnColumnPredicate<Operator::NOT_EQUAL>(left, right);
+                case Operator::LESS_THAN: return ColumnColumnPredicate<Operator::LESS_THAN>(left, right);
+                case Operator::LESS_EQUAL: return ColumnColumnPredicate<Operator::LESS_EQUAL>(left, right);
+                case Operator::GREATER_THAN: return ColumnColumnPredicate<Operator::GREATER_THAN>(left, right);
+                case Operator::GREATER_EQUAL: return ColumnColumnPredicate<Operator::GREATER_EQUAL>(left, right);
+                default: return nullptr;
+            }
+        }
+        
+        // Rewrites "literal op column" as "column op literal"
+        Operator mirror(Operator op) {
+            switch (op) {
+                case Operator::LESS_THAN: return Operator::GREATER_THAN;
+                case Operator::LESS_EQUAL: return Operator::GREATER_EQUAL;
+                case Operator::GREATER_THAN: return Operator::LESS_THAN;
+                case Operator::GREATER_EQUAL: return Operator::LESS_EQUAL;
+                default: return op;
+            }
+        }
+        
+        bool truthy(const Value& value) {
+            return value.get_type() == ColumnType::INTEGER && value.get_int() != 0;
+        }
+        
+        CompiledPredicate::Function compile_comparison(const BinaryExpression* expr,
+                                                       const storage::TableSchema& schema) {
+            Operator op = expr->get_operator();
+            const auto* left_column = dynamic_cast<const ColumnExpression*>(expr->get_left());
+            const auto* right_column = dynamic_cast<const ColumnExpression*>(expr->get_right());
+            const auto* left_literal = dynamic_cast<const LiteralExpression*>(expr->get_left());
+            const auto* right_literal = dynamic_cast<const LiteralExpression*>(expr->get_right());
+            
+            if (left_literal && right_column) {
+                std::swap(left_column, right_column);
+                std::swap(left_literal, right_literal);
+                op = mirror(op);
+            }
+            
+            // Unknown columns evaluate to NULL; let the generic path handle them
+            if (left_column && right_literal) {
+                size_t column = schema.get_column_index(left_column->get_column_name());
+                const Value& literal = right_literal->get_value();
+                if (column == SIZE_MAX || literal.is_null()) {
+                    return nullptr;
+                }
+                switch (literal.get_type()) {
+                    case ColumnType::INTEGER: return column_literal<ColumnType::INTEGER>(op, column, literal);
+                    case ColumnType::REAL: return column_literal<ColumnType::REAL>(op, column, literal);
+                    case ColumnType::TEXT: return column_literal<ColumnType::TEXT>(op, column, literal);
+                    default: return nullptr;
+                }
+            }
+            
+            if (left_column && right_column) {
+                size_t left = schema.get_column_index(left_column->get_column_name());
+                size_t right = schema.get_column_index(right_column->get_column_name());
+                if (left == SIZE_MAX || right == SIZE_MAX) {
+                    return nullptr;
+                }
+                return column_column(op, left, right);
+            }
+            
+            return nullptr;
+        }
+
+    } // namespace
+    
+    CompiledPredicate CompiledPredicate::compile(const Expression* expr, const storage::TableSchema& schema) {
+        if (expr == nullptr) {
+            return CompiledPredicate();
+        }
+        
+        // Constant expressions are folded
+        if (const auto* literal = dynamic_cast<const LiteralExpression*>(expr)) {
+            bool result = truthy(literal->get_value());
+            return CompiledPredicate([result](const Row&) { return result; });
+        }
+        if (const auto* comparison = dynamic_cast<const BinaryExpression*>(expr)) {
+            if (dynamic_cast<const LiteralExpression*>(comparison->get_left()) &&
+                dynamic_cast<const LiteralExpression*>(comparison->get_right())) {
+                bool result = truthy(expr->evaluate(Row(), schema));
+                return CompiledPredicate([result](const Row&) { return result; });
+            }
+            if (Function function = compile_comparison(comparison, schema)) {
+                return CompiledPredicate(std::move(function));
+            }
+        }
+        
+        // Anything else keeps the interpreted path; the clone and schema
+        // are owned by the closure so the predicate outlives the statement
+        std::shared_ptr<const Expression> owned = expr->clone();
+        storage::TableSchema bound_schema = schema;
+        return CompiledPredicate([owned, bound_schema](const Row& row) {
+            return truthy(owned->evaluate(row, bound_schema));
+        });
+    }
+
+} // namespace query
+} // namespace minidb
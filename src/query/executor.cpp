@@ -4,133 +4,2782 @@
  */
 
 #include "minidb/query/executor.h"
+#include "minidb/query/compiled_expression.h"
 #include "minidb/query/parser.h"
+#include "minidb/query/plan_cache.h"
+#include "minidb/query/prepared_statement.h"
+#include "minidb/query/session.h"
+#include "minidb/query/vector_batch.h"
+#include "minidb/storage/page_manager.h"
+#include "minidb/storage/serialization.h"
+#include "minidb/storage/statistics.h"
+#include "minidb/storage/transaction.h"
+#include "minidb/utils/csv_reader.h"
+#include "minidb/utils/metrics.h"
+#include "minidb/utils/thread_pool.h"
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
 
 namespace minidb {
 namespace query {
 
+    namespace {
+    
+        // Without statistics, assume a one-sided range keeps a third of the rows
+        constexpr double RANGE_SELECTIVITY = 1.0 / 3.0;
+        
+        // A row fetched through an index, against one read by a scan; index
+        // fetches jump around the heap where a scan reads it in order
+        constexpr double INDEX_FETCH_COST = 2.0;
+        
+        // Smaller tables are not worth waking the worker pool for
+        constexpr size_t PARALLEL_MIN_PAGES = 16;
+        
+        // Pages handed out per thread per wave, so uneven pages still balance
+        constexpr size_t MORSELS_PER_THREAD = 4;
+        
+        // Rows COPY converts before handing them to the table in one batch
+        constexpr size_t COPY_BATCH_ROWS = 4096;
+        
+        // Memory a sort may fill before it spills sorted runs to pages
+        constexpr size_t DEFAULT_SORT_MEMORY = 16 * 1024 * 1024;
+        
+        // Up to this many rows, ORDER BY ... LIMIT keeps a bounded heap
+        // instead of sorting everything
+        constexpr size_t TOP_N_MAX_ROWS = 10000;
+        
+        std::vector<std::string> table_column_names(const storage::Table* table) {
+            std::vector<std::string> column_names;
+            const auto& schema = table->get_schema();
+            for (size_t i = 0; i < schema.column_count(); i++) {
+                column_names.push_back(schema.get_column(i).name);
+            }
+            return column_names;
+        }
+        
+        // Cost of descending an index over the whole table
+        double index_probe_cost(const storage::Table* table) {
+            return 1.0 + std::log2(static_cast<double>(table->row_count()) + 1.0);
+        }
+        
+        // Rewrites "literal op column" as "column op literal"
+        Operator mirror_operator(Operator op) {
+            switch (op) {
+                case Operator::LESS_THAN: return Operator::GREATER_THAN;
+                case Operator::LESS_EQUAL: return Operator::GREATER_EQUAL;
+                case Operator::GREATER_THAN: return Operator::LESS_THAN;
+                case Operator::GREATER_EQUAL: return Operator::LESS_EQUAL;
+                default: return op;
+            }
+        }
+        
+        // A WHERE clause of the form "column op literal", either way round
+        struct ColumnComparison {
+            const ColumnExpression* column = nullptr;
+            const LiteralExpression* literal = nullptr;
+            Operator op = Operator::EQUAL;
+        };
+        
+        bool match_column_comparison(const Expression* expr, ColumnComparison& match) {
+            const auto* comparison = dynamic_cast<const BinaryExpression*>(expr);
+            if (!comparison) {
+                return false;
+            }
+            
+            match.op = comparison->get_operator();
+            match.column = dynamic_cast<const ColumnExpression*>(comparison->get_left());
+            match.literal = dynamic_cast<const LiteralExpression*>(comparison->get_right());
+            if (!match.column || !match.literal) {
+                match.column = dynamic_cast<const ColumnExpression*>(comparison->get_right());
+                match.literal = dynamic_cast<const LiteralExpression*>(comparison->get_left());
+                match.op = mirror_operator(match.op);
+            }
+            return match.column && match.literal;
+        }
+        
+        // Bounds an index walk over column_name can take from a WHERE
+        // comparison on that column; false if the WHERE is about another
+        bool index_bounds(const Expression* where, const std::string& column_name,
+                          std::unique_ptr<storage::Value>& lower, std::unique_ptr<storage::Value>& upper) {
+            ColumnComparison match;
+            if (!match_column_comparison(where, match) || match.column->get_column_name() != column_name) {
+                return false;
+            }
+            const storage::Value& key = match.literal->get_value();
+            if (match.op == Operator::EQUAL || match.op == Operator::GREATER_THAN ||
+                match.op == Operator::GREATER_EQUAL) {
+                lower = std::make_unique<storage::Value>(key);
+            }
+            if (match.op == Operator::EQUAL || match.op == Operator::LESS_THAN || match.op == Operator::LESS_EQUAL) {
+                upper = std::make_unique<storage::Value>(key);
+            }
+            return true;
+        }
+        
+        // Ordinals of the columns an expression reads
+        void collect_columns(const Expression* expr, const storage::TableSchema& schema,
+                             std::vector<size_t>& columns) {
+            if (const auto* column = dynamic_cast<const ColumnExpression*>(expr)) {
+                size_t index = schema.get_column_index(column->get_column_name());
+                if (index != SIZE_MAX && std::find(columns.begin(), columns.end(), index) == columns.end()) {
+                    columns.push_back(index);
+                }
+            } else if (const auto* binary = dynamic_cast<const BinaryExpression*>(expr)) {
+                collect_columns(binary->get_left(), schema, columns);
+                collect_columns(binary->get_right(), schema, columns);
+            }
+        }
+        
+        // ANALYZE statistics for one of a table's columns, if it has any
+        const storage::ColumnStatistics* column_statistics(const storage::Table* table, const std::string& column) {
+            const storage::TableStatistics* statistics = table->get_schema().get_statistics();
+            size_t index = table->get_schema().get_column_index(column);
+            if (statistics == nullptr || index >= statistics->columns.size()) {
+                return nullptr;
+            }
+            return &statistics->columns[index];
+        }
+        
+        // Fraction of a table's rows a WHERE clause keeps. Only "column op
+        // literal" on an analyzed column is estimated; anything else gets
+        // the fallback.
+        double estimate_selectivity(const storage::Table* table, const Expression* where, double fallback) {
+            if (where == nullptr) {
+                return 1.0;
+            }
+            ColumnComparison match;
+            if (!match_column_comparison(where, match)) {
+                return fallback;
+            }
+            const storage::ColumnStatistics* stats = column_statistics(table, match.column->get_column_name());
+            if (stats == nullptr) {
+                return fallback;
+            }
+            
+            const storage::Value& key = match.literal->get_value();
+            double equal = stats->equal_fraction(key);
+            switch (match.op) {
+                case Operator::EQUAL: return equal;
+                case Operator::NOT_EQUAL: return std::max(0.0, 1.0 - stats->null_fraction - equal);
+                case Operator::LESS_THAN: return std::max(0.0, stats->range_fraction(nullptr, &key) - equal);
+                case Operator::LESS_EQUAL: return stats->range_fraction(nullptr, &key);
+                case Operator::GREATER_THAN: return std::max(0.0, stats->range_fraction(&key, nullptr) - equal);
+                case Operator::GREATER_EQUAL: return stats->range_fraction(&key, nullptr);
+                default: return fallback;
+            }
+        }
+        
+        // Distinct values of a join key among rows of its input; unknown
+        // without statistics
+        double key_distinct(const storage::Table* table, const std::string& column, double rows) {
+            const storage::ColumnStatistics* stats = column_statistics(table, column);
+            if (stats == nullptr) {
+                return 0.0;
+            }
+            return std::max(1.0, std::min(static_cast<double>(stats->distinct_count), rows));
+        }
+        
+        // Hash key for an equi-join: the type tag, then the value's bytes.
+        // Keys are equal exactly when Value::compare calls the values
+        // equal, except that NULL never joins.
+        bool join_key(const storage::Value& value, std::string& key) {
+            if (value.is_null()) {
+                return false;
+            }
+            
+            key.assign(1, static_cast<char>(value.get_type()));
+            switch (value.get_type()) {
+                case storage::ColumnType::INTEGER: {
+                    int64_t v = value.get_int();
+                    key.append(reinterpret_cast<const char*>(&v), sizeof(v));
+                    break;
+                }
+                case storage::ColumnType::REAL: {
+                    double v = value.get_real();
+                    if (v == 0.0) {
+                        v = 0.0;  // -0.0 compares equal to 0.0
+                    }
+                    key.append(reinterpret_cast<const char*>(&v), sizeof(v));
+                    break;
+                }
+                default:
+                    key.append(value.get_string());
+                    break;
+            }
+            return true;
+        }
+        
+        // Hash key for a GROUP BY: each value encoded as for joins, except
+        // that NULLs form a group of their own
+        void group_key(const std::vector<storage::Value>& values, std::string& key) {
+            key.clear();
+            std::string part;
+            for (const auto& value : values) {
+                if (!join_key(value, part)) {
+                    part.assign(1, static_cast<char>(storage::ColumnType::NULL_TYPE));
+                }
+                // Length-prefixed so TEXT values cannot run into each other
+                uint32_t length = static_cast<uint32_t>(part.size());
+                key.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                key.append(part);
+            }
+        }
+        
+        bool same_group(const std::vector<storage::Value>& a, const std::vector<storage::Value>& b) {
+            for (size_t i = 0; i < a.size(); i++) {
+                if (a[i].compare(b[i]) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        
+        // left || right, with the left row padded so right ordinals line up
+        void concat_rows(const storage::Row& left, const storage::Row& right, size_t left_width,
+                         storage::Row& out) {
+            std::vector<storage::Value> values = left.get_values();
+            values.resize(left_width);
+            values.insert(values.end(), right.get_values().begin(), right.get_values().end());
+            out = storage::Row(values);
+        }
+        
+        // One table in a join, and the name its columns are qualified with
+        struct JoinInput {
+            storage::Table* table;
+            std::string qualifier;
+        };
+        
+        // "Q.COL" for a qualified or unambiguous column name, else empty
+        std::string qualify_column(const std::string& name, const std::vector<JoinInput>& inputs) {
+            size_t dot = name.find('.');
+            std::string qualified;
+            for (const auto& input : inputs) {
+                const auto& schema = input.table->get_schema();
+                if (dot != std::string::npos) {
+                    if (name.compare(0, dot, input.qualifier) == 0 && dot == input.qualifier.size() &&
+                        schema.get_column_index(name.substr(dot + 1)) != SIZE_MAX) {
+                        return name;
+                    }
+                } else if (schema.get_column_index(name) != SIZE_MAX) {
+                    if (!qualified.empty()) {
+                        return std::string();  // Ambiguous
+                    }
+                    qualified = input.qualifier + "." + name;
+                }
+            }
+            return qualified;
+        }
+        
+        // Copy of expr with every column qualified; null if one does not resolve
+        std::unique_ptr<Expression> qualify_expression(const Expression* expr, const std::vector<JoinInput>& inputs) {
+            if (const auto* column = dynamic_cast<const ColumnExpression*>(expr)) {
+                std::string qualified = qualify_column(column->get_column_name(), inputs);
+                if (qualified.empty()) {
+                    return nullptr;
+                }
+                return std::make_unique<ColumnExpression>(qualified);
+            }
+            if (const auto* binary = dynamic_cast<const BinaryExpression*>(expr)) {
+                auto left = qualify_expression(binary->get_left(), inputs);
+                auto right = qualify_expression(binary->get_right(), inputs);
+                if (!left || !right) {
+                    return nullptr;
+                }
+                return std::make_unique<BinaryExpression>(std::move(left), std::move(right), binary->get_operator());
+            }
+            return expr->clone();
+        }
+        
+        // The one input a qualified expression reads, or SIZE_MAX if it
+        // reads none or several
+        size_t single_input(const Expression* expr, const std::vector<JoinInput>& inputs) {
+            std::vector<std::string> names;
+            std::vector<const Expression*> pending{expr};
+            while (!pending.empty()) {
+                const Expression* e = pending.back();
+                pending.pop_back();
+                if (const auto* column = dynamic_cast<const ColumnExpression*>(e)) {
+                    const std::string& name = column->get_column_name();
+                    names.push_back(name.substr(0, name.find('.')));
+                } else if (const auto* binary = dynamic_cast<const BinaryExpression*>(e)) {
+                    pending.push_back(binary->get_left());
+                    pending.push_back(binary->get_right());
+                }
+            }
+            
+            bool one_qualifier = std::all_of(names.begin(), names.end(),
+                                             [&names](const std::string& name) { return name == names[0]; });
+            if (names.empty() || !one_qualifier) {
+                return SIZE_MAX;
+            }
+            for (size_t i = 0; i < inputs.size(); i++) {
+                if (inputs[i].qualifier == names[0]) {
+                    return i;
+                }
+            }
+            return SIZE_MAX;
+        }
+        
+        // Copy of a single-input expression bound back to the table's own names
+        std::unique_ptr<Expression> unqualify_expression(const Expression* expr) {
+            if (const auto* column = dynamic_cast<const ColumnExpression*>(expr)) {
+                const std::string& name = column->get_column_name();
+                return std::make_unique<ColumnExpression>(name.substr(name.find('.') + 1));
+            }
+            if (const auto* binary = dynamic_cast<const BinaryExpression*>(expr)) {
+                return std::make_unique<BinaryExpression>(unqualify_expression(binary->get_left()),
+                                                          unqualify_expression(binary->get_right()),
+                                                          binary->get_operator());
+            }
+            return expr->clone();
+        }
+        
+        // Distinct values of an equi-join's key: the larger count of its two
+        // sides, as only values on both can match. 0 when either side was
+        // never analyzed.
+        double join_key_distinct(const ColumnExpression* a, const ColumnExpression* b,
+                                 const std::vector<JoinInput>& inputs, const std::vector<double>& input_rows) {
+            double distinct = 0.0;
+            for (const ColumnExpression* column : {a, b}) {
+                size_t input = single_input(column, inputs);
+                const std::string& name = column->get_column_name();
+                double side = input == SIZE_MAX ? 0.0 : key_distinct(inputs[input].table,
+                                                                     name.substr(name.find('.') + 1),
+                                                                     input_rows[input]);
+                if (side == 0.0) {
+                    return 0.0;
+                }
+                distinct = std::max(distinct, side);
+            }
+            return distinct;
+        }
+        
+        // Rows out of an equi-join. Without a distinct count the key is
+        // taken to be unique on the smaller side, as with a foreign key.
+        double equi_join_rows(double left_rows, double right_rows, double key_distinct_values) {
+            if (key_distinct_values <= 0.0) {
+                return std::max(left_rows, right_rows);
+            }
+            return left_rows * right_rows / key_distinct_values;
+        }
+        
+        // Greedy join order: start from the smallest input, then join
+        // whichever connected input gives the fewest estimated rows. Only
+        // tried for three or more inputs, all analyzed, whose conditions
+        // are all "a.x = b.y" between two inputs. The conditions then form
+        // a tree, so each join takes exactly one of them.
+        bool choose_join_order(const std::vector<JoinInput>& inputs,
+                               const std::vector<std::unique_ptr<Expression>>& conditions,
+                               const std::vector<double>& input_rows, std::vector<size_t>& order,
+                               std::vector<size_t>& step_conditions) {
+            if (inputs.size() < 3) {
+                return false;
+            }
+            for (const auto& input : inputs) {
+                if (input.table->get_schema().get_statistics() == nullptr) {
+                    return false;
+                }
+            }
+            
+            struct Edge {
+                size_t a;
+                size_t b;
+                double distinct;
+            };
+            std::vector<Edge> edges;
+            for (const auto& condition : conditions) {
+                const auto* equality = dynamic_cast<const BinaryExpression*>(condition.get());
+                if (!equality || equality->get_operator() != Operator::EQUAL) {
+                    return false;
+                }
+                const auto* a = dynamic_cast<const ColumnExpression*>(equality->get_left());
+                const auto* b = dynamic_cast<const ColumnExpression*>(equality->get_right());
+                size_t a_input = a ? single_input(a, inputs) : SIZE_MAX;
+                size_t b_input = b ? single_input(b, inputs) : SIZE_MAX;
+                if (a_input == SIZE_MAX || b_input == SIZE_MAX || a_input == b_input) {
+                    return false;
+                }
+                edges.push_back({a_input, b_input, join_key_distinct(a, b, inputs, input_rows)});
+            }
+            
+            std::vector<bool> joined(inputs.size(), false);
+            std::vector<bool> used(edges.size(), false);
+            order.assign(1, static_cast<size_t>(std::min_element(input_rows.begin(), input_rows.end()) -
+                                                input_rows.begin()));
+            joined[order[0]] = true;
+            double rows = input_rows[order[0]];
+            while (order.size() < inputs.size()) {
+                size_t best = SIZE_MAX;
+                double best_rows = 0.0;
+                for (size_t e = 0; e < edges.size(); e++) {
+                    if (used[e] || joined[edges[e].a] == joined[edges[e].b]) {
+                        continue;
+                    }
+                    size_t next = joined[edges[e].a] ? edges[e].b : edges[e].a;
+                    double result = equi_join_rows(rows, input_rows[next], edges[e].distinct);
+                    if (best == SIZE_MAX || result < best_rows) {
+                        best = e;
+                        best_rows = result;
+                    }
+                }
+                if (best == SIZE_MAX) {
+                    return false;  // Not connected by the conditions
+                }
+                size_t next = joined[edges[best].a] ? edges[best].b : edges[best].a;
+                joined[next] = true;
+                used[best] = true;
+                order.push_back(next);
+                step_conditions.push_back(best);
+                rows = best_rows;
+            }
+            return true;
+        }
+        
+        bool is_aggregate_name(const SelectStatement* stmt, const std::string& column_name) {
+            for (const auto& aggregate : stmt->get_aggregates()) {
+                if (aggregate.name == column_name) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        // Statements that run through the planner; the rest change the
+        // catalog, or, like EXPLAIN, plan in their own way
+        bool uses_planner(const Statement* stmt) {
+            return stmt->get_type() != StatementType::CREATE_TABLE && stmt->get_type() != StatementType::DROP_TABLE &&
+                   stmt->get_type() != StatementType::TRANSACTION && stmt->get_type() != StatementType::ANALYZE &&
+                   stmt->get_type() != StatementType::EXPLAIN;
+        }
+        
+        // Only parameterless planner statements are worth keeping between calls
+        bool cacheable(const PreparedStatement& prepared) {
+            return prepared.parameter_count() == 0 && uses_planner(prepared.get_statement());
+        }
+        
+        // The table a statement changes, or "" if it changes none
+        std::string written_table(const Statement* stmt) {
+            switch (stmt->get_type()) {
+                case StatementType::INSERT:
+                    return static_cast<const InsertStatement*>(stmt)->get_table_name();
+                case StatementType::COPY:
+                    return static_cast<const CopyStatement*>(stmt)->get_table_name();
+                case StatementType::UPDATE:
+                    return static_cast<const UpdateStatement*>(stmt)->get_table_name();
+                case StatementType::DELETE:
+                    return static_cast<const DeleteStatement*>(stmt)->get_table_name();
+                case StatementType::EXPLAIN: {
+                    const auto* explain = static_cast<const ExplainStatement*>(stmt);
+                    return explain->is_analyze() ? written_table(explain->get_statement()) : std::string();
+                }
+                default:
+                    return std::string();
+            }
+        }
+        
+        // Whether a statement appends to the log outside any transaction's
+        // commit: table DDL, and writes to tables that are not versioned
+        bool logs_directly(const Statement* stmt, QueryExecutor& executor, bool versioning) {
+            if (stmt->get_type() == StatementType::CREATE_TABLE || stmt->get_type() == StatementType::DROP_TABLE) {
+                return true;
+            }
+            std::string name = written_table(stmt);
+            if (name.empty()) {
+                return false;
+            }
+            if (!versioning) {
+                return true;
+            }
+            storage::Table* table = executor.get_table(name);
+            return table != nullptr && table->get_schema().get_storage_format() == storage::StorageFormat::COLUMNAR;
+        }
+        
+        std::atomic<uint64_t> catalog_version_counter{0};
+        
+        // Converts a CSV field to a value of the column's type; an empty
+        // unquoted field is NULL and "" is an empty string
+        bool parse_csv_field(const utils::CsvField& field, storage::ColumnType type, storage::Value& value) {
+            if (field.text.empty() && !field.quoted) {
+                value = storage::Value();
+                return true;
+            }
+            
+            switch (type) {
+                case storage::ColumnType::INTEGER: {
+                    int64_t number = 0;
+                    const char* end = field.text.data() + field.text.size();
+                    auto [ptr, ec] = std::from_chars(field.text.data(), end, number);
+                    if (ec != std::errc() || ptr != end) {
+                        return false;
+                    }
+                    value = storage::Value(number);
+                    return true;
+                }
+                case storage::ColumnType::REAL: {
+                    std::string text(field.text);
+                    char* end = nullptr;
+                    double number = std::strtod(text.c_str(), &end);
+                    if (text.empty() || end != text.c_str() + text.size()) {
+                        return false;
+                    }
+                    value = storage::Value(number);
+                    return true;
+                }
+                case storage::ColumnType::TEXT:
+                    value = storage::Value(field.text);
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        
+        bool to_compare_op(Operator op, CompareOp& out) {
+            switch (op) {
+                case Operator::EQUAL: out = CompareOp::EQUAL; return true;
+                case Operator::NOT_EQUAL: out = CompareOp::NOT_EQUAL; return true;
+                case Operator::LESS_THAN: out = CompareOp::LESS_THAN; return true;
+                case Operator::LESS_EQUAL: out = CompareOp::LESS_EQUAL; return true;
+                case Operator::GREATER_THAN: out = CompareOp::GREATER_THAN; return true;
+                case Operator::GREATER_EQUAL: out = CompareOp::GREATER_EQUAL; return true;
+                default: return false;
+            }
+        }
+        
+        
+        // Rough heap footprint of a row, for the sort's memory budget
+        size_t row_footprint(const storage::Row& row) {
+            size_t bytes = sizeof(storage::Row) + row.size() * sizeof(storage::Value);
+            for (const auto& value : row.get_values()) {
+                if (value.get_type() == storage::ColumnType::TEXT) {
+                    bytes += value.get_string().size();
+                }
+            }
+            return bytes;
+        }
+        
+        // Rows a plan must produce to satisfy LIMIT and OFFSET
+        size_t rows_needed(const SelectStatement* stmt) {
+            size_t limit = stmt->get_limit();
+            return limit > SIZE_MAX - stmt->get_offset() ? SIZE_MAX : limit + stmt->get_offset();
+        }
+        
+        // A sorted run spilled to buffer pool pages, as length-prefixed rows
+        // in encode_row format packed across page boundaries. Written once,
+        // then read once; each page goes back to the pool as soon as it has
+        // been read, and the rest when the run is dropped.
+        class SpillRun {
+        public:
+            explicit SpillRun(storage::PageManager* page_manager)
+                : page_manager_(page_manager), buffer_(page_manager->get_page_size()), used_(0), bytes_(0),
+                  next_page_(0), remaining_(0) {}
+            
+            ~SpillRun() {
+                for (size_t i = next_page_; i < pages_.size(); i++) {
+                    page_manager_->deallocate_page(pages_[i]);
+                }
+            }
+            
+            SpillRun(const SpillRun&) = delete;
+            SpillRun& operator=(const SpillRun&) = delete;
+            
+            bool append(const storage::Row& row) {
+                storage::encode_row(row, row.get_id(), record_);
+                uint32_t length = static_cast<uint32_t>(record_.size());
+                return write(reinterpret_cast<const char*>(&length), sizeof(length)) &&
+                       write(record_.data(), record_.size());
+            }
+            
+            // Writes out the last partial page and rewinds for reading
+            bool finish() {
+                bool written = used_ == 0 || write_page();
+                remaining_ = bytes_;
+                used_ = buffer_.size();
+                return written;
+            }
+            
+            bool next(storage::Row& row) {
+                uint32_t length = 0;
+                if (!read(reinterpret_cast<char*>(&length), sizeof(length))) {
+                    return false;
+                }
+                record_.resize(length);
+                return read(record_.data(), length) && storage::decode_row(record_.data(), length, row);
+            }
+        
+        private:
+            bool write(const char* data, size_t length) {
+                while (length > 0) {
+                    size_t chunk = std::min(length, buffer_.size() - used_);
+                    std::memcpy(buffer_.data() + used_, data, chunk);
+                    used_ += chunk;
+                    bytes_ += chunk;
+                    data += chunk;
+                    length -= chunk;
+                    if (used_ == buffer_.size() && !write_page()) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            
+            bool write_page() {
+                storage::PageId page_id = page_manager_->allocate_page();
+                storage::Page* page = page_id != storage::INVALID_PAGE_ID ? page_manager_->fetch_page(page_id) : nullptr;
+                if (page == nullptr) {
+                    return false;  // Buffer pool exhausted
+                }
+                page->write(0, buffer_.data(), used_);
+                page_manager_->unpin_page(page_id);
+                pages_.push_back(page_id);
+                used_ = 0;
+                return true;
+            }
+            
+            bool read(char* data, size_t length) {
+                if (length > remaining_) {
+                    return false;
+                }
+                while (length > 0) {
+                    if (used_ == buffer_.size() && !read_page()) {
+                        return false;
+                    }
+                    size_t chunk = std::min(length, buffer_.size() - used_);
+                    std::memcpy(data, buffer_.data() + used_, chunk);
+                    used_ += chunk;
+                    remaining_ -= chunk;
+                    data += chunk;
+                    length -= chunk;
+                }
+                return true;
+            }
+            
+            bool read_page() {
+                if (next_page_ >= pages_.size()) {
+                    return false;
+                }
+                storage::PageId page_id = pages_[next_page_++];
+                storage::Page* page = page_manager_->fetch_page(page_id);
+                bool loaded = page != nullptr && page->read(0, buffer_.data(), buffer_.size());
+                if (page != nullptr) {
+                    page_manager_->unpin_page(page_id);
+                }
+                page_manager_->deallocate_page(page_id);
+                used_ = 0;
+                return loaded;
+            }
+            
+            storage::PageManager* page_manager_;
+            std::vector<storage::PageId> pages_;
+            std::vector<char> buffer_;  // The page being written, then the page being read
+            std::vector<char> record_;
+            size_t used_;
+            size_t bytes_;
+            size_t next_page_;
+            size_t remaining_;
+        };
+        
+        utils::LatencyHistogram& parse_latency() {
+            static utils::LatencyHistogram& histogram = utils::MetricsRegistry::global().histogram("query.parse");
+            return histogram;
+        }
+        
+        utils::LatencyHistogram& plan_latency() {
+            static utils::LatencyHistogram& histogram = utils::MetricsRegistry::global().histogram("query.plan");
+            return histogram;
+        }
+        
+        utils::LatencyHistogram& execute_latency() {
+            static utils::LatencyHistogram& histogram = utils::MetricsRegistry::global().histogram("query.execute");
+            return histogram;
+        }
+        
+        // Values and expressions as they would be written in SQL, for EXPLAIN
+        std::string describe_value(const storage::Value& value) {
+            if (value.is_null()) {
+                return "NULL";
+            }
+            return value.get_type() == storage::ColumnType::TEXT ? "'" + value.to_string() + "'" : value.to_string();
+        }
+        
+        std::string describe_expression(const Expression* expr) {
+            if (const auto* column = dynamic_cast<const ColumnExpression*>(expr)) {
+                return column->get_column_name();
+            }
+            if (const auto* literal = dynamic_cast<const LiteralExpression*>(expr)) {
+                return describe_value(literal->get_value());
+            }
+            if (const auto* binary = dynamic_cast<const BinaryExpression*>(expr)) {
+                const char* symbol = "?";
+                switch (binary->get_operator()) {
+                    case Operator::EQUAL: symbol = "="; break;
+                    case Operator::NOT_EQUAL: symbol = "!="; break;
+                    case Operator::LESS_THAN: symbol = "<"; break;
+                    case Operator::LESS_EQUAL: symbol = "<="; break;
+                    case Operator::GREATER_THAN: symbol = ">"; break;
+                    case Operator::GREATER_EQUAL: symbol = ">="; break;
+                    default: break;
+                }
+                return describe_expression(binary->get_left()) + " " + symbol + " " +
+                       describe_expression(binary->get_right());
+            }
+            return "?";
+        }
+        
+        std::string describe_names(const std::vector<std::string>& names) {
+            std::string text;
+            for (const auto& name : names) {
+                text += (text.empty() ? "" : ", ") + name;
+            }
+            return text;
+        }
+        
+        // Name of a row position in a node's output, or its number when the
+        // names are only known once the node is open
+        std::string describe_position(const PlanNode* node, size_t position) {
+            std::vector<std::string> names = node->get_column_names();
+            return position < names.size() ? names[position] : "#" + std::to_string(position + 1);
+        }
+        
+        std::string describe_aggregates(const char* kind, const std::vector<std::string>& group_by,
+                                        const std::vector<AggregateSpec>& aggregates) {
+            std::vector<std::string> outputs;
+            for (const auto& aggregate : aggregates) {
+                outputs.push_back(aggregate.output);
+            }
+            std::string text = kind;
+            if (!group_by.empty()) {
+                text += " by " + describe_names(group_by);
+            }
+            return text + ": " + describe_names(outputs);
+        }
+        
+        // Wraps a plan node for EXPLAIN ANALYZE and measures every call into
+        // it. Time and pages include the node's children, which are wrapped
+        // the same way; pages count buffer pool fetches on this thread and
+        // those parallel scan workers report back.
+        class ProfileNode : public PlanNode {
+        public:
+            using Clock = std::chrono::steady_clock;
+            
+            explicit ProfileNode(std::unique_ptr<PlanNode> node)
+                : node_(std::move(node)), rows_(0), pages_(0), elapsed_(Clock::duration::zero()) {}
+            
+            bool open() override {
+                bool opened = measure([&]() { return node_->open(); });
+                if (!opened) {
+                    error_ = node_->get_error();
+                }
+                return opened;
+            }
+            
+            bool next(storage::Row& row) override {
+                bool produced = measure([&]() { return node_->next(row); });
+                rows_ += produced ? 1 : 0;
+                return produced;
+            }
+            
+            void close() override {
+                measure([&]() {
+                    node_->close();
+                    return true;
+                });
+            }
+            
+            QueryResult execute() override {
+                QueryResult result = measure([&]() { return node_->execute(); });
+                if (result.is_success()) {
+                    rows_ += result.get_affected_rows();
+                }
+                return result;
+            }
+            
+            bool produces_rows() const override { return node_->produces_rows(); }
+            std::vector<std::string> get_column_names() const override { return node_->get_column_names(); }
+            double get_cost() const override { return node_->get_cost(); }
+            double estimate_rows() const override { return node_->estimate_rows(); }
+            std::string describe() const override { return node_->describe(); }
+            std::vector<std::unique_ptr<PlanNode>*> children() override { return node_->children(); }
+            
+            uint64_t rows() const { return rows_; }
+            uint64_t pages() const { return pages_; }
+            double milliseconds() const { return std::chrono::duration<double, std::milli>(elapsed_).count(); }
+        
+        private:
+            template<typename Call>
+            auto measure(Call call) {
+                uint64_t pages = storage::PageManager::thread_page_accesses();
+                Clock::time_point start = Clock::now();
+                auto result = call();
+                elapsed_ += Clock::now() - start;
+                pages_ += storage::PageManager::thread_page_accesses() - pages;
+                return result;
+            }
+            
+            std::unique_ptr<PlanNode> node_;
+            uint64_t rows_;
+            uint64_t pages_;
+            Clock::duration elapsed_;
+        };
+        
+        // Wraps every node of the plan in a ProfileNode, leaves first
+        void profile_plan(std::unique_ptr<PlanNode>& node) {
+            for (std::unique_ptr<PlanNode>* child : node->children()) {
+                profile_plan(*child);
+            }
+            node = std::make_unique<ProfileNode>(std::move(node));
+        }
+        
+        // EXPLAIN ANALYZE runs the plan for its measurements, not its rows
+        class DiscardSink : public ResultSink {
+        public:
+            void begin(const std::vector<std::string>& /*column_names*/) override {}
+            bool accept(const storage::Row& /*row*/) override { return true; }
+        };
+        
+        // One line per node, children indented under their parent
+        void explain_node(PlanNode* node, size_t depth, std::vector<storage::Row>& lines) {
+            std::ostringstream line;
+            if (depth > 0) {
+                line << std::string((depth - 1) * 4 + 2, ' ') << "-> ";
+            }
+            line << node->describe() << std::fixed << std::setprecision(2) << "  (cost=" << node->get_cost()
+                 << " rows=" << std::llround(node->estimate_rows()) << ")";
+            if (const auto* profile = dynamic_cast<const ProfileNode*>(node)) {
+                line << " (actual rows=" << profile->rows() << " time=" << std::setprecision(3)
+                     << profile->milliseconds() << " ms pages=" << profile->pages() << ")";
+            }
+            lines.emplace_back(std::vector<storage::Value>{storage::Value(line.str())});
+            
+            for (std::unique_ptr<PlanNode>* child : node->children()) {
+                explain_node(child->get(), depth + 1, lines);
+            }
+        }
+    
+    } // namespace
+    
+    // Runs being merged by a SortNode that spilled, with the next row of each
+    struct SortNode::Merge {
+        std::vector<std::unique_ptr<SpillRun>> runs;
+        std::vector<storage::Row> heads;
+        std::vector<size_t> heap;  // Runs that still have rows, ordered by their heads
+    };
+    
     // QueryResult implementation (constructors already in header)
     
     // Plan node implementations
-    QueryResult TableScanNode::execute() {
+    QueryResult PlanNode::execute() {
+        // Drains the pull interface; nodes that do not produce rows override this
+        if (!open()) {
+            close();
+            return QueryResult(error_);
+        }
+        
         std::vector<storage::Row> result_rows;
-        const auto& all_rows = table_->get_all_rows();
+        storage::Row row;
+        while (next(row)) {
+            result_rows.push_back(row);
+        }
+        close();
         
-        for (const auto& row : all_rows) {
-            bool include = true;
-            
-            if (filter_) {
-                storage::Value filter_result = filter_->evaluate(row, table_->get_schema());
-                include = (filter_result.get_type() == storage::ColumnType::INTEGER && 
-                          filter_result.get_int() != 0);
+        return QueryResult(result_rows, get_column_names());
+    }
+    
+    bool TableScanNode::open() {
+        next_page_ = 0;
+        page_rows_.clear();
+        page_pos_ = 0;
+        batch_rows_.clear();
+        selection_.clear();
+        selection_pos_ = 0;
+        wave_.clear();
+        wave_index_ = 0;
+        wave_pos_ = 0;
+        wave_end_ = false;
+        predicate_ = CompiledPredicate::compile(filter_.get(), table_->get_schema());
+        parallel_ = parallelism_ > 1 && table_->page_count() >= PARALLEL_MIN_PAGES;
+        
+        // "column op literal" on a plain value type is filtered in batches
+        ColumnComparison match;
+        vectorized_ = false;
+        if (filter_ && match_column_comparison(filter_.get(), match) && to_compare_op(match.op, batch_op_)) {
+            storage::ColumnType type = match.literal->get_value().get_type();
+            batch_column_ = table_->get_schema().get_column_index(match.column->get_column_name());
+            batch_literal_ = match.literal->get_value();
+            vectorized_ = batch_column_ != SIZE_MAX &&
+                          (type == storage::ColumnType::INTEGER || type == storage::ColumnType::REAL ||
+                           type == storage::ColumnType::TEXT);
+        }
+        return true;
+    }
+    
+    bool TableScanNode::next(storage::Row& row) {
+        if (parallel_) {
+            return next_parallel(row);
+        }
+        if (vectorized_) {
+            return next_batched(row);
+        }
+        
+        // Rows are pulled a heap page at a time
+        while (true) {
+            while (page_pos_ < page_rows_.size()) {
+                storage::Row& candidate = page_rows_[page_pos_++];
+                if (predicate_(candidate)) {
+                    emit(candidate, row);
+                    return true;
+                }
             }
             
-            if (include) {
-                result_rows.push_back(row);
+            if (!table_->read_page_rows(next_page_++, page_rows_, read_columns(), storage::Transaction::current())) {
+                return false;
             }
+            page_pos_ = 0;
+        }
+    }
+    
+    bool TableScanNode::next_batched(storage::Row& row) {
+        while (selection_pos_ >= selection_.size()) {
+            if (!fill_batch()) {
+                return false;
+            }
+        }
+        emit(batch_rows_[selection_[selection_pos_++]], row);
+        return true;
+    }
+    
+    bool TableScanNode::fill_batch() {
+        batch_rows_.clear();
+        selection_.clear();
+        selection_pos_ = 0;
+        
+        // Whole heap pages until the batch is full
+        const storage::Transaction* reader = storage::Transaction::current();
+        while (batch_rows_.size() < BATCH_SIZE && table_->read_page_rows(next_page_, page_rows_, read_columns(), reader)) {
+            next_page_++;
+            for (auto& page_row : page_rows_) {
+                batch_rows_.push_back(std::move(page_row));
+            }
+        }
+        if (batch_rows_.empty()) {
+            return false;
+        }
+        
+        select_batch(batch_rows_, batch_values_, selection_);
+        return true;
+    }
+    
+    void TableScanNode::select_batch(const std::vector<storage::Row>& rows, ColumnVector& values,
+                                     std::vector<uint32_t>& selection) const {
+        // Transpose the filter column and compare it in one pass
+        static const storage::Value null_value;
+        values.reset(batch_literal_.get_type());
+        for (const auto& batch_row : rows) {
+            values.append(batch_column_ < batch_row.size() ? batch_row.get_value(batch_column_) : null_value);
+        }
+        select_rows(values, batch_op_, batch_literal_, selection);
+    }
+    
+    bool TableScanNode::next_parallel(storage::Row& row) {
+        while (true) {
+            while (wave_index_ < wave_.size()) {
+                std::vector<storage::Row>& morsel = wave_[wave_index_];
+                if (wave_pos_ < morsel.size()) {
+                    row = std::move(morsel[wave_pos_++]);
+                    return true;
+                }
+                wave_index_++;
+                wave_pos_ = 0;
+            }
+            
+            if (!fill_wave()) {
+                return false;
+            }
+        }
+    }
+    
+    bool TableScanNode::fill_wave() {
+        if (wave_end_) {
+            return false;
+        }
+        
+        // Each morsel is one page, filtered and projected by whichever
+        // thread claims it. Results stay in page order, so the output
+        // matches a serial scan row for row.
+        size_t morsels = parallelism_ * MORSELS_PER_THREAD;
+        size_t first_page = next_page_;
+        std::atomic<bool> past_end(false);
+        const storage::Transaction* reader = storage::Transaction::current();  // Workers have none of their own
+        wave_.clear();
+        wave_.resize(morsels);
+        wave_index_ = 0;
+        wave_pos_ = 0;
+        
+        // Pages workers fetch are credited to this thread, as if it had read them
+        std::thread::id caller = std::this_thread::get_id();
+        std::atomic<uint64_t> worker_pages(0);
+        
+        utils::ThreadPool::shared().parallel_for(morsels, parallelism_, [&](size_t morsel) {
+            uint64_t pages = storage::PageManager::thread_page_accesses();
+            std::vector<storage::Row> rows;
+            bool read = table_->read_page_rows(first_page + morsel, rows, read_columns(), reader);
+            if (std::this_thread::get_id() != caller) {
+                worker_pages += storage::PageManager::thread_page_accesses() - pages;
+            }
+            if (!read) {
+                past_end = true;
+                return;
+            }
+            filter_morsel(rows, wave_[morsel]);
+        });
+        storage::PageManager::add_thread_page_accesses(worker_pages.load());
+        
+        next_page_ += morsels;
+        wave_end_ = past_end;
+        return true;
+    }
+    
+    void TableScanNode::filter_morsel(std::vector<storage::Row>& rows, std::vector<storage::Row>& output) const {
+        if (vectorized_) {
+            ColumnVector values;
+            std::vector<uint32_t> selection;
+            select_batch(rows, values, selection);
+            output.resize(selection.size());
+            for (size_t i = 0; i < selection.size(); i++) {
+                emit(rows[selection[i]], output[i]);
+            }
+            return;
+        }
+        
+        for (auto& row : rows) {
+            if (predicate_(row)) {
+                output.emplace_back();
+                emit(row, output.back());
+            }
+        }
+    }
+    
+    void TableScanNode::emit(storage::Row& source, storage::Row& row) const {
+        if (!projected_) {
+            row = std::move(source);
+            return;
+        }
+        
+        row = storage::Row();
+        row.set_id(source.get_id());
+        for (size_t column : projection_) {
+            row.add_value(column < source.size() ? source.get_value(column) : storage::Value());
+        }
+    }
+    
+    void TableScanNode::close() {
+        page_rows_.clear();
+        batch_rows_.clear();
+        selection_.clear();
+        wave_.clear();
+    }
+    
+    std::vector<std::string> TableScanNode::get_column_names() const {
+        if (!projected_) {
+            return table_column_names(table_);
+        }
+        
+        std::vector<std::string> column_names;
+        for (size_t column : projection_) {
+            column_names.push_back(table_->get_schema().get_column(column).name);
+        }
+        return column_names;
+    }
+    
+    double TableScanNode::get_cost() const {
+        return static_cast<double>(table_->row_count());  // Linear scan cost
+    }
+    
+    double TableScanNode::estimate_rows() const {
+        return static_cast<double>(table_->row_count()) * estimate_selectivity(table_, filter_.get(), 1.0);
+    }
+    
+    std::string TableScanNode::describe() const {
+        bool parallel = parallelism_ > 1 && table_->page_count() >= PARALLEL_MIN_PAGES;
+        std::string text = (parallel ? "Parallel Seq Scan on " : "Seq Scan on ") + table_->get_schema().get_table_name();
+        if (filter_) {
+            text += " where " + describe_expression(filter_.get());
+        }
+        return parallel ? text + " (" + std::to_string(parallelism_) + " threads)" : text;
+    }
+    
+    bool IndexLookupNode::open() {
+        position_ = 0;
+        predicate_ = CompiledPredicate::compile(filter_.get(), table_->get_schema());
+        if (!table_->index_lookup(column_name_, key_, candidates_, storage::Transaction::current())) {
+            error_ = "Index on '" + column_name_ + "' no longer exists";
+            return false;
+        }
+        return true;
+    }
+    
+    bool IndexLookupNode::next(storage::Row& row) {
+        // The index narrows the candidates; the filter still decides
+        while (position_ < candidates_.size()) {
+            storage::Row& candidate = candidates_[position_++];
+            if (predicate_(candidate)) {
+                row = std::move(candidate);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void IndexLookupNode::close() {
+        candidates_.clear();
+    }
+    
+    std::vector<std::string> IndexLookupNode::get_column_names() const {
+        return table_column_names(table_);
+    }
+    
+    double IndexLookupNode::get_cost() const {
+        // One probe, then every match fetched; a key held by most of the
+        // rows costs more than scanning them
+        return index_probe_cost(table_) + INDEX_FETCH_COST * estimate_rows();
+    }
+    
+    double IndexLookupNode::estimate_rows() const {
+        // Unanalyzed, keys are taken to be unique
+        if (column_statistics(table_, column_name_) == nullptr) {
+            return 1.0;
+        }
+        return estimate_selectivity(table_, filter_.get(), 0.0) * static_cast<double>(table_->row_count());
+    }
+    
+    std::string IndexLookupNode::describe() const {
+        return "Index Lookup on " + table_->get_schema().get_table_name() + " using " + column_name_ + " = " +
+               describe_value(key_);
+    }
+    
+    void IndexRangeScanNode::set_order(bool descending, size_t limit) {
+        ordered_ = true;
+        descending_ = descending;
+        limit_ = limit;
+    }
+    
+    bool IndexRangeScanNode::open() {
+        position_ = 0;
+        predicate_ = CompiledPredicate::compile(filter_.get(), table_->get_schema());
+        
+        // Feeding an ORDER BY, the walk goes the requested way and stops
+        // once it has enough rows that pass the filter
+        bool found = ordered_ ? table_->index_ordered(column_name_, lower_.get(), upper_.get(), descending_, limit_,
+                                                      predicate_, candidates_, storage::Transaction::current())
+                              : table_->index_range(column_name_, lower_.get(), upper_.get(), candidates_,
+                                                    storage::Transaction::current());
+        if (!found) {
+            error_ = "Range index on '" + column_name_ + "' no longer exists";
+            return false;
+        }
+        return true;
+    }
+    
+    bool IndexRangeScanNode::next(storage::Row& row) {
+        // Bounds are inclusive, so strict comparisons are settled here
+        while (position_ < candidates_.size()) {
+            storage::Row& candidate = candidates_[position_++];
+            if (predicate_(candidate)) {
+                row = std::move(candidate);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void IndexRangeScanNode::close() {
+        candidates_.clear();
+    }
+    
+    std::vector<std::string> IndexRangeScanNode::get_column_names() const {
+        return table_column_names(table_);
+    }
+    
+    double IndexRangeScanNode::get_cost() const {
+        // Every row between the bounds is fetched, whatever the filter then keeps
+        const storage::ColumnStatistics* stats = column_statistics(table_, column_name_);
+        double selectivity = stats != nullptr ? stats->range_fraction(lower_.get(), upper_.get())
+                             : (lower_ && upper_) ? RANGE_SELECTIVITY * RANGE_SELECTIVITY
+                             : (lower_ || upper_) ? RANGE_SELECTIVITY : 1.0;
+        double fetched = selectivity * static_cast<double>(table_->row_count());
+        if (ordered_) {
+            // The walk stops once limit_ rows have passed the filter
+            double rows = static_cast<double>(table_->row_count());
+            double kept = std::max(rows * estimate_selectivity(table_, filter_.get(), 1.0), 1.0);
+            fetched = std::min(fetched, static_cast<double>(limit_) * std::max(fetched / kept, 1.0));
+        }
+        return index_probe_cost(table_) + INDEX_FETCH_COST * fetched;
+    }
+    
+    double IndexRangeScanNode::estimate_rows() const {
+        double rows = static_cast<double>(table_->row_count()) * estimate_selectivity(table_, filter_.get(), 1.0);
+        return ordered_ ? std::min(rows, static_cast<double>(limit_)) : rows;
+    }
+    
+    std::string IndexRangeScanNode::describe() const {
+        std::string text = "Index Range Scan on " + table_->get_schema().get_table_name() + " using " + column_name_;
+        if (lower_) {
+            text += " from " + describe_value(*lower_);
+        }
+        if (upper_) {
+            text += " to " + describe_value(*upper_);
+        }
+        if (ordered_) {
+            text += descending_ ? " descending" : " ascending";
+            if (limit_ != SIZE_MAX) {
+                text += ", first " + std::to_string(limit_);
+            }
+        }
+        return text;
+    }
+    
+    bool ProjectionNode::open() {
+        if (!child_->open()) {
+            error_ = child_->get_error();
+            return false;
+        }
+        
+        // Determine column indices to project
+        column_indices_.clear();
+        result_columns_.clear();
+        
+        std::vector<std::string> input_columns = child_->get_column_names();
+        if (columns_.empty()) {
+            // Project all columns
+            for (size_t i = 0; i < input_columns.size(); i++) {
+                column_indices_.push_back(i);
+                result_columns_.push_back(input_columns[i]);
+            }
+        } else {
+            // Project specified columns, by name in the child's output
+            for (const auto& col_name : columns_) {
+                auto it = std::find(input_columns.begin(), input_columns.end(), col_name);
+                if (it != input_columns.end()) {
+                    column_indices_.push_back(static_cast<size_t>(it - input_columns.begin()));
+                    result_columns_.push_back(col_name);
+                }
+            }
+        }
+        
+        return true;
+    }
+    
+    bool ProjectionNode::next(storage::Row& row) {
+        if (!child_->next(input_row_)) {
+            return false;
+        }
+        
+        row = storage::Row();
+        row.set_id(input_row_.get_id());
+        
+        for (size_t col_idx : column_indices_) {
+            if (col_idx < input_row_.size()) {
+                row.add_value(input_row_.get_value(col_idx));
+            } else {
+                row.add_value(storage::Value());  // NULL
+            }
+        }
+        
+        return true;
+    }
+    
+    void ProjectionNode::close() {
+        child_->close();
+    }
+    
+    std::vector<std::string> ProjectionNode::get_column_names() const {
+        return result_columns_;
+    }
+    
+    double ProjectionNode::get_cost() const {
+        return child_->get_cost();  // Same as child cost
+    }
+    
+    double ProjectionNode::estimate_rows() const {
+        return child_->estimate_rows();
+    }
+    
+    std::string ProjectionNode::describe() const {
+        return "Projection " + (columns_.empty() ? std::string("*") : describe_names(columns_));
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> ProjectionNode::children() {
+        return {&child_};
+    }
+    
+    bool FilterNode::open() {
+        if (!child_->open()) {
+            error_ = child_->get_error();
+            return false;
+        }
+        predicate_ = CompiledPredicate::compile(filter_.get(), schema_);
+        return true;
+    }
+    
+    bool FilterNode::next(storage::Row& row) {
+        while (child_->next(row)) {
+            if (predicate_(row)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void FilterNode::close() {
+        child_->close();
+    }
+    
+    std::vector<std::string> FilterNode::get_column_names() const {
+        return child_->get_column_names();
+    }
+    
+    double FilterNode::get_cost() const {
+        return child_->get_cost();
+    }
+    
+    std::string FilterNode::describe() const {
+        return "Filter " + describe_expression(filter_.get());
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> FilterNode::children() {
+        return {&child_};
+    }
+    
+    SortNode::SortNode(std::unique_ptr<PlanNode> child, std::vector<OrderItem> keys, size_t limit,
+                       size_t memory_budget, storage::PageManager* page_manager)
+        : child_(std::move(child)), keys_(std::move(keys)), limit_(limit), memory_budget_(memory_budget),
+          page_manager_(page_manager), position_(0), emitted_(0) {
+    }
+    
+    SortNode::~SortNode() = default;
+    
+    int SortNode::compare(const storage::Row& a, const storage::Row& b) const {
+        for (const auto& [column, descending] : key_columns_) {
+            int order = a.get_value(column).compare(b.get_value(column));
+            if (order != 0) {
+                return descending ? -order : order;
+            }
+        }
+        return 0;
+    }
+    
+    bool SortNode::open() {
+        rows_.clear();
+        position_ = 0;
+        emitted_ = 0;
+        merge_.reset();
+        if (!child_->open()) {
+            error_ = child_->get_error();
+            return false;
+        }
+        
+        // Keys are found by name in the child's output, as ProjectionNode does
+        std::vector<std::string> input_columns = child_->get_column_names();
+        key_columns_.clear();
+        for (const auto& key : keys_) {
+            auto it = std::find(input_columns.begin(), input_columns.end(), key.column);
+            if (it == input_columns.end()) {
+                error_ = "Unknown ORDER BY column: " + key.column;
+                child_->close();
+                return false;
+            }
+            key_columns_.emplace_back(static_cast<size_t>(it - input_columns.begin()), key.descending);
+        }
+        
+        if (limit_ == 0) {
+            return true;
+        }
+        return limit_ <= TOP_N_MAX_ROWS ? load_top_n() : load_sorted();
+    }
+    
+    bool SortNode::load_top_n() {
+        // A max-heap of the limit_ first rows so far, its last row on top.
+        // Ties go to the row read first, as in a stable sort.
+        std::vector<std::pair<storage::Row, size_t>> heap;
+        auto before = [this](const std::pair<storage::Row, size_t>& a, const std::pair<storage::Row, size_t>& b) {
+            int order = compare(a.first, b.first);
+            return order < 0 || (order == 0 && a.second < b.second);
+        };
+        
+        storage::Row row;
+        for (size_t sequence = 0; child_->next(row); sequence++) {
+            if (heap.size() == limit_) {
+                if (compare(row, heap.front().first) >= 0) {
+                    continue;  // Sorts after every row kept
+                }
+                std::pop_heap(heap.begin(), heap.end(), before);
+                heap.pop_back();
+            }
+            heap.emplace_back(std::move(row), sequence);
+            std::push_heap(heap.begin(), heap.end(), before);
+        }
+        
+        std::sort_heap(heap.begin(), heap.end(), before);
+        rows_.reserve(heap.size());
+        for (auto& entry : heap) {
+            rows_.push_back(std::move(entry.first));
+        }
+        return true;
+    }
+    
+    bool SortNode::load_sorted() {
+        // Rows are gathered until the budget is full, then sorted and
+        // spilled as one run; the runs are merged as rows are pulled
+        auto before = [this](const storage::Row& a, const storage::Row& b) { return compare(a, b) < 0; };
+        auto spill = [&]() {
+            std::stable_sort(rows_.begin(), rows_.end(), before);
+            auto run = std::make_unique<SpillRun>(page_manager_);
+            for (const auto& row : rows_) {
+                if (!run->append(row)) {
+                    return false;
+                }
+            }
+            rows_.clear();
+            merge_->runs.push_back(std::move(run));
+            return merge_->runs.back()->finish();
+        };
+        
+        size_t used = 0;
+        storage::Row row;
+        while (child_->next(row)) {
+            used += row_footprint(row);
+            rows_.push_back(std::move(row));
+            if (used > memory_budget_ && page_manager_ != nullptr) {
+                if (!merge_) {
+                    merge_ = std::make_unique<Merge>();
+                }
+                if (!spill()) {
+                    error_ = "Failed to spill sort run";
+                    return false;
+                }
+                used = 0;
+            }
+        }
+        
+        if (!merge_) {
+            std::stable_sort(rows_.begin(), rows_.end(), before);
+            return true;
+        }
+        if (!rows_.empty() && !spill()) {
+            error_ = "Failed to spill sort run";
+            return false;
+        }
+        
+        // Heap of run numbers with the smallest head on top; ties go to the
+        // earlier run, which holds the earlier rows
+        Merge& merge = *merge_;
+        merge.heads.resize(merge.runs.size());
+        for (size_t run = 0; run < merge.runs.size(); run++) {
+            if (merge.runs[run]->next(merge.heads[run])) {
+                merge.heap.push_back(run);
+            }
+        }
+        std::make_heap(merge.heap.begin(), merge.heap.end(), [this](size_t a, size_t b) { return merge_after(a, b); });
+        return true;
+    }
+    
+    bool SortNode::merge_after(size_t a, size_t b) const {
+        int order = compare(merge_->heads[a], merge_->heads[b]);
+        return order > 0 || (order == 0 && a > b);
+    }
+    
+    bool SortNode::next(storage::Row& row) {
+        if (emitted_ >= limit_) {
+            return false;
+        }
+        
+        if (!merge_) {
+            if (position_ >= rows_.size()) {
+                return false;
+            }
+            row = std::move(rows_[position_++]);
+        } else {
+            Merge& merge = *merge_;
+            auto after = [this](size_t a, size_t b) { return merge_after(a, b); };
+            if (merge.heap.empty()) {
+                return false;
+            }
+            std::pop_heap(merge.heap.begin(), merge.heap.end(), after);
+            size_t run = merge.heap.back();
+            row = std::move(merge.heads[run]);
+            if (merge.runs[run]->next(merge.heads[run])) {
+                std::push_heap(merge.heap.begin(), merge.heap.end(), after);
+            } else {
+                merge.heap.pop_back();
+            }
+        }
+        emitted_++;
+        return true;
+    }
+    
+    void SortNode::close() {
+        child_->close();
+        rows_.clear();
+        merge_.reset();  // Returns any unread spill pages
+    }
+    
+    std::vector<std::string> SortNode::get_column_names() const {
+        return child_->get_column_names();
+    }
+    
+    double SortNode::get_cost() const {
+        // A top-N heap holds only limit_ rows, so each row costs log(limit_)
+        double rows = std::max(child_->estimate_rows(), 1.0);
+        double held = limit_ <= TOP_N_MAX_ROWS ? std::min(rows, static_cast<double>(limit_)) : rows;
+        return child_->get_cost() + rows * std::log2(held + 1.0);
+    }
+    
+    double SortNode::estimate_rows() const {
+        return std::min(child_->estimate_rows(), static_cast<double>(limit_));
+    }
+    
+    std::string SortNode::describe() const {
+        std::vector<std::string> keys;
+        for (const auto& key : keys_) {
+            keys.push_back(key.descending ? key.column + " DESC" : key.column);
+        }
+        std::string text = "Sort by " + describe_names(keys);
+        return limit_ <= TOP_N_MAX_ROWS ? text + ", top " + std::to_string(limit_) : text;
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> SortNode::children() {
+        return {&child_};
+    }
+    
+    bool LimitNode::open() {
+        skipped_ = 0;
+        returned_ = 0;
+        if (!child_->open()) {
+            error_ = child_->get_error();
+            return false;
+        }
+        return true;
+    }
+    
+    bool LimitNode::next(storage::Row& row) {
+        if (returned_ >= limit_) {
+            return false;  // The child is not pulled past the last row needed
+        }
+        while (skipped_ < offset_) {
+            if (!child_->next(row)) {
+                return false;
+            }
+            skipped_++;
+        }
+        if (!child_->next(row)) {
+            return false;
+        }
+        returned_++;
+        return true;
+    }
+    
+    void LimitNode::close() {
+        child_->close();
+    }
+    
+    std::vector<std::string> LimitNode::get_column_names() const {
+        return child_->get_column_names();
+    }
+    
+    double LimitNode::get_cost() const {
+        return child_->get_cost();
+    }
+    
+    double LimitNode::estimate_rows() const {
+        double rows = std::max(0.0, child_->estimate_rows() - static_cast<double>(offset_));
+        return std::min(rows, static_cast<double>(limit_));
+    }
+    
+    std::string LimitNode::describe() const {
+        std::string text = "Limit " + std::to_string(limit_);
+        return offset_ > 0 ? text + " offset " + std::to_string(offset_) : text;
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> LimitNode::children() {
+        return {&child_};
+    }
+    
+    bool HashJoinNode::open() {
+        if (!left_->open()) {
+            error_ = left_->get_error();
+            return false;
+        }
+        if (!right_->open()) {
+            error_ = right_->get_error();
+            left_->close();
+            return false;
+        }
+        left_width_ = left_->get_column_names().size();
+        
+        // Materialize the build side; the other side then streams past it
+        PlanNode* build = build_left_ ? left_.get() : right_.get();
+        size_t build_key = build_left_ ? left_key_ : right_key_;
+        build_rows_.clear();
+        buckets_.clear();
+        std::string key;
+        storage::Row row;
+        while (build->next(row)) {
+            if (build_key < row.size() && join_key(row.get_value(build_key), key)) {
+                buckets_[key].push_back(build_rows_.size());
+                build_rows_.push_back(std::move(row));
+            }
+        }
+        
+        matches_ = nullptr;
+        match_pos_ = 0;
+        return true;
+    }
+    
+    bool HashJoinNode::next(storage::Row& row) {
+        PlanNode* probe = build_left_ ? right_.get() : left_.get();
+        size_t probe_key = build_left_ ? right_key_ : left_key_;
+        std::string key;
+        
+        while (true) {
+            if (matches_ != nullptr && match_pos_ < matches_->size()) {
+                const storage::Row& match = build_rows_[(*matches_)[match_pos_++]];
+                if (build_left_) {
+                    concat_rows(match, probe_row_, left_width_, row);
+                } else {
+                    concat_rows(probe_row_, match, left_width_, row);
+                }
+                return true;
+            }
+            
+            if (!probe->next(probe_row_)) {
+                return false;
+            }
+            matches_ = nullptr;
+            match_pos_ = 0;
+            if (probe_key < probe_row_.size() && join_key(probe_row_.get_value(probe_key), key)) {
+                matches_ = buckets_.find(key);
+            }
+        }
+    }
+    
+    void HashJoinNode::close() {
+        left_->close();
+        right_->close();
+        build_rows_.clear();
+        buckets_.clear();
+        matches_ = nullptr;
+    }
+    
+    double HashJoinNode::get_cost() const {
+        return left_->get_cost() + right_->get_cost();  // One pass over each side
+    }
+    
+    std::string HashJoinNode::describe() const {
+        return "Hash Join on " + describe_position(left_.get(), left_key_) + " = " +
+               describe_position(right_.get(), right_key_) + (build_left_ ? ", building left" : ", building right");
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> HashJoinNode::children() {
+        return {&left_, &right_};
+    }
+    
+    bool IndexNestedLoopJoinNode::open() {
+        if (!left_->open()) {
+            error_ = left_->get_error();
+            return false;
+        }
+        left_width_ = left_->get_column_names().size();
+        predicate_ = CompiledPredicate::compile(inner_filter_.get(), inner_->get_schema());
+        candidates_.clear();
+        candidate_pos_ = 0;
+        return true;
+    }
+    
+    bool IndexNestedLoopJoinNode::next(storage::Row& row) {
+        std::string key;
+        while (true) {
+            while (candidate_pos_ < candidates_.size()) {
+                const storage::Row& candidate = candidates_[candidate_pos_++];
+                if (predicate_(candidate)) {
+                    concat_rows(left_row_, candidate, left_width_, row);
+                    return true;
+                }
+            }
+            
+            if (!left_->next(left_row_)) {
+                return false;
+            }
+            candidates_.clear();
+            candidate_pos_ = 0;
+            if (left_key_ >= left_row_.size() || !join_key(left_row_.get_value(left_key_), key)) {
+                continue;  // NULL keys never join
+            }
+            if (!inner_->index_lookup(inner_column_, left_row_.get_value(left_key_), candidates_,
+                                      storage::Transaction::current())) {
+                error_ = "Index on '" + inner_column_ + "' no longer exists";
+                return false;
+            }
+        }
+    }
+    
+    void IndexNestedLoopJoinNode::close() {
+        left_->close();
+        candidates_.clear();
+    }
+    
+    double IndexNestedLoopJoinNode::get_cost() const {
+        return left_->get_cost() + left_->estimate_rows() * index_probe_cost(inner_);  // One probe per outer row
+    }
+    
+    std::string IndexNestedLoopJoinNode::describe() const {
+        return "Index Nested Loop Join on " + describe_position(left_.get(), left_key_) + " = " +
+               inner_->get_schema().get_table_name() + "." + inner_column_ + " using its index";
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> IndexNestedLoopJoinNode::children() {
+        return {&left_};
+    }
+    
+    bool NestedLoopJoinNode::open() {
+        if (!left_->open()) {
+            error_ = left_->get_error();
+            return false;
+        }
+        if (!right_->open()) {
+            error_ = right_->get_error();
+            left_->close();
+            return false;
+        }
+        left_width_ = left_->get_column_names().size();
+        predicate_ = CompiledPredicate::compile(condition_.get(), schema_);
+        
+        right_rows_.clear();
+        storage::Row row;
+        while (right_->next(row)) {
+            right_rows_.push_back(std::move(row));
+        }
+        right_pos_ = right_rows_.size();  // Forces a fetch from the left
+        return true;
+    }
+    
+    bool NestedLoopJoinNode::next(storage::Row& row) {
+        while (true) {
+            while (right_pos_ < right_rows_.size()) {
+                concat_rows(left_row_, right_rows_[right_pos_++], left_width_, row);
+                if (predicate_(row)) {
+                    return true;
+                }
+            }
+            
+            if (!left_->next(left_row_)) {
+                return false;
+            }
+            right_pos_ = 0;
+        }
+    }
+    
+    void NestedLoopJoinNode::close() {
+        left_->close();
+        right_->close();
+        right_rows_.clear();
+    }
+    
+    double NestedLoopJoinNode::get_cost() const {
+        return left_->get_cost() * std::max(1.0, right_->get_cost());
+    }
+    
+    std::string NestedLoopJoinNode::describe() const {
+        return condition_ ? "Nested Loop Join on " + describe_expression(condition_.get()) : "Nested Loop Join";
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> NestedLoopJoinNode::children() {
+        return {&left_, &right_};
+    }
+    
+    AggregateNode::AggregateNode(std::unique_ptr<PlanNode> child, const std::vector<std::string>& group_by,
+                                 const std::vector<AggregateSpec>& aggregates)
+        : child_(std::move(child)), group_by_(group_by), aggregates_(aggregates) {
+        column_names_ = group_by_;
+        for (const auto& aggregate : aggregates_) {
+            column_names_.push_back(aggregate.output);
+        }
+    }
+    
+    bool AggregateNode::open_child() {
+        if (!child_->open()) {
+            error_ = child_->get_error();
+            return false;
+        }
+        
+        // Bind by name in the child's output; COUNT(*) reads no column
+        std::vector<std::string> input_columns = child_->get_column_names();
+        auto bind = [&input_columns](const std::string& name) {
+            auto it = std::find(input_columns.begin(), input_columns.end(), name);
+            return it != input_columns.end() ? static_cast<size_t>(it - input_columns.begin()) : SIZE_MAX;
+        };
+        group_columns_.clear();
+        for (const auto& name : group_by_) {
+            group_columns_.push_back(bind(name));
+        }
+        aggregate_columns_.clear();
+        for (const auto& aggregate : aggregates_) {
+            aggregate_columns_.push_back(aggregate.input.empty() ? SIZE_MAX : bind(aggregate.input));
+        }
+        return true;
+    }
+    
+    void AggregateNode::group_values(const storage::Row& row, std::vector<storage::Value>& values) const {
+        values.clear();
+        for (size_t column : group_columns_) {
+            values.push_back(column < row.size() ? row.get_value(column) : storage::Value());
+        }
+    }
+    
+    void AggregateNode::accumulate(std::vector<AggregateState>& states, const storage::Row& row) const {
+        states.resize(aggregates_.size());
+        for (size_t i = 0; i < aggregates_.size(); i++) {
+            AggregateState& state = states[i];
+            const AggregateSpec& aggregate = aggregates_[i];
+            if (aggregate.input.empty()) {
+                state.count++;  // COUNT(*)
+                continue;
+            }
+            
+            size_t column = aggregate_columns_[i];
+            if (column >= row.size() || row.get_value(column).is_null()) {
+                continue;  // Aggregates skip NULLs
+            }
+            const storage::Value& value = row.get_value(column);
+            switch (aggregate.function) {
+                case AggregateFunction::COUNT:
+                    state.count++;
+                    break;
+                case AggregateFunction::SUM:
+                case AggregateFunction::AVG:
+                    // Integers sum exactly until they would overflow
+                    if (value.get_type() == storage::ColumnType::INTEGER) {
+                        int64_t sum;
+                        if (__builtin_add_overflow(state.int_sum, value.get_int(), &sum)) {
+                            state.real_sum += static_cast<double>(value.get_int());
+                            state.real = true;
+                        } else {
+                            state.int_sum = sum;
+                        }
+                        state.count++;
+                    } else if (value.get_type() == storage::ColumnType::REAL) {
+                        state.real_sum += value.get_real();
+                        state.real = true;
+                        state.count++;
+                    }
+                    break;
+                case AggregateFunction::MIN:
+                    if (state.count++ == 0 || value.compare(state.extreme) < 0) {
+                        state.extreme = value;
+                    }
+                    break;
+                case AggregateFunction::MAX:
+                    if (state.count++ == 0 || value.compare(state.extreme) > 0) {
+                        state.extreme = value;
+                    }
+                    break;
+            }
+        }
+    }
+    
+    void AggregateNode::finish(const std::vector<storage::Value>& group, std::vector<AggregateState>& states,
+                               storage::Row& row) const {
+        states.resize(aggregates_.size());
+        std::vector<storage::Value> values = group;
+        for (size_t i = 0; i < aggregates_.size(); i++) {
+            const AggregateState& state = states[i];
+            switch (aggregates_[i].function) {
+                case AggregateFunction::COUNT:
+                    values.emplace_back(state.count);
+                    break;
+                case AggregateFunction::SUM:
+                    if (state.count == 0) {
+                        values.emplace_back();
+                    } else if (state.real) {
+                        values.emplace_back(state.real_sum + static_cast<double>(state.int_sum));
+                    } else {
+                        values.emplace_back(state.int_sum);
+                    }
+                    break;
+                case AggregateFunction::AVG:
+                    if (state.count == 0) {
+                        values.emplace_back();
+                    } else {
+                        double sum = state.real_sum + static_cast<double>(state.int_sum);
+                        values.emplace_back(sum / static_cast<double>(state.count));
+                    }
+                    break;
+                case AggregateFunction::MIN:
+                case AggregateFunction::MAX:
+                    values.push_back(state.count == 0 ? storage::Value() : state.extreme);
+                    break;
+            }
+        }
+        row = storage::Row(values);
+    }
+    
+    void AggregateNode::close() {
+        child_->close();
+    }
+    
+    double AggregateNode::get_cost() const {
+        return child_->get_cost();  // One pass over the input
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> AggregateNode::children() {
+        return {&child_};
+    }
+    
+    bool HashAggregateNode::open() {
+        if (!open_child()) {
+            return false;
+        }
+        
+        groups_.clear();
+        group_keys_.clear();
+        group_states_.clear();
+        position_ = 0;
+        
+        std::string key;
+        std::vector<storage::Value> group;
+        storage::Row row;
+        while (child_->next(row)) {
+            group_values(row, group);
+            group_key(group, key);
+            size_t* index = groups_.find(key);
+            if (index == nullptr) {
+                index = &groups_[key];
+                *index = group_keys_.size();
+                group_keys_.push_back(group);
+                group_states_.emplace_back();
+            }
+            accumulate(group_states_[*index], row);
+        }
+        
+        // Without GROUP BY there is always exactly one row
+        if (group_by_.empty() && group_keys_.empty()) {
+            group_keys_.emplace_back();
+            group_states_.emplace_back();
+        }
+        return true;
+    }
+    
+    bool HashAggregateNode::next(storage::Row& row) {
+        // Groups come out in order of first appearance
+        if (position_ >= group_keys_.size()) {
+            return false;
+        }
+        finish(group_keys_[position_], group_states_[position_], row);
+        position_++;
+        return true;
+    }
+    
+    void HashAggregateNode::close() {
+        AggregateNode::close();
+        groups_.clear();
+        group_keys_.clear();
+        group_states_.clear();
+    }
+    
+    std::string HashAggregateNode::describe() const {
+        return describe_aggregates("Hash Aggregate", group_by_, aggregates_);
+    }
+    
+    bool StreamAggregateNode::open() {
+        if (!open_child()) {
+            return false;
+        }
+        has_pending_ = child_->next(pending_);
+        emitted_ = false;
+        return true;
+    }
+    
+    bool StreamAggregateNode::next(storage::Row& row) {
+        if (!has_pending_) {
+            // Without GROUP BY an empty input still yields one row
+            if (group_by_.empty() && !emitted_) {
+                std::vector<AggregateState> states;
+                finish(std::vector<storage::Value>(), states, row);
+                emitted_ = true;
+                return true;
+            }
+            return false;
+        }
+        
+        // The input is ordered by the group columns, so a group ends at
+        // the first row whose values differ
+        std::vector<storage::Value> group;
+        std::vector<storage::Value> values;
+        std::vector<AggregateState> states;
+        group_values(pending_, group);
+        do {
+            accumulate(states, pending_);
+            has_pending_ = child_->next(pending_);
+            if (has_pending_) {
+                group_values(pending_, values);
+            }
+        } while (has_pending_ && same_group(values, group));
+        
+        finish(group, states, row);
+        emitted_ = true;
+        return true;
+    }
+    
+    std::string StreamAggregateNode::describe() const {
+        return describe_aggregates("Stream Aggregate", group_by_, aggregates_);
+    }
+    
+    bool IndexAggregateNode::open() {
+        values_.clear();
+        done_ = false;
+        const storage::Transaction* reader = storage::Transaction::current();
+        for (const auto& aggregate : aggregates_) {
+            if (aggregate.function == AggregateFunction::COUNT && aggregate.input.empty()) {
+                values_.emplace_back(static_cast<int64_t>(table_->count_rows(reader)));
+                continue;
+            }
+            
+            storage::Value min;
+            storage::Value max;
+            if (!table_->index_bounds(aggregate.input, min, max, reader)) {
+                error_ = "Range index on '" + aggregate.input + "' no longer exists";
+                return false;
+            }
+            values_.push_back(aggregate.function == AggregateFunction::MIN ? min : max);
+        }
+        return true;
+    }
+    
+    bool IndexAggregateNode::next(storage::Row& row) {
+        if (done_) {
+            return false;
+        }
+        row = storage::Row(values_);
+        done_ = true;
+        return true;
+    }
+    
+    std::vector<std::string> IndexAggregateNode::get_column_names() const {
+        std::vector<std::string> column_names;
+        for (const auto& aggregate : aggregates_) {
+            column_names.push_back(aggregate.output);
+        }
+        return column_names;
+    }
+    
+    double IndexAggregateNode::get_cost() const {
+        return 1.0 + static_cast<double>(aggregates_.size()) * index_probe_cost(table_);
+    }
+    
+    std::string IndexAggregateNode::describe() const {
+        return describe_aggregates("Index Aggregate", {}, aggregates_) + " from " + table_->get_schema().get_table_name();
+    }
+    
+    QueryResult InsertNode::execute() {
+        if (rows_.size() == 1) {
+            if (table_->insert_row(rows_.front(), storage::Transaction::current()) == 0) {
+                return QueryResult("Failed to insert row");
+            }
+            return QueryResult(1);  // 1 row affected
+        }
+        
+        // Multi-row VALUES goes through the batch path, which loads the
+        // table's indexes once at the end instead of per row
+        size_t inserted = table_->insert_rows(rows_, storage::Transaction::current());
+        if (inserted < rows_.size()) {
+            return QueryResult("Failed to insert row " + std::to_string(inserted + 1) + " (" +
+                               std::to_string(inserted) + " rows inserted)");
+        }
+        return QueryResult(inserted);
+    }
+    
+    double InsertNode::get_cost() const {
+        return static_cast<double>(rows_.size());
+    }
+    
+    std::string InsertNode::describe() const {
+        return "Insert into " + table_->get_schema().get_table_name() + ", " + std::to_string(rows_.size()) + " rows";
+    }
+    
+    QueryResult CopyNode::execute() {
+        utils::CsvReader reader;
+        if (!reader.open(path_)) {
+            return QueryResult(reader.error());
+        }
+        
+        const auto& schema = table_->get_schema();
+        size_t width = schema.column_count();
+        
+        // Records become rows directly from the schema's column types and are
+        // inserted in batches; nothing goes through the SQL parser
+        std::vector<utils::CsvField> fields;
+        std::vector<storage::Row> batch;
+        batch.reserve(COPY_BATCH_ROWS);
+        size_t loaded = 0;
+        
+        auto flush = [&]() {
+            size_t inserted = table_->insert_rows(batch, storage::Transaction::current());
+            loaded += inserted;
+            bool complete = inserted == batch.size();
+            batch.clear();
+            return complete;
+        };
+        auto failure = [&](const std::string& message) {
+            return QueryResult("COPY line " + std::to_string(reader.line()) + ": " + message + " (" +
+                               std::to_string(loaded) + " rows loaded)");
+        };
+        
+        bool skip_header = header_;
+        while (reader.next(fields)) {
+            if (skip_header) {
+                skip_header = false;
+                continue;
+            }
+            if (fields.size() != width) {
+                flush();
+                return failure("expected " + std::to_string(width) + " fields, got " + std::to_string(fields.size()));
+            }
+            
+            storage::Row row;
+            for (size_t i = 0; i < width; i++) {
+                storage::Value value;
+                if (!parse_csv_field(fields[i], schema.get_column(i).type, value)) {
+                    flush();
+                    return failure("invalid value for column " + schema.get_column(i).name);
+                }
+                row.add_value(std::move(value));
+            }
+            batch.push_back(std::move(row));
+            
+            if (batch.size() == COPY_BATCH_ROWS && !flush()) {
+                return failure("failed to insert row");
+            }
+        }
+        
+        if (!reader.error().empty()) {
+            flush();
+            return failure(reader.error());
+        }
+        if (!flush()) {
+            return failure("failed to insert row");
+        }
+        return QueryResult(loaded);
+    }
+    
+    double CopyNode::get_cost() const {
+        return 1.0;  // The file size is unknown until it is read
+    }
+    
+    std::string CopyNode::describe() const {
+        return "Copy into " + table_->get_schema().get_table_name() + " from '" + path_ + "'";
+    }
+    
+    QueryResult UpdateNode::execute() {
+        // Every target is found before the first one changes, so an index
+        // scan over an updated column never meets a row it already moved
+        if (!source_->open()) {
+            source_->close();
+            return QueryResult(source_->get_error());
+        }
+        
+        const auto& schema = table_->get_schema();
+        std::vector<storage::Row> rows;
+        storage::Row row;
+        while (source_->next(row)) {
+            storage::Row updated = row;
+            for (size_t i = 0; i < columns_.size(); i++) {
+                updated.set_value(columns_[i], values_[i]->evaluate(row, schema));
+            }
+            rows.push_back(std::move(updated));
+        }
+        source_->close();
+        
+        // Then they are written in one pass under one latch acquisition
+        size_t updated = table_->update_rows(rows, storage::Transaction::current());
+        if (updated < rows.size()) {
+            return QueryResult("Failed to update row " + std::to_string(rows[updated].get_id()) + " (" +
+                               std::to_string(updated) + " rows updated)");
+        }
+        return QueryResult(updated);
+    }
+    
+    double UpdateNode::get_cost() const {
+        return source_->get_cost();
+    }
+    
+    std::string UpdateNode::describe() const {
+        std::vector<std::string> columns;
+        for (size_t column : columns_) {
+            columns.push_back(table_->get_schema().get_column(column).name);
+        }
+        return "Update " + table_->get_schema().get_table_name() + " set " + describe_names(columns);
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> UpdateNode::children() {
+        return {&source_};
+    }
+    
+    QueryResult DeleteNode::execute() {
+        if (!source_->open()) {
+            source_->close();
+            return QueryResult(source_->get_error());
+        }
+        
+        std::vector<uint64_t> row_ids;
+        storage::Row row;
+        while (source_->next(row)) {
+            row_ids.push_back(row.get_id());
+        }
+        source_->close();
+        
+        size_t deleted = table_->delete_rows(row_ids, storage::Transaction::current());
+        if (deleted < row_ids.size()) {
+            return QueryResult("Failed to delete row " + std::to_string(row_ids[deleted]) + " (" +
+                               std::to_string(deleted) + " rows deleted)");
+        }
+        return QueryResult(deleted);
+    }
+    
+    double DeleteNode::get_cost() const {
+        return source_->get_cost();
+    }
+    
+    std::string DeleteNode::describe() const {
+        return "Delete from " + table_->get_schema().get_table_name();
+    }
+    
+    std::vector<std::unique_ptr<PlanNode>*> DeleteNode::children() {
+        return {&source_};
+    }
+    
+    // Query planner implementation
+    std::unique_ptr<PlanNode> QueryPlanner::create_plan(const Statement* stmt) {
+        switch (stmt->get_type()) {
+            case StatementType::SELECT:
+                return plan_select(static_cast<const SelectStatement*>(stmt));
+            case StatementType::INSERT:
+                return plan_insert(static_cast<const InsertStatement*>(stmt));
+            case StatementType::COPY:
+                return plan_copy(static_cast<const CopyStatement*>(stmt));
+            case StatementType::UPDATE:
+                return plan_update(static_cast<const UpdateStatement*>(stmt));
+            case StatementType::DELETE:
+                return plan_delete(static_cast<const DeleteStatement*>(stmt));
+            default:
+                return nullptr;
+        }
+    }
+    
+    std::unique_ptr<PlanNode> QueryPlanner::plan_select(const SelectStatement* stmt) {
+        auto plan = plan_select_rows(stmt);
+        
+        // LIMIT and OFFSET apply last, to rows already filtered, sorted and
+        // projected; a sort below was already told how many rows to keep
+        if (plan && (stmt->get_limit() != SIZE_MAX || stmt->get_offset() > 0)) {
+            plan = std::make_unique<LimitNode>(std::move(plan), stmt->get_offset(), stmt->get_limit());
+        }
+        return plan;
+    }
+    
+    std::unique_ptr<PlanNode> QueryPlanner::plan_select_rows(const SelectStatement* stmt) {
+        if (!stmt->get_joins().empty()) {
+            return plan_join_select(stmt);
+        }
+        
+        auto table_it = tables_->find(stmt->get_table_name());
+        if (table_it == tables_->end()) {
+            return nullptr;  // Table not found
+        }
+        
+        storage::Table* table = table_it->second;
+        if (stmt->is_aggregate()) {
+            return plan_aggregate_select(stmt, table);
+        }
+        if (!stmt->get_order_by().empty()) {
+            return plan_ordered_select(stmt, table);
+        }
+        const Expression* where = stmt->get_where_clause();
+        
+        // Prefer an index when the WHERE clause can use one and it is cheaper
+        auto access = plan_table_access(table, where);
+        auto* table_scan = dynamic_cast<TableScanNode*>(access.get());
+        if (table_scan == nullptr) {
+            if (!stmt->is_select_all()) {
+                return std::make_unique<ProjectionNode>(std::move(access), stmt->get_columns());
+            }
+            return access;
+        }
+        
+        // Scans project in place, which lets parallel workers do it too. They
+        // only read the projected and filtered columns; columnar tables then
+        // skip the others entirely.
+        if (!stmt->is_select_all()) {
+            std::vector<size_t> projection;
+            const auto& schema = table->get_schema();
+            for (const auto& column_name : stmt->get_columns()) {
+                size_t index = schema.get_column_index(column_name);
+                if (index != SIZE_MAX) {
+                    projection.push_back(index);
+                }
+            }
+            
+            std::vector<size_t> columns;
+            for (size_t index : projection) {
+                if (std::find(columns.begin(), columns.end(), index) == columns.end()) {
+                    columns.push_back(index);
+                }
+            }
+            collect_columns(where, schema, columns);
+            table_scan->set_columns(std::move(columns));
+            table_scan->set_projection(std::move(projection));
+        }
+        
+        return access;
+    }
+    
+    std::unique_ptr<PlanNode> QueryPlanner::plan_ordered_select(const SelectStatement* stmt, storage::Table* table) {
+        const Expression* where = stmt->get_where_clause();
+        
+        // Rows are sorted whole, so projection waits until after the sort;
+        // a scan still reads only the columns something uses
+        auto ordered = plan_index_order(stmt, table);
+        auto plan = plan_table_access(table, where);
+        if (auto* table_scan = dynamic_cast<TableScanNode*>(plan.get()); table_scan && !stmt->is_select_all()) {
+            const auto& schema = table->get_schema();
+            std::vector<size_t> columns;
+            for (const auto& column_name : stmt->get_columns()) {
+                size_t index = schema.get_column_index(column_name);
+                if (index != SIZE_MAX && std::find(columns.begin(), columns.end(), index) == columns.end()) {
+                    columns.push_back(index);
+                }
+            }
+            for (const auto& key : stmt->get_order_by()) {
+                size_t index = schema.get_column_index(key.column);
+                if (index != SIZE_MAX && std::find(columns.begin(), columns.end(), index) == columns.end()) {
+                    columns.push_back(index);
+                }
+            }
+            collect_columns(where, schema, columns);
+            table_scan->set_columns(std::move(columns));
+        }
+        plan = plan_sort(std::move(plan), stmt->get_order_by(), rows_needed(stmt));
+        
+        // Walking an index fetches rows out of heap order, so it only
+        // replaces the sort when that is cheaper
+        if (ordered && ordered->get_cost() <= plan->get_cost()) {
+            plan = std::move(ordered);
+        }
+        
+        if (!stmt->is_select_all()) {
+            plan = std::make_unique<ProjectionNode>(std::move(plan), stmt->get_columns());
+        }
+        return plan;
+    }
+    
+    std::unique_ptr<PlanNode> QueryPlanner::plan_index_order(const SelectStatement* stmt, storage::Table* table) {
+        // A single ORDER BY column with an ordered index needs no sort: the
+        // index is walked in the requested direction instead
+        const auto& order_by = stmt->get_order_by();
+        if (order_by.size() != 1) {
+            return nullptr;
+        }
+        const std::string& column_name = order_by[0].column;
+        storage::Index* index = table->get_index(column_name);
+        if (index == nullptr || !index->supports_range()) {
+            return nullptr;
         }
         
-        // Create column names for all columns
-        std::vector<std::string> column_names;
-        const auto& schema = table_->get_schema();
-        for (size_t i = 0; i < schema.column_count(); i++) {
-            column_names.push_back(schema.get_column(i).name);
+        // A WHERE on the same column bounds the walk. Any other WHERE is
+        // checked along the way, which only pays when no index serves it.
+        const Expression* where = stmt->get_where_clause();
+        std::unique_ptr<storage::Value> lower;
+        std::unique_ptr<storage::Value> upper;
+        if (!index_bounds(where, column_name, lower, upper) && where != nullptr && plan_index_access(table, where)) {
+            return nullptr;
         }
         
-        return QueryResult(result_rows, column_names);
+        auto scan = std::make_unique<IndexRangeScanNode>(table, column_name, std::move(lower), std::move(upper),
+                                                         where ? where->clone() : nullptr);
+        scan->set_order(order_by[0].descending, rows_needed(stmt));
+        return scan;
     }
     
-    double TableScanNode::get_cost() const {
-        return static_cast<double>(table_->row_count());  // Linear scan cost
+    std::unique_ptr<PlanNode> QueryPlanner::plan_sort(std::unique_ptr<PlanNode> plan,
+                                                      const std::vector<OrderItem>& order_by, size_t limit) {
+        if (order_by.empty()) {
+            return plan;
+        }
+        return std::make_unique<SortNode>(std::move(plan), order_by, limit,
+                                          sort_memory_ > 0 ? sort_memory_ : DEFAULT_SORT_MEMORY, page_manager_);
     }
     
-    QueryResult ProjectionNode::execute() {
-        QueryResult child_result = child_->execute();
+    std::unique_ptr<PlanNode> QueryPlanner::plan_table_access(storage::Table* table, const Expression* where) {
+        auto table_scan = std::make_unique<TableScanNode>(table, where ? where->clone() : nullptr);
+        table_scan->set_parallelism(parallelism_ > 0 ? parallelism_ : utils::ThreadPool::shared().size() + 1);
         
-        if (!child_result.is_success()) {
-            return child_result;
+        auto index_node = plan_index_access(table, where);
+        if (index_node && index_node->get_cost() < table_scan->get_cost()) {
+            return index_node;
+        }
+        return table_scan;
+    }
+    
+    std::unique_ptr<PlanNode> QueryPlanner::plan_join_select(const SelectStatement* stmt) {
+        // Every input is known by its alias, or by its table name without one
+        std::vector<JoinInput> inputs;
+        auto add_input = [&](const std::string& table_name, const std::string& alias) {
+            auto table_it = tables_->find(table_name);
+            if (table_it == tables_->end()) {
+                return false;  // Table not found
+            }
+            std::string qualifier = alias.empty() ? table_name : alias;
+            for (const auto& input : inputs) {
+                if (input.qualifier == qualifier) {
+                    return false;  // Two inputs with the same name
+                }
+            }
+            inputs.push_back({table_it->second, qualifier});
+            return true;
+        };
+        if (!add_input(stmt->get_table_name(), stmt->get_table_alias())) {
+            return nullptr;
+        }
+        for (const auto& join : stmt->get_joins()) {
+            if (!add_input(join.table_name, join.alias)) {
+                return nullptr;
+            }
         }
         
-        const auto& input_rows = child_result.get_rows();
-        const auto& input_columns = child_result.get_column_names();
-        std::vector<storage::Row> result_rows;
-        
-        // Determine column indices to project
-        std::vector<size_t> column_indices;
-        std::vector<std::string> result_columns;
+        // A WHERE on a single input is pushed below the joins
+        std::unique_ptr<Expression> where;
+        size_t where_input = SIZE_MAX;
+        if (stmt->get_where_clause()) {
+            where = qualify_expression(stmt->get_where_clause(), inputs);
+            if (!where) {
+                return nullptr;  // Unknown or ambiguous column
+            }
+            where_input = single_input(where.get(), inputs);
+        }
+        std::vector<std::unique_ptr<PlanNode>> input_plans;
+        std::vector<double> input_rows;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            std::unique_ptr<Expression> filter;
+            if (where_input == i) {
+                filter = unqualify_expression(where.get());
+            }
+            input_plans.push_back(plan_table_access(inputs[i].table, filter.get()));
+            input_rows.push_back(input_plans.back()->estimate_rows());
+        }
         
-        if (columns_.empty()) {
-            // Project all columns
-            for (size_t i = 0; i < input_columns.size(); i++) {
-                column_indices.push_back(i);
-                result_columns.push_back(input_columns[i]);
+        std::vector<std::unique_ptr<Expression>> conditions;
+        for (const auto& join : stmt->get_joins()) {
+            conditions.push_back(qualify_expression(join.condition.get(), inputs));
+            if (!conditions.back()) {
+                return nullptr;
             }
-        } else {
-            // Project specified columns
-            const auto& schema = table_->get_schema();
-            for (const auto& col_name : columns_) {
-                size_t index = schema.get_column_index(col_name);
-                if (index != SIZE_MAX) {
-                    column_indices.push_back(index);
-                    result_columns.push_back(col_name);
+        }
+        
+        // Inputs join left-deep in the order written, unless statistics
+        // find a cheaper order; order[k] joins on condition step_conditions[k - 1]
+        std::vector<size_t> order;
+        std::vector<size_t> step_conditions;
+        bool reordered = choose_join_order(inputs, conditions, input_rows, order, step_conditions);
+        if (!reordered) {
+            order.clear();
+            step_conditions.clear();
+            for (size_t i = 0; i < inputs.size(); i++) {
+                order.push_back(i);
+                if (i > 0) {
+                    step_conditions.push_back(i - 1);
                 }
             }
         }
         
-        // Project rows
-        for (const auto& input_row : input_rows) {
-            storage::Row result_row;
-            result_row.set_id(input_row.get_id());
+        // Joined rows use qualified names, so the rest of the plan can bind
+        // columns of the same name in different tables. Their layout
+        // follows the join order.
+        storage::TableSchema joined_schema;
+        std::vector<std::string> joined_columns;
+        for (size_t i : order) {
+            for (const auto& column : inputs[i].table->get_schema().get_columns()) {
+                joined_columns.push_back(inputs[i].qualifier + "." + column.name);
+                joined_schema.add_column(storage::Column(joined_columns.back(), column.type));
+            }
+        }
+        
+        std::unique_ptr<PlanNode> plan = std::move(input_plans[order[0]]);
+        double plan_rows = input_rows[order[0]];
+        size_t left_width = inputs[order[0]].table->get_schema().column_count();
+        for (size_t k = 1; k < order.size(); k++) {
+            size_t i = order[k];
+            storage::Table* inner = inputs[i].table;
+            size_t inner_width = inner->get_schema().column_count();
+            std::vector<std::string> columns(joined_columns.begin(),
+                                             joined_columns.begin() + left_width + inner_width);
+            std::unique_ptr<Expression> condition = std::move(conditions[step_conditions[k - 1]]);
             
-            for (size_t col_idx : column_indices) {
-                if (col_idx < input_row.size()) {
-                    result_row.add_value(input_row.get_value(col_idx));
-                } else {
-                    result_row.add_value(storage::Value());  // NULL
+            // "left column = inner column" joins by key; anything else
+            // compares every pair
+            size_t left_key = SIZE_MAX;
+            size_t inner_key = SIZE_MAX;
+            double key_distinct_values = 0.0;
+            const auto* equality = dynamic_cast<const BinaryExpression*>(condition.get());
+            if (equality && equality->get_operator() == Operator::EQUAL) {
+                const auto* a = dynamic_cast<const ColumnExpression*>(equality->get_left());
+                const auto* b = dynamic_cast<const ColumnExpression*>(equality->get_right());
+                if (a && b) {
+                    size_t a_index = joined_schema.get_column_index(a->get_column_name());
+                    size_t b_index = joined_schema.get_column_index(b->get_column_name());
+                    if (a_index >= left_width) {
+                        std::swap(a_index, b_index);
+                    }
+                    if (a_index < left_width && b_index >= left_width && b_index < left_width + inner_width) {
+                        left_key = a_index;
+                        inner_key = b_index - left_width;
+                        key_distinct_values = join_key_distinct(a, b, inputs, input_rows);
+                    }
                 }
             }
             
-            result_rows.push_back(result_row);
+            std::unique_ptr<PlanNode> right = std::move(input_plans[i]);
+            double right_rows = input_rows[i];
+            if (left_key == SIZE_MAX) {
+                storage::TableSchema schema;
+                for (const auto& name : columns) {
+                    schema.add_column(*joined_schema.get_column(name));
+                }
+                plan = std::make_unique<NestedLoopJoinNode>(std::move(plan), std::move(right),
+                                                            std::move(condition), schema, columns);
+                plan_rows *= right_rows;
+                plan->set_estimated_rows(plan_rows);
+            } else {
+                // Probing the inner table's index beats hashing it when the
+                // outer side is small
+                const std::string& inner_column = inner->get_schema().get_column(inner_key).name;
+                double left_cost = plan->get_cost();
+                double right_cost = right->get_cost();
+                double probe_cost = left_cost + plan->estimate_rows() * index_probe_cost(inner);
+                if (inner->get_index(inner_column) != nullptr && probe_cost < left_cost + right_cost) {
+                    std::unique_ptr<Expression> inner_filter;
+                    if (where_input == i) {
+                        inner_filter = unqualify_expression(where.get());
+                    }
+                    plan = std::make_unique<IndexNestedLoopJoinNode>(std::move(plan), inner, inner_column, left_key,
+                                                                     std::move(inner_filter), columns);
+                } else {
+                    // The smaller side is built; an estimate of the rows
+                    // beats the cost of reading them
+                    bool build_left = plan_rows < right_rows || (plan_rows == right_rows && left_cost < right_cost);
+                    plan = std::make_unique<HashJoinNode>(std::move(plan), std::move(right), left_key, inner_key,
+                                                          build_left, columns);
+                }
+                plan_rows = equi_join_rows(plan_rows, right_rows, key_distinct_values);
+                plan->set_estimated_rows(plan_rows);
+            }
+            left_width += inner_width;
         }
         
-        return QueryResult(result_rows, result_columns);
-    }
-    
-    double ProjectionNode::get_cost() const {
-        return child_->get_cost();  // Same as child cost
-    }
-    
-    QueryResult InsertNode::execute() {
-        uint64_t row_id = table_->insert_row(row_);
-        if (row_id == 0) {
-            return QueryResult("Failed to insert row");
+        if (where && where_input == SIZE_MAX) {
+            plan = std::make_unique<FilterNode>(std::move(plan), std::move(where), joined_schema);
         }
         
-        return QueryResult(1);  // 1 row affected
+        // Aggregates keep the names they were written with
+        std::vector<std::string> group_by;
+        if (stmt->is_aggregate()) {
+            if (stmt->is_select_all()) {
+                return nullptr;
+            }
+            for (const auto& column_name : stmt->get_group_by()) {
+                group_by.push_back(qualify_column(column_name, inputs));
+                if (group_by.back().empty()) {
+                    return nullptr;
+                }
+            }
+            std::vector<AggregateSpec> aggregates;
+            for (const auto& call : stmt->get_aggregates()) {
+                std::string input = call.column.empty() ? call.column : qualify_column(call.column, inputs);
+                if (!call.column.empty() && input.empty()) {
+                    return nullptr;
+                }
+                aggregates.push_back({call.function, input, call.name});
+            }
+            plan = std::make_unique<HashAggregateNode>(std::move(plan), group_by, aggregates);
+        }
+        
+        std::vector<OrderItem> order_by;
+        for (const auto& key : stmt->get_order_by()) {
+            order_by.push_back(key);
+            if (!is_aggregate_name(stmt, key.column)) {
+                order_by.back().column = qualify_column(key.column, inputs);
+                if (order_by.back().column.empty()) {
+                    return nullptr;
+                }
+            }
+        }
+        plan = plan_sort(std::move(plan), order_by, rows_needed(stmt));
+        
+        if (!stmt->is_select_all()) {
+            std::vector<std::string> columns;
+            for (const auto& column_name : stmt->get_columns()) {
+                if (is_aggregate_name(stmt, column_name)) {
+                    columns.push_back(column_name);
+                    continue;
+                }
+                std::string qualified = qualify_column(column_name, inputs);
+                if (qualified.empty()) {
+                    return nullptr;
+                }
+                if (stmt->is_aggregate() && std::find(group_by.begin(), group_by.end(), qualified) == group_by.end()) {
+                    return nullptr;  // Neither grouped on nor aggregated
+                }
+                columns.push_back(qualified);
+            }
+            plan = std::make_unique<ProjectionNode>(std::move(plan), columns);
+        } else if (!std::is_sorted(order.begin(), order.end())) {
+            // SELECT * keeps the columns in the order the tables were written
+            std::vector<std::string> columns;
+            for (const auto& input : inputs) {
+                for (const auto& column : input.table->get_schema().get_columns()) {
+                    columns.push_back(input.qualifier + "." + column.name);
+                }
+            }
+            plan = std::make_unique<ProjectionNode>(std::move(plan), columns);
+        }
+        return plan;
     }
     
-    double InsertNode::get_cost() const {
-        return 1.0;  // Constant cost
+    std::unique_ptr<PlanNode> QueryPlanner::plan_aggregate_select(const SelectStatement* stmt, storage::Table* table) {
+        const auto& schema = table->get_schema();
+        const Expression* where = stmt->get_where_clause();
+        const auto& group_by = stmt->get_group_by();
+        if (stmt->is_select_all()) {
+            return nullptr;
+        }
+        
+        for (const auto& column_name : group_by) {
+            if (schema.get_column_index(column_name) == SIZE_MAX) {
+                return nullptr;
+            }
+        }
+        for (const auto& column_name : stmt->get_columns()) {
+            if (!is_aggregate_name(stmt, column_name) &&
+                std::find(group_by.begin(), group_by.end(), column_name) == group_by.end()) {
+                return nullptr;  // Neither grouped on nor aggregated
+            }
+        }
+        
+        // COUNT(*) and MIN/MAX over an ordered index need no rows at all
+        std::vector<AggregateSpec> aggregates;
+        bool from_index = where == nullptr && group_by.empty();
+        for (const auto& call : stmt->get_aggregates()) {
+            if (!call.column.empty() && schema.get_column_index(call.column) == SIZE_MAX) {
+                return nullptr;
+            }
+            aggregates.push_back({call.function, call.column, call.name});
+            
+            storage::Index* index = call.column.empty() ? nullptr : table->get_index(call.column);
+            bool count_all = call.function == AggregateFunction::COUNT && call.column.empty();
+            bool bound = (call.function == AggregateFunction::MIN || call.function == AggregateFunction::MAX) &&
+                         index != nullptr && index->supports_range();
+            from_index = from_index && (count_all || bound);
+        }
+        
+        std::unique_ptr<PlanNode> plan;
+        if (from_index) {
+            plan = std::make_unique<IndexAggregateNode>(table, aggregates);
+        } else {
+            auto input = plan_table_access(table, where);
+            if (auto* table_scan = dynamic_cast<TableScanNode*>(input.get())) {
+                // Only grouped, aggregated and filtered columns are read
+                std::vector<size_t> columns;
+                for (const auto& column_name : group_by) {
+                    size_t index = schema.get_column_index(column_name);
+                    if (std::find(columns.begin(), columns.end(), index) == columns.end()) {
+                        columns.push_back(index);
+                    }
+                }
+                for (const auto& aggregate : aggregates) {
+                    size_t index = schema.get_column_index(aggregate.input);
+                    if (index != SIZE_MAX && std::find(columns.begin(), columns.end(), index) == columns.end()) {
+                        columns.push_back(index);
+                    }
+                }
+                collect_columns(where, schema, columns);
+                table_scan->set_columns(std::move(columns));
+            }
+            plan = std::make_unique<HashAggregateNode>(std::move(input), group_by, aggregates);
+        }
+        
+        // An ordered index hands over each group's rows together, so groups
+        // are finished one at a time instead of hashed. It wins ties, but
+        // walking the whole index fetches rows out of heap order, which
+        // costs more than scanning unless a WHERE on the column bounds it.
+        storage::Index* group_index = group_by.size() == 1 ? table->get_index(group_by[0]) : nullptr;
+        if (!from_index && group_index != nullptr && group_index->supports_range()) {
+            std::unique_ptr<storage::Value> lower;
+            std::unique_ptr<storage::Value> upper;
+            index_bounds(where, group_by[0], lower, upper);
+            auto ordered = std::make_unique<IndexRangeScanNode>(table, group_by[0], std::move(lower),
+                                                                std::move(upper), where ? where->clone() : nullptr);
+            auto streamed = std::make_unique<StreamAggregateNode>(std::move(ordered), group_by, aggregates);
+            if (streamed->get_cost() <= plan->get_cost()) {
+                plan = std::move(streamed);
+            }
+        }
+        
+        // Groups and aggregates are sorted by their output names
+        plan = plan_sort(std::move(plan), stmt->get_order_by(), rows_needed(stmt));
+        return std::make_unique<ProjectionNode>(std::move(plan), stmt->get_columns());
     }
     
-    // Query planner implementation
-    std::unique_ptr<PlanNode> QueryPlanner::create_plan(const Statement* stmt) {
-        switch (stmt->get_type()) {
-            case StatementType::SELECT:
-                return plan_select(static_cast<const SelectStatement*>(stmt));
-            case StatementType::INSERT:
-                return plan_insert(static_cast<const InsertStatement*>(stmt));
-            case StatementType::UPDATE:
-                return plan_update(static_cast<const UpdateStatement*>(stmt));
-            case StatementType::DELETE:
-                return plan_delete(static_cast<const DeleteStatement*>(stmt));
+    std::unique_ptr<PlanNode> QueryPlanner::plan_index_access(storage::Table* table, const Expression* where) {
+        // Only "column op literal" (either way round) can use an index
+        ColumnComparison match;
+        if (!match_column_comparison(where, match)) {
+            return nullptr;
+        }
+        
+        Operator op = match.op;
+        const std::string& column_name = match.column->get_column_name();
+        storage::Index* index = table->get_index(column_name);
+        if (!index) {
+            return nullptr;
+        }
+        
+        const storage::Value& key = match.literal->get_value();
+        switch (op) {
+            case Operator::EQUAL:
+                return std::make_unique<IndexLookupNode>(table, column_name, key, where->clone());
+            case Operator::LESS_THAN:
+            case Operator::LESS_EQUAL:
+                if (!index->supports_range()) return nullptr;
+                return std::make_unique<IndexRangeScanNode>(
+                    table, column_name, nullptr, std::make_unique<storage::Value>(key), where->clone());
+            case Operator::GREATER_THAN:
+            case Operator::GREATER_EQUAL:
+                if (!index->supports_range()) return nullptr;
+                return std::make_unique<IndexRangeScanNode>(
+                    table, column_name, std::make_unique<storage::Value>(key), nullptr, where->clone());
             default:
                 return nullptr;
         }
     }
     
-    std::unique_ptr<PlanNode> QueryPlanner::plan_select(const SelectStatement* stmt) {
+    std::unique_ptr<PlanNode> QueryPlanner::plan_insert(const InsertStatement* stmt) {
         auto table_it = tables_->find(stmt->get_table_name());
         if (table_it == tables_->end()) {
             return nullptr;  // Table not found
@@ -138,57 +2787,93 @@ namespace query {
         
         storage::Table* table = table_it->second;
         
-        // Create table scan node
-        std::unique_ptr<Expression> filter;
-        if (stmt->get_where_clause()) {
-            filter = stmt->get_where_clause()->clone();
+        // Create one row per VALUES tuple
+        std::vector<storage::Row> rows;
+        rows.reserve(stmt->get_rows().size());
+        for (const auto& values : stmt->get_rows()) {
+            storage::Row row;
+            for (const auto& value : values) {
+                row.add_value(value);
+            }
+            rows.push_back(std::move(row));
         }
         
-        auto scan_node = std::make_unique<TableScanNode>(table, std::move(filter));
-        
-        // Add projection if specific columns requested
-        if (!stmt->is_select_all()) {
-            return std::make_unique<ProjectionNode>(
-                std::move(scan_node), stmt->get_columns(), table);
+        return std::make_unique<InsertNode>(table, std::move(rows));
+    }
+    
+    std::unique_ptr<PlanNode> QueryPlanner::plan_copy(const CopyStatement* stmt) {
+        auto table_it = tables_->find(stmt->get_table_name());
+        if (table_it == tables_->end()) {
+            return nullptr;  // Table not found
         }
         
-        return scan_node;
+        return std::make_unique<CopyNode>(table_it->second, stmt->get_file_path(), stmt->has_header());
     }
     
-    std::unique_ptr<PlanNode> QueryPlanner::plan_insert(const InsertStatement* stmt) {
+    std::unique_ptr<PlanNode> QueryPlanner::plan_update(const UpdateStatement* stmt) {
         auto table_it = tables_->find(stmt->get_table_name());
         if (table_it == tables_->end()) {
             return nullptr;  // Table not found
         }
         
         storage::Table* table = table_it->second;
-        const auto& values = stmt->get_values();
-        
-        // Create row from values
-        storage::Row row;
-        for (const auto& value : values) {
-            row.add_value(value);
+        const auto& schema = table->get_schema();
+        std::vector<size_t> columns;
+        std::vector<std::unique_ptr<Expression>> values;
+        for (const auto& assignment : stmt->get_assignments()) {
+            size_t column = schema.get_column_index(assignment.column);
+            if (column == SIZE_MAX) {
+                return nullptr;  // Column not found
+            }
+            columns.push_back(column);
+            values.push_back(assignment.value->clone());
         }
         
-        return std::make_unique<InsertNode>(table, row);
-    }
-    
-    std::unique_ptr<PlanNode> QueryPlanner::plan_update(const UpdateStatement* stmt) {
-        // Not implemented for simplicity
-        return nullptr;
+        // Targets are located the way a SELECT with the same WHERE would
+        return std::make_unique<UpdateNode>(table, plan_table_access(table, stmt->get_where_clause()),
+                                            std::move(columns), std::move(values));
     }
     
     std::unique_ptr<PlanNode> QueryPlanner::plan_delete(const DeleteStatement* stmt) {
-        // Not implemented for simplicity
-        return nullptr;
+        auto table_it = tables_->find(stmt->get_table_name());
+        if (table_it == tables_->end()) {
+            return nullptr;  // Table not found
+        }
+        
+        storage::Table* table = table_it->second;
+        const Expression* where = stmt->get_where_clause();
+        auto access = plan_table_access(table, where);
+        
+        // Only row ids are needed, so a scan reads just the filtered columns
+        if (auto* table_scan = dynamic_cast<TableScanNode*>(access.get())) {
+            std::vector<size_t> columns;
+            collect_columns(where, table->get_schema(), columns);
+            if (!columns.empty()) {
+                table_scan->set_columns(std::move(columns));
+            }
+        }
+        return std::make_unique<DeleteNode>(table, std::move(access));
     }
     
     // Query executor implementation
-    QueryResult QueryExecutor::execute(const Statement* stmt) {
+    QueryResult QueryExecutor::execute(const Statement* stmt, ResultSink* sink, Session* session) {
+        QueryResult result = run_in_transaction(stmt, session, [&]() { return execute_statement(stmt, sink); });
+        
+        // Transactions make their changes durable when they commit; what
+        // was appended directly is waited for here
+        if (wal_ != nullptr && logs_directly(stmt, *this, transactions_ != nullptr) && !wal_->commit()) {
+            return QueryResult("Failed to write the log");
+        }
+        
+        return result;
+    }
+    
+    QueryResult QueryExecutor::execute_statement(const Statement* stmt, ResultSink* sink) {
         switch (stmt->get_type()) {
             case StatementType::CREATE_TABLE: {
                 const auto* create_stmt = static_cast<const CreateTableStatement*>(stmt);
                 storage::TableSchema schema(create_stmt->get_table_name());
+                schema.set_storage_format(create_stmt->get_storage_format());
                 
                 for (const auto& column : create_stmt->get_columns()) {
                     schema.add_column(column);
@@ -210,54 +2895,297 @@ namespace query {
                 }
             }
             
+            case StatementType::ANALYZE: {
+                const auto* analyze_stmt = static_cast<const AnalyzeStatement*>(stmt);
+                if (analyze(analyze_stmt->get_table_name())) {
+                    return QueryResult(0);
+                } else {
+                    return QueryResult("Table not found: " + analyze_stmt->get_table_name());
+                }
+            }
+            
+            case StatementType::EXPLAIN:
+                return explain(static_cast<const ExplainStatement*>(stmt));
+            
             default: {
-                // For other statements, use the planner
-                auto plan = planner_.create_plan(stmt);
+                // For other statements, use the planner. The shared catalog
+                // latch keeps the tables alive until the plan has finished.
+                std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+                std::unique_ptr<PlanNode> plan;
+                {
+                    utils::ScopedTimer timer(plan_latency());
+                    plan = planner_.create_plan(stmt);
+                }
                 if (!plan) {
                     return QueryResult("Failed to create execution plan");
                 }
-                
-                return plan->execute();
+                return run_plan(plan.get(), sink);
+            }
+        }
+    }
+    
+    QueryResult QueryExecutor::execute_prepared(PreparedStatement& prepared, ResultSink* sink) {
+        size_t unbound = prepared.first_unbound();
+        if (unbound != SIZE_MAX) {
+            return QueryResult("Parameter " + std::to_string(unbound + 1) + " is not bound");
+        }
+        
+        const Statement* stmt = prepared.get_statement();
+        if (!uses_planner(stmt)) {
+            return execute_statement(stmt, sink);
+        }
+        
+        // The plan is reused until the catalog it points into changes
+        std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+        uint64_t index_version = index_version_unlocked();
+        if (!prepared.plan_ || prepared.plan_catalog_version_ != catalog_version_ ||
+            prepared.plan_index_version_ != index_version) {
+            utils::ScopedTimer timer(plan_latency());
+            prepared.plan_ = planner_.create_plan(stmt);
+            prepared.plan_catalog_version_ = catalog_version_;
+            prepared.plan_index_version_ = index_version;
+        }
+        if (!prepared.plan_) {
+            return QueryResult("Failed to create execution plan");
+        }
+        return run_plan(prepared.plan_.get(), sink);
+    }
+    
+    QueryResult QueryExecutor::explain(const ExplainStatement* stmt) {
+        const Statement* inner = stmt->get_statement();
+        if (!uses_planner(inner)) {
+            return QueryResult("EXPLAIN needs a SELECT, INSERT, COPY, UPDATE or DELETE");
+        }
+        
+        std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+        auto planning_start = std::chrono::steady_clock::now();
+        auto plan = planner_.create_plan(inner);
+        std::chrono::duration<double, std::milli> planning = std::chrono::steady_clock::now() - planning_start;
+        if (!plan) {
+            return QueryResult("Failed to create execution plan");
+        }
+        
+        std::vector<storage::Row> lines;
+        if (!stmt->is_analyze()) {
+            explain_node(plan.get(), 0, lines);
+            return QueryResult(lines, {"QUERY PLAN"});
+        }
+        
+        // ANALYZE runs the statement, changes included, and drops its rows
+        profile_plan(plan);
+        DiscardSink discard;
+        auto execution_start = std::chrono::steady_clock::now();
+        QueryResult result = run_plan(plan.get(), &discard);
+        std::chrono::duration<double, std::milli> execution = std::chrono::steady_clock::now() - execution_start;
+        if (!result.is_success()) {
+            return result;
+        }
+        
+        explain_node(plan.get(), 0, lines);
+        std::ostringstream timing;
+        timing << std::fixed << std::setprecision(3) << "Planning time: " << planning.count() << " ms";
+        lines.emplace_back(std::vector<storage::Value>{storage::Value(timing.str())});
+        timing.str("");
+        timing << "Execution time: " << execution.count() << " ms";
+        lines.emplace_back(std::vector<storage::Value>{storage::Value(timing.str())});
+        return QueryResult(lines, {"QUERY PLAN"});
+    }
+    
+    QueryResult QueryExecutor::run_in_transaction(const Statement* stmt, Session* session,
+                                                  const std::function<QueryResult()>& run) {
+        if (stmt->get_type() == StatementType::TRANSACTION) {
+            return control_transaction(static_cast<const TransactionStatement*>(stmt)->get_action(), session);
+        }
+        if (transactions_ == nullptr) {
+            return run();
+        }
+        
+        // Outside BEGIN ... COMMIT every statement is its own transaction
+        std::unique_ptr<storage::Transaction> autocommit;
+        storage::Transaction* txn = session != nullptr ? session->transaction() : nullptr;
+        if (txn == nullptr) {
+            autocommit = transactions_->begin();
+            txn = autocommit.get();
+        }
+        
+        QueryResult result = [&]() {
+            storage::TransactionScope scope(txn);
+            return run();
+        }();
+        
+        if (txn->has_conflict()) {
+            transactions_->rollback(*txn);
+            if (!autocommit) {
+                session->txn_.reset();
+            }
+            return QueryResult("could not serialize access due to a concurrent update; transaction rolled back");
+        }
+        
+        // A statement that fails on its own leaves nothing behind, e.g. a
+        // COPY that hits a bad record; inside BEGIN ... COMMIT what it
+        // applied stays part of the transaction
+        if (autocommit && !result.is_success()) {
+            transactions_->rollback(*autocommit);
+            return result;
+        }
+        if (autocommit && !transactions_->commit(*autocommit)) {
+            return QueryResult("Failed to write the log");
+        }
+        return result;
+    }
+    
+    QueryResult QueryExecutor::control_transaction(TransactionAction action, Session* session) {
+        if (session == nullptr || transactions_ == nullptr) {
+            return QueryResult("Transactions need a database session");
+        }
+        
+        if (action == TransactionAction::BEGIN) {
+            if (session->in_transaction()) {
+                return QueryResult("A transaction is already in progress");
+            }
+            session->txn_ = transactions_->begin();
+            session->manager_ = transactions_;
+            return QueryResult(0);
+        }
+        
+        if (!session->in_transaction()) {
+            return QueryResult("No transaction is in progress");
+        }
+        std::unique_ptr<storage::Transaction> txn = std::move(session->txn_);
+        if (action == TransactionAction::ROLLBACK) {
+            transactions_->rollback(*txn);
+            return QueryResult(0);
+        }
+        if (!transactions_->commit(*txn)) {
+            return QueryResult("Failed to write the log; transaction rolled back");
+        }
+        return QueryResult(0);
+    }
+    
+    QueryResult QueryExecutor::run_plan(PlanNode* plan, ResultSink* sink) {
+        utils::ScopedTimer timer(execute_latency());
+        if (sink != nullptr && plan->produces_rows()) {
+            return stream_plan(plan, *sink);
+        }
+        return plan->execute();
+    }
+    
+    QueryResult QueryExecutor::stream_plan(PlanNode* plan, ResultSink& sink) {
+        if (!plan->open()) {
+            plan->close();
+            return QueryResult(plan->get_error());
+        }
+        
+        std::vector<std::string> column_names = plan->get_column_names();
+        sink.begin(column_names);
+        
+        // Rows go straight from the plan to the sink; the sink can stop early
+        storage::Row row;
+        while (plan->next(row)) {
+            if (!sink.accept(row)) {
+                break;
+            }
+        }
+        plan->close();
+        
+        return QueryResult(std::vector<storage::Row>(), column_names);
+    }
+    
+    QueryResult QueryExecutor::execute(PreparedStatement& prepared, ResultSink* sink, Session* session) {
+        QueryResult result = run_in_transaction(prepared.get_statement(), session,
+                                                [&]() { return execute_prepared(prepared, sink); });
+        
+        if (wal_ != nullptr && logs_directly(prepared.get_statement(), *this, transactions_ != nullptr) &&
+            !wal_->commit()) {
+            return QueryResult("Failed to write the log");
+        }
+        
+        return result;
+    }
+    
+    QueryResult QueryExecutor::execute_sql(const std::string& sql, ResultSink* sink, Session* session) {
+        // Repeated SQL skips parsing, and planning too while the catalog holds
+        std::string key = PlanCache::normalize(sql);
+        std::unique_ptr<PreparedStatement> prepared = plan_cache_.take(key);
+        if (!prepared) {
+            std::string error;
+            prepared = prepare(sql, error);
+            if (!prepared) {
+                return QueryResult("Parse error: " + error);
             }
         }
+        
+        QueryResult result = execute(*prepared, sink, session);
+        if (cacheable(*prepared)) {
+            plan_cache_.put(key, std::move(prepared));
+        }
+        return result;
     }
     
-    QueryResult QueryExecutor::execute_sql(const std::string& sql) {
+    std::unique_ptr<PreparedStatement> QueryExecutor::prepare(const std::string& sql, std::string& error) {
         Parser parser;
-        auto stmt = parser.parse(sql);
+        std::unique_ptr<Statement> stmt;
+        {
+            utils::ScopedTimer timer(parse_latency());
+            stmt = parser.parse(sql);
+        }
         
         if (!stmt) {
-            return QueryResult("Parse error: " + parser.get_error());
+            error = parser.get_error();
+            return nullptr;
         }
         
-        return execute(stmt.get());
+        return std::make_unique<PreparedStatement>(std::move(stmt), parser.get_parameters());
     }
     
     bool QueryExecutor::create_table(const std::string& name, const storage::TableSchema& schema) {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        
         if (table_refs_.find(name) != table_refs_.end()) {
             return false;  // Table already exists
         }
         
+        if (wal_ != nullptr) {
+            std::vector<char> payload;
+            storage::encode_schema(schema, payload);
+            wal_->append(storage::LogRecordType::CREATE_TABLE, name, payload);
+        }
+        
         auto table = std::make_unique<storage::Table>(schema, page_manager_);
         storage::Table* table_ptr = table.get();
+        table_ptr->attach_wal(wal_, name);
+        table_ptr->attach_transactions(transactions_);
         
         tables_[name] = std::move(table);
         table_refs_[name] = table_ptr;
+        catalog_version_ = next_catalog_version();
         
         return true;
     }
     
     bool QueryExecutor::drop_table(const std::string& name) {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        
         auto it = tables_.find(name);
         if (it != tables_.end()) {
+            // An open transaction's undo still points into the table
+            if (it->second->has_uncommitted_writes()) {
+                return false;
+            }
+            if (wal_ != nullptr) {
+                wal_->append(storage::LogRecordType::DROP_TABLE, name, std::vector<char>());
+            }
             table_refs_.erase(name);
             tables_.erase(it);
+            catalog_version_ = next_catalog_version();
             return true;
         }
         return false;
     }
     
     storage::Table* QueryExecutor::get_table(const std::string& name) {
+        std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+        
         auto it = table_refs_.find(name);
         if (it != table_refs_.end()) {
             return it->second;
@@ -266,6 +3194,8 @@ namespace query {
     }
     
     std::vector<std::string> QueryExecutor::get_table_names() const {
+        std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+        
         std::vector<std::string> names;
         for (const auto& [name, table] : tables_) {
             names.push_back(name);
@@ -274,8 +3204,102 @@ namespace query {
     }
     
     void QueryExecutor::clear_all_tables() {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        
+        if (wal_ != nullptr) {
+            for (const auto& [name, table] : tables_) {
+                wal_->append(storage::LogRecordType::DROP_TABLE, name, std::vector<char>());
+            }
+        }
         tables_.clear();
         table_refs_.clear();
+        catalog_version_ = next_catalog_version();
+    }
+    
+    void QueryExecutor::set_wal(storage::WriteAheadLog* wal) {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        
+        wal_ = wal;
+        for (auto& [name, table] : tables_) {
+            table->attach_wal(wal, name);
+        }
+    }
+    
+    void QueryExecutor::set_transactions(storage::TransactionManager* transactions) {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        
+        transactions_ = transactions;
+        for (auto& [name, table] : tables_) {
+            table->attach_transactions(transactions);
+        }
+    }
+    
+    size_t QueryExecutor::collect_garbage() {
+        std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+        if (transactions_ == nullptr) {
+            return 0;
+        }
+        
+        // Transactions that begin from here on read at or after the horizon
+        storage::Timestamp horizon = transactions_->horizon();
+        size_t reclaimed = 0;
+        for (const auto& [name, table] : table_refs_) {
+            reclaimed += table->collect_garbage(horizon);
+        }
+        return reclaimed;
+    }
+    
+    bool QueryExecutor::analyze(const std::string& table_name) {
+        // Rows are read with the catalog shared, so other statements keep
+        // running meanwhile; the results go in with it held exclusively
+        std::vector<std::pair<std::string, std::shared_ptr<const storage::TableStatistics>>> collected;
+        {
+            std::shared_lock<std::shared_mutex> lock(catalog_latch_);
+            for (const auto& [name, table] : table_refs_) {
+                if (table_name.empty() || name == table_name) {
+                    collected.emplace_back(name, table->collect_statistics(storage::Transaction::current()));
+                }
+            }
+        }
+        if (collected.empty() && !table_name.empty()) {
+            return false;
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        for (auto& [name, statistics] : collected) {
+            auto it = table_refs_.find(name);
+            if (it != table_refs_.end()) {
+                it->second->set_statistics(std::move(statistics));
+            }
+        }
+        catalog_version_ = next_catalog_version();  // Plans are costed from the statistics
+        return true;
+    }
+    
+    void QueryExecutor::set_parallelism(size_t threads) {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        planner_.set_parallelism(threads);
+        catalog_version_ = next_catalog_version();  // Scans are sized when planned
+    }
+    
+    void QueryExecutor::set_sort_memory(size_t bytes) {
+        std::unique_lock<std::shared_mutex> lock(catalog_latch_);
+        planner_.set_sort_memory(bytes);
+        catalog_version_ = next_catalog_version();  // Sorts are budgeted when planned
+    }
+    
+    uint64_t QueryExecutor::next_catalog_version() {
+        // Process-wide, so a plan is never taken as valid by another executor
+        return ++catalog_version_counter;
+    }
+    
+    uint64_t QueryExecutor::index_version_unlocked() const {
+        // Index versions only grow, so the sum changes whenever any index does
+        uint64_t version = 0;
+        for (const auto& [name, table] : table_refs_) {
+            version += table->index_version();
+        }
+        return version;
     }
 
 } // namespace query
@@ -4,8 +4,11 @@
  */
 
 #include "minidb/query/parser.h"
-#include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <string_view>
+#include <tuple>
 
 namespace minidb {
 namespace query {
@@ -60,24 +63,139 @@ namespace query {
         return std::make_unique<BinaryExpression>(left_->clone(), right_->clone(), op_);
     }
     
+    namespace {
+    
+        struct KeywordEntry {
+            std::string_view name;
+            Keyword keyword;
+        };
+        
+        constexpr KeywordEntry KEYWORDS[] = {
+            {"SELECT", Keyword::SELECT},   {"FROM", Keyword::FROM},       {"WHERE", Keyword::WHERE},
+            {"INSERT", Keyword::INSERT},   {"INTO", Keyword::INTO},       {"VALUES", Keyword::VALUES},
+            {"CREATE", Keyword::CREATE},   {"TABLE", Keyword::TABLE},     {"DROP", Keyword::DROP},
+            {"UPDATE", Keyword::UPDATE},   {"DELETE", Keyword::DELETE},   {"JOIN", Keyword::JOIN},
+            {"INNER", Keyword::INNER},     {"ON", Keyword::ON},           {"AS", Keyword::AS},
+            {"GROUP", Keyword::GROUP},     {"BY", Keyword::BY},           {"USING", Keyword::USING},
+            {"ROW", Keyword::ROW},         {"COLUMNAR", Keyword::COLUMNAR}, {"SET", Keyword::SET},
+            {"COPY", Keyword::COPY},       {"WITH", Keyword::WITH},       {"HEADER", Keyword::HEADER},
+            {"COUNT", Keyword::COUNT},     {"SUM", Keyword::SUM},         {"MIN", Keyword::MIN},
+            {"MAX", Keyword::MAX},         {"AVG", Keyword::AVG},
+            {"INTEGER", Keyword::INTEGER}, {"INT", Keyword::INT},         {"TEXT", Keyword::TEXT},
+            {"VARCHAR", Keyword::VARCHAR}, {"REAL", Keyword::REAL},       {"FLOAT", Keyword::FLOAT},
+            {"DOUBLE", Keyword::DOUBLE},
+            {"BEGIN", Keyword::BEGIN},     {"COMMIT", Keyword::COMMIT},   {"ROLLBACK", Keyword::ROLLBACK},
+            {"TRANSACTION", Keyword::TRANSACTION},
+            {"ORDER", Keyword::ORDER},     {"ASC", Keyword::ASC},         {"DESC", Keyword::DESC},
+            {"LIMIT", Keyword::LIMIT},     {"OFFSET", Keyword::OFFSET},   {"ANALYZE", Keyword::ANALYZE},
+            {"EXPLAIN", Keyword::EXPLAIN},
+        };
+        
+        // Hash slots; a power of two comfortably larger than the keyword count
+        constexpr size_t KEYWORD_SLOTS = 256;
+        
+        constexpr char ascii_upper(char c) {
+            return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+        }
+        
+        // Case-insensitive FNV-1a, perturbed by seed
+        constexpr size_t keyword_hash(std::string_view word, uint32_t seed) {
+            uint32_t hash = 2166136261u ^ seed;
+            for (char c : word) {
+                hash ^= static_cast<unsigned char>(ascii_upper(c));
+                hash *= 16777619u;
+            }
+            // The multiply only carries upward, so the low bits alone would
+            // ignore most of the seed; fold the high half down first
+            return (hash ^ (hash >> 16)) & (KEYWORD_SLOTS - 1);
+        }
+        
+        constexpr bool is_perfect_seed(uint32_t seed) {
+            bool used[KEYWORD_SLOTS] = {};
+            for (const auto& entry : KEYWORDS) {
+                size_t slot = keyword_hash(entry.name, seed);
+                if (used[slot]) {
+                    return false;
+                }
+                used[slot] = true;
+            }
+            return true;
+        }
+        
+        // The first seed under which no two keywords share a slot, found
+        // by the compiler so the keyword list can change freely
+        constexpr uint32_t find_keyword_seed() {
+            uint32_t seed = 0;
+            while (!is_perfect_seed(seed)) {
+                seed++;
+            }
+            return seed;
+        }
+        
+        constexpr uint32_t KEYWORD_SEED = find_keyword_seed();
+        
+        // Slot -> index into KEYWORDS, or -1
+        constexpr std::array<int8_t, KEYWORD_SLOTS> build_keyword_slots() {
+            std::array<int8_t, KEYWORD_SLOTS> slots{};
+            for (auto& slot : slots) {
+                slot = -1;
+            }
+            for (size_t i = 0; i < sizeof(KEYWORDS) / sizeof(KEYWORDS[0]); i++) {
+                slots[keyword_hash(KEYWORDS[i].name, KEYWORD_SEED)] = static_cast<int8_t>(i);
+            }
+            return slots;
+        }
+        
+        constexpr std::array<int8_t, KEYWORD_SLOTS> KEYWORD_SLOT_TABLE = build_keyword_slots();
+        
+        std::string_view keyword_name(Keyword keyword) {
+            for (const auto& entry : KEYWORDS) {
+                if (entry.keyword == keyword) {
+                    return entry.name;
+                }
+            }
+            return std::string_view();
+        }
+        
+        const Token END_TOKEN{TokenKind::END, Keyword::NONE, std::string_view()};
+    
+    } // namespace
+    
+    Keyword lookup_keyword(std::string_view word) {
+        // One probe; the slot's keyword then has to match exactly
+        int8_t index = KEYWORD_SLOT_TABLE[keyword_hash(word, KEYWORD_SEED)];
+        if (index < 0 || KEYWORDS[index].name.size() != word.size()) {
+            return Keyword::NONE;
+        }
+        
+        const KeywordEntry& entry = KEYWORDS[index];
+        for (size_t i = 0; i < word.size(); i++) {
+            if (ascii_upper(word[i]) != entry.name[i]) {
+                return Keyword::NONE;
+            }
+        }
+        return entry.keyword;
+    }
+    
     // Tokenizer implementation
     bool Tokenizer::is_whitespace(char c) const {
-        return std::isspace(c);
+        return std::isspace(static_cast<unsigned char>(c));
     }
     
     bool Tokenizer::is_alpha(char c) const {
-        return std::isalpha(c) || c == '_';
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
     }
     
     bool Tokenizer::is_digit(char c) const {
-        return std::isdigit(c);
+        return std::isdigit(static_cast<unsigned char>(c));
     }
     
     bool Tokenizer::is_alphanumeric(char c) const {
         return is_alpha(c) || is_digit(c);
     }
     
-    bool Tokenizer::tokenize(const std::string& sql) {
+    bool Tokenizer::tokenize(std::string_view sql) {
+        // Tokens are views into sql, which must outlive them
         tokens_.clear();
         current_pos_ = 0;
         
@@ -91,74 +209,66 @@ namespace query {
                 continue;
             }
             
-            // Handle quoted strings
+            size_t start = i;
+            
+            // Quoted strings keep their quotes
             if (c == '\'' || c == '\"') {
-                char quote = c;
-                std::string token;
-                token += c;
+                size_t close = sql.find(c, i + 1);
+                i = close == std::string_view::npos ? sql.length() : close + 1;
+                tokens_.push_back({TokenKind::STRING, Keyword::NONE, sql.substr(start, i - start)});
+                continue;
+            }
+            
+            // "--" comments run to the end of the line
+            if (c == '-' && i + 1 < sql.length() && sql[i + 1] == '-') {
+                size_t newline = sql.find('\n', i);
+                i = newline == std::string_view::npos ? sql.length() : newline + 1;
+                continue;
+            }
+            
+            // A minus sign directly before a digit is part of the number
+            if (c == '-' && i + 1 < sql.length() && is_digit(sql[i + 1])) {
                 i++;
-                
-                while (i < sql.length() && sql[i] != quote) {
-                    token += sql[i];
-                    i++;
-                }
-                
-                if (i < sql.length()) {
-                    token += sql[i];  // Add closing quote
+                while (i < sql.length() && (is_digit(sql[i]) || sql[i] == '.')) {
                     i++;
                 }
-                
-                tokens_.push_back(token);
+                tokens_.push_back({TokenKind::NUMBER, Keyword::NONE, sql.substr(start, i - start)});
                 continue;
             }
             
             // Handle operators and punctuation
-            if (c == '=' || c == '<' || c == '>' || c == '!' || 
-                c == '(' || c == ')' || c == ',' || c == ';' || c == '*') {
-                
-                std::string token;
-                token += c;
+            if (c == '=' || c == '<' || c == '>' || c == '!' ||
+                c == '(' || c == ')' || c == ',' || c == ';' || c == '*' || c == '?' || c == '-') {
+                i++;
                 
                 // Handle two-character operators
-                if (i + 1 < sql.length()) {
-                    char next = sql[i + 1];
-                    if ((c == '<' && next == '=') ||
-                        (c == '>' && next == '=') ||
-                        (c == '!' && next == '=')) {
-                        token += next;
-                        i++;
-                    }
+                if (i < sql.length() && sql[i] == '=' && (c == '<' || c == '>' || c == '!')) {
+                    i++;
                 }
                 
-                tokens_.push_back(token);
-                i++;
+                tokens_.push_back({TokenKind::SYMBOL, Keyword::NONE, sql.substr(start, i - start)});
                 continue;
             }
             
-            // Handle identifiers and keywords
+            // Handle identifiers and keywords; "table.column" stays one token
             if (is_alpha(c)) {
-                std::string token;
-                while (i < sql.length() && is_alphanumeric(sql[i])) {
-                    token += sql[i];
+                while (i < sql.length() &&
+                       (is_alphanumeric(sql[i]) ||
+                        (sql[i] == '.' && i + 1 < sql.length() && is_alpha(sql[i + 1])))) {
                     i++;
                 }
                 
-                // Convert to uppercase for keywords
-                std::string upper_token = token;
-                std::transform(upper_token.begin(), upper_token.end(), 
-                             upper_token.begin(), ::toupper);
-                tokens_.push_back(upper_token);
+                std::string_view word = sql.substr(start, i - start);
+                tokens_.push_back({TokenKind::IDENTIFIER, lookup_keyword(word), word});
                 continue;
             }
             
             // Handle numbers
             if (is_digit(c)) {
-                std::string token;
                 while (i < sql.length() && (is_digit(sql[i]) || sql[i] == '.')) {
-                    token += sql[i];
                     i++;
                 }
-                tokens_.push_back(token);
+                tokens_.push_back({TokenKind::NUMBER, Keyword::NONE, sql.substr(start, i - start)});
                 continue;
             }
             
@@ -169,11 +279,11 @@ namespace query {
         return true;
     }
     
-    std::string Tokenizer::current_token() const {
+    const Token& Tokenizer::current_token() const {
         if (current_pos_ < tokens_.size()) {
             return tokens_[current_pos_];
         }
-        return "";
+        return END_TOKEN;
     }
     
     bool Tokenizer::next_token() {
@@ -184,11 +294,11 @@ namespace query {
         return false;
     }
     
-    std::string Tokenizer::peek_token() const {
+    const Token& Tokenizer::peek_token() const {
         if (current_pos_ + 1 < tokens_.size()) {
             return tokens_[current_pos_ + 1];
         }
-        return "";
+        return END_TOKEN;
     }
     
     bool Tokenizer::at_end() const {
@@ -202,6 +312,7 @@ namespace query {
     // Parser implementation
     std::unique_ptr<Statement> Parser::parse(const std::string& sql) {
         error_message_.clear();
+        parameters_.clear();
         
         if (!tokenizer_.tokenize(sql)) {
             error_message_ = "Tokenization failed";
@@ -215,50 +326,90 @@ namespace query {
             return nullptr;
         }
         
-        std::string first_token = tokenizer_.current_token();
-        
-        if (first_token == "SELECT") {
-            return parse_select();
-        } else if (first_token == "INSERT") {
-            return parse_insert();
-        } else if (first_token == "UPDATE") {
-            return parse_update();
-        } else if (first_token == "DELETE") {
-            return parse_delete();
-        } else if (first_token == "CREATE") {
-            return parse_create_table();
-        } else if (first_token == "DROP") {
-            return parse_drop_table();
-        } else {
-            error_message_ = "Unsupported statement type: " + first_token;
+        auto statement = parse_statement();
+        if (!statement) {
             return nullptr;
         }
+        
+        // Anything left over means the statement was not what it looked like
+        if (at_symbol(";")) {
+            tokenizer_.next_token();
+        }
+        if (!tokenizer_.at_end()) {
+            error_message_ = "Unexpected '" + std::string(tokenizer_.current_token().text) + "' after statement";
+            return nullptr;
+        }
+        return statement;
+    }
+    
+    std::unique_ptr<Statement> Parser::parse_statement() {
+        switch (tokenizer_.current_token().keyword) {
+            case Keyword::SELECT:
+                return parse_select();
+            case Keyword::INSERT:
+                return parse_insert();
+            case Keyword::COPY:
+                return parse_copy();
+            case Keyword::UPDATE:
+                return parse_update();
+            case Keyword::DELETE:
+                return parse_delete();
+            case Keyword::CREATE:
+                return parse_create_table();
+            case Keyword::DROP:
+                return parse_drop_table();
+            case Keyword::ANALYZE:
+                return parse_analyze();
+            case Keyword::EXPLAIN:
+                return parse_explain();
+            case Keyword::BEGIN:
+            case Keyword::COMMIT:
+            case Keyword::ROLLBACK:
+                return parse_transaction();
+            default:
+                error_message_ = "Unsupported statement type: " + token_name(tokenizer_.current_token());
+                return nullptr;
+        }
     }
     
     std::unique_ptr<Statement> Parser::parse_select() {
-        // SELECT columns FROM table [WHERE condition]
+        // SELECT columns FROM table [alias] {[INNER] JOIN table [alias] ON condition} [WHERE condition]
+        //     [GROUP BY column {, column}] [ORDER BY column [ASC | DESC] {, ...}] [LIMIT n] [OFFSET n]
         
-        if (!expect_token("SELECT")) {
+        if (!expect_keyword(Keyword::SELECT)) {
             return nullptr;
         }
         
         std::vector<std::string> columns;
+        std::vector<AggregateCall> aggregates;
         
         // Parse column list or *
-        if (tokenizer_.current_token() == "*") {
+        if (at_symbol("*")) {
             // Select all columns (empty vector indicates this)
             tokenizer_.next_token();
         } else {
             do {
-                std::string column = tokenizer_.current_token();
-                if (column.empty()) {
+                const Token& column = tokenizer_.current_token();
+                if (column.kind == TokenKind::END) {
                     error_message_ = "Expected column name";
                     return nullptr;
                 }
-                columns.push_back(column);
-                tokenizer_.next_token();
                 
-                if (tokenizer_.current_token() == ",") {
+                // Aggregates are listed under their result name, e.g. "SUM(AMOUNT)"
+                const Token& next = tokenizer_.peek_token();
+                if (next.kind == TokenKind::SYMBOL && next.text == "(") {
+                    AggregateCall aggregate;
+                    if (!parse_aggregate(aggregate)) {
+                        return nullptr;
+                    }
+                    columns.push_back(aggregate.name);
+                    aggregates.push_back(aggregate);
+                } else {
+                    columns.push_back(token_name(column));
+                    tokenizer_.next_token();
+                }
+                
+                if (at_symbol(",")) {
                     tokenizer_.next_token();
                 } else {
                     break;
@@ -267,20 +418,50 @@ namespace query {
         }
         
         // Parse FROM clause
-        if (!expect_token("FROM")) {
+        if (!expect_keyword(Keyword::FROM)) {
             return nullptr;
         }
         
-        std::string table_name = tokenizer_.current_token();
+        std::string table_name = token_name(tokenizer_.current_token());
         if (table_name.empty()) {
             error_message_ = "Expected table name";
             return nullptr;
         }
         tokenizer_.next_token();
+        std::string table_alias = parse_table_alias();
+        
+        // Parse joins
+        std::vector<JoinClause> joins;
+        while (at_keyword(Keyword::JOIN) || at_keyword(Keyword::INNER)) {
+            if (at_keyword(Keyword::INNER)) {
+                tokenizer_.next_token();
+            }
+            if (!expect_keyword(Keyword::JOIN)) {
+                return nullptr;
+            }
+            
+            JoinClause join;
+            join.table_name = token_name(tokenizer_.current_token());
+            if (join.table_name.empty()) {
+                error_message_ = "Expected table name after JOIN";
+                return nullptr;
+            }
+            tokenizer_.next_token();
+            join.alias = parse_table_alias();
+            
+            if (!expect_keyword(Keyword::ON)) {
+                return nullptr;
+            }
+            join.condition = parse_expression();
+            if (!join.condition) {
+                return nullptr;
+            }
+            joins.push_back(std::move(join));
+        }
         
         // Parse optional WHERE clause
         std::unique_ptr<Expression> where_clause;
-        if (tokenizer_.current_token() == "WHERE") {
+        if (at_keyword(Keyword::WHERE)) {
             tokenizer_.next_token();
             where_clause = parse_expression();
             if (!where_clause) {
@@ -288,119 +469,521 @@ namespace query {
             }
         }
         
-        return std::make_unique<SelectStatement>(columns, table_name, std::move(where_clause));
+        // Parse optional GROUP BY clause
+        std::vector<std::string> group_by;
+        if (at_keyword(Keyword::GROUP)) {
+            tokenizer_.next_token();
+            if (!expect_keyword(Keyword::BY)) {
+                return nullptr;
+            }
+            while (true) {
+                const Token& column = tokenizer_.current_token();
+                if (column.kind == TokenKind::END || column.kind == TokenKind::SYMBOL) {
+                    error_message_ = "Expected column name in GROUP BY";
+                    return nullptr;
+                }
+                group_by.push_back(token_name(column));
+                tokenizer_.next_token();
+                
+                if (!at_symbol(",")) {
+                    break;
+                }
+                tokenizer_.next_token();
+            }
+        }
+        
+        // Parse optional ORDER BY clause; an aggregate is named as in the select list
+        std::vector<OrderItem> order_by;
+        if (at_keyword(Keyword::ORDER)) {
+            tokenizer_.next_token();
+            if (!expect_keyword(Keyword::BY)) {
+                return nullptr;
+            }
+            while (true) {
+                const Token& column = tokenizer_.current_token();
+                if (column.kind == TokenKind::END || column.kind == TokenKind::SYMBOL) {
+                    error_message_ = "Expected column name in ORDER BY";
+                    return nullptr;
+                }
+                
+                OrderItem item;
+                const Token& next = tokenizer_.peek_token();
+                if (next.kind == TokenKind::SYMBOL && next.text == "(") {
+                    AggregateCall aggregate;
+                    if (!parse_aggregate(aggregate)) {
+                        return nullptr;
+                    }
+                    item.column = aggregate.name;
+                } else {
+                    item.column = token_name(column);
+                    tokenizer_.next_token();
+                }
+                
+                if (at_keyword(Keyword::ASC) || at_keyword(Keyword::DESC)) {
+                    item.descending = at_keyword(Keyword::DESC);
+                    tokenizer_.next_token();
+                }
+                order_by.push_back(item);
+                
+                if (!at_symbol(",")) {
+                    break;
+                }
+                tokenizer_.next_token();
+            }
+        }
+        
+        // Parse optional LIMIT and OFFSET
+        size_t limit = SIZE_MAX;
+        size_t offset = 0;
+        if (at_keyword(Keyword::LIMIT)) {
+            tokenizer_.next_token();
+            if (!parse_row_count("LIMIT", limit)) {
+                return nullptr;
+            }
+        }
+        if (at_keyword(Keyword::OFFSET)) {
+            tokenizer_.next_token();
+            if (!parse_row_count("OFFSET", offset)) {
+                return nullptr;
+            }
+        }
+        
+        auto select = std::make_unique<SelectStatement>(columns, table_name, std::move(where_clause));
+        select->set_table_alias(table_alias);
+        for (auto& join : joins) {
+            select->add_join(std::move(join));
+        }
+        for (const auto& aggregate : aggregates) {
+            select->add_aggregate(aggregate);
+        }
+        select->set_group_by(group_by);
+        select->set_order_by(order_by);
+        select->set_limit(limit, offset);
+        return select;
+    }
+    
+    bool Parser::parse_row_count(const char* clause, size_t& count) {
+        const Token& token = tokenizer_.current_token();
+        uint64_t value = 0;
+        const char* end = token.text.data() + token.text.size();
+        auto [ptr, ec] = std::from_chars(token.text.data(), end, value);
+        if (token.kind != TokenKind::NUMBER || ec != std::errc() || ptr != end) {
+            error_message_ = std::string("Expected a row count after ") + clause;
+            return false;
+        }
+        count = static_cast<size_t>(value);
+        tokenizer_.next_token();
+        return true;
+    }
+    
+    bool Parser::parse_aggregate(AggregateCall& aggregate) {
+        // FUNCTION(column), or COUNT(*)
+        std::string function = token_name(tokenizer_.current_token());
+        switch (tokenizer_.current_token().keyword) {
+            case Keyword::COUNT: aggregate.function = AggregateFunction::COUNT; break;
+            case Keyword::SUM: aggregate.function = AggregateFunction::SUM; break;
+            case Keyword::MIN: aggregate.function = AggregateFunction::MIN; break;
+            case Keyword::MAX: aggregate.function = AggregateFunction::MAX; break;
+            case Keyword::AVG: aggregate.function = AggregateFunction::AVG; break;
+            default:
+                error_message_ = "Unknown function: " + function;
+                return false;
+        }
+        tokenizer_.next_token();
+        
+        if (!expect_symbol("(")) {
+            return false;
+        }
+        
+        const Token& column = tokenizer_.current_token();
+        if (at_symbol("*") && aggregate.function == AggregateFunction::COUNT) {
+            aggregate.column.clear();
+        } else if (column.kind == TokenKind::IDENTIFIER) {
+            aggregate.column = token_name(column);
+        } else {
+            error_message_ = "Expected column name in " + function + "()";
+            return false;
+        }
+        tokenizer_.next_token();
+        
+        if (!expect_symbol(")")) {
+            return false;
+        }
+        
+        aggregate.name = function + "(" + (aggregate.column.empty() ? "*" : aggregate.column) + ")";
+        return true;
+    }
+    
+    std::string Parser::parse_table_alias() {
+        // [AS] alias, where alias is any identifier that is not a clause keyword
+        if (at_keyword(Keyword::AS)) {
+            tokenizer_.next_token();
+        }
+        
+        const Token& token = tokenizer_.current_token();
+        if (token.kind != TokenKind::IDENTIFIER || token.text.find('.') != std::string_view::npos) {
+            return "";
+        }
+        switch (token.keyword) {
+            case Keyword::JOIN:
+            case Keyword::INNER:
+            case Keyword::ON:
+            case Keyword::WHERE:
+            case Keyword::GROUP:
+            case Keyword::ORDER:
+            case Keyword::LIMIT:
+            case Keyword::OFFSET:
+                return "";
+            default:
+                break;
+        }
+        
+        std::string alias = token_name(token);
+        tokenizer_.next_token();
+        return alias;
     }
     
     std::unique_ptr<Statement> Parser::parse_insert() {
-        // INSERT INTO table VALUES (value1, value2, ...)
+        // INSERT INTO table VALUES (value1, value2, ...) {, (value1, value2, ...)}
         
-        if (!expect_token("INSERT") || !expect_token("INTO")) {
+        if (!expect_keyword(Keyword::INSERT) || !expect_keyword(Keyword::INTO)) {
             return nullptr;
         }
         
-        std::string table_name = tokenizer_.current_token();
+        std::string table_name = token_name(tokenizer_.current_token());
         if (table_name.empty()) {
             error_message_ = "Expected table name";
             return nullptr;
         }
         tokenizer_.next_token();
         
-        if (!expect_token("VALUES") || !expect_token("(")) {
+        if (!expect_keyword(Keyword::VALUES)) {
             return nullptr;
         }
         
-        std::vector<storage::Value> values;
+        std::vector<std::vector<storage::Value>> rows;
         std::vector<std::string> columns;  // Empty for now, assume all columns
         
         do {
-            storage::Value value = parse_literal();
-            values.push_back(value);
+            if (!expect_symbol("(")) {
+                return nullptr;
+            }
             
-            if (tokenizer_.current_token() == ",") {
-                tokenizer_.next_token();
-            } else {
+            std::vector<storage::Value> values;
+            do {
+                // A "?" is a NULL placeholder until a value is bound to it
+                if (at_symbol("?")) {
+                    parameters_.push_back(ParameterSlot{nullptr, rows.size(), values.size()});
+                    tokenizer_.next_token();
+                    values.emplace_back();
+                } else {
+                    values.emplace_back();
+                    if (!parse_literal(values.back())) {
+                        return nullptr;
+                    }
+                }
+                
+                if (at_symbol(",")) {
+                    tokenizer_.next_token();
+                } else {
+                    break;
+                }
+            } while (!tokenizer_.at_end());
+            
+            if (!expect_symbol(")")) {
+                return nullptr;
+            }
+            
+            // Every tuple is checked against the first, so a bad one fails
+            // the whole statement before anything is inserted
+            if (!rows.empty() && values.size() != rows.front().size()) {
+                error_message_ = "VALUES row " + std::to_string(rows.size() + 1) + " has " +
+                                 std::to_string(values.size()) + " values, expected " +
+                                 std::to_string(rows.front().size());
+                return nullptr;
+            }
+            rows.push_back(std::move(values));
+            
+            if (!at_symbol(",")) {
                 break;
             }
+            tokenizer_.next_token();
         } while (!tokenizer_.at_end());
         
-        if (!expect_token(")")) {
+        return std::make_unique<InsertStatement>(table_name, columns, std::move(rows));
+    }
+    
+    std::unique_ptr<Statement> Parser::parse_copy() {
+        // COPY table FROM 'file' [[WITH] HEADER]
+        
+        if (!expect_keyword(Keyword::COPY)) {
             return nullptr;
         }
         
-        return std::make_unique<InsertStatement>(table_name, columns, values);
+        std::string table_name = token_name(tokenizer_.current_token());
+        if (table_name.empty()) {
+            error_message_ = "Expected table name";
+            return nullptr;
+        }
+        tokenizer_.next_token();
+        
+        if (!expect_keyword(Keyword::FROM)) {
+            return nullptr;
+        }
+        
+        const Token& path_token = tokenizer_.current_token();
+        if (path_token.kind != TokenKind::STRING) {
+            error_message_ = "Expected quoted file name after FROM";
+            return nullptr;
+        }
+        storage::Value path_value;
+        parse_literal(path_value);
+        std::string path(path_value.get_string());
+        
+        bool header = false;
+        if (at_keyword(Keyword::WITH)) {
+            tokenizer_.next_token();
+            if (!expect_keyword(Keyword::HEADER)) {
+                return nullptr;
+            }
+            header = true;
+        } else if (at_keyword(Keyword::HEADER)) {
+            tokenizer_.next_token();
+            header = true;
+        }
+        
+        return std::make_unique<CopyStatement>(table_name, path, header);
     }
     
     std::unique_ptr<Statement> Parser::parse_create_table() {
-        // CREATE TABLE name (column1 type1, column2 type2, ...)
+        // CREATE TABLE name (column1 type1, column2 type2, ...) [USING format]
         
-        if (!expect_token("CREATE") || !expect_token("TABLE")) {
+        if (!expect_keyword(Keyword::CREATE) || !expect_keyword(Keyword::TABLE)) {
             return nullptr;
         }
         
-        std::string table_name = tokenizer_.current_token();
+        std::string table_name = token_name(tokenizer_.current_token());
         if (table_name.empty()) {
             error_message_ = "Expected table name";
             return nullptr;
         }
         tokenizer_.next_token();
         
-        if (!expect_token("(")) {
+        if (!expect_symbol("(")) {
             return nullptr;
         }
         
         std::vector<storage::Column> columns;
         
         do {
-            std::string column_name = tokenizer_.current_token();
+            std::string column_name = token_name(tokenizer_.current_token());
             if (column_name.empty()) {
                 error_message_ = "Expected column name";
                 return nullptr;
             }
             tokenizer_.next_token();
             
-            std::string type_str = tokenizer_.current_token();
-            storage::ColumnType type = parse_column_type(type_str);
+            storage::ColumnType type = parse_column_type(tokenizer_.current_token());
             tokenizer_.next_token();
             
             columns.emplace_back(column_name, type);
             
-            if (tokenizer_.current_token() == ",") {
+            if (at_symbol(",")) {
                 tokenizer_.next_token();
             } else {
                 break;
             }
         } while (!tokenizer_.at_end());
         
-        if (!expect_token(")")) {
+        if (!expect_symbol(")")) {
             return nullptr;
         }
         
-        return std::make_unique<CreateTableStatement>(table_name, columns);
+        // Optional storage engine: USING ROW | USING COLUMNAR
+        storage::StorageFormat format = storage::StorageFormat::ROW;
+        if (at_keyword(Keyword::USING)) {
+            tokenizer_.next_token();
+            if (at_keyword(Keyword::COLUMNAR)) {
+                format = storage::StorageFormat::COLUMNAR;
+            } else if (!at_keyword(Keyword::ROW)) {
+                error_message_ = "Unknown storage format: " + token_name(tokenizer_.current_token());
+                return nullptr;
+            }
+            tokenizer_.next_token();
+        }
+        
+        return std::make_unique<CreateTableStatement>(table_name, columns, format);
     }
     
     std::unique_ptr<Statement> Parser::parse_drop_table() {
-        if (!expect_token("DROP") || !expect_token("TABLE")) {
+        if (!expect_keyword(Keyword::DROP) || !expect_keyword(Keyword::TABLE)) {
             return nullptr;
         }
         
-        std::string table_name = tokenizer_.current_token();
+        std::string table_name = token_name(tokenizer_.current_token());
         if (table_name.empty()) {
             error_message_ = "Expected table name";
             return nullptr;
         }
+        tokenizer_.next_token();
         
         return std::make_unique<DropTableStatement>(table_name);
     }
     
-    // Simplified implementations for update and delete
+    std::unique_ptr<Statement> Parser::parse_analyze() {
+        // ANALYZE [table]; without a table, every table is analyzed
+        
+        if (!expect_keyword(Keyword::ANALYZE)) {
+            return nullptr;
+        }
+        
+        std::string table_name;
+        if (!tokenizer_.at_end() && !at_symbol(";")) {
+            const Token& table = tokenizer_.current_token();
+            if (table.kind != TokenKind::IDENTIFIER) {
+                error_message_ = "Expected table name";
+                return nullptr;
+            }
+            table_name = token_name(table);
+            tokenizer_.next_token();
+        }
+        
+        return std::make_unique<AnalyzeStatement>(table_name);
+    }
+    
+    std::unique_ptr<Statement> Parser::parse_explain() {
+        // EXPLAIN [ANALYZE] statement; a following ANALYZE is always the
+        // option, never the ANALYZE statement
+        
+        if (!expect_keyword(Keyword::EXPLAIN)) {
+            return nullptr;
+        }
+        
+        bool analyze = at_keyword(Keyword::ANALYZE);
+        if (analyze) {
+            tokenizer_.next_token();
+        }
+        
+        if (tokenizer_.at_end()) {
+            error_message_ = "Expected statement after EXPLAIN";
+            return nullptr;
+        }
+        if (at_keyword(Keyword::EXPLAIN)) {
+            error_message_ = "EXPLAIN cannot explain EXPLAIN";
+            return nullptr;
+        }
+        
+        auto statement = parse_statement();
+        if (!statement) {
+            return nullptr;
+        }
+        return std::make_unique<ExplainStatement>(std::move(statement), analyze);
+    }
+    
+    std::unique_ptr<Statement> Parser::parse_transaction() {
+        // BEGIN [TRANSACTION] | COMMIT [TRANSACTION] | ROLLBACK [TRANSACTION]
+        
+        TransactionAction action;
+        switch (tokenizer_.current_token().keyword) {
+            case Keyword::BEGIN:
+                action = TransactionAction::BEGIN;
+                break;
+            case Keyword::COMMIT:
+                action = TransactionAction::COMMIT;
+                break;
+            default:
+                action = TransactionAction::ROLLBACK;
+                break;
+        }
+        tokenizer_.next_token();
+        
+        if (at_keyword(Keyword::TRANSACTION)) {
+            tokenizer_.next_token();
+        }
+        
+        return std::make_unique<TransactionStatement>(action);
+    }
+    
     std::unique_ptr<Statement> Parser::parse_update() {
-        error_message_ = "UPDATE not yet implemented";
-        return nullptr;
+        // UPDATE table SET column = expression {, column = expression} [WHERE condition]
+        
+        if (!expect_keyword(Keyword::UPDATE)) {
+            return nullptr;
+        }
+        
+        std::string table_name = token_name(tokenizer_.current_token());
+        if (table_name.empty()) {
+            error_message_ = "Expected table name";
+            return nullptr;
+        }
+        tokenizer_.next_token();
+        
+        if (!expect_keyword(Keyword::SET)) {
+            return nullptr;
+        }
+        
+        std::vector<Assignment> assignments;
+        do {
+            const Token& column = tokenizer_.current_token();
+            if (column.kind != TokenKind::IDENTIFIER) {
+                error_message_ = "Expected column name in SET";
+                return nullptr;
+            }
+            Assignment assignment;
+            assignment.column = token_name(column);
+            tokenizer_.next_token();
+            
+            if (!expect_symbol("=")) {
+                return nullptr;
+            }
+            assignment.value = parse_expression();
+            if (!assignment.value) {
+                return nullptr;
+            }
+            assignments.push_back(std::move(assignment));
+            
+            if (!at_symbol(",")) {
+                break;
+            }
+            tokenizer_.next_token();
+        } while (!tokenizer_.at_end());
+        
+        std::unique_ptr<Expression> where_clause;
+        if (at_keyword(Keyword::WHERE)) {
+            tokenizer_.next_token();
+            where_clause = parse_expression();
+            if (!where_clause) {
+                return nullptr;
+            }
+        }
+        
+        return std::make_unique<UpdateStatement>(table_name, std::move(assignments), std::move(where_clause));
     }
     
     std::unique_ptr<Statement> Parser::parse_delete() {
-        error_message_ = "DELETE not yet implemented";
-        return nullptr;
+        // DELETE FROM table [WHERE condition]
+        
+        if (!expect_keyword(Keyword::DELETE) || !expect_keyword(Keyword::FROM)) {
+            return nullptr;
+        }
+        
+        std::string table_name = token_name(tokenizer_.current_token());
+        if (table_name.empty()) {
+            error_message_ = "Expected table name";
+            return nullptr;
+        }
+        tokenizer_.next_token();
+        
+        std::unique_ptr<Expression> where_clause;
+        if (at_keyword(Keyword::WHERE)) {
+            tokenizer_.next_token();
+            where_clause = parse_expression();
+            if (!where_clause) {
+                return nullptr;
+            }
+        }
+        
+        return std::make_unique<DeleteStatement>(table_name, std::move(where_clause));
     }
     
     std::unique_ptr<Expression> Parser::parse_expression() {
@@ -411,20 +994,23 @@ namespace query {
         auto left = parse_primary_expression();
         if (!left) return nullptr;
         
-        std::string op_token = tokenizer_.current_token();
-        Operator op;
+        const Token& op_token = tokenizer_.current_token();
+        if (op_token.kind != TokenKind::SYMBOL) {
+            return left;  // No comparison operator
+        }
         
-        if (op_token == "=") {
+        Operator op;
+        if (op_token.text == "=") {
             op = Operator::EQUAL;
-        } else if (op_token == "!=") {
+        } else if (op_token.text == "!=") {
             op = Operator::NOT_EQUAL;
-        } else if (op_token == "<") {
+        } else if (op_token.text == "<") {
             op = Operator::LESS_THAN;
-        } else if (op_token == "<=") {
+        } else if (op_token.text == "<=") {
             op = Operator::LESS_EQUAL;
-        } else if (op_token == ">") {
+        } else if (op_token.text == ">") {
             op = Operator::GREATER_THAN;
-        } else if (op_token == ">=") {
+        } else if (op_token.text == ">=") {
             op = Operator::GREATER_EQUAL;
         } else {
             return left;  // No comparison operator
@@ -438,74 +1024,132 @@ namespace query {
     }
     
     std::unique_ptr<Expression> Parser::parse_primary_expression() {
-        std::string token = tokenizer_.current_token();
+        const Token& token = tokenizer_.current_token();
         
-        if (token.empty()) {
+        if (token.kind == TokenKind::END) {
             error_message_ = "Unexpected end of expression";
             return nullptr;
         }
         
+        // Parameters parse as NULL literals that binding overwrites
+        if (at_symbol("?")) {
+            auto literal = std::make_unique<LiteralExpression>(storage::Value());
+            parameters_.push_back(ParameterSlot{literal.get(), 0, 0});
+            tokenizer_.next_token();
+            return literal;
+        }
+        
         // Check if it's a literal
-        if ((token[0] >= '0' && token[0] <= '9') || 
-            token[0] == '\'' || token[0] == '\"') {
-            storage::Value value = parse_literal();
+        if (token.kind == TokenKind::NUMBER || token.kind == TokenKind::STRING) {
+            storage::Value value;
+            if (!parse_literal(value)) {
+                return nullptr;
+            }
             return std::make_unique<LiteralExpression>(value);
         }
         
         // Otherwise, treat as column name
-        std::string column_name = token;
+        std::string column_name = token_name(token);
         tokenizer_.next_token();
         return std::make_unique<ColumnExpression>(column_name);
     }
     
-    storage::ColumnType Parser::parse_column_type(const std::string& type_str) {
-        std::string upper_type = type_str;
-        std::transform(upper_type.begin(), upper_type.end(), 
-                      upper_type.begin(), ::toupper);
-        
-        if (upper_type == "INTEGER" || upper_type == "INT") {
-            return storage::ColumnType::INTEGER;
-        } else if (upper_type == "TEXT" || upper_type == "VARCHAR") {
-            return storage::ColumnType::TEXT;
-        } else if (upper_type == "REAL" || upper_type == "FLOAT" || upper_type == "DOUBLE") {
-            return storage::ColumnType::REAL;
-        } else {
-            return storage::ColumnType::TEXT;  // Default
+    storage::ColumnType Parser::parse_column_type(const Token& token) {
+        switch (token.keyword) {
+            case Keyword::INTEGER:
+            case Keyword::INT:
+                return storage::ColumnType::INTEGER;
+            case Keyword::TEXT:
+            case Keyword::VARCHAR:
+                return storage::ColumnType::TEXT;
+            case Keyword::REAL:
+            case Keyword::FLOAT:
+            case Keyword::DOUBLE:
+                return storage::ColumnType::REAL;
+            default:
+                return storage::ColumnType::TEXT;  // Default
         }
     }
     
-    storage::Value Parser::parse_literal() {
-        std::string token = tokenizer_.current_token();
-        tokenizer_.next_token();
-        
-        if (token.empty()) {
-            return storage::Value();  // NULL
-        }
+    bool Parser::parse_literal(storage::Value& value) {
+        const Token& token = tokenizer_.current_token();
+        std::string_view text = token.text;
         
         // String literal
-        if (token[0] == '\'' || token[0] == '\"') {
-            std::string str = token.substr(1, token.length() - 2);  // Remove quotes
-            return storage::Value(str);
+        if (token.kind == TokenKind::STRING) {
+            bool closed = text.size() >= 2 && text.back() == text.front();
+            value = storage::Value(std::string(text.substr(1, text.size() - (closed ? 2 : 1))));
+            tokenizer_.next_token();
+            return true;
         }
         
         // Number literal
-        if (token[0] >= '0' && token[0] <= '9') {
-            if (token.find('.') != std::string::npos) {
-                return storage::Value(std::stod(token));
+        if (token.kind == TokenKind::NUMBER) {
+            const char* end = text.data() + text.size();
+            std::errc ec;
+            const char* ptr;
+            if (text.find('.') != std::string_view::npos) {
+                double number = 0;
+                std::tie(ptr, ec) = std::from_chars(text.data(), end, number);
+                value = storage::Value(number);
             } else {
-                return storage::Value(static_cast<int64_t>(std::stoll(token)));
+                int64_t number = 0;
+                std::tie(ptr, ec) = std::from_chars(text.data(), end, number);
+                value = storage::Value(number);
+            }
+            if (ec == std::errc::result_out_of_range) {
+                error_message_ = "Number out of range: " + std::string(text);
+                return false;
+            }
+            if (ec != std::errc() || ptr != end) {
+                error_message_ = "Invalid number: " + std::string(text);
+                return false;
             }
+            tokenizer_.next_token();
+            return true;
         }
         
-        return storage::Value();  // NULL
+        value = storage::Value();  // NULL
+        tokenizer_.next_token();
+        return true;
+    }
+    
+    std::string Parser::token_name(const Token& token) {
+        // Identifiers are case-insensitive and stored upper-case
+        std::string name(token.text);
+        if (token.kind == TokenKind::IDENTIFIER) {
+            for (char& c : name) {
+                c = ascii_upper(c);
+            }
+        }
+        return name;
+    }
+    
+    bool Parser::at_keyword(Keyword keyword) const {
+        return tokenizer_.current_token().keyword == keyword;
+    }
+    
+    bool Parser::at_symbol(std::string_view symbol) const {
+        const Token& token = tokenizer_.current_token();
+        return token.kind == TokenKind::SYMBOL && token.text == symbol;
+    }
+    
+    bool Parser::expect_keyword(Keyword keyword) {
+        if (at_keyword(keyword)) {
+            tokenizer_.next_token();
+            return true;
+        }
+        error_message_ = "Expected '" + std::string(keyword_name(keyword)) + "', got '" +
+                         token_name(tokenizer_.current_token()) + "'";
+        return false;
     }
     
-    bool Parser::expect_token(const std::string& expected) {
-        if (tokenizer_.current_token() == expected) {
+    bool Parser::expect_symbol(std::string_view symbol) {
+        if (at_symbol(symbol)) {
             tokenizer_.next_token();
             return true;
         }
-        error_message_ = "Expected '" + expected + "', got '" + tokenizer_.current_token() + "'";
+        error_message_ = "Expected '" + std::string(symbol) + "', got '" + token_name(tokenizer_.current_token()) + "'";
         return false;
     }
 
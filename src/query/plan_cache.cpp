@@ -0,0 +1,124 @@
+/**
+ * @file plan_cache.cpp
+ * @brief LRU plan cache implementation
+ */
+
+#include "minidb/query/plan_cache.h"
+#include <cctype>
+
+namespace minidb {
+namespace query {
+
+    std::string PlanCache::normalize(const std::string& sql) {
+        std::string key;
+        key.reserve(sql.size());
+        
+        char quote = 0;
+        bool pending_space = false;
+        for (char c : sql) {
+            if (quote != 0) {
+                key += c;
+                if (c == quote) {
+                    quote = 0;
+                }
+                continue;
+            }
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                pending_space = !key.empty();
+                continue;
+            }
+            if (pending_space) {
+                key += ' ';
+                pending_space = false;
+            }
+            if (c == '\'' || c == '\"') {
+                quote = c;
+            }
+            key += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        
+        // Trailing semicolons end the statement without changing it
+        while (quote == 0 && !key.empty() && (key.back() == ';' || key.back() == ' ')) {
+            key.pop_back();
+        }
+        return key;
+    }
+    
+    std::unique_ptr<PreparedStatement> PlanCache::take(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        auto it = positions_.find(key);
+        if (it == positions_.end()) {
+            misses_++;
+            return nullptr;
+        }
+        
+        hits_++;
+        std::unique_ptr<PreparedStatement> statement = std::move(it->second->statement);
+        entries_.erase(it->second);
+        positions_.erase(it);
+        return statement;
+    }
+    
+    void PlanCache::put(const std::string& key, std::unique_ptr<PreparedStatement> statement) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (capacity_ == 0) {
+            return;
+        }
+        
+        // Another thread may have cached the same SQL meanwhile; keep the newer one
+        auto it = positions_.find(key);
+        if (it != positions_.end()) {
+            entries_.erase(it->second);
+            positions_.erase(it);
+        }
+        
+        entries_.push_front(Entry{key, std::move(statement)});
+        positions_[key] = entries_.begin();
+        evict_unlocked();
+    }
+    
+    void PlanCache::set_capacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        capacity_ = capacity;
+        evict_unlocked();
+    }
+    
+    size_t PlanCache::capacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+    
+    size_t PlanCache::size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+    
+    void PlanCache::clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        positions_.clear();
+        entries_.clear();
+    }
+    
+    uint64_t PlanCache::hits() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+    
+    uint64_t PlanCache::misses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+    
+    void PlanCache::evict_unlocked() {
+        while (entries_.size() > capacity_) {
+            positions_.erase(entries_.back().key);
+            entries_.pop_back();
+        }
+    }
+
+} // namespace query
+} // namespace minidb
@@ -0,0 +1,53 @@
+/**
+ * @file prepared_statement.cpp
+ * @brief Prepared statement parameter binding
+ */
+
+#include "minidb/query/prepared_statement.h"
+#include "minidb/query/executor.h"
+
+namespace minidb {
+namespace query {
+
+    PreparedStatement::PreparedStatement(std::unique_ptr<Statement> statement, std::vector<ParameterSlot> parameters)
+        : statement_(std::move(statement)), parameters_(std::move(parameters)), bound_(parameters_.size(), false) {
+    }
+    
+    PreparedStatement::~PreparedStatement() = default;
+    
+    bool PreparedStatement::bind(size_t index, const storage::Value& value) {
+        if (index >= parameters_.size()) {
+            return false;
+        }
+        
+        // Parameters are written into the statement itself, so planning
+        // sees them as literals and can still pick an index
+        const ParameterSlot& slot = parameters_[index];
+        if (slot.literal != nullptr) {
+            slot.literal->set_value(value);
+        } else {
+            static_cast<InsertStatement*>(statement_.get())->set_value(slot.row_index, slot.value_index, value);
+        }
+        bound_[index] = true;
+        plan_.reset();
+        return true;
+    }
+    
+    void PreparedStatement::clear_bindings() {
+        for (size_t i = 0; i < parameters_.size(); i++) {
+            bind(i, storage::Value());
+            bound_[i] = false;
+        }
+    }
+    
+    size_t PreparedStatement::first_unbound() const {
+        for (size_t i = 0; i < bound_.size(); i++) {
+            if (!bound_[i]) {
+                return i;
+            }
+        }
+        return SIZE_MAX;
+    }
+
+} // namespace query
+} // namespace minidb
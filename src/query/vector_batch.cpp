@@ -0,0 +1,250 @@
+/**
+ * @file vector_batch.cpp
+ * @brief Column vector and comparison kernel implementation
+ */
+
+#include "minidb/query/vector_batch.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define MINIDB_VECTOR_BATCH_AVX2 1
+#endif
+
+namespace minidb {
+namespace query {
+
+    namespace {
+
+        // Result of comparing with an ordering from Value::compare
+        bool apply_compare(int order, CompareOp op) {
+            switch (op) {
+                case CompareOp::EQUAL: return order == 0;
+                case CompareOp::NOT_EQUAL: return order != 0;
+                case CompareOp::LESS_THAN: return order < 0;
+                case CompareOp::LESS_EQUAL: return order <= 0;
+                case CompareOp::GREATER_THAN: return order > 0;
+                case CompareOp::GREATER_EQUAL: return order >= 0;
+            }
+            return false;
+        }
+        
+        // One tight loop per operator so the compiler can vectorize each.
+        // Everything is phrased with < and > to match Value::compare.
+        template<typename T, typename L>
+        void compare_scalar(const T* values, size_t count, CompareOp op, const L& literal, uint8_t* mask) {
+            switch (op) {
+                case CompareOp::EQUAL:
+                    for (size_t i = 0; i < count; i++) mask[i] = !(values[i] < literal) && !(literal < values[i]);
+                    break;
+                case CompareOp::NOT_EQUAL:
+                    for (size_t i = 0; i < count; i++) mask[i] = (values[i] < literal) || (literal < values[i]);
+                    break;
+                case CompareOp::LESS_THAN:
+                    for (size_t i = 0; i < count; i++) mask[i] = values[i] < literal;
+                    break;
+                case CompareOp::LESS_EQUAL:
+                    for (size_t i = 0; i < count; i++) mask[i] = !(literal < values[i]);
+                    break;
+                case CompareOp::GREATER_THAN:
+                    for (size_t i = 0; i < count; i++) mask[i] = literal < values[i];
+                    break;
+                case CompareOp::GREATER_EQUAL:
+                    for (size_t i = 0; i < count; i++) mask[i] = !(values[i] < literal);
+                    break;
+            }
+        }
+
+#ifdef MINIDB_VECTOR_BATCH_AVX2
+
+        bool cpu_has_avx2() {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+        
+        // Four 0/1 mask bytes for each 4-bit lane pattern
+        struct MaskBytes {
+            uint32_t bytes[16];
+            constexpr MaskBytes() : bytes() {
+                for (uint32_t bits = 0; bits < 16; bits++) {
+                    for (uint32_t lane = 0; lane < 4; lane++) {
+                        bytes[bits] |= ((bits >> lane) & 1u) << (lane * 8);
+                    }
+                }
+            }
+        };
+        constexpr MaskBytes MASK_BYTES;
+        
+        inline void store_lanes(int bits, uint8_t* mask) {
+            std::memcpy(mask, &MASK_BYTES.bytes[bits & 0xF], 4);
+        }
+        
+        __attribute__((target("avx2")))
+        void compare_int64_avx2(const int64_t* values, size_t count, CompareOp op, int64_t literal, uint8_t* mask) {
+            const __m256i lit = _mm256_set1_epi64x(literal);
+            // Each operator is one of ==, v > lit, lit > v, possibly negated
+            const int invert = (op == CompareOp::NOT_EQUAL || op == CompareOp::LESS_EQUAL ||
+                                op == CompareOp::GREATER_EQUAL) ? 0xF : 0;
+                                
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                __m256i result;
+                switch (op) {
+                    case CompareOp::EQUAL:
+                    case CompareOp::NOT_EQUAL:
+                        result = _mm256_cmpeq_epi64(v, lit);
+                        break;
+                    case CompareOp::GREATER_THAN:
+                    case CompareOp::LESS_EQUAL:
+                        result = _mm256_cmpgt_epi64(v, lit);
+                        break;
+                    default:
+                        result = _mm256_cmpgt_epi64(lit, v);
+                        break;
+                }
+                store_lanes(_mm256_movemask_pd(_mm256_castsi256_pd(result)) ^ invert, mask + i);
+            }
+            compare_scalar(values + i, count - i, op, literal, mask + i);
+        }
+        
+        __attribute__((target("avx2")))
+        void compare_double_avx2(const double* values, size_t count, CompareOp op, double literal, uint8_t* mask) {
+            const __m256d lit = _mm256_set1_pd(literal);
+            // Ordered predicates, so NaN behaves as in Value::compare
+            const int invert = (op == CompareOp::EQUAL || op == CompareOp::LESS_EQUAL ||
+                                op == CompareOp::GREATER_EQUAL) ? 0xF : 0;
+                                
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m256d v = _mm256_loadu_pd(values + i);
+                __m256d result;
+                switch (op) {
+                    case CompareOp::EQUAL:
+                    case CompareOp::NOT_EQUAL:
+                        result = _mm256_cmp_pd(v, lit, _CMP_NEQ_OQ);
+                        break;
+                    case CompareOp::GREATER_THAN:
+                    case CompareOp::LESS_EQUAL:
+                        result = _mm256_cmp_pd(v, lit, _CMP_GT_OQ);
+                        break;
+                    default:
+                        result = _mm256_cmp_pd(v, lit, _CMP_LT_OQ);
+                        break;
+                }
+                store_lanes(_mm256_movemask_pd(result) ^ invert, mask + i);
+            }
+            compare_scalar(values + i, count - i, op, literal, mask + i);
+        }
+
+#endif
+
+    } // namespace
+    
+    void ColumnVector::reset(storage::ColumnType type) {
+        type_ = type;
+        ints_.clear();
+        reals_.clear();
+        strings_.clear();
+        typed_.clear();
+        sources_.clear();
+        untyped_count_ = 0;
+    }
+    
+    void ColumnVector::append(const storage::Value& value) {
+        bool typed = !value.is_null() && value.get_type() == type_;
+        typed_.push_back(typed ? 1 : 0);
+        sources_.push_back(&value);
+        untyped_count_ += typed ? 0 : 1;
+        
+        // Untyped rows still take a slot so positions line up
+        switch (type_) {
+            case storage::ColumnType::INTEGER:
+                ints_.push_back(typed ? value.get_int() : 0);
+                break;
+            case storage::ColumnType::REAL:
+                reals_.push_back(typed ? value.get_real() : 0.0);
+                break;
+            case storage::ColumnType::TEXT:
+                strings_.push_back(typed ? std::string_view(value.get_string()) : std::string_view());
+                break;
+            default:
+                break;
+        }
+    }
+    
+    void compare_int64(const int64_t* values, size_t count, CompareOp op, int64_t literal, uint8_t* mask) {
+#ifdef MINIDB_VECTOR_BATCH_AVX2
+        if (cpu_has_avx2()) {
+            compare_int64_avx2(values, count, op, literal, mask);
+            return;
+        }
+#endif
+        compare_scalar(values, count, op, literal, mask);
+    }
+    
+    void compare_double(const double* values, size_t count, CompareOp op, double literal, uint8_t* mask) {
+#ifdef MINIDB_VECTOR_BATCH_AVX2
+        if (cpu_has_avx2()) {
+            compare_double_avx2(values, count, op, literal, mask);
+            return;
+        }
+#endif
+        compare_scalar(values, count, op, literal, mask);
+    }
+    
+    void compare_string(const std::string_view* values, size_t count, CompareOp op,
+                        std::string_view literal, uint8_t* mask) {
+        compare_scalar(values, count, op, literal, mask);
+    }
+    
+    size_t mask_to_selection(const uint8_t* mask, size_t count, uint32_t* selection) {
+        // Branch-free: always write, advance only when selected
+        size_t selected = 0;
+        for (size_t i = 0; i < count; i++) {
+            selection[selected] = static_cast<uint32_t>(i);
+            selected += mask[i];
+        }
+        return selected;
+    }
+    
+    size_t select_rows(const ColumnVector& column, CompareOp op, const storage::Value& literal,
+                       std::vector<uint32_t>& selection) {
+        size_t count = column.size();
+        std::vector<uint8_t> mask(count, 0);
+        
+        bool kernel = !literal.is_null() && literal.get_type() == column.type();
+        if (kernel) {
+            switch (column.type()) {
+                case storage::ColumnType::INTEGER:
+                    compare_int64(column.ints(), count, op, literal.get_int(), mask.data());
+                    break;
+                case storage::ColumnType::REAL:
+                    compare_double(column.reals(), count, op, literal.get_real(), mask.data());
+                    break;
+                case storage::ColumnType::TEXT:
+                    compare_string(column.strings(), count, op, literal.get_string(), mask.data());
+                    break;
+                default:
+                    kernel = false;
+                    break;
+            }
+        }
+        
+        // NULLs and values of another type take the generic comparison
+        if (!kernel || column.untyped_count() > 0) {
+            for (size_t i = 0; i < count; i++) {
+                if (!kernel || !column.is_typed(i)) {
+                    mask[i] = apply_compare(column.source(i).compare(literal), op);
+                }
+            }
+        }
+        
+        selection.resize(count);
+        size_t selected = mask_to_selection(mask.data(), count, selection.data());
+        selection.resize(selected);
+        return selected;
+    }
+
+} // namespace query
+} // namespace minidb
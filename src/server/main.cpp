@@ -0,0 +1,127 @@
+/**
+ * @file main.cpp
+ * @brief Entry point for the MiniDB network server
+ */
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+#include "minidb/minidb.h"
+#include "minidb/server/server.h"
+
+using namespace minidb;
+
+/**
+ * @brief Print usage information
+ */
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS] <database>\n";
+    std::cout << "\nServes a MiniDB database to many clients over TCP, one SQL statement per line.\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  -h, --help                    Show this help message\n";
+    std::cout << "  --host <address>              IPv4 address to listen on (default 127.0.0.1)\n";
+    std::cout << "  -p, --port <port>             TCP port to listen on (default 5433)\n";
+    std::cout << "  -w, --workers <count>         Statement worker threads (default: one per core)\n";
+    std::cout << "\nExample:\n";
+    std::cout << "  " << program_name << " -p 5433 shop\n";
+}
+
+/**
+ * @brief Parse command line arguments
+ * @return true if the server should start, false if it should exit
+ */
+bool parse_arguments(int argc, char* argv[], server::ServerConfig& config, std::string& database, int& exit_code) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return false;
+        } else if ((arg == "-p" || arg == "--port") && has_value) {
+            long port = std::strtol(argv[++i], nullptr, 10);
+            if (port < 0 || port > 65535) {
+                std::cerr << "Error: invalid port " << argv[i] << "\n";
+                exit_code = 1;
+                return false;
+            }
+            config.port = static_cast<uint16_t>(port);
+        } else if (arg == "--host" && has_value) {
+            config.host = argv[++i];
+        } else if ((arg == "-w" || arg == "--workers") && has_value) {
+            config.workers = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!arg.empty() && arg[0] != '-' && database.empty()) {
+            database = arg;
+        } else {
+            std::cerr << "Error: unexpected argument " << arg << "\n";
+            print_usage(argv[0]);
+            exit_code = 1;
+            return false;
+        }
+    }
+    
+    if (database.empty()) {
+        std::cerr << "Error: no database name given\n";
+        print_usage(argv[0]);
+        exit_code = 1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Main application entry point
+ * @return Exit code (0 for success)
+ */
+int main(int argc, char* argv[]) {
+    server::ServerConfig config;
+    std::string database_name;
+    int exit_code = 0;
+    if (!parse_arguments(argc, argv, config, database_name, exit_code)) {
+        return exit_code;
+    }
+    
+    // Blocked before any thread starts, so every thread inherits the mask
+    // and the signals are only ever taken by sigwait below
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    
+    if (!initialize()) {
+        std::cerr << "Error: Failed to initialize MiniDB library\n";
+        return 1;
+    }
+    
+    Database db(database_name);
+    if (!db.open()) {
+        std::cerr << "Error: could not open database " << database_name << "\n";
+        cleanup();
+        return 1;
+    }
+    
+    server::Server server(db, config);
+    std::string error;
+    if (!server.start(&error)) {
+        std::cerr << "Error: " << error << "\n";
+        db.close();
+        cleanup();
+        return 1;
+    }
+    std::cout << "MiniDB " << get_version() << " serving " << database_name << " on " << config.host << ":"
+              << server.port() << std::endl;
+    
+    int received = 0;
+    sigwait(&signals, &received);
+    
+    // Running statements finish and open transactions roll back before
+    // the final snapshot is written
+    std::cout << "Shutting down" << std::endl;
+    server.stop();
+    db.close();
+    cleanup();
+    return 0;
+}
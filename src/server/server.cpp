@@ -0,0 +1,546 @@
+/**
+ * @file server.cpp
+ * @brief Epoll event loop and statement workers
+ */
+
+#include "minidb/server/server.h"
+#include "minidb/query/session.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace minidb {
+namespace server {
+
+    namespace {
+    
+        constexpr size_t READ_CHUNK = 64 * 1024;
+        constexpr int MAX_EVENTS = 64;
+        
+        // Rows a worker formats before handing them to the event loop
+        constexpr size_t REPLY_CHUNK = 64 * 1024;
+        
+        void append_escaped(std::string& out, std::string_view text) {
+            for (char c : text) {
+                switch (c) {
+                    case '\\': out += "\\\\"; break;
+                    case '\t': out += "\\t"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    default: out += c; break;
+                }
+            }
+        }
+        
+        void append_row(std::string& out, const storage::Row& row) {
+            out += "ROW ";
+            for (size_t i = 0; i < row.size(); i++) {
+                if (i > 0) {
+                    out += '\t';
+                }
+                const storage::Value& value = row.get_value(i);
+                if (value.is_null()) {
+                    out += "\\N";
+                } else if (value.get_type() == storage::ColumnType::TEXT) {
+                    append_escaped(out, value.get_string());
+                } else {
+                    out += value.to_string();
+                }
+            }
+            out += '\n';
+        }
+        
+        void append_columns(std::string& out, const std::vector<std::string>& column_names) {
+            out += "COLUMNS ";
+            for (size_t i = 0; i < column_names.size(); i++) {
+                if (i > 0) {
+                    out += '\t';
+                }
+                append_escaped(out, column_names[i]);
+            }
+            out += '\n';
+        }
+        
+        bool is_blank(std::string_view line) {
+            return std::all_of(line.begin(), line.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); });
+        }
+    
+    } // anonymous namespace
+    
+    struct Server::Connection {
+        explicit Connection(int socket) : fd(socket) {}
+        
+        const int fd;
+        
+        // Event loop only
+        std::string input;
+        bool input_closed = false;
+        bool reading = true;
+        bool writing = false;
+        
+        // Shared with the worker running this connection's statements
+        std::mutex mutex;
+        std::condition_variable drained;
+        std::deque<std::string> statements;
+        std::string output;
+        bool running = false;  // A worker owns the session
+        bool closed = false;   // Socket gone; replies are dropped
+        bool stalled = false;  // Client stopped reading; the loop closes it
+        
+        query::Session session;
+    };
+    
+    /**
+     * @brief Formats streamed rows straight into the connection's output
+     *
+     * Rows are handed over in chunks. When the client falls behind, the
+     * worker waits here, which pauses the plan instead of buffering the
+     * whole result. A wait longer than the stall timeout ends the statement
+     * and has the event loop close the connection.
+     */
+    class Server::ReplySink : public query::ResultSink {
+    public:
+        ReplySink(Server& server, Connection& connection)
+            : server_(server), connection_(connection), started_(false), rows_(0) {}
+        
+        void begin(const std::vector<std::string>& column_names) override {
+            append_columns(buffer_, column_names);
+            started_ = true;
+        }
+        
+        bool accept(const storage::Row& row) override {
+            append_row(buffer_, row);
+            rows_++;
+            return buffer_.size() < REPLY_CHUNK || flush();
+        }
+        
+        // Hand over everything buffered; false once the client is gone
+        bool flush() {
+            {
+                std::unique_lock<std::mutex> lock(connection_.mutex);
+                bool drained = connection_.drained.wait_for(lock, server_.config_.stall_timeout, [this]() {
+                    return connection_.closed || connection_.stalled ||
+                           connection_.output.size() <= server_.config_.max_output_bytes;
+                });
+                if (!drained) {
+                    connection_.stalled = true;
+                }
+                if (connection_.closed || connection_.stalled) {
+                    buffer_.clear();
+                    lock.unlock();
+                    server_.wake(connection_.fd);
+                    return false;
+                }
+                connection_.output += buffer_;
+            }
+            buffer_.clear();
+            server_.wake(connection_.fd);
+            return true;
+        }
+        
+        std::string& buffer() { return buffer_; }
+        bool started() const { return started_; }
+        size_t rows() const { return rows_; }
+    
+    private:
+        Server& server_;
+        Connection& connection_;
+        std::string buffer_;
+        bool started_;
+        size_t rows_;
+    };
+    
+    // Server implementation
+    Server::Server(Database& database, const ServerConfig& config)
+        : database_(database), config_(config), bound_port_(0), listen_fd_(-1), epoll_fd_(-1), wake_fd_(-1),
+          stopping_(false), connections_accepted_(0), connections_open_(0), statements_(0) {
+    }
+    
+    Server::~Server() {
+        stop();
+    }
+    
+    bool Server::start(std::string* error) {
+        if (is_running()) {
+            return true;
+        }
+        
+        auto fail = [&](const std::string& what) {
+            if (error != nullptr) {
+                *error = what + ": " + std::strerror(errno);
+            }
+            for (int* fd : {&listen_fd_, &epoll_fd_, &wake_fd_}) {
+                if (*fd >= 0) {
+                    ::close(*fd);
+                    *fd = -1;
+                }
+            }
+            return false;
+        };
+        
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(config_.port);
+        if (::inet_pton(AF_INET, config_.host.c_str(), &address.sin_addr) != 1) {
+            errno = EINVAL;
+            return fail("Invalid listen address '" + config_.host + "'");
+        }
+        
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            return fail("socket");
+        }
+        int enable = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            return fail("bind " + config_.host + ":" + std::to_string(config_.port));
+        }
+        if (::listen(listen_fd_, SOMAXCONN) != 0) {
+            return fail("listen");
+        }
+        
+        socklen_t length = sizeof(address);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        bound_port_ = ntohs(address.sin_port);
+        
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd_ < 0 || wake_fd_ < 0) {
+            return fail("epoll");
+        }
+        for (int fd : {listen_fd_, wake_fd_}) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+                return fail("epoll_ctl");
+            }
+        }
+        
+        size_t workers = config_.workers > 0 ? config_.workers : std::max(1u, std::thread::hardware_concurrency());
+        workers_ = std::make_unique<utils::ThreadPool>(workers);
+        stopping_ = false;
+        loop_ = std::thread(&Server::event_loop, this);
+        return true;
+    }
+    
+    void Server::stop() {
+        if (!is_running()) {
+            return;
+        }
+        
+        stopping_ = true;
+        uint64_t one = 1;
+        ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+        (void)written;
+        loop_.join();
+        
+        // Closing marks every connection closed, which stops statements
+        // waiting on a slow client; the pool then finishes what is running
+        std::vector<std::shared_ptr<Connection>> open;
+        for (const auto& [fd, connection] : connections_) {
+            open.push_back(connection);
+        }
+        for (const auto& connection : open) {
+            close_client(connection);
+        }
+        workers_.reset();
+        
+        ::close(listen_fd_);
+        ::close(epoll_fd_);
+        ::close(wake_fd_);
+        listen_fd_ = epoll_fd_ = wake_fd_ = -1;
+        ready_.clear();
+    }
+    
+    Server::Stats Server::get_stats() const {
+        return Stats{connections_accepted_.load(), connections_open_.load(), statements_.load()};
+    }
+    
+    void Server::event_loop() {
+        epoll_event events[MAX_EVENTS];
+        while (!stopping_) {
+            int count = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            
+            for (int i = 0; i < count && !stopping_; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listen_fd_) {
+                    accept_clients();
+                    continue;
+                }
+                
+                if (fd == wake_fd_) {
+                    uint64_t wakeups = 0;
+                    ssize_t drained = ::read(wake_fd_, &wakeups, sizeof(wakeups));
+                    (void)drained;
+                    std::vector<int> ready;
+                    {
+                        std::lock_guard<std::mutex> lock(ready_mutex_);
+                        ready.swap(ready_);
+                    }
+                    for (int ready_fd : ready) {
+                        auto it = connections_.find(ready_fd);
+                        if (it != connections_.end()) {
+                            flush_client(std::shared_ptr<Connection>(it->second));
+                        }
+                    }
+                    continue;
+                }
+                
+                auto it = connections_.find(fd);
+                if (it == connections_.end()) {
+                    continue;
+                }
+                std::shared_ptr<Connection> connection = it->second;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    close_client(connection);
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                    read_client(connection);
+                } else if (events[i].events & EPOLLOUT) {
+                    flush_client(connection);
+                }
+            }
+        }
+    }
+    
+    void Server::accept_clients() {
+        while (true) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                return;  // EAGAIN: backlog empty; anything else is retried on the next event
+            }
+            
+            // Replies are usually small; send them as soon as they are ready
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLRDHUP;
+            event.data.fd = fd;
+            if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+                ::close(fd);
+                continue;
+            }
+            connections_[fd] = std::make_shared<Connection>(fd);
+            connections_accepted_++;
+            connections_open_++;
+        }
+    }
+    
+    void Server::read_client(const std::shared_ptr<Connection>& connection) {
+        char buffer[READ_CHUNK];
+        while (true) {
+            ssize_t received = ::recv(connection->fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                connection->input.append(buffer, static_cast<size_t>(received));
+                continue;
+            }
+            if (received == 0) {
+                connection->input_closed = true;
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            close_client(connection);
+            return;
+        }
+        
+        // Every complete line is a statement; a last line without a newline
+        // counts too once the client has stopped sending
+        std::vector<std::string> lines;
+        size_t start = 0;
+        for (size_t end; (end = connection->input.find('\n', start)) != std::string::npos; start = end + 1) {
+            std::string_view line(connection->input.data() + start, end - start);
+            if (!is_blank(line)) {
+                lines.emplace_back(line);
+            }
+        }
+        connection->input.erase(0, start);
+        if (connection->input.size() > config_.max_line_bytes) {
+            close_client(connection);
+            return;
+        }
+        if (connection->input_closed) {
+            if (!is_blank(connection->input)) {
+                lines.push_back(std::move(connection->input));
+            }
+            connection->input.clear();
+        }
+        
+        if (!lines.empty()) {
+            bool dispatch;
+            {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                for (auto& line : lines) {
+                    connection->statements.push_back(std::move(line));
+                }
+                dispatch = !connection->running;
+                connection->running = true;
+            }
+            if (dispatch) {
+                workers_->submit([this, connection]() { run_statements(connection); });
+            }
+        }
+        
+        flush_client(connection);
+    }
+    
+    void Server::flush_client(const std::shared_ptr<Connection>& connection) {
+        bool broken = false;
+        bool pending;
+        bool backed_up;
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            std::string& output = connection->output;
+            size_t sent = 0;
+            while (sent < output.size()) {
+                ssize_t written = ::send(connection->fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+                if (written > 0) {
+                    sent += static_cast<size_t>(written);
+                } else if (written < 0 && errno == EINTR) {
+                    continue;
+                } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    break;
+                } else {
+                    broken = true;  // Peer is gone
+                    break;
+                }
+            }
+            output.erase(0, sent);
+            pending = !output.empty();
+            backed_up = output.size() > config_.max_output_bytes;
+            idle = !connection->running && connection->statements.empty();
+            broken = broken || connection->stalled;  // A worker gave up waiting on it
+            if (!backed_up) {
+                connection->drained.notify_all();
+            }
+        }
+        
+        // A client that stopped sending is closed once everything it asked
+        // for has been answered
+        if (broken || (connection->input_closed && idle && !pending)) {
+            close_client(connection);
+            return;
+        }
+        watch(*connection, !connection->input_closed && !backed_up, pending);
+    }
+    
+    void Server::close_client(const std::shared_ptr<Connection>& connection) {
+        std::shared_ptr<Connection> keep = connection;  // May be the map's own reference
+        if (connections_.erase(keep->fd) == 0) {
+            return;
+        }
+        
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, keep->fd, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(keep->mutex);
+            ::close(keep->fd);
+            keep->closed = true;
+            keep->statements.clear();
+            keep->output.clear();
+        }
+        keep->drained.notify_all();
+        connections_open_--;
+    }
+    
+    void Server::watch(Connection& connection, bool readable, bool writable) {
+        if (connection.reading == readable && connection.writing == writable) {
+            return;
+        }
+        
+        epoll_event event{};
+        event.events = (readable ? EPOLLIN | EPOLLRDHUP : 0) | (writable ? EPOLLOUT : 0);
+        event.data.fd = connection.fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.reading = readable;
+        connection.writing = writable;
+    }
+    
+    void Server::run_statements(const std::shared_ptr<Connection>& connection) {
+        while (true) {
+            std::string sql;
+            {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                if (connection->statements.empty() || connection->stalled) {
+                    connection->running = false;
+                    break;
+                }
+                sql = std::move(connection->statements.front());
+                connection->statements.pop_front();
+            }
+            
+            ReplySink sink(*this, *connection);
+            // A throwing statement fails alone instead of taking down the worker
+            QueryResult result = [&]() {
+                try {
+                    return database_.execute_query(sql, connection->session, &sink);
+                } catch (const std::exception& e) {
+                    return QueryResult(std::string("Internal error: ") + e.what());
+                } catch (...) {
+                    return QueryResult(std::string("Internal error"));
+                }
+            }();
+            statements_++;
+            
+            std::string& reply = sink.buffer();
+            if (!result.is_success()) {
+                std::string message = result.get_error();
+                std::replace(message.begin(), message.end(), '\n', ' ');
+                reply += "ERROR " + message + "\n";
+            } else if (sink.started()) {
+                reply += "OK " + std::to_string(sink.rows()) + "\n";
+            } else if (result.has_data()) {
+                append_columns(reply, result.get_column_names());
+                for (const auto& row : result.get_rows()) {
+                    append_row(reply, row);
+                }
+                reply += "OK " + std::to_string(result.row_count()) + "\n";
+            } else {
+                reply += "OK " + std::to_string(result.get_affected_rows()) + "\n";
+            }
+            sink.flush();
+        }
+        
+        // Lets the loop close a connection that was only waiting on us
+        wake(connection->fd);
+    }
+    
+    void Server::wake(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            ready_.push_back(fd);
+        }
+        uint64_t one = 1;
+        ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+        (void)written;
+    }
+
+} // namespace server
+} // namespace minidb
@@ -0,0 +1,241 @@
+/**
+ * @file column_store.cpp
+ * @brief Column-oriented storage implementation
+ */
+
+#include "minidb/storage/column_store.h"
+#include <algorithm>
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+
+        bool test_bit(const std::vector<uint64_t>& bits, size_t position) {
+            return (bits[position >> 6] >> (position & 63)) & 1;
+        }
+        
+        void set_bit(std::vector<uint64_t>& bits, size_t position, bool value) {
+            uint64_t mask = uint64_t(1) << (position & 63);
+            if (value) {
+                bits[position >> 6] |= mask;
+            } else {
+                bits[position >> 6] &= ~mask;
+            }
+        }
+        
+        // Grow a bitmap to cover position, with new bits clear
+        void extend_bits(std::vector<uint64_t>& bits, size_t position) {
+            if ((position >> 6) >= bits.size()) {
+                bits.push_back(0);
+            }
+        }
+        
+    } // anonymous namespace
+    
+    ColumnStore::ColumnStore(const TableSchema& schema) : deleted_count_(0) {
+        for (const auto& column : schema.get_columns()) {
+            types_.push_back(column.type);
+            columns_.emplace_back(column.type);
+        }
+    }
+    
+    bool ColumnStore::append(const Row& row, uint64_t row_id) {
+        if (!positions_.insert(row_id, row_ids_.size())) {
+            return false;
+        }
+        
+        size_t position = row_ids_.size();
+        row_ids_.push_back(row_id);
+        extend_bits(deleted_, position);
+        
+        for (size_t i = 0; i < columns_.size(); i++) {
+            push_slot(columns_[i]);
+            store(columns_[i], position, i < row.size() ? row.get_value(i) : Value());
+        }
+        return true;
+    }
+    
+    bool ColumnStore::update(uint64_t row_id, const Row& row) {
+        const size_t* position = positions_.find(row_id);
+        if (position == nullptr) {
+            return false;
+        }
+        
+        for (size_t i = 0; i < columns_.size(); i++) {
+            store(columns_[i], *position, i < row.size() ? row.get_value(i) : Value());
+        }
+        return true;
+    }
+    
+    bool ColumnStore::erase(uint64_t row_id) {
+        const size_t* position = positions_.find(row_id);
+        if (position == nullptr) {
+            return false;
+        }
+        
+        set_bit(deleted_, *position, true);
+        positions_.remove(row_id);
+        deleted_count_++;
+        
+        // Reclaim in bulk so the cost is amortized over many deletes
+        if (deleted_count_ >= SEGMENT_ROWS && deleted_count_ * 2 >= row_ids_.size()) {
+            compact();
+        }
+        return true;
+    }
+    
+    bool ColumnStore::get(uint64_t row_id, Row& row) const {
+        const size_t* position = positions_.find(row_id);
+        if (position == nullptr) {
+            return false;
+        }
+        
+        fill_row(*position, nullptr, row);
+        return true;
+    }
+    
+    void ColumnStore::clear() {
+        columns_.clear();
+        for (ColumnType type : types_) {
+            columns_.emplace_back(type);
+        }
+        row_ids_.clear();
+        deleted_.clear();
+        deleted_count_ = 0;
+        positions_.clear();
+    }
+    
+    bool ColumnStore::read_segment(size_t segment, const std::vector<size_t>* columns,
+                                   std::vector<Row>& rows) const {
+        rows.clear();
+        size_t begin = segment * SEGMENT_ROWS;
+        if (begin >= row_ids_.size()) {
+            return false;
+        }
+        
+        size_t end = std::min(begin + SEGMENT_ROWS, row_ids_.size());
+        for (size_t position = begin; position < end; position++) {
+            if (test_bit(deleted_, position)) {
+                continue;
+            }
+            rows.emplace_back();
+            fill_row(position, columns, rows.back());
+        }
+        return true;
+    }
+    
+    size_t ColumnStore::dictionary_size(size_t column) const {
+        return column < columns_.size() ? columns_[column].dictionary.size() : 0;
+    }
+    
+    void ColumnStore::push_slot(ColumnData& column) {
+        // Every position gets a slot in the typed array so they line up
+        size_t position = row_ids_.size() - 1;
+        switch (column.type) {
+            case ColumnType::INTEGER: column.ints.push_back(0); break;
+            case ColumnType::REAL: column.reals.push_back(0.0); break;
+            case ColumnType::TEXT: column.codes.push_back(0); break;
+            default: break;
+        }
+        extend_bits(column.nulls, position);
+        extend_bits(column.mismatched, position);
+    }
+    
+    void ColumnStore::store(ColumnData& column, size_t position, const Value& value) {
+        if (test_bit(column.mismatched, position)) {
+            column.others.erase(position);
+            set_bit(column.mismatched, position, false);
+        }
+        set_bit(column.nulls, position, value.is_null());
+        if (value.is_null()) {
+            return;
+        }
+        
+        if (value.get_type() != column.type) {
+            set_bit(column.mismatched, position, true);
+            column.others[position] = value;
+            return;
+        }
+        
+        switch (column.type) {
+            case ColumnType::INTEGER:
+                column.ints[position] = value.get_int();
+                break;
+            case ColumnType::REAL:
+                column.reals[position] = value.get_real();
+                break;
+            case ColumnType::TEXT: {
+                std::string text(value.get_string());
+                auto code = column.dictionary_codes.try_emplace(text, static_cast<uint32_t>(column.dictionary.size()));
+                if (code.second) {
+                    column.dictionary.push_back(std::move(text));
+                }
+                column.codes[position] = *code.first;
+                break;
+            }
+            default:
+                // Untyped columns keep everything aside
+                set_bit(column.mismatched, position, true);
+                column.others[position] = value;
+                break;
+        }
+    }
+    
+    Value ColumnStore::load(const ColumnData& column, size_t position) const {
+        if (test_bit(column.nulls, position)) {
+            return Value();
+        }
+        if (test_bit(column.mismatched, position)) {
+            return column.others.at(position);
+        }
+        
+        switch (column.type) {
+            case ColumnType::INTEGER: return Value(column.ints[position]);
+            case ColumnType::REAL: return Value(column.reals[position]);
+            case ColumnType::TEXT: return Value(column.dictionary[column.codes[position]]);
+            default: return Value();
+        }
+    }
+    
+    void ColumnStore::fill_row(size_t position, const std::vector<size_t>* columns, Row& row) const {
+        std::vector<Value> values(columns_.size());
+        if (columns == nullptr) {
+            for (size_t i = 0; i < columns_.size(); i++) {
+                values[i] = load(columns_[i], position);
+            }
+        } else {
+            for (size_t i : *columns) {
+                if (i < columns_.size()) {
+                    values[i] = load(columns_[i], position);
+                }
+            }
+        }
+        
+        row = Row(values);
+        row.set_id(row_ids_[position]);
+    }
+    
+    void ColumnStore::compact() {
+        // Rebuild from the live rows; this also drops unused dictionary entries
+        std::vector<uint64_t> live_ids;
+        std::vector<Row> live_rows;
+        live_ids.reserve(positions_.size());
+        live_rows.reserve(positions_.size());
+        for (size_t position = 0; position < row_ids_.size(); position++) {
+            if (!test_bit(deleted_, position)) {
+                live_ids.push_back(row_ids_[position]);
+                live_rows.emplace_back();
+                fill_row(position, nullptr, live_rows.back());
+            }
+        }
+        
+        clear();
+        positions_.reserve(live_ids.size());
+        for (size_t i = 0; i < live_ids.size(); i++) {
+            append(live_rows[i], live_ids[i]);
+        }
+    }
+
+} // namespace storage
+} // namespace minidb
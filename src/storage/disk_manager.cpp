@@ -0,0 +1,186 @@
+/**
+ * @file disk_manager.cpp
+ * @brief Disk Manager implementation
+ */
+
+#include "minidb/storage/disk_manager.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+
+#ifdef _WIN32
+        // Windows has no pread/pwrite in the CRT; emulate with seek + read/write.
+        // The shared file offset makes this path unsafe for concurrent callers.
+        long long positioned_read(int fd, char* buffer, size_t length, long long offset) {
+            if (_lseeki64(fd, offset, SEEK_SET) < 0) return -1;
+            return _read(fd, buffer, static_cast<unsigned int>(length));
+        }
+        
+        long long positioned_write(int fd, const char* buffer, size_t length, long long offset) {
+            if (_lseeki64(fd, offset, SEEK_SET) < 0) return -1;
+            return _write(fd, buffer, static_cast<unsigned int>(length));
+        }
+#else
+        long long positioned_read(int fd, char* buffer, size_t length, long long offset) {
+            return ::pread(fd, buffer, length, static_cast<off_t>(offset));
+        }
+        
+        long long positioned_write(int fd, const char* buffer, size_t length, long long offset) {
+            return ::pwrite(fd, buffer, length, static_cast<off_t>(offset));
+        }
+#endif
+
+    } // anonymous namespace
+    
+    DiskManager::DiskManager(PageSize page_size)
+        : fd_(-1), page_size_(page_size), read_count_(0), write_count_(0),
+          base_data_(nullptr), base_page_count_(0) {
+    }
+    
+    DiskManager::~DiskManager() {
+        close();
+    }
+    
+    bool DiskManager::open(const std::string& path, bool truncate) {
+        close();
+        
+#ifdef _WIN32
+        int flags = _O_RDWR | _O_CREAT | _O_BINARY | (truncate ? _O_TRUNC : 0);
+        fd_ = ::_open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+        int flags = O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0);
+        fd_ = ::open(path.c_str(), flags, 0644);
+#endif
+        if (fd_ < 0) {
+            return false;
+        }
+        
+        path_ = path;
+        return true;
+    }
+    
+    void DiskManager::close() {
+        if (fd_ >= 0) {
+            sync();
+#ifdef _WIN32
+            ::_close(fd_);
+#else
+            ::close(fd_);
+#endif
+            fd_ = -1;
+        }
+    }
+    
+    bool DiskManager::read_page(PageId page_id, char* buffer) {
+        if (fd_ < 0) {
+            return false;
+        }
+        
+        // Untouched base pages are copied out of the image; the first access
+        // faults the mapped page in
+        if (page_id < base_page_count_ && !base_replaced_[page_id].load(std::memory_order_acquire)) {
+            std::memcpy(buffer, base_data_ + static_cast<size_t>(page_id) * page_size_, page_size_);
+            read_count_++;
+            return true;
+        }
+        
+        long long offset = static_cast<long long>(page_id) * page_size_;
+        size_t done = 0;
+        
+        while (done < page_size_) {
+            long long n = positioned_read(fd_, buffer + done, page_size_ - done, offset + done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (n == 0) {
+                break;  // End of file
+            }
+            done += static_cast<size_t>(n);
+        }
+        
+        // Pages that were allocated but never written read back as zeros
+        if (done < page_size_) {
+            std::memset(buffer + done, 0, page_size_ - done);
+        }
+        
+        read_count_++;
+        return true;
+    }
+    
+    bool DiskManager::write_page(PageId page_id, const char* buffer) {
+        if (fd_ < 0) {
+            return false;
+        }
+        
+        long long offset = static_cast<long long>(page_id) * page_size_;
+        size_t done = 0;
+        
+        while (done < page_size_) {
+            long long n = positioned_write(fd_, buffer + done, page_size_ - done, offset + done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        
+        if (page_id < base_page_count_) {
+            base_replaced_[page_id].store(true, std::memory_order_release);
+        }
+        write_count_++;
+        return true;
+    }
+    
+    bool DiskManager::sync() {
+        if (fd_ < 0) {
+            return false;
+        }
+        
+#ifdef _WIN32
+        return ::_commit(fd_) == 0;
+#else
+        return ::fsync(fd_) == 0;
+#endif
+    }
+    
+    PageId DiskManager::get_page_count() const {
+        if (fd_ < 0) {
+            return 0;
+        }
+        
+#ifdef _WIN32
+        struct _stat64 st;
+        if (::_fstat64(fd_, &st) != 0) return 0;
+#else
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) return 0;
+#endif
+        PageId file_pages = static_cast<PageId>((st.st_size + page_size_ - 1) / page_size_);
+        return std::max(file_pages, base_page_count_);
+    }
+    
+    void DiskManager::set_base_image(const char* data, PageId page_count) {
+        base_data_ = data;
+        base_page_count_ = data != nullptr ? page_count : 0;
+        base_replaced_.reset(base_page_count_ > 0 ? new std::atomic<bool>[base_page_count_] : nullptr);
+        for (PageId i = 0; i < base_page_count_; i++) {
+            base_replaced_[i].store(false, std::memory_order_relaxed);
+        }
+    }
+
+} // namespace storage
+} // namespace minidb
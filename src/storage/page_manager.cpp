@@ -4,13 +4,25 @@
  */
 
 #include "minidb/storage/page_manager.h"
+#include "minidb/storage/disk_manager.h"
+#include "minidb/storage/replacement_policy.h"
+#include "minidb/utils/metrics.h"
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <shared_mutex>
 
 namespace minidb {
 namespace storage {
 
+    namespace {
+    
+        // Pages fetched through any buffer pool by this thread
+        thread_local uint64_t page_accesses_on_thread = 0;
+    
+    } // anonymous namespace
+    
     // Page implementation
     Page::Page(PageId id, PageSize size) 
         : id_(id), size_(size), dirty_(false), in_use_(false), ref_count_(0) {
@@ -41,38 +53,41 @@ namespace storage {
         return true;
     }
     
-    // LRU Policy implementation
-    PageId LRUPolicy::select_victim(const std::vector<PageId>& pages) {
-        if (pages.empty()) {
-            return INVALID_PAGE_ID;
+    void Page::add_ref() {
+        ref_count_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    
+    void Page::release_ref() {
+        size_t count = ref_count_.load(std::memory_order_acquire);
+        while (count > 0 &&
+               !ref_count_.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel)) {
+            // count was reloaded by the failed exchange; retry
         }
-        
-        // Find the least recently used page
-        PageId lru_page = INVALID_PAGE_ID;
-        auto lru_position = access_order_.end();
-        
-        for (PageId page_id : pages) {
-            auto it = std::find(access_order_.begin(), access_order_.end(), page_id);
-            if (it != access_order_.end()) {
-                if (lru_position == access_order_.end() || it < lru_position) {
-                    lru_position = it;
-                    lru_page = page_id;
-                }
+    }
+    
+    // LRU Policy implementation
+    PageId LRUPolicy::select_victim(const EvictablePredicate& can_evict) {
+        // Walk from the least recently used end; skipping pinned pages is the
+        // only non-constant part, and there are rarely many of them
+        for (PageId page_id : access_order_) {
+            if (can_evict(page_id)) {
+                return page_id;
             }
         }
         
-        return lru_page != INVALID_PAGE_ID ? lru_page : pages[0];
+        return INVALID_PAGE_ID;
     }
     
     void LRUPolicy::page_accessed(PageId page_id) {
-        // Remove if already in list
-        auto it = std::find(access_order_.begin(), access_order_.end(), page_id);
-        if (it != access_order_.end()) {
-            access_order_.erase(it);
+        auto it = positions_.find(page_id);
+        if (it != positions_.end()) {
+            // Move to end (most recently used) without reallocating the node
+            access_order_.splice(access_order_.end(), access_order_, it->second);
+            return;
         }
         
-        // Add to end (most recently used)
         access_order_.push_back(page_id);
+        positions_[page_id] = std::prev(access_order_.end());
     }
     
     void LRUPolicy::page_added(PageId page_id) {
@@ -80,46 +95,150 @@ namespace storage {
     }
     
     void LRUPolicy::page_removed(PageId page_id) {
-        auto it = std::find(access_order_.begin(), access_order_.end(), page_id);
-        if (it != access_order_.end()) {
-            access_order_.erase(it);
+        auto it = positions_.find(page_id);
+        if (it != positions_.end()) {
+            access_order_.erase(it->second);
+            positions_.erase(it);
         }
     }
     
     // Page Manager implementation
-    PageManager::PageManager(PageSize page_size, size_t max_pages)
-        : replacement_policy_(std::make_unique<LRUPolicy>()),
-          page_size_(page_size), max_pages_(max_pages), 
-          current_pages_(0), next_page_id_(1) {
+    PageManager::PageManager(PageSize page_size, size_t max_pages, size_t partition_count)
+        : page_size_(page_size), max_pages_(max_pages), next_page_id_(1),
+          hit_count_(0), miss_count_(0), eviction_count_(0) {
+        
+        // One partition per 64 frames by default, so small pools behave like
+        // a single LRU while large ones spread their page table latches out
+        if (partition_count == 0) {
+            partition_count = std::min<size_t>(DEFAULT_PARTITION_COUNT, 
+                                               std::max<size_t>(1, max_pages_ / 64));
+        }
+        partition_count = std::min(partition_count, std::max<size_t>(1, max_pages_));
+        
+        policy_factory_ = [](size_t) { return std::make_unique<LRUPolicy>(); };
+        
+        for (size_t i = 0; i < partition_count; i++) {
+            auto partition = std::make_unique<Partition>();
+            partition->capacity = max_pages_ / partition_count + 
+                                  (i < max_pages_ % partition_count ? 1 : 0);
+            partition->policy = policy_factory_(partition->capacity);
+            partitions_.push_back(std::move(partition));
+        }
+        
+        // Every live pool adds to the process-wide buffer pool figures
+        utils::MetricsRegistry::global().add_source(this, [this](utils::MetricsSnapshot& snapshot) {
+            snapshot.counters["buffer_pool.hits"] += hit_count_.load();
+            snapshot.counters["buffer_pool.misses"] += miss_count_.load();
+            snapshot.counters["buffer_pool.evictions"] += eviction_count_.load();
+        });
     }
     
     PageManager::~PageManager() {
+        utils::MetricsRegistry::global().remove_source(this);
+        close();
+    }
+    
+    uint64_t PageManager::thread_page_accesses() {
+        return page_accesses_on_thread;
+    }
+    
+    void PageManager::add_thread_page_accesses(uint64_t count) {
+        page_accesses_on_thread += count;
+    }
+    
+    bool PageManager::open(const std::string& file_path, bool truncate) {
+        close();
+        
+        auto disk_manager = std::make_unique<DiskManager>(page_size_);
+        if (!disk_manager->open(file_path, truncate)) {
+            return false;
+        }
+        
+        // Page 0 is reserved, so a fresh file still starts handing out page 1
+        PageId first_free = std::max<PageId>(next_page_id_.load(), disk_manager->get_page_count());
+        next_page_id_ = (first_free == INVALID_PAGE_ID) ? 1 : first_free;
+        
+        disk_manager_ = std::move(disk_manager);
+        return true;
+    }
+    
+    bool PageManager::set_base_image(const char* data, PageId page_count) {
+        if (!disk_manager_) {
+            return false;
+        }
+        
+        // Base pages are read lazily through the disk manager; new pages are
+        // numbered after them
+        disk_manager_->set_base_image(data, page_count);
+        
+        std::lock_guard<std::mutex> lock(allocation_latch_);
+        if (next_page_id_ < page_count) {
+            next_page_id_ = page_count;
+        }
+        return true;
+    }
+    
+    void PageManager::close() {
         flush_all();
+        
+        if (disk_manager_) {
+            disk_manager_->close();
+            disk_manager_.reset();
+        }
     }
     
     PageId PageManager::allocate_page() {
-        // Check if we need to evict pages
-        if (current_pages_ >= max_pages_) {
-            if (!evict_pages(1)) {
-                return INVALID_PAGE_ID;  // Could not make room
+        PageId new_page_id;
+        {
+            std::lock_guard<std::mutex> lock(allocation_latch_);
+            if (!free_page_ids_.empty()) {
+                new_page_id = free_page_ids_.back();
+                free_page_ids_.pop_back();
+            } else {
+                new_page_id = next_page_id_++;
             }
         }
         
-        PageId new_page_id = next_page_id_++;
+        Partition& partition = partition_for(new_page_id);
+        std::lock_guard<std::mutex> lock(partition.latch);
+        
+        // Check if we need to evict pages. Without a backing file there is
+        // nowhere to write victims to, so the in-memory pool simply grows.
+        if (disk_manager_ && partition.pages.size() >= partition.capacity &&
+            !evict_pages(partition, 1)) {
+            std::lock_guard<std::mutex> alloc_lock(allocation_latch_);
+            free_page_ids_.push_back(new_page_id);
+            return INVALID_PAGE_ID;  // Could not make room
+        }
+        
         auto new_page = std::make_unique<Page>(new_page_id, page_size_);
         new_page->set_in_use(true);
         
-        pages_[new_page_id] = std::move(new_page);
-        current_pages_++;
+        // A fresh page must reach disk on eviction, otherwise a reused page id
+        // would read back whatever the previous owner left in the file
+        new_page->mark_dirty();
         
-        replacement_policy_->page_added(new_page_id);
+        partition.pages[new_page_id] = std::move(new_page);
+        partition.policy->page_added(new_page_id);
         
         return new_page_id;
     }
     
     bool PageManager::deallocate_page(PageId page_id) {
-        auto it = pages_.find(page_id);
-        if (it == pages_.end()) {
+        Partition& partition = partition_for(page_id);
+        std::unique_lock<std::mutex> lock(partition.latch);
+        
+        auto it = partition.pages.find(page_id);
+        if (it == partition.pages.end()) {
+            lock.unlock();
+            
+            // Not resident; it may still exist in the database file
+            std::lock_guard<std::mutex> alloc_lock(allocation_latch_);
+            if (disk_manager_ && page_id != INVALID_PAGE_ID && page_id < next_page_id_ &&
+                std::find(free_page_ids_.begin(), free_page_ids_.end(), page_id) == free_page_ids_.end()) {
+                free_page_ids_.push_back(page_id);
+                return true;
+            }
             return false;  // Page not found
         }
         
@@ -128,138 +247,273 @@ namespace storage {
             return false;
         }
         
-        replacement_policy_->page_removed(page_id);
-        pages_.erase(it);
-        current_pages_--;
+        partition.policy->page_removed(page_id);
+        partition.pages.erase(it);
+        lock.unlock();
+        
+        if (disk_manager_) {
+            std::lock_guard<std::mutex> alloc_lock(allocation_latch_);
+            free_page_ids_.push_back(page_id);
+        }
         
         return true;
     }
     
-    Page* PageManager::get_page(PageId page_id) {
-        auto it = pages_.find(page_id);
-        if (it == pages_.end()) {
-            return nullptr;
-        }
-        
-        replacement_policy_->page_accessed(page_id);
-        return it->second.get();
+    Page* PageManager::fetch_page(PageId page_id) {
+        Partition& partition = partition_for(page_id);
+        std::lock_guard<std::mutex> lock(partition.latch);
+        return find_or_load(partition, page_id);
     }
     
     bool PageManager::pin_page(PageId page_id) {
-        Page* page = get_page(page_id);
-        if (page == nullptr) {
-            return false;
-        }
-        
-        page->add_ref();
-        return true;
+        return fetch_page(page_id) != nullptr;
     }
     
     bool PageManager::unpin_page(PageId page_id) {
-        Page* page = get_page(page_id);
-        if (page == nullptr) {
+        Partition& partition = partition_for(page_id);
+        std::lock_guard<std::mutex> lock(partition.latch);
+        
+        auto it = partition.pages.find(page_id);
+        if (it == partition.pages.end()) {
             return false;
         }
         
-        page->release_ref();
+        it->second->release_ref();
         return true;
     }
     
     bool PageManager::flush_all() {
         bool success = true;
         
-        for (const auto& [page_id, page] : pages_) {
-            if (page->is_dirty()) {
-                // In a real implementation, this would write to disk
-                page->mark_clean();
+        for (const auto& partition : partitions_) {
+            // Pin the dirty pages, then write them without holding the
+            // partition latch so lookups in this partition are not stalled
+            std::vector<Page*> dirty_pages;
+            {
+                std::lock_guard<std::mutex> lock(partition->latch);
+                for (const auto& [page_id, page] : partition->pages) {
+                    if (page->is_dirty()) {
+                        page->add_ref();
+                        dirty_pages.push_back(page.get());
+                    }
+                }
             }
+            
+            for (Page* page : dirty_pages) {
+                {
+                    std::shared_lock<Page> page_latch(*page);
+                    if (!write_back(*page)) {
+                        success = false;
+                    }
+                }
+                page->release_ref();
+            }
+        }
+        
+        if (disk_manager_ && !disk_manager_->sync()) {
+            success = false;
         }
         
         return success;
     }
     
     bool PageManager::flush_page(PageId page_id) {
-        Page* page = get_page(page_id);
-        if (page == nullptr) {
-            return false;
+        Page* page = nullptr;
+        {
+            Partition& partition = partition_for(page_id);
+            std::lock_guard<std::mutex> lock(partition.latch);
+            
+            auto it = partition.pages.find(page_id);
+            if (it == partition.pages.end()) {
+                return false;
+            }
+            
+            page = it->second.get();
+            page->add_ref();  // Keep it resident while we write it out
         }
         
-        if (page->is_dirty()) {
-            // In a real implementation, this would write to disk
-            page->mark_clean();
+        bool success;
+        {
+            std::shared_lock<Page> page_latch(*page);
+            success = write_back(*page);
         }
+        page->release_ref();
         
-        return true;
+        return success;
     }
     
     PageManager::Stats PageManager::get_stats() const {
         Stats stats;
         stats.total_pages = max_pages_;
-        stats.used_pages = current_pages_;
         stats.page_size = page_size_;
-        stats.total_memory = current_pages_ * page_size_;
         
+        size_t used_pages = 0;
         size_t dirty_pages = 0;
         size_t pinned_pages = 0;
         
-        for (const auto& [page_id, page] : pages_) {
-            if (page->is_dirty()) {
-                dirty_pages++;
-            }
-            if (page->get_ref_count() > 0) {
-                pinned_pages++;
+        for (const auto& partition : partitions_) {
+            std::lock_guard<std::mutex> lock(partition->latch);
+            used_pages += partition->pages.size();
+            
+            for (const auto& [page_id, page] : partition->pages) {
+                if (page->is_dirty()) {
+                    dirty_pages++;
+                }
+                if (page->get_ref_count() > 0) {
+                    pinned_pages++;
+                }
             }
         }
         
+        stats.used_pages = used_pages;
+        stats.total_memory = used_pages * page_size_;
         stats.dirty_pages = dirty_pages;
         stats.pinned_pages = pinned_pages;
-        stats.hit_rate = 1.0;  // Simplified for in-memory implementation
+        stats.hits = hit_count_.load();
+        stats.misses = miss_count_.load();
+        stats.evictions = eviction_count_.load();
+        stats.disk_reads = disk_manager_ ? disk_manager_->get_read_count() : 0;
+        stats.disk_writes = disk_manager_ ? disk_manager_->get_write_count() : 0;
+        
+        size_t requests = stats.hits + stats.misses;
+        stats.hit_rate = requests > 0 
+            ? static_cast<double>(stats.hits) / static_cast<double>(requests)
+            : 1.0;  // No requests yet
         
         return stats;
     }
     
     void PageManager::clear() {
-        pages_.clear();
-        current_pages_ = 0;
+        for (const auto& partition : partitions_) {
+            std::lock_guard<std::mutex> lock(partition->latch);
+            partition->pages.clear();
+            partition->policy = policy_factory_(partition->capacity);
+        }
+        
+        std::lock_guard<std::mutex> alloc_lock(allocation_latch_);
+        free_page_ids_.clear();
         next_page_id_ = 1;
+        hit_count_ = 0;
+        miss_count_ = 0;
+        eviction_count_ = 0;
     }
     
-    void PageManager::set_replacement_policy(std::unique_ptr<ReplacementPolicy> policy) {
-        replacement_policy_ = std::move(policy);
+    void PageManager::set_replacement_policy(const PolicyFactory& factory) {
+        policy_factory_ = factory;
+        
+        for (const auto& partition : partitions_) {
+            std::lock_guard<std::mutex> lock(partition->latch);
+            partition->policy = policy_factory_(partition->capacity);
+            
+            // Let the new policy know about everything already resident
+            for (const auto& [page_id, page] : partition->pages) {
+                partition->policy->page_added(page_id);
+            }
+        }
     }
     
-    bool PageManager::evict_pages(size_t needed_pages) {
-        if (needed_pages == 0) {
-            return true;
+    bool PageManager::set_replacement_policy(const std::string& policy_name) {
+        if (!create_replacement_policy(policy_name, 1)) {
+            return false;  // Unknown policy name
         }
         
-        // Get list of evictable pages (not pinned)
-        std::vector<PageId> evictable_pages;
-        for (const auto& [page_id, page] : pages_) {
-            if (page->get_ref_count() == 0) {
-                evictable_pages.push_back(page_id);
+        set_replacement_policy([policy_name](size_t capacity) {
+            return create_replacement_policy(policy_name, capacity);
+        });
+        return true;
+    }
+    
+    PageManager::Partition& PageManager::partition_for(PageId page_id) const {
+        // Page ids are handed out sequentially, so modulo spreads them evenly
+        return *partitions_[page_id % partitions_.size()];
+    }
+    
+    Page* PageManager::find_or_load(Partition& partition, PageId page_id) {
+        auto it = partition.pages.find(page_id);
+        if (it != partition.pages.end()) {
+            hit_count_++;
+            page_accesses_on_thread++;
+            partition.policy->page_accessed(page_id);
+            it->second->add_ref();
+            return it->second.get();
+        }
+        
+        if (!disk_manager_ || page_id == INVALID_PAGE_ID || page_id >= next_page_id_) {
+            return nullptr;
+        }
+        
+        miss_count_++;
+        page_accesses_on_thread++;
+        Page* page = load_page(partition, page_id);
+        if (page) {
+            page->add_ref();
+        }
+        return page;
+    }
+    
+    Page* PageManager::load_page(Partition& partition, PageId page_id) {
+        if (partition.pages.size() >= partition.capacity) {
+            if (!evict_pages(partition, 1)) {
+                return nullptr;  // Every resident page is pinned
             }
         }
         
-        if (evictable_pages.size() < needed_pages) {
-            return false;  // Not enough evictable pages
+        auto page = std::make_unique<Page>(page_id, page_size_);
+        if (!disk_manager_->read_page(page_id, page->get_data())) {
+            return nullptr;
         }
+        page->mark_clean();
+        page->set_in_use(true);
+        
+        Page* page_ptr = page.get();
+        partition.pages[page_id] = std::move(page);
+        partition.policy->page_added(page_id);
+        
+        return page_ptr;
+    }
+    
+    bool PageManager::write_back(Page& page) {
+        if (!page.is_dirty()) {
+            return true;
+        }
+        
+        if (disk_manager_ && !disk_manager_->write_page(page.get_id(), page.get_data())) {
+            return false;  // Leave dirty so a later flush can retry
+        }
+        
+        page.mark_clean();
+        return true;
+    }
+    
+    bool PageManager::evict_pages(Partition& partition, size_t needed_pages) {
+        if (needed_pages == 0) {
+            return true;
+        }
+        
+        // Only unpinned pages may leave the pool. Pins are taken under the
+        // partition latch we hold, so an unpinned page cannot be grabbed (or
+        // latched) by another thread while we write it out.
+        auto can_evict = [&partition](PageId page_id) {
+            auto it = partition.pages.find(page_id);
+            return it != partition.pages.end() && it->second->get_ref_count() == 0;
+        };
         
         // Evict pages according to replacement policy
         for (size_t i = 0; i < needed_pages; i++) {
-            PageId victim = replacement_policy_->select_victim(evictable_pages);
+            PageId victim = partition.policy->select_victim(can_evict);
             if (victim == INVALID_PAGE_ID) {
-                return false;
+                return false;  // Not enough evictable pages
             }
             
-            // Flush if dirty before evicting
-            flush_page(victim);
-            deallocate_page(victim);
+            // Write back if dirty; the page stays allocated in the file
+            auto it = partition.pages.find(victim);
+            if (!write_back(*it->second)) {
+                return false;
+            }
             
-            // Remove from evictable list
-            evictable_pages.erase(
-                std::find(evictable_pages.begin(), evictable_pages.end(), victim)
-            );
+            partition.policy->page_removed(victim);
+            partition.pages.erase(it);
+            eviction_count_++;
         }
         
         return true;
@@ -0,0 +1,265 @@
+/**
+ * @file replacement_policy.cpp
+ * @brief CLOCK, 2Q and LRU-K replacement policies
+ */
+
+#include "minidb/storage/replacement_policy.h"
+#include <algorithm>
+
+namespace minidb {
+namespace storage {
+
+    // CLOCK implementation
+    ClockPolicy::ClockPolicy() : hand_(ring_.end()) {
+    }
+    
+    void ClockPolicy::advance_hand() {
+        if (hand_ != ring_.end()) {
+            ++hand_;
+        }
+        if (hand_ == ring_.end()) {
+            hand_ = ring_.begin();
+        }
+    }
+    
+    PageId ClockPolicy::select_victim(const EvictablePredicate& can_evict) {
+        if (ring_.empty()) {
+            return INVALID_PAGE_ID;
+        }
+        if (hand_ == ring_.end()) {
+            hand_ = ring_.begin();
+        }
+        
+        // Two sweeps: the first may only clear reference bits
+        for (size_t steps = 0; steps < 2 * ring_.size(); steps++) {
+            Frame& frame = *hand_;
+            if (can_evict(frame.page_id)) {
+                if (!frame.referenced) {
+                    return frame.page_id;
+                }
+                frame.referenced = false;
+            }
+            advance_hand();
+        }
+        
+        return INVALID_PAGE_ID;  // Everything is pinned
+    }
+    
+    void ClockPolicy::page_accessed(PageId page_id) {
+        auto it = frames_.find(page_id);
+        if (it != frames_.end()) {
+            it->second->referenced = true;
+        }
+    }
+    
+    void ClockPolicy::page_added(PageId page_id) {
+        if (frames_.find(page_id) != frames_.end()) {
+            page_accessed(page_id);
+            return;
+        }
+        
+        // Insert just behind the hand so a new page gets a full sweep
+        auto position = (hand_ == ring_.end()) ? ring_.end() : hand_;
+        auto it = ring_.insert(position, Frame{page_id, true});
+        frames_[page_id] = it;
+    }
+    
+    void ClockPolicy::page_removed(PageId page_id) {
+        auto it = frames_.find(page_id);
+        if (it == frames_.end()) {
+            return;
+        }
+        
+        if (hand_ == it->second) {
+            advance_hand();
+            if (hand_ == it->second) {
+                hand_ = ring_.end();  // Removing the only frame
+            }
+        }
+        
+        ring_.erase(it->second);
+        frames_.erase(it);
+    }
+    
+    // 2Q implementation
+    TwoQueuePolicy::TwoQueuePolicy(size_t capacity)
+        : a1in_limit_(std::max<size_t>(1, capacity / 4)),
+          a1out_limit_(std::max<size_t>(1, capacity / 2)) {
+    }
+    
+    PageId TwoQueuePolicy::pick_from(std::list<PageId>& queue, 
+                                     const EvictablePredicate& can_evict) const {
+        for (PageId page_id : queue) {
+            if (can_evict(page_id)) {
+                return page_id;
+            }
+        }
+        return INVALID_PAGE_ID;
+    }
+    
+    PageId TwoQueuePolicy::select_victim(const EvictablePredicate& can_evict) {
+        // Drain probation while it is over budget, otherwise the main queue
+        bool prefer_a1in = a1in_.size() > a1in_limit_ || am_.empty();
+        
+        PageId victim = prefer_a1in ? pick_from(a1in_, can_evict) : pick_from(am_, can_evict);
+        if (victim == INVALID_PAGE_ID) {
+            victim = prefer_a1in ? pick_from(am_, can_evict) : pick_from(a1in_, can_evict);
+        }
+        
+        return victim;
+    }
+    
+    void TwoQueuePolicy::page_accessed(PageId page_id) {
+        auto it = resident_.find(page_id);
+        if (it == resident_.end()) {
+            page_added(page_id);
+            return;
+        }
+        
+        // Re-references while on probation are treated as correlated and ignored
+        if (it->second.queue == Queue::AM) {
+            am_.splice(am_.end(), am_, it->second.position);
+        }
+    }
+    
+    void TwoQueuePolicy::page_added(PageId page_id) {
+        if (resident_.find(page_id) != resident_.end()) {
+            page_accessed(page_id);
+            return;
+        }
+        
+        auto ghost = ghosts_.find(page_id);
+        if (ghost != ghosts_.end()) {
+            // Seen recently enough to have survived probation once: promote
+            a1out_.erase(ghost->second);
+            ghosts_.erase(ghost);
+            
+            am_.push_back(page_id);
+            resident_[page_id] = Entry{Queue::AM, std::prev(am_.end())};
+        } else {
+            a1in_.push_back(page_id);
+            resident_[page_id] = Entry{Queue::A1_IN, std::prev(a1in_.end())};
+        }
+    }
+    
+    void TwoQueuePolicy::page_removed(PageId page_id) {
+        auto it = resident_.find(page_id);
+        if (it == resident_.end()) {
+            return;
+        }
+        
+        if (it->second.queue == Queue::A1_IN) {
+            a1in_.erase(it->second.position);
+            remember_ghost(page_id);
+        } else {
+            am_.erase(it->second.position);
+        }
+        
+        resident_.erase(it);
+    }
+    
+    void TwoQueuePolicy::remember_ghost(PageId page_id) {
+        if (ghosts_.find(page_id) != ghosts_.end()) {
+            return;
+        }
+        
+        a1out_.push_back(page_id);
+        ghosts_[page_id] = std::prev(a1out_.end());
+        
+        if (a1out_.size() > a1out_limit_) {
+            ghosts_.erase(a1out_.front());
+            a1out_.pop_front();
+        }
+    }
+    
+    // LRU-K implementation
+    LRUKPolicy::LRUKPolicy(size_t k) : k_(std::max<size_t>(1, k)), clock_(0) {
+    }
+    
+    std::pair<uint64_t, PageId> LRUKPolicy::order_key(PageId page_id, 
+                                                       const History& history) const {
+        // Front of the history is the oldest retained access: the first access
+        // for young pages, the K-th most recent for mature ones
+        return std::make_pair(history.timestamps.front(), page_id);
+    }
+    
+    void LRUKPolicy::erase_order(PageId page_id, const History& history) {
+        auto& order = history.timestamps.size() < k_ ? young_ : mature_;
+        order.erase(order_key(page_id, history));
+    }
+    
+    void LRUKPolicy::insert_order(PageId page_id, const History& history) {
+        auto& order = history.timestamps.size() < k_ ? young_ : mature_;
+        order.insert(order_key(page_id, history));
+    }
+    
+    PageId LRUKPolicy::select_victim(const EvictablePredicate& can_evict) {
+        for (const auto& [timestamp, page_id] : young_) {
+            if (can_evict(page_id)) {
+                return page_id;
+            }
+        }
+        for (const auto& [timestamp, page_id] : mature_) {
+            if (can_evict(page_id)) {
+                return page_id;
+            }
+        }
+        return INVALID_PAGE_ID;
+    }
+    
+    void LRUKPolicy::page_accessed(PageId page_id) {
+        auto it = history_.find(page_id);
+        if (it == history_.end()) {
+            page_added(page_id);
+            return;
+        }
+        
+        History& history = it->second;
+        erase_order(page_id, history);
+        
+        history.timestamps.push_back(++clock_);
+        if (history.timestamps.size() > k_) {
+            history.timestamps.pop_front();
+        }
+        
+        insert_order(page_id, history);
+    }
+    
+    void LRUKPolicy::page_added(PageId page_id) {
+        if (history_.find(page_id) != history_.end()) {
+            page_accessed(page_id);
+            return;
+        }
+        
+        History& history = history_[page_id];
+        history.timestamps.push_back(++clock_);
+        insert_order(page_id, history);
+    }
+    
+    void LRUKPolicy::page_removed(PageId page_id) {
+        auto it = history_.find(page_id);
+        if (it == history_.end()) {
+            return;
+        }
+        
+        erase_order(page_id, it->second);
+        history_.erase(it);
+    }
+    
+    // Policy factory
+    std::unique_ptr<ReplacementPolicy> create_replacement_policy(const std::string& name,
+                                                                 size_t capacity) {
+        if (name == "lru") {
+            return std::make_unique<LRUPolicy>();
+        } else if (name == "clock") {
+            return std::make_unique<ClockPolicy>();
+        } else if (name == "2q") {
+            return std::make_unique<TwoQueuePolicy>(capacity);
+        } else if (name == "lru-k" || name == "lru2") {
+            return std::make_unique<LRUKPolicy>(2);
+        }
+        return nullptr;  // Unknown policy
+    }
+
+} // namespace storage
+} // namespace minidb
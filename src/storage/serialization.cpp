@@ -0,0 +1,269 @@
+/**
+ * @file serialization.cpp
+ * @brief Row and schema encodings
+ */
+
+#include "minidb/storage/serialization.h"
+#include "minidb/storage/statistics.h"
+#include <algorithm>
+#include <memory>
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+
+        // Column constraint flags in encoded schemas
+        constexpr uint8_t FLAG_PRIMARY_KEY = 0x01;
+        constexpr uint8_t FLAG_NOT_NULL = 0x02;
+        constexpr uint8_t FLAG_UNIQUE = 0x04;
+        
+        void write_statistics(ByteWriter& writer, const TableStatistics& statistics) {
+            writer.write(statistics.row_count);
+            for (const auto& column : statistics.columns) {
+                writer.write(column.distinct_count);
+                writer.write(column.null_fraction);
+                write_value(writer, column.min);
+                write_value(writer, column.max);
+                writer.write(static_cast<uint32_t>(column.most_common.size()));
+                for (const auto& [value, fraction] : column.most_common) {
+                    write_value(writer, value);
+                    writer.write(fraction);
+                }
+                writer.write(static_cast<uint32_t>(column.histogram.size()));
+                for (const auto& bound : column.histogram) {
+                    write_value(writer, bound);
+                }
+            }
+        }
+        
+        bool read_statistics(ByteReader& reader, size_t column_count, TableStatistics& statistics) {
+            if (!reader.read(statistics.row_count)) {
+                return false;
+            }
+            statistics.columns.resize(column_count);
+            for (auto& column : statistics.columns) {
+                uint32_t common_count = 0;
+                uint32_t bound_count = 0;
+                if (!reader.read(column.distinct_count) || !reader.read(column.null_fraction) ||
+                    !read_value(reader, column.min) || !read_value(reader, column.max) || !reader.read(common_count)) {
+                    return false;
+                }
+                column.most_common.resize(std::min<size_t>(common_count, reader.remaining()));
+                for (auto& [value, fraction] : column.most_common) {
+                    if (!read_value(reader, value) || !reader.read(fraction)) {
+                        return false;
+                    }
+                }
+                if (common_count != column.most_common.size() || !reader.read(bound_count)) {
+                    return false;
+                }
+                column.histogram.resize(std::min<size_t>(bound_count, reader.remaining()));
+                for (auto& bound : column.histogram) {
+                    if (!read_value(reader, bound)) {
+                        return false;
+                    }
+                }
+                if (bound_count != column.histogram.size()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    
+    } // anonymous namespace
+    
+    void write_value(ByteWriter& writer, const Value& value) {
+        ColumnType type = value.is_null() ? ColumnType::NULL_TYPE : value.get_type();
+        
+        switch (type) {
+            case ColumnType::INTEGER:
+                writer.write(static_cast<uint8_t>(type));
+                writer.write(value.get_int());
+                break;
+            case ColumnType::REAL:
+                writer.write(static_cast<uint8_t>(type));
+                writer.write(value.get_real());
+                break;
+            case ColumnType::TEXT:
+                writer.write(static_cast<uint8_t>(type));
+                writer.write_string(value.get_string());
+                break;
+            default:
+                writer.write(static_cast<uint8_t>(ColumnType::NULL_TYPE));
+                break;
+        }
+    }
+    
+    bool read_value(ByteReader& reader, Value& value) {
+        uint8_t type = 0;
+        if (!reader.read(type)) {
+            return false;
+        }
+        
+        switch (static_cast<ColumnType>(type)) {
+            case ColumnType::INTEGER: {
+                int64_t int_val = 0;
+                if (!reader.read(int_val)) return false;
+                value = Value(int_val);
+                return true;
+            }
+            case ColumnType::REAL: {
+                double real_val = 0.0;
+                if (!reader.read(real_val)) return false;
+                value = Value(real_val);
+                return true;
+            }
+            case ColumnType::TEXT: {
+                std::string_view str_val;
+                if (!reader.read_string(str_val)) return false;
+                value = Value(str_val);
+                return true;
+            }
+            default:
+                value = Value();
+                return true;
+        }
+    }
+    
+    void encode_row(const Row& row, uint64_t row_id, std::vector<char>& out) {
+        out.clear();
+        ByteWriter writer(out);
+        writer.write(row_id);
+        writer.write(static_cast<uint16_t>(row.size()));
+        
+        for (size_t i = 0; i < row.size(); i++) {
+            write_value(writer, row.get_value(i));
+        }
+    }
+    
+    bool decode_row(const char* data, size_t length, Row& row) {
+        ByteReader reader(data, length);
+        uint64_t row_id = 0;
+        uint16_t value_count = 0;
+        
+        if (!reader.read(row_id) || !reader.read(value_count)) {
+            return false;
+        }
+        
+        row = Row();
+        row.set_id(row_id);
+        
+        Value value;
+        for (uint16_t i = 0; i < value_count; i++) {
+            if (!read_value(reader, value)) {
+                return false;
+            }
+            row.add_value(std::move(value));
+        }
+        
+        return true;
+    }
+    
+    uint64_t decode_row_id(const char* data, size_t length) {
+        ByteReader reader(data, length);
+        uint64_t row_id = 0;
+        reader.read(row_id);
+        return row_id;
+    }
+    
+    void encode_schema(const TableSchema& schema, std::vector<char>& out) {
+        out.clear();
+        ByteWriter writer(out);
+        writer.write_string(schema.get_table_name());
+        writer.write(static_cast<uint16_t>(schema.column_count()));
+        
+        for (size_t i = 0; i < schema.column_count(); i++) {
+            const Column& column = schema.get_column(i);
+            uint8_t flags = (column.primary_key ? FLAG_PRIMARY_KEY : 0) |
+                            (column.not_null ? FLAG_NOT_NULL : 0) |
+                            (column.unique ? FLAG_UNIQUE : 0);
+                            
+            writer.write_string(column.name);
+            writer.write(static_cast<uint8_t>(column.type));
+            writer.write(flags);
+        }
+        
+        writer.write(static_cast<uint8_t>(schema.get_storage_format()));
+        
+        // Statistics from the last ANALYZE, if any
+        const TableStatistics* statistics = schema.get_statistics();
+        writer.write(static_cast<uint8_t>(statistics != nullptr));
+        if (statistics != nullptr) {
+            write_statistics(writer, *statistics);
+        }
+    }
+    
+    bool decode_schema(const char* data, size_t length, TableSchema& schema) {
+        ByteReader reader(data, length);
+        std::string table_name;
+        uint16_t column_count = 0;
+        
+        if (!reader.read_string(table_name) || !reader.read(column_count)) {
+            return false;
+        }
+        
+        schema = TableSchema(table_name);
+        for (uint16_t i = 0; i < column_count; i++) {
+            std::string name;
+            uint8_t type = 0;
+            uint8_t flags = 0;
+            
+            if (!reader.read_string(name) || !reader.read(type) || !reader.read(flags)) {
+                return false;
+            }
+            
+            Column column(name, static_cast<ColumnType>(type));
+            column.primary_key = (flags & FLAG_PRIMARY_KEY) != 0;
+            column.not_null = (flags & FLAG_NOT_NULL) != 0;
+            column.unique = (flags & FLAG_UNIQUE) != 0;
+            
+            if (!schema.add_column(column)) {
+                return false;
+            }
+        }
+        
+        // Schemas logged before storage formats existed end here
+        uint8_t format = 0;
+        if (reader.read(format)) {
+            if (format > static_cast<uint8_t>(StorageFormat::COLUMNAR)) {
+                return false;
+            }
+            schema.set_storage_format(static_cast<StorageFormat>(format));
+        }
+        
+        // Schemas written before ANALYZE existed end here
+        uint8_t has_statistics = 0;
+        if (reader.read(has_statistics) && has_statistics != 0) {
+            auto statistics = std::make_shared<TableStatistics>();
+            if (!read_statistics(reader, schema.column_count(), *statistics)) {
+                return false;
+            }
+            schema.set_statistics(std::move(statistics));
+        }
+        
+        return true;
+    }
+    
+    uint32_t crc32(const char* data, size_t length) {
+        static const auto table = [] {
+            std::vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+        
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < length; i++) {
+            crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+} // namespace storage
+} // namespace minidb
@@ -0,0 +1,188 @@
+/**
+ * @file slotted_page.cpp
+ * @brief Slotted page implementation
+ */
+
+#include "minidb/storage/slotted_page.h"
+#include <algorithm>
+#include <cstring>
+
+namespace minidb {
+namespace storage {
+
+    uint16_t SlottedPage::get_u16(size_t offset) const {
+        uint16_t value = 0;
+        page_->read(offset, &value, sizeof(value));
+        return value;
+    }
+    
+    void SlottedPage::put_u16(size_t offset, uint16_t value) {
+        page_->write(offset, &value, sizeof(value));
+    }
+    
+    void SlottedPage::init() {
+        page_->clear();
+        put_u16(0, 0);                                              // slot_count
+        put_u16(sizeof(uint16_t), static_cast<uint16_t>(page_->get_size()));  // free_end
+        put_u16(2 * sizeof(uint16_t), 0);                           // live_bytes
+    }
+    
+    size_t SlottedPage::contiguous_free() const {
+        size_t directory_end = slot_offset(slot_count());
+        size_t end = free_end();
+        return end > directory_end ? end - directory_end : 0;
+    }
+    
+    SlotId SlottedPage::find_free_slot() const {
+        SlotId count = slot_count();
+        for (SlotId slot = 0; slot < count; slot++) {
+            if (get_u16(slot_offset(slot) + sizeof(uint16_t)) == 0) {
+                return slot;
+            }
+        }
+        return INVALID_SLOT_ID;
+    }
+    
+    size_t SlottedPage::available_space() const {
+        size_t used = HEADER_SIZE + slot_count() * SLOT_SIZE + live_bytes();
+        size_t total_free = page_->get_size() > used ? page_->get_size() - used : 0;
+        
+        // A new record needs a new slot unless a deleted one can be reused
+        if (find_free_slot() == INVALID_SLOT_ID) {
+            total_free = total_free > SLOT_SIZE ? total_free - SLOT_SIZE : 0;
+        }
+        return total_free;
+    }
+    
+    bool SlottedPage::is_live(SlotId slot) const {
+        return slot < slot_count() && get_u16(slot_offset(slot) + sizeof(uint16_t)) != 0;
+    }
+    
+    SlotId SlottedPage::insert(const char* data, size_t length) {
+        if (length == 0 || length > available_space()) {
+            return INVALID_SLOT_ID;
+        }
+        
+        SlotId slot = find_free_slot();
+        size_t needed = length + (slot == INVALID_SLOT_ID ? SLOT_SIZE : 0);
+        
+        if (contiguous_free() < needed) {
+            compact();
+        }
+        
+        if (slot == INVALID_SLOT_ID) {
+            slot = slot_count();
+            put_u16(0, static_cast<uint16_t>(slot + 1));
+        }
+        
+        uint16_t offset = static_cast<uint16_t>(free_end() - length);
+        page_->write(offset, data, length);
+        put_u16(sizeof(uint16_t), offset);
+        put_u16(2 * sizeof(uint16_t), static_cast<uint16_t>(live_bytes() + length));
+        
+        put_u16(slot_offset(slot), offset);
+        put_u16(slot_offset(slot) + sizeof(uint16_t), static_cast<uint16_t>(length));
+        
+        return slot;
+    }
+    
+    bool SlottedPage::read(SlotId slot, std::vector<char>& record) const {
+        if (!is_live(slot)) {
+            return false;
+        }
+        
+        uint16_t offset = get_u16(slot_offset(slot));
+        uint16_t length = get_u16(slot_offset(slot) + sizeof(uint16_t));
+        
+        record.resize(length);
+        return page_->read(offset, record.data(), length);
+    }
+    
+    bool SlottedPage::update(SlotId slot, const char* data, size_t length) {
+        if (!is_live(slot) || length == 0) {
+            return false;
+        }
+        
+        uint16_t offset = get_u16(slot_offset(slot));
+        uint16_t old_length = get_u16(slot_offset(slot) + sizeof(uint16_t));
+        
+        // Shrinking or same size: overwrite in place
+        if (length <= old_length) {
+            page_->write(offset, data, length);
+            put_u16(slot_offset(slot) + sizeof(uint16_t), static_cast<uint16_t>(length));
+            put_u16(2 * sizeof(uint16_t), static_cast<uint16_t>(live_bytes() - old_length + length));
+            return true;
+        }
+        
+        // Growing: the old bytes become reclaimable, so they count as free
+        size_t used = HEADER_SIZE + slot_count() * SLOT_SIZE + live_bytes() - old_length;
+        if (used + length > page_->get_size()) {
+            return false;
+        }
+        
+        // Drop the old version, then re-place the record under the same slot
+        put_u16(slot_offset(slot) + sizeof(uint16_t), 0);
+        put_u16(2 * sizeof(uint16_t), static_cast<uint16_t>(live_bytes() - old_length));
+        
+        if (contiguous_free() < length) {
+            compact();
+        }
+        
+        uint16_t new_offset = static_cast<uint16_t>(free_end() - length);
+        page_->write(new_offset, data, length);
+        put_u16(sizeof(uint16_t), new_offset);
+        put_u16(2 * sizeof(uint16_t), static_cast<uint16_t>(live_bytes() + length));
+        put_u16(slot_offset(slot), new_offset);
+        put_u16(slot_offset(slot) + sizeof(uint16_t), static_cast<uint16_t>(length));
+        
+        return true;
+    }
+    
+    bool SlottedPage::erase(SlotId slot) {
+        if (!is_live(slot)) {
+            return false;
+        }
+        
+        uint16_t length = get_u16(slot_offset(slot) + sizeof(uint16_t));
+        put_u16(slot_offset(slot) + sizeof(uint16_t), 0);
+        put_u16(2 * sizeof(uint16_t), static_cast<uint16_t>(live_bytes() - length));
+        
+        // Trailing empty slots can be dropped from the directory entirely
+        SlotId count = slot_count();
+        while (count > 0 && get_u16(slot_offset(count - 1) + sizeof(uint16_t)) == 0) {
+            count--;
+        }
+        put_u16(0, count);
+        
+        if (count == 0) {
+            put_u16(sizeof(uint16_t), static_cast<uint16_t>(page_->get_size()));
+        }
+        
+        return true;
+    }
+    
+    void SlottedPage::compact() {
+        // Copy live records out in slot order, then pack them against the page end
+        SlotId count = slot_count();
+        std::vector<char> buffer(page_->get_size());
+        uint16_t end = static_cast<uint16_t>(page_->get_size());
+        
+        for (SlotId slot = 0; slot < count; slot++) {
+            uint16_t length = get_u16(slot_offset(slot) + sizeof(uint16_t));
+            if (length == 0) {
+                continue;
+            }
+            
+            uint16_t offset = get_u16(slot_offset(slot));
+            end = static_cast<uint16_t>(end - length);
+            page_->read(offset, buffer.data() + end, length);
+            put_u16(slot_offset(slot), end);
+        }
+        
+        size_t record_bytes = page_->get_size() - end;
+        page_->write(end, buffer.data() + end, record_bytes);
+        put_u16(sizeof(uint16_t), end);
+    }
+
+} // namespace storage
+} // namespace minidb
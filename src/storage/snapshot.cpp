@@ -0,0 +1,261 @@
+/**
+ * @file snapshot.cpp
+ * @brief Snapshot writer and memory-mapped reader
+ */
+
+#include "minidb/storage/snapshot.h"
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+    
+        constexpr char SNAPSHOT_MAGIC[8] = {'M', 'D', 'B', 'S', 'N', 'A', 'P', '\0'};
+        constexpr uint32_t SNAPSHOT_VERSION = 1;
+        
+        // magic, version, page size, page count, lsn, catalog offset and
+        // length, catalog crc
+        constexpr size_t HEADER_SIZE = 8 + 4 + 4 + 8 + 8 + 8 + 8 + 4;
+        
+        bool sync_stream(std::FILE* file) {
+            if (std::fflush(file) != 0) {
+                return false;
+            }
+#ifdef _WIN32
+            return ::_commit(::_fileno(file)) == 0;
+#else
+            return ::fsync(::fileno(file)) == 0;
+#endif
+        }
+        
+        // A rename is only durable once the directory holding it is synced
+        bool sync_parent_directory(const std::string& path) {
+#ifdef _WIN32
+            (void)path;
+            return true;  // NTFS journals the rename itself
+#else
+            size_t slash = path.find_last_of('/');
+            std::string directory = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+            int fd = ::open(directory.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            bool synced = ::fsync(fd) == 0;
+            ::close(fd);
+            return synced;
+#endif
+        }
+    
+    } // anonymous namespace
+    
+    // SnapshotWriter implementation
+    SnapshotWriter::SnapshotWriter(PageSize page_size)
+        : page_size_(page_size), file_(nullptr), page_count_(0), failed_(false) {
+    }
+    
+    SnapshotWriter::~SnapshotWriter() {
+        abandon();
+    }
+    
+    bool SnapshotWriter::open(const std::string& path) {
+        abandon();
+        
+        path_ = path;
+        temp_path_ = path + ".tmp";
+        file_ = std::fopen(temp_path_.c_str(), "wb");
+        if (file_ == nullptr) {
+            return false;
+        }
+        
+        // Page 0 is the header, filled in by commit()
+        std::vector<char> zeros(page_size_, 0);
+        failed_ = std::fwrite(zeros.data(), 1, zeros.size(), file_) != zeros.size();
+        page_count_ = 1;
+        catalog_.clear();
+        return !failed_;
+    }
+    
+    PageId SnapshotWriter::add_page(const char* data) {
+        if (file_ == nullptr || failed_) {
+            return INVALID_PAGE_ID;
+        }
+        
+        if (std::fwrite(data, 1, page_size_, file_) != page_size_) {
+            failed_ = true;
+            return INVALID_PAGE_ID;
+        }
+        return page_count_++;
+    }
+    
+    bool SnapshotWriter::commit(Lsn lsn) {
+        if (file_ == nullptr || failed_) {
+            abandon();
+            return false;
+        }
+        
+        uint64_t catalog_offset = static_cast<uint64_t>(page_count_) * page_size_;
+        std::vector<char> header;
+        ByteWriter writer(header);
+        writer.write_bytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        writer.write(SNAPSHOT_VERSION);
+        writer.write(static_cast<uint32_t>(page_size_));
+        writer.write(static_cast<uint64_t>(page_count_));
+        writer.write(static_cast<uint64_t>(lsn));
+        writer.write(catalog_offset);
+        writer.write(static_cast<uint64_t>(catalog_.size()));
+        writer.write(crc32(catalog_.data(), catalog_.size()));
+        
+        // The header goes in last so a torn write cannot look complete
+        bool written = std::fwrite(catalog_.data(), 1, catalog_.size(), file_) == catalog_.size() &&
+                       sync_stream(file_) &&
+                       std::fseek(file_, 0, SEEK_SET) == 0 &&
+                       std::fwrite(header.data(), 1, header.size(), file_) == header.size() &&
+                       sync_stream(file_);
+        bool closed = std::fclose(file_) == 0;
+        file_ = nullptr;
+        if (!written || !closed) {
+            std::remove(temp_path_.c_str());
+            return false;
+        }
+        
+#ifdef _WIN32
+        // rename() does not replace an existing file on Windows
+        std::remove(path_.c_str());
+#endif
+        if (std::rename(temp_path_.c_str(), path_.c_str()) != 0) {
+            std::remove(temp_path_.c_str());
+            return false;
+        }
+        return sync_parent_directory(path_);
+    }
+    
+    void SnapshotWriter::abandon() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+            std::remove(temp_path_.c_str());
+        }
+        failed_ = false;
+    }
+    
+    // Snapshot implementation
+    Snapshot::Snapshot()
+        : data_(nullptr), size_(0), page_count_(0), lsn_(INVALID_LSN), catalog_offset_(0), catalog_size_(0) {
+    }
+    
+    Snapshot::~Snapshot() {
+        close();
+    }
+    
+    bool Snapshot::exists(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::fclose(file);
+        return true;
+    }
+    
+    bool Snapshot::open(const std::string& path, PageSize page_size) {
+        close();
+        
+#ifdef _WIN32
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::fseek(file, 0, SEEK_END);
+        long long length = _ftelli64(file);
+        std::fseek(file, 0, SEEK_SET);
+        contents_.resize(length > 0 ? static_cast<size_t>(length) : 0);
+        bool read = std::fread(contents_.data(), 1, contents_.size(), file) == contents_.size();
+        std::fclose(file);
+        if (!read || contents_.empty()) {
+            contents_.clear();
+            return false;
+        }
+        data_ = contents_.data();
+        size_ = contents_.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        
+        // The mapping outlives the descriptor; pages fault in on first access
+        void* mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(mapping);
+        size_ = static_cast<size_t>(st.st_size);
+#endif
+        
+        // Validate the header before trusting any offset in it
+        ByteReader reader(data_, size_);
+        char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+        uint32_t version = 0;
+        uint32_t stored_page_size = 0;
+        uint64_t page_count = 0;
+        uint64_t lsn = 0;
+        uint64_t catalog_offset = 0;
+        uint64_t catalog_size = 0;
+        uint32_t catalog_crc = 0;
+        bool valid = size_ >= HEADER_SIZE &&
+                     reader.read_bytes(magic, sizeof(magic)) &&
+                     std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0 &&
+                     reader.read(version) && version == SNAPSHOT_VERSION &&
+                     reader.read(stored_page_size) && stored_page_size == page_size &&
+                     reader.read(page_count) && reader.read(lsn) &&
+                     reader.read(catalog_offset) && reader.read(catalog_size) && reader.read(catalog_crc) &&
+                     page_count >= 1 && catalog_offset == page_count * page_size &&
+                     catalog_offset <= size_ && catalog_size <= size_ - catalog_offset &&
+                     crc32(data_ + catalog_offset, static_cast<size_t>(catalog_size)) == catalog_crc;
+        if (!valid) {
+            close();
+            return false;
+        }
+        
+        page_count_ = static_cast<PageId>(page_count);
+        lsn_ = lsn;
+        catalog_offset_ = static_cast<size_t>(catalog_offset);
+        catalog_size_ = static_cast<size_t>(catalog_size);
+        return true;
+    }
+    
+    void Snapshot::close() {
+        if (data_ != nullptr) {
+#ifdef _WIN32
+            contents_.clear();
+            contents_.shrink_to_fit();
+#else
+            ::munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+        data_ = nullptr;
+        size_ = 0;
+        page_count_ = 0;
+        lsn_ = INVALID_LSN;
+        catalog_offset_ = 0;
+        catalog_size_ = 0;
+    }
+
+} // namespace storage
+} // namespace minidb
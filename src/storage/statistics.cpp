@@ -0,0 +1,153 @@
+/**
+ * @file statistics.cpp
+ * @brief Column statistics and the estimates drawn from them
+ */
+
+#include "minidb/storage/statistics.h"
+#include <algorithm>
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+    
+        bool is_numeric(const Value& value) {
+            return value.get_type() == ColumnType::INTEGER || value.get_type() == ColumnType::REAL;
+        }
+        
+        double as_double(const Value& value) {
+            return value.get_type() == ColumnType::INTEGER ? static_cast<double>(value.get_int()) : value.get_real();
+        }
+        
+        // Where key falls between two bounds, as a fraction; text has no
+        // distance, so it is taken to be halfway
+        double interpolate(const Value& low, const Value& high, const Value& key) {
+            if (!is_numeric(low) || !is_numeric(high) || !is_numeric(key)) {
+                return 0.5;
+            }
+            double width = as_double(high) - as_double(low);
+            if (width <= 0.0) {
+                return 1.0;
+            }
+            return std::clamp((as_double(key) - as_double(low)) / width, 0.0, 1.0);
+        }
+    
+    } // anonymous namespace
+    
+    double ColumnStatistics::equal_fraction(const Value& key) const {
+        if (key.is_null() || histogram.empty() || key < min || max < key) {
+            return 0.0;
+        }
+        
+        // Common values are known exactly; the rest share what is left evenly
+        double common = 0.0;
+        for (const auto& [value, fraction] : most_common) {
+            if (value == key) {
+                return fraction;
+            }
+            common += fraction;
+        }
+        uint64_t others = distinct_count > most_common.size() ? distinct_count - most_common.size() : 1;
+        return std::max(0.0, 1.0 - null_fraction - common) / static_cast<double>(others);
+    }
+    
+    double ColumnStatistics::range_fraction(const Value* lower, const Value* upper) const {
+        if (histogram.empty() || (lower && lower->is_null()) || (upper && upper->is_null())) {
+            return 0.0;
+        }
+        
+        // NULLs fall in no range; of the rest, those below lower are out,
+        // and those up to and including upper are in
+        double non_null = 1.0 - null_fraction;
+        double from = lower ? fraction_below(*lower) : 0.0;
+        double to = 1.0;
+        if (upper) {
+            to = non_null > 0.0 ? fraction_below(*upper) + equal_fraction(*upper) / non_null : 0.0;
+        }
+        return non_null * std::clamp(to - from, 0.0, 1.0);
+    }
+    
+    double ColumnStatistics::fraction_below(const Value& key) const {
+        if (!(histogram.front() < key)) {
+            return 0.0;
+        }
+        if (histogram.back() < key || histogram.size() == 1) {
+            return 1.0;
+        }
+        
+        // The last bound below key starts the bucket key falls in
+        size_t buckets = histogram.size() - 1;
+        size_t bucket = static_cast<size_t>(
+            std::lower_bound(histogram.begin(), histogram.end(), key) - histogram.begin()) - 1;
+        double within = interpolate(histogram[bucket], histogram[bucket + 1], key);
+        return std::min(1.0, (static_cast<double>(bucket) + within) / static_cast<double>(buckets));
+    }
+    
+    StatisticsBuilder::StatisticsBuilder(size_t column_count) : values_(column_count), rows_(0) {
+    }
+    
+    void StatisticsBuilder::add(const Row& row) {
+        rows_++;
+        for (size_t column = 0; column < values_.size() && column < row.size(); column++) {
+            const Value& value = row.get_value(column);
+            if (!value.is_null()) {
+                values_[column].push_back(value);
+            }
+        }
+    }
+    
+    TableStatistics StatisticsBuilder::finish(size_t histogram_buckets) {
+        TableStatistics statistics;
+        statistics.row_count = rows_;
+        statistics.columns.resize(values_.size());
+        
+        for (size_t column = 0; column < values_.size(); column++) {
+            std::vector<Value>& values = values_[column];
+            ColumnStatistics& stats = statistics.columns[column];
+            if (rows_ == 0) {
+                continue;
+            }
+            stats.null_fraction = static_cast<double>(rows_ - values.size()) / static_cast<double>(rows_);
+            if (values.empty()) {
+                continue;
+            }
+            
+            std::sort(values.begin(), values.end());
+            stats.min = values.front();
+            stats.max = values.back();
+            
+            // Runs of equal values give the distinct count and the common values
+            size_t n = values.size();
+            std::vector<std::pair<size_t, size_t>> heavy;  // Run length, start
+            for (size_t start = 0; start < n;) {
+                size_t end = start + 1;
+                while (end < n && values[end] == values[start]) {
+                    end++;
+                }
+                stats.distinct_count++;
+                if ((end - start) * histogram_buckets >= n) {
+                    heavy.emplace_back(end - start, start);
+                }
+                start = end;
+            }
+            std::stable_sort(heavy.begin(), heavy.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+            for (size_t i = 0; i < heavy.size() && i < MAX_MOST_COMMON; i++) {
+                stats.most_common.emplace_back(values[heavy[i].second],
+                                               static_cast<double>(heavy[i].first) / static_cast<double>(rows_));
+            }
+            
+            // Bounds at evenly spaced ranks; a value spanning several buckets
+            // repeats as a bound, which is how the skew shows up in ranges
+            size_t buckets = std::max<size_t>(1, std::min(histogram_buckets, n - 1));
+            for (size_t bound = 0; bound <= buckets; bound++) {
+                stats.histogram.push_back(values[bound * (n - 1) / buckets]);
+            }
+            
+            // The values are no longer needed
+            std::vector<Value>().swap(values);
+        }
+        return statistics;
+    }
+
+} // namespace storage
+} // namespace minidb
@@ -4,8 +4,22 @@
  */
 
 #include "minidb/storage/table.h"
+#include "minidb/storage/column_store.h"
+#include "minidb/storage/serialization.h"
+#include "minidb/storage/slotted_page.h"
+#include "minidb/storage/snapshot.h"
+#include "minidb/storage/statistics.h"
+#include "minidb/storage/transaction.h"
+#include "minidb/storage/wal.h"
+#include "minidb/utils/metrics.h"
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <string_view>
+#include <unordered_map>
 
 namespace minidb {
 namespace storage {
@@ -70,19 +84,105 @@ namespace storage {
         return primary_key_count <= 1;
     }
     
-    // Value implementation
-    std::string Value::to_string() const {
-        if (is_null_) {
-            return "NULL";
+    // Value implementation. Numbers live in the payload itself and TEXT up
+    // to INLINE_TEXT bytes is stored inline, so only long strings allocate.
+    Value::Value() : type_(ColumnType::NULL_TYPE), size_(0) {
+        payload_.int_val = 0;
+    }
+    
+    Value::Value(int64_t value) : type_(ColumnType::INTEGER), size_(0) {
+        payload_.int_val = value;
+    }
+    
+    Value::Value(double value) : type_(ColumnType::REAL), size_(0) {
+        payload_.real_val = value;
+    }
+    
+    Value::Value(std::string_view value) : type_(ColumnType::TEXT), size_(0) {
+        assign_text(value);
+    }
+    
+    Value::Value(const std::string& value) : Value(std::string_view(value)) {
+    }
+    
+    Value::Value(const char* value) : Value(std::string_view(value)) {
+    }
+    
+    Value::Value(const Value& other) : type_(other.type_), size_(0), payload_(other.payload_) {
+        if (type_ == ColumnType::TEXT) {
+            assign_text(other.get_string());
         }
-        
+    }
+    
+    Value::Value(Value&& other) noexcept : type_(other.type_), size_(other.size_), payload_(other.payload_) {
+        // Long text now belongs to this value
+        other.type_ = ColumnType::NULL_TYPE;
+        other.size_ = 0;
+    }
+    
+    Value& Value::operator=(const Value& other) {
+        if (this != &other) {
+            release();
+            type_ = other.type_;
+            payload_ = other.payload_;
+            if (type_ == ColumnType::TEXT) {
+                assign_text(other.get_string());
+            }
+        }
+        return *this;
+    }
+    
+    Value& Value::operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            type_ = other.type_;
+            size_ = other.size_;
+            payload_ = other.payload_;
+            other.type_ = ColumnType::NULL_TYPE;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+    
+    Value::~Value() {
+        release();
+    }
+    
+    void Value::assign_text(std::string_view text) {
+        // Callers have released any previous long text
+        size_ = static_cast<uint32_t>(text.size());
+        char* chars = payload_.inline_chars;
+        if (size_ > INLINE_TEXT) {
+            chars = payload_.heap_chars = new char[size_];
+        }
+        if (size_ > 0) {
+            std::memcpy(chars, text.data(), size_);
+        }
+    }
+    
+    void Value::release() {
+        if (type_ == ColumnType::TEXT && size_ > INLINE_TEXT) {
+            delete[] payload_.heap_chars;
+        }
+        type_ = ColumnType::NULL_TYPE;
+        size_ = 0;
+    }
+    
+    std::string_view Value::get_string() const {
+        if (type_ != ColumnType::TEXT) {
+            return std::string_view();
+        }
+        return std::string_view(size_ > INLINE_TEXT ? payload_.heap_chars : payload_.inline_chars, size_);
+    }
+    
+    std::string Value::to_string() const {
         switch (type_) {
             case ColumnType::INTEGER:
-                return std::to_string(int_val_);
+                return std::to_string(payload_.int_val);
             case ColumnType::TEXT:
-                return str_val_;
+                return std::string(get_string());
             case ColumnType::REAL:
-                return std::to_string(real_val_);
+                return std::to_string(payload_.real_val);
             case ColumnType::NULL_TYPE:
                 return "NULL";
             default:
@@ -92,9 +192,9 @@ namespace storage {
     
     int Value::compare(const Value& other) const {
         // Handle null values
-        if (is_null_ && other.is_null_) return 0;
-        if (is_null_) return -1;
-        if (other.is_null_) return 1;
+        if (is_null() && other.is_null()) return 0;
+        if (is_null()) return -1;
+        if (other.is_null()) return 1;
         
         // Type mismatch comparison (simplified)
         if (type_ != other.type_) {
@@ -103,195 +203,1685 @@ namespace storage {
         
         switch (type_) {
             case ColumnType::INTEGER:
-                if (int_val_ < other.int_val_) return -1;
-                if (int_val_ > other.int_val_) return 1;
+                if (payload_.int_val < other.payload_.int_val) return -1;
+                if (payload_.int_val > other.payload_.int_val) return 1;
                 return 0;
-                
-            case ColumnType::TEXT:
-                return str_val_.compare(other.str_val_);
-                
+            
+            case ColumnType::TEXT: {
+                int order = get_string().compare(other.get_string());
+                return order < 0 ? -1 : (order > 0 ? 1 : 0);
+            }
+            
             case ColumnType::REAL:
-                if (real_val_ < other.real_val_) return -1;
-                if (real_val_ > other.real_val_) return 1;
+                if (payload_.real_val < other.payload_.real_val) return -1;
+                if (payload_.real_val > other.payload_.real_val) return 1;
                 return 0;
-                
+            
             default:
                 return 0;
         }
     }
     
+    size_t Value::hash() const {
+        // Equal values hash alike: compare() says -0.0 == 0.0
+        size_t seed = static_cast<size_t>(type_);
+        switch (type_) {
+            case ColumnType::INTEGER:
+                return seed ^ std::hash<int64_t>()(payload_.int_val);
+            case ColumnType::REAL:
+                return seed ^ std::hash<double>()(payload_.real_val == 0.0 ? 0.0 : payload_.real_val);
+            case ColumnType::TEXT:
+                return seed ^ std::hash<std::string_view>()(get_string());
+            default:
+                return seed;
+        }
+    }
+    
     // Index implementations (basic versions)
+    void Index::insert_batch(std::vector<std::pair<Value, uint64_t>> entries) {
+        for (const auto& [key, row_id] : entries) {
+            insert(key, row_id);
+        }
+    }
+    
+    void Index::scan_entries(const Value* start, const Value* end,
+                             const std::function<bool(const Value&, uint64_t)>& visitor) {
+        // Unordered indexes have no key order to walk
+    }
+    
+    void Index::scan_entries_reverse(const Value* start, const Value* end,
+                                     const std::function<bool(const Value&, uint64_t)>& visitor) {
+    }
+    
     bool BTreeIndex::insert(const Value& key, uint64_t row_id) {
         return btree_.insert(std::make_pair(key, row_id));
     }
     
+    void BTreeIndex::insert_batch(std::vector<std::pair<Value, uint64_t>> entries) {
+        // Batches exported by another B-Tree (snapshots) arrive sorted already
+        if (!std::is_sorted(entries.begin(), entries.end())) {
+            std::sort(entries.begin(), entries.end());
+        }
+        
+        // A batch that is small next to the tree goes in key by key (sorted,
+        // so consecutive descents share a path); anything larger rebuilds
+        // the tree bottom-up from the merged entries
+        if (btree_.empty()) {
+            btree_.bulk_load(std::move(entries));
+        } else if (entries.size() * BULK_MERGE_RATIO < btree_.size()) {
+            for (const auto& entry : entries) {
+                btree_.insert(entry);
+            }
+        } else {
+            btree_.merge(entries);
+        }
+    }
+    
+    const char* BTreeIndex::type_name() const {
+        return "btree";
+    }
+    
+    void BTreeIndex::export_entries(std::vector<std::pair<Value, uint64_t>>& entries) const {
+        entries.reserve(entries.size() + btree_.size());
+        for (auto it = btree_.begin(); it.valid(); it.next()) {
+            entries.push_back(*it);
+        }
+    }
+    
     bool BTreeIndex::remove(const Value& key) {
-        // Simplified - in full implementation would need to find exact pair
-        return false;  // Not implemented for simplicity
+        // Drops every entry for key
+        std::vector<uint64_t> row_ids = find_all(key);
+        for (uint64_t row_id : row_ids) {
+            btree_.remove(std::make_pair(key, row_id));
+        }
+        return !row_ids.empty();
+    }
+    
+    bool BTreeIndex::remove(const Value& key, uint64_t row_id) {
+        return btree_.remove(std::make_pair(key, row_id));
     }
     
     uint64_t BTreeIndex::find(const Value& key) {
-        // Simplified search
-        bool found = btree_.search(std::make_pair(key, 0));
-        return found ? 1 : 0;  // Simplified return
+        // Lower bound of (key, 0) is the key's entry with the smallest row id
+        auto it = btree_.seek(std::make_pair(key, uint64_t{0}));
+        if (it.valid() && it->first == key) {
+            return it->second;
+        }
+        return 0;
+    }
+    
+    std::vector<uint64_t> BTreeIndex::find_all(const Value& key) {
+        return range_query(key, key);
     }
     
     std::vector<uint64_t> BTreeIndex::range_query(const Value& start, const Value& end) {
         std::vector<uint64_t> results;
-        // Simplified implementation
+        
+        // Entries are ordered by (key, row_id) and row ids start at 1, so
+        // (start, 0) sorts before every entry for start
+        btree_.range_scan(std::make_pair(start, uint64_t{0}), std::make_pair(end, UINT64_MAX),
+                          [&results](const std::pair<Value, uint64_t>& entry) {
+            results.push_back(entry.second);
+            return true;
+        });
+        
+        return results;
+    }
+    
+    std::vector<uint64_t> BTreeIndex::scan_range(const Value* start, const Value* end) {
+        std::vector<uint64_t> results;
+        
+        auto it = start ? btree_.seek(std::make_pair(*start, uint64_t{0})) : btree_.begin();
+        for (; it.valid() && (end == nullptr || it->first <= *end); it.next()) {
+            results.push_back(it->second);
+        }
+        
         return results;
     }
     
+    void BTreeIndex::scan_entries(const Value* start, const Value* end,
+                                  const std::function<bool(const Value&, uint64_t)>& visitor) {
+        auto it = start ? btree_.seek(std::make_pair(*start, uint64_t{0})) : btree_.begin();
+        for (; it.valid() && (end == nullptr || it->first <= *end); it.next()) {
+            if (!visitor(it->first, it->second)) {
+                return;
+            }
+        }
+    }
+    
+    void BTreeIndex::scan_entries_reverse(const Value* start, const Value* end,
+                                          const std::function<bool(const Value&, uint64_t)>& visitor) {
+        // Row ids never reach UINT64_MAX, so this starts at end's last entry
+        auto it = end ? btree_.seek_before(std::make_pair(*end, UINT64_MAX)) : btree_.last();
+        for (; it.valid() && (start == nullptr || *start <= it->first); it = btree_.seek_before(*it)) {
+            if (!visitor(it->first, it->second)) {
+                return;
+            }
+        }
+    }
+    
+    bool BTreeIndex::key_bounds(Value& min, Value& max) {
+        // NULL sorts before every other key and is skipped; (NULL, max id)
+        // lands just past the NULL entries
+        auto it = btree_.seek(std::make_pair(Value(), UINT64_MAX));
+        while (it.valid() && it->first.is_null()) {
+            it.next();
+        }
+        if (!it.valid()) {
+            return false;
+        }
+        
+        min = it->first;
+        max = btree_.last()->first;
+        return true;
+    }
+    
     bool HashIndex::insert(const Value& key, uint64_t row_id) {
-        return hashmap_.insert(key, row_id);
+        // The first row for a key stays in the main map so unique keys cost
+        // a single probe; further rows with the same key go to duplicates_
+        if (!hashmap_.try_emplace(key, row_id).second) {
+            duplicates_[key].push_back(row_id);
+        }
+        return true;
+    }
+    
+    const char* HashIndex::type_name() const {
+        return "hash";
+    }
+    
+    void HashIndex::export_entries(std::vector<std::pair<Value, uint64_t>>& entries) const {
+        for (const auto& entry : hashmap_) {
+            entries.emplace_back(entry.key, entry.value);
+        }
+        for (const auto& entry : duplicates_) {
+            for (uint64_t row_id : entry.value) {
+                entries.emplace_back(entry.key, row_id);
+            }
+        }
     }
     
     bool HashIndex::remove(const Value& key) {
+        duplicates_.remove(key);
         return hashmap_.remove(key);
     }
     
+    bool HashIndex::remove(const Value& key, uint64_t row_id) {
+        uint64_t* result = hashmap_.find(key);
+        if (result == nullptr) {
+            return false;
+        }
+        
+        std::vector<uint64_t>* extra = duplicates_.find(key);
+        if (*result == row_id) {
+            if (extra == nullptr) {
+                return hashmap_.remove(key);
+            }
+            // Promote a duplicate into the main map
+            *result = extra->back();
+            extra->pop_back();
+        } else {
+            if (extra == nullptr) {
+                return false;
+            }
+            auto it = std::find(extra->begin(), extra->end(), row_id);
+            if (it == extra->end()) {
+                return false;
+            }
+            *it = extra->back();
+            extra->pop_back();
+        }
+        
+        if (extra->empty()) {
+            duplicates_.remove(key);
+        }
+        return true;
+    }
+    
     uint64_t HashIndex::find(const Value& key) {
         const uint64_t* result = hashmap_.find(key);
         return result ? *result : 0;
     }
     
+    std::vector<uint64_t> HashIndex::find_all(const Value& key) {
+        std::vector<uint64_t> results;
+        const uint64_t* result = hashmap_.find(key);
+        if (result != nullptr) {
+            results.push_back(*result);
+            const std::vector<uint64_t>* extra = duplicates_.find(key);
+            if (extra != nullptr) {
+                results.insert(results.end(), extra->begin(), extra->end());
+            }
+        }
+        return results;
+    }
+    
     std::vector<uint64_t> HashIndex::range_query(const Value& start, const Value& end) {
         // Hash index doesn't support efficient range queries
         return std::vector<uint64_t>();
     }
     
+    std::vector<uint64_t> HashIndex::scan_range(const Value* start, const Value* end) {
+        return std::vector<uint64_t>();
+    }
+    
+    bool HashIndex::key_bounds(Value& min, Value& max) {
+        return false;  // Keys are unordered
+    }
+    
+    namespace {
+    
+        // Process-wide counts of index probes, for the metrics registry
+        utils::Counter& index_lookup_counter() {
+            static utils::Counter& counter = utils::MetricsRegistry::global().counter("index.lookups");
+            return counter;
+        }
+        
+        utils::Counter& index_range_scan_counter() {
+            static utils::Counter& counter = utils::MetricsRegistry::global().counter("index.range_scans");
+            return counter;
+        }
+        
+        std::unique_ptr<Index> make_index(const std::string& index_type) {
+            if (index_type == "btree") {
+                return std::make_unique<BTreeIndex>();
+            }
+            if (index_type == "hash") {
+                return std::make_unique<HashIndex>();
+            }
+            return nullptr;
+        }
+        
+        // Runs a write outside any transaction as a transaction of its own,
+        // so readers with open snapshots still see the table as it was. A
+        // write that failed, conflicted or could not be logged is undone and
+        // reported as 0/false.
+        template<typename Write>
+        auto autocommit(TransactionManager& transactions, Write write) {
+            std::unique_ptr<Transaction> txn = transactions.begin();
+            auto result = write(txn.get());
+            if (!result || txn->has_conflict()) {
+                transactions.rollback(*txn);
+                return decltype(result){};
+            }
+            if (!transactions.commit(*txn)) {
+                return decltype(result){};  // commit() has already rolled back
+            }
+            return result;
+        }
+        
+        bool is_visible(const RecordVersion& version, const Transaction* reader) {
+            return version.begin.visible_to(reader) && !version.end.visible_to(reader);
+        }
+        
+        bool same_record(const RecordId& a, const RecordId& b) {
+            return a.page_id == b.page_id && a.slot == b.slot;
+        }
+        
+        // Keeps a heap page pinned and latched for the guard's lifetime.
+        // Pages are pinned before they are latched and unlatched before they
+        // are unpinned, so the buffer pool never evicts a latched page.
+        class PinnedPage {
+        public:
+            enum class Mode { SHARED, EXCLUSIVE };
+            
+            PinnedPage(PageManager* page_manager, PageId page_id, Mode mode)
+                : page_manager_(page_manager), page_id_(page_id), mode_(mode),
+                  page_(page_manager->fetch_page(page_id)) {
+                if (page_) {
+                    if (mode_ == Mode::EXCLUSIVE) page_->lock();
+                    else page_->lock_shared();
+                }
+            }
+            ~PinnedPage() {
+                if (page_) {
+                    if (mode_ == Mode::EXCLUSIVE) page_->unlock();
+                    else page_->unlock_shared();
+                    page_manager_->unpin_page(page_id_);
+                }
+            }
+            
+            PinnedPage(const PinnedPage&) = delete;
+            PinnedPage& operator=(const PinnedPage&) = delete;
+            
+            Page* get() const { return page_; }
+        
+        private:
+            PageManager* page_manager_;
+            PageId page_id_;
+            Mode mode_;
+            Page* page_;
+        };
+    
+    } // anonymous namespace
+    
     // Table implementation
     Table::Table(const TableSchema& schema, PageManager* page_manager)
-        : schema_(schema), page_manager_(page_manager), next_row_id_(1) {
+        : schema_(schema), page_manager_(page_manager), wal_(nullptr), transactions_(nullptr),
+          next_row_id_(1), row_count_(0) {
+        if (schema_.get_storage_format() == StorageFormat::COLUMNAR) {
+            column_store_ = std::make_unique<ColumnStore>(schema_);
+        }
+    }
+    
+    Table::~Table() {
+        release_pages();
     }
     
-    uint64_t Table::insert_row(const Row& row) {
+    uint64_t Table::insert_row(const Row& row, Transaction* txn) {
         // Validate row has correct number of columns
         if (row.size() != schema_.column_count()) {
             return 0;  // Invalid row
         }
+        if (txn == nullptr && versioned()) {
+            return autocommit(*transactions_, [&](Transaction* local) { return insert_row(row, local); });
+        }
         
-        // Create new row with assigned ID
-        Row new_row = row;
-        new_row.set_id(next_row_id_++);
-        
-        // Add to storage
-        rows_.push_back(new_row);
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
         
-        // Update indices
-        for (auto& [column_name, index] : indices_) {
-            size_t column_index = schema_.get_column_index(column_name);
-            if (column_index != SIZE_MAX && column_index < row.size()) {
-                index->insert(row.get_value(column_index), new_row.get_id());
-            }
+        uint64_t row_id = next_row_id_;
+        if (!insert_with_id(row, row_id, txn)) {
+            return 0;  // Row too large or buffer pool exhausted
         }
+        next_row_id_++;
         
-        return new_row.get_id();
+        return row_id;
     }
     
-    bool Table::update_row(uint64_t row_id, const Row& new_row) {
-        // Find existing row
-        auto it = std::find_if(rows_.begin(), rows_.end(),
-            [row_id](const Row& r) { return r.get_id() == row_id; });
+    bool Table::restore_row(const Row& row) {
+        if (row.size() != schema_.column_count() || row.get_id() == 0) {
+            return false;
+        }
         
-        if (it == rows_.end()) {
-            return false;  // Row not found
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        if (!insert_with_id(row, row.get_id(), nullptr)) {
+            return false;
         }
+        next_row_id_ = std::max(next_row_id_, row.get_id() + 1);
         
-        // Update indices (remove old, add new)
+        return true;
+    }
+    
+    size_t Table::insert_rows(const std::vector<Row>& rows, Transaction* txn) {
+        if (txn == nullptr && versioned()) {
+            return autocommit(*transactions_, [&](Transaction* local) { return insert_rows(rows, local); });
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        // Index maintenance is deferred: entries are gathered per index and
+        // handed over in one batch once the rows are stored
+        std::vector<std::pair<size_t, Index*>> targets;
         for (auto& [column_name, index] : indices_) {
-            size_t column_index = schema_.get_column_index(column_name);
-            if (column_index != SIZE_MAX) {
-                if (column_index < it->size()) {
-                    index->remove(it->get_value(column_index));
-                }
-                if (column_index < new_row.size()) {
-                    index->insert(new_row.get_value(column_index), row_id);
+            targets.emplace_back(schema_.get_column_index(column_name), index.get());
+        }
+        std::vector<std::vector<std::pair<Value, uint64_t>>> entries(targets.size());
+        
+        size_t inserted = 0;
+        for (const Row& row : rows) {
+            uint64_t row_id = next_row_id_;
+            if (row.size() != schema_.column_count() || !store_row(row, row_id, txn)) {
+                break;  // Rows before this one stay inserted
+            }
+            track_insert(row_id, txn);
+            next_row_id_++;
+            inserted++;
+            
+            for (size_t i = 0; i < targets.size(); i++) {
+                if (targets[i].first < row.size()) {
+                    entries[i].emplace_back(row.get_value(targets[i].first), row_id);
                 }
             }
         }
         
-        // Update the row
-        *it = new_row;
-        it->set_id(row_id);  // Preserve row ID
+        for (size_t i = 0; i < targets.size(); i++) {
+            targets[i].second->insert_batch(std::move(entries[i]));
+        }
+        return inserted;
+    }
+    
+    bool Table::insert_with_id(const Row& row, uint64_t row_id, Transaction* txn) {
+        if (!store_row(row, row_id, txn)) {
+            return false;
+        }
+        
+        track_insert(row_id, txn);
+        index_row(row, row_id);
+        return true;
+    }
+    
+    bool Table::store_row(const Row& row, uint64_t row_id, Transaction* txn) {
+        std::vector<char> record;
+        encode_row(row, row_id, record);
+        if (column_store_ ? column_store_->contains(row_id)
+                          : !record_fits(record) || row_directory_.contains(row_id)) {
+            return false;
+        }
+        
+        // Log before the heap page is dirtied
+        log_change(LogRecordType::INSERT, record, txn);
         
+        // Add to storage
+        bool stored;
+        if (column_store_) {
+            stored = column_store_->append(row, row_id);
+        } else {
+            RecordId location = place_record(record);
+            stored = location.is_valid() && row_directory_.insert(row_id, location);
+        }
+        if (!stored) {
+            // The logged insert never happened; cancel it for replay
+            log_row_id(LogRecordType::DELETE, row_id, txn);
+            return false;
+        }
+        row_count_++;
         return true;
     }
     
-    bool Table::delete_row(uint64_t row_id) {
-        auto it = std::find_if(rows_.begin(), rows_.end(),
-            [row_id](const Row& r) { return r.get_id() == row_id; });
+    void Table::track_insert(uint64_t row_id, Transaction* txn) {
+        if (txn != nullptr && versioned()) {
+            // Nobody else sees the row until txn commits
+            RecordVersion version{*row_directory_.find(row_id), txn->stamp(), VersionStamp()};
+            versions_.try_emplace(row_id).first->push_back(std::move(version));
+            txn->record_write(this, row_id);
+        }
+    }
+    
+    bool Table::update_row(uint64_t row_id, const Row& new_row, Transaction* txn) {
+        if (txn == nullptr && versioned()) {
+            return autocommit(*transactions_, [&](Transaction* local) { return update_row(row_id, new_row, local); });
+        }
         
-        if (it == rows_.end()) {
-            return false;  // Row not found
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        return update_unlocked(row_id, new_row, txn);
+    }
+    
+    size_t Table::update_rows(const std::vector<Row>& rows, Transaction* txn) {
+        if (txn == nullptr && versioned()) {
+            return autocommit(*transactions_, [&](Transaction* local) { return update_rows(rows, local); });
+        }
+        
+        // One latch acquisition for the whole batch; each row carries the
+        // id of the row it replaces
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        size_t updated = 0;
+        for (const Row& row : rows) {
+            if (row.size() != schema_.column_count() || !update_unlocked(row.get_id(), row, txn)) {
+                break;  // Rows before this one stay updated
+            }
+            updated++;
+        }
+        return updated;
+    }
+    
+    bool Table::update_unlocked(uint64_t row_id, const Row& new_row, Transaction* txn) {
+        if (txn != nullptr && versioned()) {
+            return update_version(row_id, new_row, *txn);
+        }
+        
+        // Find existing row
+        Row old_row;
+        RecordId location;
+        if (column_store_) {
+            if (!column_store_->get(row_id, old_row)) {
+                return false;  // Row not found
+            }
+        } else {
+            location = locate_row(row_id, &old_row);
+            if (!location.is_valid()) {
+                return false;  // Row not found
+            }
+        }
+        
+        std::vector<char> record;
+        encode_row(new_row, row_id, record);
+        if (!column_store_ && !record_fits(record)) {
+            return false;
         }
         
-        // Remove from indices
+        // Log before the heap page is dirtied; if the update then fails,
+        // log the old row again so replay ends in the same state
+        log_change(LogRecordType::UPDATE, record, txn);
+        auto log_undo = [&]() {
+            if (wal_ != nullptr) {
+                std::vector<char> old_record;
+                encode_row(old_row, row_id, old_record);
+                log_change(LogRecordType::UPDATE, old_record, txn);
+            }
+        };
+        
+        bool stored = column_store_ ? column_store_->update(row_id, new_row)
+                                    : update_record(row_id, location, record);
+        if (!stored) {
+            log_undo();
+            return false;
+        }
+        
+        // Update indices (remove old, add new)
         for (auto& [column_name, index] : indices_) {
             size_t column_index = schema_.get_column_index(column_name);
-            if (column_index != SIZE_MAX && column_index < it->size()) {
-                index->remove(it->get_value(column_index));
+            if (column_index == SIZE_MAX) {
+                continue;
+            }
+            if (column_index < old_row.size() && column_index < new_row.size() &&
+                old_row.get_value(column_index) == new_row.get_value(column_index)) {
+                continue;  // Indexed value unchanged
+            }
+            if (column_index < old_row.size()) {
+                index->remove(old_row.get_value(column_index), row_id);
+            }
+            if (column_index < new_row.size()) {
+                index->insert(new_row.get_value(column_index), row_id);
             }
         }
         
-        // Remove from storage
-        rows_.erase(it);
         return true;
     }
     
-    const Row* Table::get_row(uint64_t row_id) const {
-        auto it = std::find_if(rows_.begin(), rows_.end(),
-            [row_id](const Row& r) { return r.get_id() == row_id; });
+    bool Table::update_version(uint64_t row_id, const Row& new_row, Transaction& txn) {
+        Row old_row;
+        RecordId location = locate_row(row_id, &old_row);
+        if (!location.is_valid()) {
+            return false;  // Row not found
+        }
         
-        return (it != rows_.end()) ? &(*it) : nullptr;
-    }
-    
-    bool Table::create_index(const std::string& column_name, const std::string& index_type) {
-        // Check if column exists
-        if (schema_.get_column(column_name) == nullptr) {
+        std::vector<RecordVersion>* chain = versions_.find(row_id);
+        if (chain != nullptr && !claim_row(chain->front(), txn)) {
             return false;
         }
         
-        // Check if index already exists
-        if (indices_.find(column_name) != indices_.end()) {
+        std::vector<char> record;
+        encode_row(new_row, row_id, record);
+        if (!record_fits(record)) {
             return false;
         }
         
-        // Create appropriate index type
-        std::unique_ptr<Index> index;
-        if (index_type == "btree") {
-            index = std::make_unique<BTreeIndex>();
-        } else if (index_type == "hash") {
-            index = std::make_unique<HashIndex>();
-        } else {
-            return false;  // Unknown index type
-        }
+        log_change(LogRecordType::UPDATE, record, &txn);
+        auto log_undo = [&]() {
+            std::vector<char> old_record;
+            encode_row(old_row, row_id, old_record);
+            log_change(LogRecordType::UPDATE, old_record, &txn);
+        };
         
-        // Build index from existing data
-        size_t column_index = schema_.get_column_index(column_name);
-        for (const auto& row : rows_) {
-            if (column_index < row.size()) {
-                index->insert(row.get_value(column_index), row.get_id());
+        if (chain != nullptr && chain->front().begin.written_by(&txn)) {
+            // Nobody else can see a version txn wrote, so it changes in place
+            if (!update_record(row_id, location, record)) {
+                log_undo();
+                return false;
             }
+            chain->front().location = *row_directory_.find(row_id);
+            reindex_version(row_id, *chain, &old_row, new_row);
+            return true;
         }
         
-        indices_[column_name] = std::move(index);
+        // Otherwise the new version is a new record and the old one stays
+        // where it is for snapshots that still see it
+        RecordId placed = place_record(record);
+        if (!placed.is_valid()) {
+            log_undo();
+            return false;
+        }
+        
+        if (chain == nullptr) {
+            chain = versions_.try_emplace(row_id).first;
+            chain->push_back(RecordVersion{location, VersionStamp::frozen(), VersionStamp()});
+        }
+        chain->front().end = txn.stamp();
+        chain->insert(chain->begin(), RecordVersion{placed, txn.stamp(), VersionStamp()});
+        row_directory_.upsert(row_id, placed);
+        txn.record_write(this, row_id);
+        
+        reindex_version(row_id, *chain, nullptr, new_row);
         return true;
     }
     
-    bool Table::drop_index(const std::string& column_name) {
+    bool Table::delete_row(uint64_t row_id, Transaction* txn) {
+        if (txn == nullptr && versioned()) {
+            return autocommit(*transactions_, [&](Transaction* local) { return delete_row(row_id, local); });
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        return delete_unlocked(row_id, txn);
+    }
+    
+    size_t Table::delete_rows(const std::vector<uint64_t>& row_ids, Transaction* txn) {
+        if (txn == nullptr && versioned()) {
+            return autocommit(*transactions_, [&](Transaction* local) { return delete_rows(row_ids, local); });
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        size_t deleted = 0;
+        for (uint64_t row_id : row_ids) {
+            if (!delete_unlocked(row_id, txn)) {
+                break;  // Rows before this one stay deleted
+            }
+            deleted++;
+        }
+        return deleted;
+    }
+    
+    bool Table::delete_unlocked(uint64_t row_id, Transaction* txn) {
+        Row old_row;
+        if (column_store_) {
+            if (!column_store_->get(row_id, old_row)) {
+                return false;  // Row not found
+            }
+            log_row_id(LogRecordType::DELETE, row_id, txn);
+            unindex_row(old_row, row_id);
+            column_store_->erase(row_id);
+            row_count_--;
+            return true;
+        }
+        
+        RecordId location = locate_row(row_id, &old_row);
+        if (!location.is_valid()) {
+            return false;  // Row not found
+        }
+        
+        if (txn != nullptr && versioned()) {
+            // The record stays until no snapshot can see it; only its end is stamped
+            std::vector<RecordVersion>* chain = versions_.find(row_id);
+            if (chain != nullptr && !claim_row(chain->front(), *txn)) {
+                return false;
+            }
+            
+            log_row_id(LogRecordType::DELETE, row_id, txn);
+            if (chain == nullptr) {
+                chain = versions_.try_emplace(row_id).first;
+                chain->push_back(RecordVersion{location, VersionStamp::frozen(), VersionStamp()});
+            }
+            chain->front().end = txn->stamp();
+            txn->record_write(this, row_id);
+            row_count_--;
+            return true;
+        }
+        
+        PinnedPage page(page_manager_, location.page_id, PinnedPage::Mode::EXCLUSIVE);
+        if (!page.get()) {
+            return false;
+        }
+        
+        log_row_id(LogRecordType::DELETE, row_id, txn);
+        unindex_row(old_row, row_id);
+        
+        // Remove from storage
+        SlottedPage(page.get()).erase(location.slot);
+        pages_with_space_.insert(location.page_id);
+        row_directory_.remove(row_id);
+        row_count_--;
+        return true;
+    }
+    
+    bool Table::claim_row(const RecordVersion& newest, Transaction& txn) const {
+        // First updater wins: a row changed by a transaction txn cannot see
+        // is off limits, and txn can only roll back
+        if (!newest.begin.written_by(&txn) && newest.begin.commit_ts() > txn.get_read_ts()) {
+            txn.mark_conflict();
+            return false;
+        }
+        if (newest.end.is_set()) {
+            if (!newest.end.written_by(&txn) && newest.end.commit_ts() > txn.get_read_ts()) {
+                txn.mark_conflict();
+            }
+            return false;  // Already deleted
+        }
+        return true;
+    }
+    
+    void Table::rollback(uint64_t row_id, const Transaction& txn) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        std::vector<RecordVersion>* chain = versions_.find(row_id);
+        if (chain == nullptr) {
+            return;  // Already undone, or the table was truncated since
+        }
+        
+        // txn's versions are the newest ones; drop them and reopen the
+        // version they ended
+        bool existed = !chain->front().end.is_set();
+        std::vector<Row> undone;
+        size_t dropped = 0;
+        for (; dropped < chain->size() && (*chain)[dropped].begin.written_by(&txn); dropped++) {
+            Row row;
+            if (read_record((*chain)[dropped].location, row)) {
+                undone.push_back(std::move(row));
+            }
+            erase_record((*chain)[dropped].location);
+        }
+        chain->erase(chain->begin(), chain->begin() + dropped);
+        
+        if (chain->empty()) {
+            unindex_versions(row_id, nullptr, undone);
+            row_directory_.remove(row_id);
+            versions_.remove(row_id);
+            if (existed) {
+                row_count_--;
+            }
+            return;
+        }
+        
+        if (chain->front().end.written_by(&txn)) {
+            chain->front().end = VersionStamp();
+        }
+        row_directory_.upsert(row_id, chain->front().location);
+        unindex_versions(row_id, chain, undone);
+        
+        bool exists = !chain->front().end.is_set();
+        if (exists && !existed) {
+            row_count_++;
+        } else if (existed && !exists) {
+            row_count_--;
+        }
+    }
+    
+    size_t Table::collect_garbage(Timestamp horizon) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        if (versions_.empty()) {
+            return 0;
+        }
+        
+        size_t reclaimed = 0;
+        std::vector<uint64_t> settled;
+        for (auto& entry : versions_) {
+            std::vector<RecordVersion>& chain = entry.value;
+            reclaimed += prune_versions(entry.key, chain, horizon);
+            
+            // A single version everyone sees is an ordinary row again
+            if (chain.empty() || (chain.size() == 1 && chain.front().begin.commit_ts() <= horizon &&
+                                  !chain.front().end.is_set())) {
+                settled.push_back(entry.key);
+            }
+        }
+        
+        for (uint64_t row_id : settled) {
+            if (versions_.find(row_id)->empty()) {
+                row_directory_.remove(row_id);  // Deleted for everyone
+            }
+            versions_.remove(row_id);
+        }
+        return reclaimed;
+    }
+    
+    size_t Table::prune_versions(uint64_t row_id, std::vector<RecordVersion>& chain, Timestamp horizon) {
+        // Find the newest version every open and future snapshot sees;
+        // everything older is out of sight for good
+        size_t keep = 0;
+        while (keep < chain.size() && chain[keep].begin.commit_ts() > horizon) {
+            keep++;
+        }
+        
+        size_t first_dead = chain.size();
+        if (keep < chain.size()) {
+            bool deleted = chain[keep].end.commit_ts() <= horizon;
+            first_dead = deleted ? keep : keep + 1;
+        }
+        
+        std::vector<Row> removed;
+        for (size_t i = first_dead; i < chain.size(); i++) {
+            Row row;
+            if (read_record(chain[i].location, row)) {
+                removed.push_back(std::move(row));
+            }
+            erase_record(chain[i].location);
+        }
+        chain.erase(chain.begin() + first_dead, chain.end());
+        
+        // Committed stamps no longer need their writer's status
+        for (auto& version : chain) {
+            for (VersionStamp* stamp : {&version.begin, &version.end}) {
+                if (stamp->writer != nullptr && stamp->commit_ts() != TS_NEVER) {
+                    *stamp = VersionStamp{stamp->commit_ts(), nullptr};
+                }
+            }
+        }
+        
+        unindex_versions(row_id, chain.empty() ? nullptr : &chain, removed);
+        return removed.size();
+    }
+    
+    bool Table::has_uncommitted_writes() const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        // Only the newest version of a row can belong to a running writer
+        for (const auto& entry : versions_) {
+            const RecordVersion& newest = entry.value.front();
+            if (newest.begin.commit_ts() == TS_NEVER || (newest.end.writer && newest.end.commit_ts() == TS_NEVER)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool Table::get_row(uint64_t row_id, Row& row, const Transaction* reader) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        if (column_store_) {
+            return column_store_->get(row_id, row);
+        }
+        return read_visible(row_id, row, reader);
+    }
+    
+    void Table::scan(const std::function<bool(const Row&)>& visitor, const Transaction* reader) const {
+        // Readers share the table latch; the visitor must not modify this table
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        scan_unlocked(visitor, reader);
+    }
+    
+    bool Table::read_page_rows(size_t page_index, std::vector<Row>& rows,
+                               const std::vector<size_t>* columns, const Transaction* reader) const {
+        // One heap page per call, so a streaming reader holds the latch
+        // only while it copies that page out
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        // Columnar tables read a segment, and only the requested columns
+        if (column_store_) {
+            return column_store_->read_segment(page_index, columns, rows);
+        }
+        
+        rows.clear();
+        if (page_index >= heap_pages_.size()) {
+            return false;
+        }
+        
+        scan_page_unlocked(heap_pages_[page_index], [&rows](const Row& row) {
+            rows.push_back(row);
+            return true;
+        }, reader);
+        return true;
+    }
+    
+    size_t Table::page_count() const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        return column_store_ ? column_store_->segment_count() : heap_pages_.size();
+    }
+    
+    size_t Table::count_rows(const Transaction* reader) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        // row_count_ counts newest versions; rows with older versions
+        // around are corrected one by one
+        size_t count = row_count_;
+        for (const auto& entry : versions_) {
+            const std::vector<RecordVersion>& chain = entry.value;
+            bool seen = std::any_of(chain.begin(), chain.end(), [reader](const RecordVersion& version) {
+                return is_visible(version, reader);
+            });
+            bool counted = !chain.front().end.is_set();
+            count = count + (seen ? 1 : 0) - (counted ? 1 : 0);
+        }
+        return count;
+    }
+    
+    std::shared_ptr<const TableStatistics> Table::collect_statistics(const Transaction* reader) const {
+        StatisticsBuilder builder(schema_.column_count());
+        scan([&builder](const Row& row) {
+            builder.add(row);
+            return true;
+        }, reader);
+        return std::make_shared<const TableStatistics>(builder.finish());
+    }
+    
+    bool Table::set_statistics(std::shared_ptr<const TableStatistics> statistics) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        if (statistics && statistics->columns.size() != schema_.column_count()) {
+            return false;  // Collected from a different table of the same name
+        }
+        schema_.set_statistics(std::move(statistics));
+        return true;
+    }
+    
+    void Table::scan_unlocked(const std::function<bool(const Row&)>& visitor, const Transaction* reader) const {
+        if (column_store_) {
+            std::vector<Row> rows;
+            for (size_t segment = 0; column_store_->read_segment(segment, nullptr, rows); segment++) {
+                for (const auto& row : rows) {
+                    if (!visitor(row)) {
+                        return;
+                    }
+                }
+            }
+            return;
+        }
+        
+        for (PageId page_id : heap_pages_) {
+            if (!scan_page_unlocked(page_id, visitor, reader)) {
+                return;
+            }
+        }
+    }
+    
+    bool Table::scan_page_unlocked(PageId page_id, const std::function<bool(const Row&)>& visitor,
+                                   const Transaction* reader) const {
+        PinnedPage page(page_manager_, page_id, PinnedPage::Mode::SHARED);
+        if (!page.get()) {
+            return true;
+        }
+        
+        std::vector<char> record;
+        Row row;
+        SlottedPage heap_page(page.get());
+        SlotId slot_count = heap_page.slot_count();
+        
+        for (SlotId slot = 0; slot < slot_count; slot++) {
+            if (!heap_page.read(slot, record)) {
+                continue;
+            }
+            
+            // Every version of a row is its own record; reader sees at most one
+            if (!versions_.empty()) {
+                const std::vector<RecordVersion>* chain =
+                    versions_.find(decode_row_id(record.data(), record.size()));
+                if (chain != nullptr && !visible_at(*chain, RecordId{page_id, slot}, reader)) {
+                    continue;
+                }
+            }
+            
+            if (!decode_row(record.data(), record.size(), row)) {
+                continue;
+            }
+            if (!visitor(row)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    std::vector<Row> Table::get_all_rows() const {
+        std::vector<Row> rows;
+        rows.reserve(row_count_);
+        scan([&rows](const Row& row) {
+            rows.push_back(row);
+            return true;
+        });
+        return rows;
+    }
+    
+    RecordId Table::locate_row(uint64_t row_id, Row* row) const {
+        // The directory makes this one probe, however large the heap is
+        const RecordId* location = row_directory_.find(row_id);
+        if (location == nullptr) {
+            return RecordId();
+        }
+        if (row != nullptr && !read_record(*location, *row)) {
+            return RecordId();
+        }
+        return *location;
+    }
+    
+    bool Table::read_record(RecordId location, Row& row) const {
+        PinnedPage page(page_manager_, location.page_id, PinnedPage::Mode::SHARED);
+        std::vector<char> record;
+        return page.get() && SlottedPage(page.get()).read(location.slot, record) &&
+               decode_row(record.data(), record.size(), row);
+    }
+    
+    bool Table::read_visible(uint64_t row_id, Row& row, const Transaction* reader) const {
+        const RecordId* location = row_directory_.find(row_id);
+        if (location == nullptr) {
+            return false;
+        }
+        
+        // The directory points at the newest version; older ones are only
+        // reachable through the row's chain
+        const std::vector<RecordVersion>* chain = versions_.find(row_id);
+        if (chain == nullptr) {
+            return read_record(*location, row);
+        }
+        for (const auto& version : *chain) {
+            if (is_visible(version, reader)) {
+                return read_record(version.location, row);
+            }
+        }
+        return false;
+    }
+    
+    bool Table::visible_at(const std::vector<RecordVersion>& chain, RecordId location,
+                           const Transaction* reader) const {
+        for (const auto& version : chain) {
+            if (same_record(version.location, location)) {
+                return is_visible(version, reader);
+            }
+        }
+        return false;
+    }
+    
+    void Table::erase_record(RecordId location) {
+        PinnedPage page(page_manager_, location.page_id, PinnedPage::Mode::EXCLUSIVE);
+        if (page.get()) {
+            SlottedPage(page.get()).erase(location.slot);
+            pages_with_space_.insert(location.page_id);
+        }
+    }
+    
+    bool Table::update_record(uint64_t row_id, RecordId location, const std::vector<char>& record) {
+        bool updated_in_place;
+        {
+            PinnedPage page(page_manager_, location.page_id, PinnedPage::Mode::EXCLUSIVE);
+            if (!page.get()) {
+                return false;
+            }
+            updated_in_place = SlottedPage(page.get()).update(location.slot, record.data(), record.size());
+        }
+        
+        if (!updated_in_place) {
+            // No room to grow in place: move the row to another page. The old
+            // page is unlatched first since placement may pick it again.
+            RecordId moved = place_record(record);
+            if (!moved.is_valid()) {
+                return false;
+            }
+            row_directory_.upsert(row_id, moved);
+            
+            PinnedPage page(page_manager_, location.page_id, PinnedPage::Mode::EXCLUSIVE);
+            if (page.get()) {
+                SlottedPage(page.get()).erase(location.slot);
+                pages_with_space_.insert(location.page_id);
+            }
+        }
+        return true;
+    }
+    
+    bool Table::record_fits(const std::vector<char>& record) const {
+        return page_manager_ != nullptr &&
+               record.size() <= SlottedPage::max_record_size(page_manager_->get_page_size());
+    }
+    
+    RecordId Table::place_record(const std::vector<char>& record) {
+        if (!record_fits(record)) {
+            return RecordId();
+        }
+        
+        // Try the tail page first, then pages that freed space through deletes
+        if (!heap_pages_.empty()) {
+            RecordId rid = insert_into_page(heap_pages_.back(), record);
+            if (rid.is_valid()) {
+                return rid;
+            }
+        }
+        
+        while (!pages_with_space_.empty()) {
+            PageId candidate = *pages_with_space_.begin();
+            RecordId rid = insert_into_page(candidate, record);
+            if (rid.is_valid()) {
+                return rid;
+            }
+            pages_with_space_.erase(candidate);  // Too full for rows of this size
+        }
+        
+        // Extend the heap with a fresh page
+        PageId page_id = page_manager_->allocate_page();
+        if (page_id == INVALID_PAGE_ID) {
+            return RecordId();
+        }
+        
+        {
+            PinnedPage page(page_manager_, page_id, PinnedPage::Mode::EXCLUSIVE);
+            if (!page.get()) {
+                return RecordId();
+            }
+            SlottedPage(page.get()).init();
+        }
+        heap_pages_.push_back(page_id);
+        
+        return insert_into_page(page_id, record);
+    }
+    
+    RecordId Table::insert_into_page(PageId page_id, const std::vector<char>& record) {
+        PinnedPage page(page_manager_, page_id, PinnedPage::Mode::EXCLUSIVE);
+        if (!page.get()) {
+            return RecordId();
+        }
+        
+        SlotId slot = SlottedPage(page.get()).insert(record.data(), record.size());
+        if (slot == INVALID_SLOT_ID) {
+            return RecordId();
+        }
+        
+        return RecordId{page_id, slot};
+    }
+    
+    void Table::release_pages() {
+        if (page_manager_ != nullptr) {
+            for (PageId page_id : heap_pages_) {
+                page_manager_->deallocate_page(page_id);
+            }
+        }
+        heap_pages_.clear();
+        pages_with_space_.clear();
+        row_directory_.clear();
+        versions_.clear();
+    }
+    
+    void Table::index_row(const Row& row, uint64_t row_id) {
+        for (auto& [column_name, index] : indices_) {
+            size_t column_index = schema_.get_column_index(column_name);
+            if (column_index != SIZE_MAX && column_index < row.size()) {
+                index->insert(row.get_value(column_index), row_id);
+            }
+        }
+    }
+    
+    void Table::unindex_row(const Row& row, uint64_t row_id) {
+        for (auto& [column_name, index] : indices_) {
+            size_t column_index = schema_.get_column_index(column_name);
+            if (column_index != SIZE_MAX && column_index < row.size()) {
+                index->remove(row.get_value(column_index), row_id);
+            }
+        }
+    }
+    
+    bool Table::key_in_versions(const std::vector<RecordVersion>& chain, size_t from, size_t column,
+                                const Value& key) const {
+        Row row;
+        for (size_t i = from; i < chain.size(); i++) {
+            if (read_record(chain[i].location, row) && column < row.size() && row.get_value(column) == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void Table::reindex_version(uint64_t row_id, const std::vector<RecordVersion>& chain,
+                                const Row* replaced, const Row& added) {
+        // Indexes hold one entry per distinct key across all of a row's
+        // versions; chain[0] already holds added
+        for (auto& [column_name, index] : indices_) {
+            size_t column_index = schema_.get_column_index(column_name);
+            if (column_index == SIZE_MAX || column_index >= added.size()) {
+                continue;
+            }
+            
+            const Value& key = added.get_value(column_index);
+            if (replaced != nullptr && column_index < replaced->size()) {
+                const Value& old_key = replaced->get_value(column_index);
+                if (old_key == key) {
+                    continue;
+                }
+                if (!key_in_versions(chain, 1, column_index, old_key)) {
+                    index->remove(old_key, row_id);
+                }
+            }
+            if (!key_in_versions(chain, 1, column_index, key)) {
+                index->insert(key, row_id);
+            }
+        }
+    }
+    
+    void Table::unindex_versions(uint64_t row_id, const std::vector<RecordVersion>* survivors,
+                                 const std::vector<Row>& removed) {
+        for (auto& [column_name, index] : indices_) {
+            size_t column_index = schema_.get_column_index(column_name);
+            if (column_index == SIZE_MAX) {
+                continue;
+            }
+            for (const Row& row : removed) {
+                if (column_index < row.size() &&
+                    (survivors == nullptr || !key_in_versions(*survivors, 0, column_index, row.get_value(column_index)))) {
+                    index->remove(row.get_value(column_index), row_id);
+                }
+            }
+        }
+    }
+    
+    bool Table::create_index(const std::string& column_name, const std::string& index_type) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        // Check if column exists
+        if (schema_.get_column(column_name) == nullptr) {
+            return false;
+        }
+        
+        // Check if index already exists
+        if (indices_.find(column_name) != indices_.end()) {
+            return false;
+        }
+        
+        // Create appropriate index type
+        std::unique_ptr<Index> index = make_index(index_type);
+        if (!index) {
+            return false;  // Unknown index type
+        }
+        
+        if (wal_ != nullptr) {
+            std::vector<char> payload;
+            ByteWriter writer(payload);
+            writer.write_string(column_name);
+            writer.write_string(index_type);
+            log_change(LogRecordType::CREATE_INDEX, payload);
+        }
+        
+        // Build index from existing data in one batch
+        size_t column_index = schema_.get_column_index(column_name);
+        std::vector<std::pair<Value, uint64_t>> entries;
+        entries.reserve(row_count_);
+        scan_unlocked([&](const Row& row) {
+            if (column_index < row.size() && !versions_.contains(row.get_id())) {
+                entries.emplace_back(row.get_value(column_index), row.get_id());
+            }
+            return true;
+        }, nullptr);
+        
+        // Rows with several versions get an entry per distinct key
+        Row row;
+        for (const auto& entry : versions_) {
+            size_t first = entries.size();
+            for (const auto& version : entry.value) {
+                if (!read_record(version.location, row) || column_index >= row.size()) {
+                    continue;
+                }
+                const Value& key = row.get_value(column_index);
+                bool seen = std::any_of(entries.begin() + first, entries.end(), [&key](const auto& indexed) {
+                    return indexed.first == key;
+                });
+                if (!seen) {
+                    entries.emplace_back(key, entry.key);
+                }
+            }
+        }
+        index->insert_batch(std::move(entries));
+        
+        indices_[column_name] = std::move(index);
+        index_version_++;
+        return true;
+    }
+    
+    uint64_t Table::index_version() const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        return index_version_;
+    }
+    
+    Index* Table::get_index(const std::string& column_name) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        auto it = indices_.find(column_name);
+        return it != indices_.end() ? it->second.get() : nullptr;
+    }
+    
+    bool Table::index_lookup(const std::string& column_name, const Value& key, std::vector<Row>& rows,
+                             const Transaction* reader) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        auto it = indices_.find(column_name);
+        if (it == indices_.end()) {
+            return false;
+        }
+        
+        index_lookup_counter().add();
+        fetch_rows(it->second->find_all(key), rows, reader);
+        
+        // An entry may be for a version reader does not see
+        if (!versions_.empty()) {
+            size_t column_index = schema_.get_column_index(column_name);
+            rows.erase(std::remove_if(rows.begin(), rows.end(), [&](const Row& row) {
+                return column_index >= row.size() || !(row.get_value(column_index) == key);
+            }), rows.end());
+        }
+        return true;
+    }
+    
+    bool Table::index_range(const std::string& column_name, const Value* lower, const Value* upper,
+                            std::vector<Row>& rows, const Transaction* reader) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        auto it = indices_.find(column_name);
+        if (it == indices_.end() || !it->second->supports_range()) {
+            return false;
+        }
+        index_range_scan_counter().add();
+        
+        if (versions_.empty()) {
+            fetch_rows(it->second->scan_range(lower, upper), rows, reader);
+            return true;
+        }
+        
+        // A row with versions under several keys is listed once, under the
+        // key of the version reader sees
+        rows.clear();
+        size_t column_index = schema_.get_column_index(column_name);
+        Row row;
+        it->second->scan_entries(lower, upper, [&](const Value& key, uint64_t row_id) {
+            if (read_visible(row_id, row, reader) && column_index < row.size() &&
+                row.get_value(column_index) == key) {
+                rows.push_back(row);
+            }
+            return true;
+        });
+        return true;
+    }
+    
+    bool Table::index_ordered(const std::string& column_name, const Value* lower, const Value* upper,
+                              bool descending, size_t limit, const std::function<bool(const Row&)>& filter,
+                              std::vector<Row>& rows, const Transaction* reader) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        auto it = indices_.find(column_name);
+        if (it == indices_.end() || !it->second->supports_range()) {
+            return false;
+        }
+        index_range_scan_counter().add();
+        
+        // Rows are fetched one entry at a time, so a LIMIT stops the walk
+        // instead of the whole range being read first
+        rows.clear();
+        size_t column_index = schema_.get_column_index(column_name);
+        Row row;
+        auto visit = [&](const Value& key, uint64_t row_id) {
+            bool found = column_store_ ? column_store_->get(row_id, row) : read_visible(row_id, row, reader);
+            
+            // As in index_range, a row with versions under several keys is
+            // listed under the key of the version reader sees
+            if (found && (versions_.empty() || (column_index < row.size() && row.get_value(column_index) == key)) &&
+                filter(row)) {
+                rows.push_back(row);
+            }
+            return rows.size() < limit;
+        };
+        if (limit == 0) {
+            return true;
+        }
+        if (descending) {
+            it->second->scan_entries_reverse(lower, upper, visit);
+        } else {
+            it->second->scan_entries(lower, upper, visit);
+        }
+        return true;
+    }
+    
+    bool Table::index_bounds(const std::string& column_name, Value& min, Value& max,
+                             const Transaction* reader) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        auto it = indices_.find(column_name);
+        if (it == indices_.end() || !it->second->supports_range()) {
+            return false;
+        }
+        
+        if (!it->second->key_bounds(min, max)) {
+            min = Value();
+            max = Value();
+            return true;
+        }
+        if (versions_.empty()) {
+            return true;
+        }
+        
+        // Some entries may be for versions reader does not see; walk the
+        // keys in order and keep the first and last that it does
+        size_t column_index = schema_.get_column_index(column_name);
+        bool found = false;
+        Row row;
+        it->second->scan_entries(&min, nullptr, [&](const Value& key, uint64_t row_id) {
+            bool seen = versions_.find(row_id) == nullptr ||
+                        (read_visible(row_id, row, reader) && column_index < row.size() &&
+                         row.get_value(column_index) == key);
+            if (seen) {
+                if (!found) {
+                    min = key;
+                    found = true;
+                }
+                max = key;
+            }
+            return true;
+        });
+        if (!found) {
+            min = Value();
+            max = Value();
+        }
+        return true;
+    }
+    
+    void Table::fetch_rows(const std::vector<uint64_t>& row_ids, std::vector<Row>& rows,
+                           const Transaction* reader) const {
+        rows.clear();
+        if (row_ids.empty()) {
+            return;
+        }
+        
+        // Columnar tables find rows by id directly
+        if (column_store_) {
+            Row row;
+            for (uint64_t row_id : row_ids) {
+                if (column_store_->get(row_id, row)) {
+                    rows.push_back(row);
+                }
+            }
+            return;
+        }
+        
+        // Rows keep the index's order
+        rows.reserve(row_ids.size());
+        Row row;
+        for (uint64_t row_id : row_ids) {
+            if (read_visible(row_id, row, reader)) {
+                rows.push_back(row);
+            }
+        }
+    }
+    
+    bool Table::drop_index(const std::string& column_name) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
         auto it = indices_.find(column_name);
         if (it != indices_.end()) {
+            if (wal_ != nullptr) {
+                std::vector<char> payload;
+                ByteWriter(payload).write_string(column_name);
+                log_change(LogRecordType::DROP_INDEX, payload);
+            }
             indices_.erase(it);
+            index_version_++;
             return true;
         }
         return false;
     }
     
     void Table::clear() {
-        rows_.clear();
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        log_change(LogRecordType::TRUNCATE_TABLE, std::vector<char>());
+        release_pages();
+        if (column_store_) {
+            column_store_->clear();
+        }
         indices_.clear();
+        index_version_++;
         next_row_id_ = 1;
+        row_count_ = 0;
+    }
+    
+    void Table::attach_wal(WriteAheadLog* wal, const std::string& log_name) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        wal_ = wal;
+        wal_name_ = log_name;
+    }
+    
+    void Table::attach_transactions(TransactionManager* transactions) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        transactions_ = transactions;
+    }
+    
+    void Table::log_change(LogRecordType type, const std::vector<char>& payload, Transaction* txn) {
+        if (wal_ == nullptr) {
+            return;
+        }
+        
+        // Versioned changes reach the log when their transaction commits
+        if (txn != nullptr && versioned()) {
+            txn->log(type, wal_name_, payload);
+        } else {
+            wal_->append(type, wal_name_, payload);
+        }
+    }
+    
+    void Table::log_row_id(LogRecordType type, uint64_t row_id, Transaction* txn) {
+        if (wal_ != nullptr) {
+            std::vector<char> payload;
+            ByteWriter(payload).write(row_id);
+            log_change(type, payload, txn);
+        }
+    }
+    
+    bool Table::write_snapshot(SnapshotWriter& snapshot, ByteWriter& out) const {
+        std::shared_lock<std::shared_mutex> lock(table_latch_);
+        
+        // Pages still hold versions some transaction may undo or see
+        if (!versions_.empty()) {
+            return false;
+        }
+        
+        out.write(next_row_id_);
+        out.write(static_cast<uint64_t>(row_count_));
+        
+        // Heap pages are copied into the snapshot and renumbered densely there
+        std::unordered_map<PageId, PageId> renumbered;
+        out.write(static_cast<uint32_t>(heap_pages_.size()));
+        for (PageId page_id : heap_pages_) {
+            PinnedPage page(page_manager_, page_id, PinnedPage::Mode::SHARED);
+            PageId copy = page.get() ? snapshot.add_page(page.get()->get_data()) : INVALID_PAGE_ID;
+            if (copy == INVALID_PAGE_ID) {
+                return false;
+            }
+            renumbered[page_id] = copy;
+            out.write(static_cast<uint64_t>(copy));
+        }
+        
+        out.write(static_cast<uint32_t>(pages_with_space_.size()));
+        for (PageId page_id : pages_with_space_) {
+            out.write(static_cast<uint64_t>(renumbered[page_id]));
+        }
+        
+        // Fixed-width directory entries: [row_id:u64][page:u64][slot:u16]
+        out.write(static_cast<uint64_t>(row_directory_.size()));
+        for (const auto& entry : row_directory_) {
+            out.write(entry.key);
+            out.write(static_cast<uint64_t>(renumbered[entry.value.page_id]));
+            out.write(entry.value.slot);
+        }
+        
+        // Columnar tables live only in memory, so their rows go in whole
+        std::vector<char> record;
+        out.write(static_cast<uint64_t>(column_store_ ? row_count_ : 0));
+        if (column_store_) {
+            scan_unlocked([&](const Row& row) {
+                encode_row(row, row.get_id(), record);
+                out.write_string(std::string_view(record.data(), record.size()));
+                return true;
+            }, nullptr);
+        }
+        
+        // Index entries in index order, so B-Trees can be bulk loaded
+        std::vector<std::pair<Value, uint64_t>> entries;
+        out.write(static_cast<uint32_t>(indices_.size()));
+        for (const auto& [column_name, index] : indices_) {
+            entries.clear();
+            index->export_entries(entries);
+            out.write_string(column_name);
+            out.write_string(index->type_name());
+            out.write(static_cast<uint64_t>(entries.size()));
+            for (const auto& [key, row_id] : entries) {
+                write_value(out, key);
+                out.write(row_id);
+            }
+        }
+        
+        return true;
+    }
+    
+    bool Table::load_snapshot(ByteReader& in) {
+        std::unique_lock<std::shared_mutex> lock(table_latch_);
+        
+        uint64_t next_row_id = 0;
+        uint64_t row_count = 0;
+        uint32_t page_count = 0;
+        if (!in.read(next_row_id) || !in.read(row_count) || !in.read(page_count)) {
+            return false;
+        }
+        
+        // Page ids refer to the snapshot's page images, which the page
+        // manager serves lazily from the mapping
+        heap_pages_.reserve(page_count);
+        for (uint32_t i = 0; i < page_count; i++) {
+            uint64_t page_id = 0;
+            if (!in.read(page_id)) {
+                return false;
+            }
+            heap_pages_.push_back(static_cast<PageId>(page_id));
+        }
+        
+        uint32_t space_count = 0;
+        if (!in.read(space_count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < space_count; i++) {
+            uint64_t page_id = 0;
+            if (!in.read(page_id)) {
+                return false;
+            }
+            pages_with_space_.insert(static_cast<PageId>(page_id));
+        }
+        
+        uint64_t directory_size = 0;
+        if (!in.read(directory_size)) {
+            return false;
+        }
+        row_directory_.reserve(static_cast<size_t>(directory_size));
+        for (uint64_t i = 0; i < directory_size; i++) {
+            uint64_t row_id = 0;
+            uint64_t page_id = 0;
+            SlotId slot = INVALID_SLOT_ID;
+            if (!in.read(row_id) || !in.read(page_id) || !in.read(slot)) {
+                return false;
+            }
+            row_directory_.insert(row_id, RecordId{static_cast<PageId>(page_id), slot});
+        }
+        
+        uint64_t columnar_rows = 0;
+        if (!in.read(columnar_rows) || (columnar_rows > 0 && !column_store_)) {
+            return false;
+        }
+        Row row;
+        for (uint64_t i = 0; i < columnar_rows; i++) {
+            std::string_view record;
+            if (!in.read_string(record) || !decode_row(record.data(), record.size(), row) ||
+                !column_store_->append(row, row.get_id())) {
+                return false;
+            }
+        }
+        
+        uint32_t index_count = 0;
+        if (!in.read(index_count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < index_count; i++) {
+            std::string column_name;
+            std::string index_type;
+            uint64_t entry_count = 0;
+            if (!in.read_string(column_name) || !in.read_string(index_type) || !in.read(entry_count)) {
+                return false;
+            }
+            std::unique_ptr<Index> index = make_index(index_type);
+            if (!index || schema_.get_column(column_name) == nullptr) {
+                return false;
+            }
+            
+            std::vector<std::pair<Value, uint64_t>> entries;
+            entries.reserve(static_cast<size_t>(entry_count));
+            for (uint64_t e = 0; e < entry_count; e++) {
+                Value key;
+                uint64_t row_id = 0;
+                if (!read_value(in, key) || !in.read(row_id)) {
+                    return false;
+                }
+                entries.emplace_back(std::move(key), row_id);
+            }
+            index->insert_batch(std::move(entries));
+            indices_[column_name] = std::move(index);
+        }
+        
+        next_row_id_ = next_row_id;
+        row_count_ = static_cast<size_t>(row_count);
+        index_version_++;
+        return true;
     }
 
 } // namespace storage
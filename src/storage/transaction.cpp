@@ -0,0 +1,214 @@
+/**
+ * @file transaction.cpp
+ * @brief Transaction manager and version visibility
+ */
+
+#include "minidb/storage/transaction.h"
+#include "minidb/storage/table.h"
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+    
+        thread_local Transaction* current_transaction = nullptr;
+    
+    } // anonymous namespace
+    
+    // VersionStamp implementation
+    bool VersionStamp::written_by(const Transaction* txn) const {
+        return txn != nullptr && writer != nullptr && writer.get() == txn->status();
+    }
+    
+    bool VersionStamp::visible_to(const Transaction* reader) const {
+        if (written_by(reader)) {
+            return true;  // A transaction sees its own changes
+        }
+        return commit_ts() <= (reader ? reader->get_read_ts() : TS_LATEST);
+    }
+    
+    // Transaction implementation
+    Transaction::Transaction(uint64_t id, Timestamp read_ts)
+        : id_(id), read_ts_(read_ts), conflict_(false) {
+    }
+    
+    VersionStamp Transaction::stamp() {
+        if (!status_) {
+            status_ = std::make_shared<TransactionStatus>();
+        }
+        return VersionStamp{TS_NEVER, status_};
+    }
+    
+    void Transaction::log(LogRecordType type, const std::string& table_name, const std::vector<char>& payload) {
+        log_.push_back(PendingRecord{type, table_name, payload});
+    }
+    
+    Transaction* Transaction::current() {
+        return current_transaction;
+    }
+    
+    // TransactionScope implementation
+    TransactionScope::TransactionScope(Transaction* txn) : previous_(current_transaction) {
+        current_transaction = txn;
+    }
+    
+    TransactionScope::~TransactionScope() {
+        current_transaction = previous_;
+    }
+    
+    // TransactionManager implementation
+    TransactionManager::TransactionManager()
+        : clock_(1), next_id_(1), wal_(nullptr), collect_pending_(false), stopping_(false),
+          begun_(0), committed_(0), rolled_back_(0), collections_(0) {
+    }
+    
+    TransactionManager::~TransactionManager() {
+        stop_collector();
+    }
+    
+    std::unique_ptr<Transaction> TransactionManager::begin() {
+        // The clock is read under the same mutex horizon() takes, so a
+        // collection never overlooks a transaction that is just starting
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        auto txn = std::make_unique<Transaction>(next_id_++, clock_.load(std::memory_order_acquire));
+        txn->active_entry_ = active_.insert(txn->read_ts_);
+        begun_++;
+        return txn;
+    }
+    
+    bool TransactionManager::commit(Transaction& txn) {
+        bool logged = true;
+        Lsn last_lsn = INVALID_LSN;
+        {
+            std::lock_guard<std::mutex> lock(commit_mutex_);
+            
+            for (const auto& record : txn.log_) {
+                if (wal_ == nullptr) {
+                    break;
+                }
+                last_lsn = wal_->append(record.type, record.table_name, record.payload);
+                if (last_lsn == INVALID_LSN) {
+                    logged = false;
+                    break;
+                }
+            }
+        }
+        
+        // The commit is durable before anyone can see it, so no reader acts
+        // on a change a crash would take back. Concurrent commits share the
+        // fsync. With synchronous commit off, the log returns at once and
+        // the last flush interval's commits can be seen and then lost.
+        if (logged && last_lsn != INVALID_LSN && !wal_->commit(last_lsn)) {
+            logged = false;
+        }
+        
+        // The status is stamped before the clock moves, so anyone who reads
+        // the new clock also sees this commit
+        if (logged && txn.status_) {
+            std::lock_guard<std::mutex> lock(commit_mutex_);
+            Timestamp commit_ts = clock_.load(std::memory_order_relaxed) + 1;
+            txn.status_->commit_ts.store(commit_ts, std::memory_order_release);
+            clock_.store(commit_ts, std::memory_order_release);
+        }
+        
+        if (!logged) {
+            rollback(txn);
+            return false;
+        }
+        
+        txn.log_.clear();
+        finish(txn);
+        committed_++;
+        return true;
+    }
+    
+    void TransactionManager::rollback(Transaction& txn) {
+        // Newest writes first; undoing a row twice is harmless
+        for (auto it = txn.writes_.rbegin(); it != txn.writes_.rend(); ++it) {
+            it->first->rollback(it->second, txn);
+        }
+        txn.log_.clear();
+        
+        finish(txn);
+        rolled_back_++;
+    }
+    
+    void TransactionManager::finish(Transaction& txn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (txn.active_entry_ == active_.end()) {
+            return;  // Already committed or rolled back
+        }
+        
+        // Versions become collectable when written, or when the oldest
+        // reader that could still see old ones goes away
+        bool oldest = txn.active_entry_ == active_.begin();
+        active_.erase(txn.active_entry_);
+        txn.active_entry_ = active_.end();
+        if (!txn.writes_.empty() || oldest) {
+            collect_pending_ = true;
+            collect_requested_.notify_one();
+        }
+        txn.writes_.clear();
+    }
+    
+    void TransactionManager::set_wal(WriteAheadLog* wal) {
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        wal_ = wal;
+    }
+    
+    size_t TransactionManager::active_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_.size();
+    }
+    
+    Timestamp TransactionManager::horizon() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_.empty() ? clock_.load(std::memory_order_acquire) : *active_.begin();
+    }
+    
+    void TransactionManager::start_collector(std::function<void()> collect, std::chrono::milliseconds interval) {
+        stop_collector();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            collect_ = std::move(collect);
+            stopping_ = false;
+        }
+        collector_ = std::thread(&TransactionManager::collector_loop, this, interval);
+    }
+    
+    void TransactionManager::stop_collector() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        collect_requested_.notify_one();
+        if (collector_.joinable()) {
+            collector_.join();
+        }
+    }
+    
+    void TransactionManager::collector_loop(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            // Batch up everything that finished within one interval
+            collect_requested_.wait(lock, [this] { return collect_pending_ || stopping_; });
+            if (stopping_ || collect_requested_.wait_for(lock, interval, [this] { return stopping_; })) {
+                break;
+            }
+            
+            collect_pending_ = false;
+            lock.unlock();
+            collect_();
+            collections_++;
+            lock.lock();
+        }
+    }
+    
+    TransactionManager::Stats TransactionManager::get_stats() const {
+        return Stats{begun_.load(), committed_.load(), rolled_back_.load(), collections_.load()};
+    }
+
+} // namespace storage
+} // namespace minidb
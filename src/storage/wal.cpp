@@ -0,0 +1,396 @@
+/**
+ * @file wal.cpp
+ * @brief Write-ahead log implementation
+ */
+
+#include "minidb/storage/wal.h"
+#include "minidb/storage/serialization.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace minidb {
+namespace storage {
+
+    namespace {
+        
+        // [length:u32][crc32:u32]
+        constexpr size_t FRAME_HEADER_SIZE = 8;
+        
+        // Anything larger than this in a frame header is treated as corruption
+        constexpr uint32_t MAX_RECORD_SIZE = 64u * 1024u * 1024u;
+        
+#ifdef _WIN32
+        long long positioned_read(int fd, char* buffer, size_t length, long long offset) {
+            if (_lseeki64(fd, offset, SEEK_SET) < 0) return -1;
+            return _read(fd, buffer, static_cast<unsigned int>(length));
+        }
+        
+        long long file_size(int fd) {
+            struct _stat64 st;
+            return ::_fstat64(fd, &st) == 0 ? st.st_size : -1;
+        }
+        
+        bool truncate_file(int fd, long long size) {
+            return ::_chsize_s(fd, size) == 0;
+        }
+#else
+        long long positioned_read(int fd, char* buffer, size_t length, long long offset) {
+            return ::pread(fd, buffer, length, static_cast<off_t>(offset));
+        }
+        
+        long long file_size(int fd) {
+            struct stat st;
+            return ::fstat(fd, &st) == 0 ? st.st_size : -1;
+        }
+        
+        bool truncate_file(int fd, long long size) {
+            return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+        }
+#endif
+
+        bool read_fully(int fd, char* buffer, size_t length, long long offset) {
+            size_t done = 0;
+            while (done < length) {
+                long long n = positioned_read(fd, buffer + done, length - done, offset + done);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                if (n == 0) {
+                    return false;  // Short file
+                }
+                done += static_cast<size_t>(n);
+            }
+            return true;
+        }
+        
+    } // anonymous namespace
+    
+    // WriteAheadLog implementation
+    WriteAheadLog::WriteAheadLog()
+        : fd_(-1), next_lsn_(1), durable_lsn_(INVALID_LSN), synchronous_commit_(true),
+          flush_interval_(10), buffered_lsn_(INVALID_LSN), sync_requests_(0),
+          durable_size_(0), failed_(false), stopping_(false), records_appended_(0), bytes_written_(0),
+          commits_(0), syncs_(0) {
+    }
+    
+    WriteAheadLog::~WriteAheadLog() {
+        close();
+    }
+    
+    bool WriteAheadLog::open(const std::string& path) {
+        close();
+        
+#ifdef _WIN32
+        fd_ = ::_open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+#endif
+        if (fd_ < 0) {
+            return false;
+        }
+        
+        // Find the end of the intact prefix and drop whatever a crash left behind
+        uint64_t valid_end = 0;
+        Lsn last_lsn = INVALID_LSN;
+        if (!read_records(nullptr, valid_end, last_lsn)) {
+            close();
+            return false;
+        }
+        if (file_size(fd_) > static_cast<long long>(valid_end) &&
+            !truncate_file(fd_, static_cast<long long>(valid_end))) {
+            close();
+            return false;
+        }
+        
+        path_ = path;
+        next_lsn_ = last_lsn + 1;
+        durable_lsn_ = last_lsn;
+        buffered_lsn_ = last_lsn;
+        buffer_.clear();
+        sync_requests_ = 0;
+        durable_size_ = valid_end;
+        failed_ = false;
+        stopping_ = false;
+        
+        flusher_ = std::thread(&WriteAheadLog::flusher_loop, this);
+        return true;
+    }
+    
+    void WriteAheadLog::close() {
+        if (fd_ < 0) {
+            return;
+        }
+        
+        // The flusher drains the buffer before it exits
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        flush_requested_.notify_all();
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+        
+#ifdef _WIN32
+        ::_close(fd_);
+#else
+        ::close(fd_);
+#endif
+        fd_ = -1;
+    }
+    
+    bool WriteAheadLog::replay(const std::function<bool(const LogRecord&)>& visitor) {
+        if (fd_ < 0 || !flush()) {
+            return false;
+        }
+        
+        uint64_t valid_end = 0;
+        Lsn last_lsn = INVALID_LSN;
+        return read_records(&visitor, valid_end, last_lsn);
+    }
+    
+    Lsn WriteAheadLog::append(LogRecordType type, const std::string& table_name,
+                              const std::vector<char>& payload) {
+        if (fd_ < 0) {
+            return INVALID_LSN;
+        }
+        
+        // Frame the record up front; only the LSN and checksum need the latch
+        std::vector<char> frame;
+        frame.reserve(FRAME_HEADER_SIZE + sizeof(Lsn) + 1 + 4 + table_name.size() + payload.size());
+        ByteWriter writer(frame);
+        writer.write(static_cast<uint32_t>(0));
+        writer.write(static_cast<uint32_t>(0));
+        writer.write(static_cast<Lsn>(INVALID_LSN));
+        writer.write(static_cast<uint8_t>(type));
+        writer.write_string(table_name);
+        writer.write_bytes(payload.data(), payload.size());
+        
+        uint32_t body_length = static_cast<uint32_t>(frame.size() - FRAME_HEADER_SIZE);
+        std::memcpy(frame.data(), &body_length, sizeof(body_length));
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        Lsn lsn = next_lsn_++;
+        std::memcpy(frame.data() + FRAME_HEADER_SIZE, &lsn, sizeof(lsn));
+        uint32_t checksum = crc32(frame.data() + FRAME_HEADER_SIZE, body_length);
+        std::memcpy(frame.data() + 4, &checksum, sizeof(checksum));
+        
+        buffer_.insert(buffer_.end(), frame.begin(), frame.end());
+        buffered_lsn_ = lsn;
+        records_appended_++;
+        return lsn;
+    }
+    
+    bool WriteAheadLog::commit(Lsn lsn) {
+        if (fd_ < 0) {
+            return false;
+        }
+        
+        commits_++;
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!synchronous_commit_) {
+            return !failed_;  // The flusher picks it up within the flush interval
+        }
+        return wait_durable(lock, lsn == INVALID_LSN ? buffered_lsn_ : lsn);
+    }
+    
+    bool WriteAheadLog::flush() {
+        if (fd_ < 0) {
+            return false;
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex_);
+        return wait_durable(lock, buffered_lsn_);
+    }
+    
+    bool WriteAheadLog::truncate() {
+        if (!flush()) {
+            return false;
+        }
+        
+        // The flusher is idle once everything appended is durable; anything
+        // appended since the flush would be lost, so refuse
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!buffer_.empty() || durable_lsn_ != buffered_lsn_) {
+            return false;
+        }
+        if (!truncate_file(fd_, 0) || !sync_file()) {
+            return false;
+        }
+        durable_size_ = 0;
+        return true;
+    }
+    
+    void WriteAheadLog::set_next_lsn(Lsn lsn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (lsn > next_lsn_) {
+            next_lsn_ = lsn;
+            durable_lsn_ = lsn - 1;
+            buffered_lsn_ = lsn - 1;
+        }
+    }
+    
+    bool WriteAheadLog::wait_durable(std::unique_lock<std::mutex>& lock, Lsn lsn) {
+        if (durable_lsn_ >= lsn || failed_) {
+            return !failed_;
+        }
+        
+        // Everyone waiting here is served by the same sync once the flusher
+        // takes the buffer, so concurrent commits cost one fsync per batch
+        sync_requests_++;
+        flush_requested_.notify_one();
+        durable_advanced_.wait(lock, [&] { return durable_lsn_ >= lsn || failed_; });
+        sync_requests_--;
+        
+        return !failed_;
+    }
+    
+    void WriteAheadLog::flusher_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        
+        while (true) {
+            flush_requested_.wait_for(lock, flush_interval_, [this] {
+                return stopping_ || (sync_requests_ > 0 && !buffer_.empty());
+            });
+            
+            if (buffer_.empty()) {
+                if (stopping_) {
+                    break;
+                }
+                continue;
+            }
+            
+            // After a failure nothing more reaches the file; the commits
+            // behind these records have been told they failed
+            if (failed_) {
+                buffer_.clear();
+                continue;
+            }
+            
+            std::vector<char> batch;
+            batch.swap(buffer_);
+            Lsn batch_lsn = buffered_lsn_;
+            
+            // Appends and new commit requests proceed while this batch syncs
+            lock.unlock();
+            bool ok = write_fully(batch) && sync_file();
+            lock.lock();
+            
+            if (ok) {
+                durable_lsn_ = batch_lsn;
+                durable_size_ += batch.size();
+                bytes_written_ += batch.size();
+                syncs_++;
+            } else {
+                // Cut off whatever part of the batch got in, so a restart
+                // can't replay commits that were reported as failed
+                failed_ = true;
+                if (truncate_file(fd_, static_cast<long long>(durable_size_))) {
+                    sync_file();
+                }
+            }
+            durable_advanced_.notify_all();
+        }
+    }
+    
+    bool WriteAheadLog::write_fully(const std::vector<char>& data) {
+        size_t done = 0;
+        
+        while (done < data.size()) {
+#ifdef _WIN32
+            long long n = ::_write(fd_, data.data() + done, static_cast<unsigned int>(data.size() - done));
+#else
+            long long n = ::write(fd_, data.data() + done, data.size() - done);
+#endif
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        
+        return true;
+    }
+    
+    bool WriteAheadLog::sync_file() {
+#ifdef _WIN32
+        return ::_commit(fd_) == 0;
+#else
+        return ::fsync(fd_) == 0;
+#endif
+    }
+    
+    bool WriteAheadLog::read_records(const std::function<bool(const LogRecord&)>* visitor,
+                                     uint64_t& valid_end, Lsn& last_lsn) {
+        long long size = file_size(fd_);
+        if (size < 0) {
+            return false;
+        }
+        
+        uint64_t offset = 0;
+        std::vector<char> body;
+        LogRecord record;
+        
+        while (offset + FRAME_HEADER_SIZE <= static_cast<uint64_t>(size)) {
+            char header[FRAME_HEADER_SIZE];
+            if (!read_fully(fd_, header, FRAME_HEADER_SIZE, static_cast<long long>(offset))) {
+                break;
+            }
+            
+            uint32_t body_length = 0;
+            uint32_t checksum = 0;
+            std::memcpy(&body_length, header, sizeof(body_length));
+            std::memcpy(&checksum, header + 4, sizeof(checksum));
+            
+            uint64_t body_offset = offset + FRAME_HEADER_SIZE;
+            if (body_length > MAX_RECORD_SIZE || body_offset + body_length > static_cast<uint64_t>(size)) {
+                break;  // Torn write at the tail
+            }
+            
+            body.resize(body_length);
+            if (!read_fully(fd_, body.data(), body_length, static_cast<long long>(body_offset)) ||
+                crc32(body.data(), body_length) != checksum) {
+                break;
+            }
+            
+            ByteReader reader(body.data(), body.size());
+            uint8_t type = 0;
+            if (!reader.read(record.lsn) || !reader.read(type) || !reader.read_string(record.table_name)) {
+                break;
+            }
+            record.type = static_cast<LogRecordType>(type);
+            record.payload.assign(reader.current(), reader.current() + reader.remaining());
+            
+            offset = body_offset + body_length;
+            valid_end = offset;
+            last_lsn = record.lsn;
+            
+            if (visitor != nullptr && !(*visitor)(record)) {
+                break;
+            }
+        }
+        
+        return true;
+    }
+    
+    WriteAheadLog::Stats WriteAheadLog::get_stats() const {
+        Stats stats;
+        stats.records_appended = records_appended_;
+        stats.bytes_written = bytes_written_;
+        stats.commits = commits_;
+        stats.syncs = syncs_;
+        return stats;
+    }
+
+} // namespace storage
+} // namespace minidb
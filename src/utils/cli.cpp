@@ -4,6 +4,7 @@
  */
 
 #include "minidb/utils/cli.h"
+#include "minidb/utils/metrics.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -14,18 +15,54 @@
 namespace minidb {
 namespace utils {
 
+    namespace {
+
+        // Feeds streamed rows from the executor into a formatter
+        class FormatterSink : public query::ResultSink {
+        public:
+            FormatterSink(ResultFormatter& formatter, std::ostream& output)
+                : formatter_(formatter), output_(output), started_(false) {}
+                
+            void begin(const std::vector<std::string>& column_names) override {
+                formatter_.begin_rows(column_names, output_);
+                started_ = true;
+            }
+            
+            bool accept(const storage::Row& row) override {
+                formatter_.add_row(row, output_);
+                return true;
+            }
+            
+            bool started() const { return started_; }
+            
+        private:
+            ResultFormatter& formatter_;
+            std::ostream& output_;
+            bool started_;
+        };
+
+    } // namespace
+    
+    // ResultFormatter streaming defaults: collect the rows, then format()
+    void ResultFormatter::begin_rows(const std::vector<std::string>& column_names, std::ostream& output) {
+        stream_columns_ = column_names;
+        stream_rows_.clear();
+    }
+    
+    void ResultFormatter::add_row(const storage::Row& row, std::ostream& output) {
+        stream_rows_.push_back(row);
+    }
+    
+    void ResultFormatter::end_rows(std::ostream& output) {
+        format(query::QueryResult(stream_rows_, stream_columns_), output);
+        stream_rows_.clear();
+    }
+    
     // TableFormatter implementation
     std::vector<size_t> TableFormatter::calculate_column_widths(
-        const query::QueryResult& result) const {
+        const std::vector<std::string>& column_names, const std::vector<storage::Row>& rows) const {
         std::vector<size_t> widths;
         
-        if (!result.has_data()) {
-            return widths;
-        }
-        
-        const auto& column_names = result.get_column_names();
-        const auto& rows = result.get_rows();
-        
         // Initialize with column name lengths
         for (const auto& name : column_names) {
             widths.push_back(std::min(name.length(), max_column_width_));
@@ -78,9 +115,32 @@ namespace utils {
             return;
         }
         
-        const auto& column_names = result.get_column_names();
-        const auto& rows = result.get_rows();
-        std::vector<size_t> widths = calculate_column_widths(result);
+        print_rows(result.get_column_names(), result.get_rows(), result.get_rows().size(), output);
+    }
+    
+    void TableFormatter::begin_rows(const std::vector<std::string>& column_names, std::ostream& output) {
+        stream_columns_ = column_names;
+        stream_rows_.clear();
+        stream_total_ = 0;
+    }
+    
+    void TableFormatter::add_row(const storage::Row& row, std::ostream& output) {
+        // Only the rows that will be printed are kept; the rest are counted
+        if (stream_rows_.size() < max_rows_) {
+            stream_rows_.push_back(row);
+        }
+        stream_total_++;
+    }
+    
+    void TableFormatter::end_rows(std::ostream& output) {
+        print_rows(stream_columns_, stream_rows_, stream_total_, output);
+        stream_rows_.clear();
+    }
+    
+    void TableFormatter::print_rows(const std::vector<std::string>& column_names,
+                                    const std::vector<storage::Row>& rows,
+                                    size_t total_rows, std::ostream& output) const {
+        std::vector<size_t> widths = calculate_column_widths(column_names, rows);
         
         if (widths.empty()) {
             output << "No data to display.\n";
@@ -121,12 +181,12 @@ namespace utils {
         print_separator(widths, output);
         
         // Show row count
-        output << "(" << rows.size() << " row";
-        if (rows.size() != 1) output << "s";
+        output << "(" << total_rows << " row";
+        if (total_rows != 1) output << "s";
         output << ")\n";
         
-        if (rows.size() > max_rows_) {
-            output << "... and " << (rows.size() - max_rows_) << " more rows\n";
+        if (total_rows > max_rows_) {
+            output << "... and " << (total_rows - max_rows_) << " more rows\n";
         }
     }
     
@@ -207,14 +267,21 @@ namespace utils {
     void CLI::execute_sql(const std::string& sql) {
         auto start_time = std::chrono::high_resolution_clock::now();
         
-        query::QueryResult result = executor_->execute_sql(sql);
+        // SELECT rows are printed as they are produced
+        FormatterSink sink(*formatter_, std::cout);
+        query::QueryResult result = executor_->execute_sql(sql, &sink);
+        if (sink.started()) {
+            formatter_->end_rows(std::cout);
+        }
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
             end_time - start_time);
-        
-        // Format and display result
-        formatter_->format(result, std::cout);
+            
+        // Format and display everything else
+        if (!sink.started() || !result.is_success()) {
+            formatter_->format(result, std::cout);
+        }
         
         // Show query time if enabled
         if (config_.show_query_time) {
@@ -237,6 +304,8 @@ namespace utils {
             [this](const auto& args) { handle_tables(args); });
         commands_.emplace_back("describe", "Describe table structure", 
             [this](const auto& args) { handle_describe(args); });
+        commands_.emplace_back("metrics", "Show engine metrics ('metrics reset' to zero)", 
+            [this](const auto& args) { handle_metrics(args); });
     }
     
     void CLI::handle_help(const std::vector<std::string>& args) {
@@ -252,6 +321,8 @@ namespace utils {
         std::cout << "  SELECT       - Query data from table\n";
         std::cout << "  UPDATE       - Update existing data\n";
         std::cout << "  DELETE       - Delete data from table\n";
+        std::cout << "  ANALYZE      - Gather statistics for the planner\n";
+        std::cout << "  EXPLAIN      - Show a statement's plan (ANALYZE runs it)\n";
         std::cout << "\n";
     }
     
@@ -305,9 +376,22 @@ namespace utils {
             std::cout << "\n";
         }
         
+        if (schema.get_storage_format() == storage::StorageFormat::COLUMNAR) {
+            std::cout << "Storage: columnar\n";
+        }
         std::cout << "Rows: " << table->row_count() << "\n\n";
     }
     
+    void CLI::handle_metrics(const std::vector<std::string>& args) {
+        if (!args.empty() && args[0] == "reset") {
+            utils::MetricsRegistry::global().reset();
+            std::cout << "Metrics reset.\n\n";
+            return;
+        }
+        
+        std::cout << utils::MetricsRegistry::global().snapshot().to_string() << "\n";
+    }
+    
     std::vector<std::string> CLI::parse_input(const std::string& input) {
         std::vector<std::string> tokens;
         std::istringstream iss(input);
@@ -0,0 +1,132 @@
+/**
+ * @file csv_reader.cpp
+ * @brief Streaming CSV reader implementation
+ */
+
+#include "minidb/utils/csv_reader.h"
+
+namespace minidb {
+namespace utils {
+
+    CsvReader::CsvReader(char delimiter)
+        : delimiter_(delimiter), file_(nullptr), pos_(0), end_(0), line_(1), record_line_(0) {
+    }
+    
+    CsvReader::~CsvReader() {
+        close();
+    }
+    
+    bool CsvReader::open(const std::string& path) {
+        close();
+        
+        file_ = std::fopen(path.c_str(), "rb");
+        if (file_ == nullptr) {
+            error_ = "Cannot open " + path;
+            return false;
+        }
+        
+        buffer_.resize(CHUNK_BYTES);
+        pos_ = 0;
+        end_ = 0;
+        line_ = 1;
+        record_line_ = 0;
+        error_.clear();
+        return true;
+    }
+    
+    void CsvReader::close() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+    
+    bool CsvReader::fill() {
+        if (pos_ < end_) {
+            return true;
+        }
+        if (file_ == nullptr) {
+            return false;
+        }
+        
+        pos_ = 0;
+        end_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+        if (end_ == 0 && std::ferror(file_)) {
+            error_ = "Read error";
+        }
+        return end_ > 0;
+    }
+    
+    bool CsvReader::next(std::vector<CsvField>& fields) {
+        fields.clear();
+        record_.clear();
+        spans_.clear();
+        
+        // Skip blank lines between records
+        while (fill() && (buffer_[pos_] == '\n' || buffer_[pos_] == '\r')) {
+            if (buffer_[pos_] == '\n') {
+                line_++;
+            }
+            pos_++;
+        }
+        if (pos_ >= end_) {
+            return false;
+        }
+        record_line_ = line_;
+        
+        Span field{0, 0, false};
+        bool in_quotes = false;
+        while (fill()) {
+            char c = buffer_[pos_++];
+            
+            if (in_quotes) {
+                if (c != '"') {
+                    if (c == '\n') {
+                        line_++;
+                    }
+                    record_ += c;
+                } else if (fill() && buffer_[pos_] == '"') {
+                    record_ += '"';  // "" inside quotes is a literal quote
+                    pos_++;
+                } else {
+                    in_quotes = false;
+                }
+                continue;
+            }
+            
+            if (c == '"' && !field.quoted && record_.size() == field.begin) {
+                in_quotes = true;
+                field.quoted = true;
+            } else if (c == delimiter_) {
+                field.end = record_.size();
+                spans_.push_back(field);
+                field = Span{record_.size(), 0, false};
+            } else if (c == '\n') {
+                line_++;
+                break;
+            } else if (c != '\r') {
+                record_ += c;
+            }
+        }
+        
+        if (in_quotes) {
+            error_ = "Unterminated quoted field starting on line " + std::to_string(record_line_);
+            return false;
+        }
+        if (!error_.empty()) {
+            return false;
+        }
+        
+        field.end = record_.size();
+        spans_.push_back(field);
+        
+        // record_ no longer grows, so views into it stay put
+        std::string_view text(record_);
+        for (const Span& span : spans_) {
+            fields.push_back(CsvField{text.substr(span.begin, span.end - span.begin), span.quoted});
+        }
+        return true;
+    }
+
+} // namespace utils
+} // namespace minidb
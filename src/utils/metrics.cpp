@@ -0,0 +1,163 @@
+/**
+ * @file metrics.cpp
+ * @brief Metrics registry implementation
+ */
+
+#include "minidb/utils/metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace minidb {
+namespace utils {
+
+    namespace {
+    
+        // Bucket i holds [2^i, 2^(i+1)) nanoseconds; bucket 0 also holds 0
+        size_t bucket_for(uint64_t ns) {
+            size_t bucket = 0;
+            while (ns > 1 && bucket + 1 < LatencyHistogram::BUCKETS) {
+                ns >>= 1;
+                bucket++;
+            }
+            return bucket;
+        }
+    
+    } // anonymous namespace
+    
+    void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+        uint64_t ns = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+        buckets_[bucket_for(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_ns_.fetch_add(ns, std::memory_order_relaxed);
+        
+        uint64_t max = max_ns_.load(std::memory_order_relaxed);
+        while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+            // max was reloaded by the failed exchange; retry
+        }
+    }
+    
+    LatencyHistogram::Summary LatencyHistogram::summarize() const {
+        Summary summary;
+        summary.count = count_.load(std::memory_order_relaxed);
+        if (summary.count == 0) {
+            return summary;
+        }
+        summary.mean_us = static_cast<double>(total_ns_.load(std::memory_order_relaxed)) /
+                          static_cast<double>(summary.count) / 1000.0;
+        summary.p50_us = percentile(0.50, summary.count);
+        summary.p95_us = percentile(0.95, summary.count);
+        summary.p99_us = percentile(0.99, summary.count);
+        summary.max_us = static_cast<double>(max_ns_.load(std::memory_order_relaxed)) / 1000.0;
+        return summary;
+    }
+    
+    double LatencyHistogram::percentile(double fraction, uint64_t count) const {
+        // The upper bound of the bucket holding the rank, but never past the max
+        auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+        uint64_t seen = 0;
+        size_t bucket = 0;
+        for (; bucket + 1 < BUCKETS; bucket++) {
+            seen += buckets_[bucket].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                break;
+            }
+        }
+        double upper_ns = std::ldexp(1.0, static_cast<int>(bucket) + 1);
+        return std::min(upper_ns, static_cast<double>(max_ns_.load(std::memory_order_relaxed))) / 1000.0;
+    }
+    
+    void LatencyHistogram::reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        total_ns_.store(0, std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+    }
+    
+    std::string MetricsSnapshot::to_string() const {
+        std::ostringstream out;
+        size_t width = 0;
+        for (const auto& [name, value] : counters) {
+            width = std::max(width, name.size());
+        }
+        for (const auto& [name, summary] : histograms) {
+            width = std::max(width, name.size());
+        }
+        
+        for (const auto& [name, value] : counters) {
+            out << std::left << std::setw(static_cast<int>(width)) << name << "  " << value << "\n";
+        }
+        out << std::fixed << std::setprecision(1);
+        for (const auto& [name, summary] : histograms) {
+            out << std::left << std::setw(static_cast<int>(width)) << name << "  count=" << summary.count
+                << " mean=" << summary.mean_us << "us p50=" << summary.p50_us << "us p95=" << summary.p95_us
+                << "us p99=" << summary.p99_us << "us max=" << summary.max_us << "us\n";
+        }
+        return out.str();
+    }
+    
+    MetricsRegistry& MetricsRegistry::global() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+    
+    Counter& MetricsRegistry::counter(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = counters_[name];
+        if (!slot) {
+            slot = std::make_unique<Counter>();
+        }
+        return *slot;
+    }
+    
+    LatencyHistogram& MetricsRegistry::histogram(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = histograms_[name];
+        if (!slot) {
+            slot = std::make_unique<LatencyHistogram>();
+        }
+        return *slot;
+    }
+    
+    void MetricsRegistry::add_source(const void* owner, Source source) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sources_.emplace_back(owner, std::move(source));
+    }
+    
+    void MetricsRegistry::remove_source(const void* owner) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sources_.erase(std::remove_if(sources_.begin(), sources_.end(),
+                                      [owner](const auto& source) { return source.first == owner; }),
+                       sources_.end());
+    }
+    
+    MetricsSnapshot MetricsRegistry::snapshot() const {
+        MetricsSnapshot snapshot;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, counter] : counters_) {
+            snapshot.counters[name] = counter->value();
+        }
+        for (const auto& [name, histogram] : histograms_) {
+            snapshot.histograms[name] = histogram->summarize();
+        }
+        for (const auto& source : sources_) {
+            source.second(snapshot);
+        }
+        return snapshot;
+    }
+    
+    void MetricsRegistry::reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [name, counter] : counters_) {
+            counter->reset();
+        }
+        for (auto& [name, histogram] : histograms_) {
+            histogram->reset();
+        }
+    }
+
+} // namespace utils
+} // namespace minidb
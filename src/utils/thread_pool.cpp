@@ -0,0 +1,104 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Worker pool implementation
+ */
+
+#include "minidb/utils/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace minidb {
+namespace utils {
+
+    ThreadPool::ThreadPool(size_t threads) : stopping_(false) {
+        for (size_t i = 0; i < threads; i++) {
+            workers_.emplace_back(&ThreadPool::worker_loop, this);
+        }
+    }
+    
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        job_ready_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+    
+    void ThreadPool::parallel_for(size_t count, size_t max_threads, const std::function<void(size_t)>& task) {
+        if (count == 0) {
+            return;
+        }
+        
+        struct State {
+            std::atomic<size_t> next{0};
+            size_t running = 0;
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto state = std::make_shared<State>();
+        
+        auto drain = [state, count, &task]() {
+            for (size_t i = state->next++; i < count; i = state->next++) {
+                task(i);
+            }
+        };
+        
+        // The caller drains too, so only count - 1 helpers can be useful
+        size_t helpers = std::min({workers_.size(), max_threads > 0 ? max_threads - 1 : 0, count - 1});
+        state->running = helpers;
+        if (helpers > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < helpers; i++) {
+                jobs_.emplace_back([state, drain]() {
+                    drain();
+                    std::lock_guard<std::mutex> done_lock(state->mutex);
+                    if (--state->running == 0) {
+                        state->finished.notify_one();
+                    }
+                });
+            }
+        }
+        job_ready_.notify_all();
+        
+        drain();
+        
+        // task is borrowed by the helpers, so wait for every one of them
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state]() { return state->running == 0; });
+    }
+    
+    void ThreadPool::submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(std::move(job));
+        }
+        job_ready_.notify_one();
+    }
+    
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+    
+    void ThreadPool::worker_loop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                job_ready_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return;  // Stopping with nothing left to run
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+
+} // namespace utils
+} // namespace minidb
@@ -3,8 +3,11 @@
  * @brief B-Tree tests
  */
 
+#include "minidb/core/bplus_tree.h"
 #include "minidb/core/btree.h"
+#include <algorithm>
 #include <iostream>
+#include <random>
 
 using namespace minidb::core;
 
@@ -47,3 +50,198 @@ bool test_btree_insert_search() {
     
     return true;
 }
+
+bool test_btree_range_query() {
+    BTree<int, 5> btree;
+    for (int i = 0; i < 200; i++) {
+        btree.insert((i * 37) % 200);
+    }
+    
+    std::vector<int> range = btree.range_query(50, 59);
+    if (range.size() != 10) return false;
+    for (int i = 0; i < 10; i++) {
+        if (range[i] != 50 + i) return false;
+    }
+    
+    if (!btree.range_query(300, 400).empty()) return false;
+    if (btree.range_query(-10, 500).size() != 200) return false;
+    
+    return true;
+}
+
+bool test_bplus_tree_range_scan() {
+    // A small order forces a deep tree with many leaf splits
+    BPlusTree<int, 4> tree;
+    
+    std::vector<int> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(i * 2);
+    }
+    std::shuffle(values.begin(), values.end(), std::mt19937(42));
+    
+    for (int val : values) {
+        if (!tree.insert(val)) return false;
+    }
+    if (tree.insert(values[0])) return false;  // Duplicates are rejected
+    if (tree.size() != values.size()) return false;
+    if (tree.height() < 5) return false;
+    
+    for (int i = 0; i < 2000; i++) {
+        if (tree.search(i) != (i % 2 == 0)) return false;
+    }
+    
+    // Leaf chain yields every key in order
+    int expected = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        if (*it != expected) return false;
+        expected += 2;
+    }
+    if (expected != 2000) return false;
+    
+    // Seek lands on the first key not less than the target
+    auto it = tree.seek(101);
+    if (!it.valid() || it.key() != 102) return false;
+    if (tree.seek(1999).valid()) return false;
+    if (!tree.last().valid() || tree.last().key() != 1998) return false;
+    if (BPlusTree<int, 4>().last().valid()) return false;
+    
+    // Walking backwards one predecessor at a time, across every leaf
+    expected = 1998;
+    for (auto back = tree.last(); back.valid(); back = tree.seek_before(back.key())) {
+        if (back.key() != expected) return false;
+        expected -= 2;
+    }
+    if (expected != -2) return false;
+    if (tree.seek_before(101).key() != 100 || tree.seek_before(100).key() != 98) return false;
+    if (tree.seek_before(0).valid() || tree.seek_before(5000).key() != 1998) return false;
+    
+    std::vector<int> range = tree.range_query(101, 121);
+    if (range.size() != 10 || range.front() != 102 || range.back() != 120) return false;
+    
+    size_t visited = 0;
+    tree.range_scan(0, 1998, [&visited](int) {
+        return ++visited < 5;
+    });
+    if (visited != 5) return false;
+    
+    return true;
+}
+
+bool test_btree_large_fanout() {
+    BTree<int, 64> btree;
+    BPlusTree<int> bplus_tree;
+    
+    std::vector<int> values;
+    for (int i = 0; i < 100000; i++) {
+        values.push_back(i);
+    }
+    std::shuffle(values.begin(), values.end(), std::mt19937(7));
+    
+    for (int val : values) {
+        if (!btree.insert(val)) return false;
+        if (!bplus_tree.insert(val)) return false;
+    }
+    
+    for (int i = -5; i < 100005; i += 3) {
+        bool expected = (i >= 0 && i < 100000);
+        if (btree.search(i) != expected) return false;
+        if (bplus_tree.search(i) != expected) return false;
+    }
+    
+    // Wide nodes keep the tree shallow
+    if (bplus_tree.height() > 3) return false;
+    if (bplus_tree.node_count() > 100000 / (BPlusTree<int>::MAX_KEYS / 2) + 16) return false;
+    
+    if (btree.min() != 0 || btree.max() != 99999) return false;
+    if (bplus_tree.range_query(500, 1499).size() != 1000) return false;
+    
+    return true;
+}
+
+bool test_btree_remove() {
+    BTree<int, 5> btree;
+    BPlusTree<int, 4> bplus_tree;
+    
+    std::vector<int> values;
+    for (int i = 0; i < 2000; i++) {
+        values.push_back(i);
+    }
+    std::shuffle(values.begin(), values.end(), std::mt19937(3));
+    for (int val : values) {
+        btree.insert(val);
+        bplus_tree.insert(val);
+    }
+    
+    // Remove the odd keys in a different order; merges and borrows keep
+    // both trees searchable
+    std::shuffle(values.begin(), values.end(), std::mt19937(4));
+    for (int val : values) {
+        if (val % 2 == 0) continue;
+        if (!btree.remove(val) || !bplus_tree.remove(val)) return false;
+    }
+    if (btree.remove(1) || bplus_tree.remove(1)) return false;
+    if (btree.size() != 1000 || bplus_tree.size() != 1000) return false;
+    
+    for (int i = 0; i < 2000; i++) {
+        if (btree.search(i) != (i % 2 == 0)) return false;
+        if (bplus_tree.search(i) != (i % 2 == 0)) return false;
+    }
+    std::vector<int> range = bplus_tree.range_query(100, 120);
+    if (range.size() != 11 || range.front() != 100 || range.back() != 120) return false;
+    
+    // Emptying the trees collapses them back to a single leaf
+    for (int val : values) {
+        if (val % 2 != 0) continue;
+        if (!btree.remove(val) || !bplus_tree.remove(val)) return false;
+    }
+    if (!btree.empty() || !bplus_tree.empty()) return false;
+    if (bplus_tree.height() != 1 || bplus_tree.node_count() != 1) return false;
+    if (bplus_tree.begin() != bplus_tree.end()) return false;
+    
+    return true;
+}
+
+bool test_bplus_tree_bulk_load() {
+    BPlusTree<int, 4> tree;
+    
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; i++) {
+        keys.push_back(i * 2);
+    }
+    tree.bulk_load(keys);
+    if (tree.size() != 1000 || tree.height() < 5) return false;
+    
+    int expected = 0;
+    for (auto it = tree.begin(); it.valid(); it.next()) {
+        if (*it != expected) return false;
+        expected += 2;
+    }
+    if (expected != 2000) return false;
+    if (!tree.search(998) || tree.search(999)) return false;
+    
+    // Merging skips keys already present and rebuilds around the rest
+    std::vector<int> more;
+    for (int i = 0; i < 2000; i += 3) {
+        more.push_back(i);
+    }
+    size_t added = tree.merge(more);
+    if (added != 333 || tree.size() != 1333) return false;
+    if (!tree.search(3) || !tree.search(4) || tree.search(5)) return false;
+    if (tree.range_query(0, 12).size() != 9) return false;
+    
+    // A bulk-loaded tree stays balanced under ordinary updates
+    for (int i = 0; i < 2000; i++) {
+        if (i % 2 == 0 || i % 3 == 0) {
+            if (!tree.remove(i)) return false;
+        } else if (!tree.insert(i)) {
+            return false;
+        }
+    }
+    if (tree.size() != 2000 - 1333) return false;
+    if (tree.search(0) || !tree.search(1) || !tree.search(1999)) return false;
+    
+    tree.bulk_load({});
+    if (!tree.empty() || tree.height() != 1 || tree.node_count() != 1) return false;
+    
+    return true;
+}
@@ -4,7 +4,10 @@
  */
 
 #include "minidb/core/hashmap.h"
+#include "minidb/core/flat_hash_map.h"
 #include <iostream>
+#include <string>
+#include <unordered_map>
 
 using namespace minidb::core;
 
@@ -51,3 +54,71 @@ bool test_hashmap_operations() {
     
     return true;
 }
+
+bool test_flat_hash_map() {
+    FlatHashMap<int, int> map;
+    std::unordered_map<int, int> reference;
+    
+    // try_emplace reports whether the key was new
+    auto first = map.try_emplace(7, 70);
+    if (!first.second || *first.first != 70) return false;
+    auto again = map.try_emplace(7, 700);
+    if (again.second || *again.first != 70) return false;
+    reference[7] = 70;
+    
+    // Enough inserts to force several resizes
+    for (int i = 0; i < 5000; i++) {
+        int key = i * 31;
+        if (map.insert(key, i) != reference.emplace(key, i).second) return false;
+    }
+    
+    // Interleave removes and re-inserts so tombstones pile up and
+    // trigger same-capacity cleanups
+    for (int round = 0; round < 20; round++) {
+        for (int i = round; i < 5000; i += 3) {
+            int key = i * 31;
+            if (map.remove(key) != (reference.erase(key) == 1)) return false;
+        }
+        for (int i = round; i < 5000; i += 5) {
+            int key = i * 31;
+            if (map.upsert(key, round) != (reference.count(key) == 0)) return false;
+            reference[key] = round;
+        }
+    }
+    
+    if (map.size() != reference.size()) return false;
+    for (const auto& entry : reference) {
+        const int* value = map.find(entry.first);
+        if (!value || *value != entry.second) return false;
+    }
+    if (map.contains(-1)) return false;
+    
+    size_t visited = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        auto ref = reference.find(it->key);
+        if (ref == reference.end() || ref->second != it->value) return false;
+        visited++;
+    }
+    if (visited != reference.size()) return false;
+    
+    // Explicit rehash keeps every entry
+    map.rehash(map.capacity() * 4);
+    if (map.size() != reference.size()) return false;
+    for (const auto& entry : reference) {
+        const int* value = map.find(entry.first);
+        if (!value || *value != entry.second) return false;
+    }
+    
+    // Non-trivial keys, operator[] default-constructs
+    FlatHashMap<std::string, std::string> strings;
+    strings["alpha"] += "a";
+    strings["alpha"] += "b";
+    if (*strings.find("alpha") != "ab") return false;
+    if (!strings.remove("alpha") || !strings.empty()) return false;
+    
+    strings.insert("beta", "b");
+    strings.clear();
+    if (!strings.empty() || strings.contains("beta")) return false;
+    
+    return true;
+}
@@ -53,8 +53,52 @@ void add_test(const std::string& name, std::function<bool()> test_func) {
 // Forward declarations for test functions
 extern bool test_btree_basic();
 extern bool test_btree_insert_search();
+extern bool test_btree_range_query();
+extern bool test_bplus_tree_range_scan();
+extern bool test_btree_large_fanout();
+extern bool test_btree_remove();
+extern bool test_bplus_tree_bulk_load();
 extern bool test_hashmap_basic();
 extern bool test_hashmap_operations();
+extern bool test_flat_hash_map();
+extern bool test_page_manager_disk_roundtrip();
+extern bool test_replacement_policies();
+extern bool test_page_manager_concurrent_access();
+extern bool test_table_heap_storage();
+extern bool test_btree_index_range_query();
+extern bool test_btree_index_maintenance();
+extern bool test_columnar_table();
+extern bool test_row_directory();
+extern bool test_value_representation();
+extern bool test_table_statistics();
+extern bool test_wal_recovery();
+extern bool test_wal_torn_tail();
+extern bool test_wal_group_commit();
+extern bool test_snapshot_reopen();
+extern bool test_snapshot_isolation();
+extern bool test_concurrent_transfers();
+extern bool test_commit_durable_before_visible();
+extern bool test_sql_transactions();
+#ifdef __linux__
+extern bool test_server_pipelining();
+extern bool test_server_sessions();
+extern bool test_server_stalled_client();
+#endif
+extern bool test_planner_index_selection();
+extern bool test_streaming_execution();
+extern bool test_vector_filter_kernels();
+extern bool test_compiled_predicates();
+extern bool test_parallel_scan();
+extern bool test_joins();
+extern bool test_aggregates();
+extern bool test_prepared_statements();
+extern bool test_tokenizer();
+extern bool test_bulk_load();
+extern bool test_update_delete();
+extern bool test_order_by_limit();
+extern bool test_cost_based_planning();
+extern bool test_explain();
+extern bool test_metrics_registry();
 
 int main() {
     std::cout << "Running MiniDB tests...\n\n";
@@ -62,8 +106,52 @@ int main() {
     // Register external tests
     add_test("btree_basic", test_btree_basic);
     add_test("btree_insert_search", test_btree_insert_search);
+    add_test("btree_range_query", test_btree_range_query);
+    add_test("bplus_tree_range_scan", test_bplus_tree_range_scan);
+    add_test("btree_large_fanout", test_btree_large_fanout);
+    add_test("btree_remove", test_btree_remove);
+    add_test("bplus_tree_bulk_load", test_bplus_tree_bulk_load);
     add_test("hashmap_basic", test_hashmap_basic);
     add_test("hashmap_operations", test_hashmap_operations);
+    add_test("flat_hash_map", test_flat_hash_map);
+    add_test("page_manager_disk_roundtrip", test_page_manager_disk_roundtrip);
+    add_test("replacement_policies", test_replacement_policies);
+    add_test("page_manager_concurrent_access", test_page_manager_concurrent_access);
+    add_test("table_heap_storage", test_table_heap_storage);
+    add_test("btree_index_range_query", test_btree_index_range_query);
+    add_test("btree_index_maintenance", test_btree_index_maintenance);
+    add_test("columnar_table", test_columnar_table);
+    add_test("row_directory", test_row_directory);
+    add_test("value_representation", test_value_representation);
+    add_test("table_statistics", test_table_statistics);
+    add_test("wal_recovery", test_wal_recovery);
+    add_test("wal_torn_tail", test_wal_torn_tail);
+    add_test("wal_group_commit", test_wal_group_commit);
+    add_test("snapshot_reopen", test_snapshot_reopen);
+    add_test("snapshot_isolation", test_snapshot_isolation);
+    add_test("concurrent_transfers", test_concurrent_transfers);
+    add_test("commit_durable_before_visible", test_commit_durable_before_visible);
+    add_test("sql_transactions", test_sql_transactions);
+#ifdef __linux__
+    add_test("server_pipelining", test_server_pipelining);
+    add_test("server_sessions", test_server_sessions);
+    add_test("server_stalled_client", test_server_stalled_client);
+#endif
+    add_test("planner_index_selection", test_planner_index_selection);
+    add_test("streaming_execution", test_streaming_execution);
+    add_test("vector_filter_kernels", test_vector_filter_kernels);
+    add_test("compiled_predicates", test_compiled_predicates);
+    add_test("parallel_scan", test_parallel_scan);
+    add_test("joins", test_joins);
+    add_test("aggregates", test_aggregates);
+    add_test("prepared_statements", test_prepared_statements);
+    add_test("tokenizer", test_tokenizer);
+    add_test("bulk_load", test_bulk_load);
+    add_test("update_delete", test_update_delete);
+    add_test("order_by_limit", test_order_by_limit);
+    add_test("cost_based_planning", test_cost_based_planning);
+    add_test("explain", test_explain);
+    add_test("metrics_registry", test_metrics_registry);
     
     int passed = 0;
     int failed = 0;
@@ -0,0 +1,1296 @@
+/**
+ * @file test_query.cpp
+ * @brief Query planner and executor tests
+ */
+
+#include "minidb/query/compiled_expression.h"
+#include "minidb/query/executor.h"
+#include "minidb/query/parser.h"
+#include "minidb/query/plan_cache.h"
+#include "minidb/query/vector_batch.h"
+#include "minidb/utils/cli.h"
+#include "minidb/utils/metrics.h"
+#include "minidb/utils/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+using namespace minidb::query;
+using namespace minidb::storage;
+
+static std::vector<uint64_t> sorted_ids(const QueryResult& result) {
+    std::vector<uint64_t> ids;
+    for (const auto& row : result.get_rows()) {
+        ids.push_back(row.get_id());
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+bool test_planner_index_selection() {
+    PageManager page_manager;
+    // The tokenizer upper-cases identifiers
+    TableSchema schema("ITEMS");
+    schema.add_column(Column("ID", ColumnType::INTEGER));
+    schema.add_column(Column("TAG", ColumnType::TEXT));
+    Table table(schema, &page_manager);
+
+    for (int64_t i = 0; i < 300; i++) {
+        Row row;
+        row.add_value(Value(i));
+        row.add_value(Value("tag_" + std::to_string(i % 7)));
+        if (table.insert_row(row) == 0) return false;
+    }
+    if (!table.create_index("ID", "btree")) return false;
+    if (!table.create_index("TAG", "hash")) return false;
+
+    std::unordered_map<std::string, Table*> tables{{"ITEMS", &table}};
+    QueryPlanner planner(&tables);
+    Parser parser;
+
+    // Each query must plan to the expected node and agree with a full scan
+    struct Case {
+        std::string sql;
+        bool lookup;
+        bool range;
+        size_t expected_rows;
+    };
+    const std::vector<Case> cases = {
+        {"SELECT * FROM items WHERE id = 42", true, false, 1},
+        {"SELECT * FROM items WHERE 42 = id", true, false, 1},
+        {"SELECT * FROM items WHERE id >= 290", false, true, 10},
+        {"SELECT * FROM items WHERE id > 290", false, true, 9},
+        {"SELECT * FROM items WHERE 10 > id", false, true, 10},
+        {"SELECT * FROM items WHERE tag = 'tag_3'", true, false, 43},
+        {"SELECT * FROM items WHERE tag > 'tag_3'", false, false, 128},
+        {"SELECT * FROM items WHERE id != 5", false, false, 299},
+    };
+
+    for (const auto& c : cases) {
+        auto stmt = parser.parse(c.sql);
+        if (!stmt) return false;
+        auto plan = planner.create_plan(stmt.get());
+        if (!plan) return false;
+
+        if ((dynamic_cast<IndexLookupNode*>(plan.get()) != nullptr) != c.lookup) return false;
+        if ((dynamic_cast<IndexRangeScanNode*>(plan.get()) != nullptr) != c.range) return false;
+
+        QueryResult result = plan->execute();
+        if (!result.is_success() || result.row_count() != c.expected_rows) return false;
+
+        const auto* select = static_cast<const SelectStatement*>(stmt.get());
+        TableScanNode scan(&table, select->get_where_clause()->clone());
+        if (sorted_ids(result) != sorted_ids(scan.execute())) return false;
+    }
+
+    // Duplicate keys in a hash index survive removal of one of the rows
+    auto stmt = parser.parse("SELECT * FROM items WHERE tag = 'tag_0'");
+    size_t before = planner.create_plan(stmt.get())->execute().row_count();
+    if (!table.delete_row(1)) return false;  // id 0 has tag_0
+    if (planner.create_plan(stmt.get())->execute().row_count() != before - 1) return false;
+
+    // An empty table is cheaper to scan than to probe
+    Table empty(schema, &page_manager);
+    if (!empty.create_index("ID", "btree")) return false;
+    std::unordered_map<std::string, Table*> empty_tables{{"ITEMS", &empty}};
+    QueryPlanner empty_planner(&empty_tables);
+    auto empty_stmt = parser.parse("SELECT * FROM items WHERE id = 1");
+    auto empty_plan = empty_planner.create_plan(empty_stmt.get());
+    if (!dynamic_cast<TableScanNode*>(empty_plan.get())) return false;
+
+    return true;
+}
+
+namespace {
+
+    // Collects streamed rows and stops after a fixed number
+    class CountingSink : public ResultSink {
+    public:
+        explicit CountingSink(size_t stop_after) : stop_after_(stop_after), rows_(0) {}
+        void begin(const std::vector<std::string>& column_names) override { columns_ = column_names; }
+        bool accept(const Row& row) override { return ++rows_ < stop_after_; }
+        size_t rows() const { return rows_; }
+        const std::vector<std::string>& columns() const { return columns_; }
+    private:
+        size_t stop_after_;
+        size_t rows_;
+        std::vector<std::string> columns_;
+    };
+
+} // namespace
+
+bool test_streaming_execution() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE t (id INTEGER, name TEXT)").is_success()) return false;
+
+    // Enough rows for several heap pages
+    for (int i = 0; i < 400; i++) {
+        std::string sql = "INSERT INTO t VALUES (" + std::to_string(i) + ", 'row_" + std::to_string(i) + "')";
+        if (!executor.execute_sql(sql).is_success()) return false;
+    }
+
+    // The sink sees the projected columns and can stop the scan early
+    CountingSink early(5);
+    if (!executor.execute_sql("SELECT name FROM t WHERE id >= 100", &early).is_success()) return false;
+    if (early.rows() != 5) return false;
+    if (early.columns() != std::vector<std::string>{"NAME"}) return false;
+
+    CountingSink all(SIZE_MAX);
+    if (!executor.execute_sql("SELECT * FROM t WHERE id >= 100", &all).is_success()) return false;
+    if (all.rows() != 300 || all.columns().size() != 2) return false;
+
+    // Without a sink the same plan is materialized as before
+    QueryResult result = executor.execute_sql("SELECT * FROM t WHERE id >= 100");
+    if (!result.is_success() || result.row_count() != 300) return false;
+
+    // Non-SELECT statements never reach the sink
+    CountingSink unused(SIZE_MAX);
+    if (!executor.execute_sql("INSERT INTO t VALUES (1000, 'late')", &unused).is_success()) return false;
+    if (unused.rows() != 0 || !unused.columns().empty()) return false;
+
+    // Streaming through the table formatter prints what format() prints
+    minidb::utils::TableFormatter formatter(30, 50);
+    std::ostringstream streamed;
+    std::ostringstream materialized;
+    formatter.begin_rows(result.get_column_names(), streamed);
+    for (const auto& row : result.get_rows()) {
+        formatter.add_row(row, streamed);
+    }
+    formatter.end_rows(streamed);
+    formatter.format(result, materialized);
+    if (streamed.str() != materialized.str()) return false;
+    if (streamed.str().find("... and 250 more rows") == std::string::npos) return false;
+
+    return true;
+}
+
+bool test_vector_filter_kernels() {
+    const CompareOp ops[] = {CompareOp::EQUAL, CompareOp::NOT_EQUAL, CompareOp::LESS_THAN,
+                             CompareOp::LESS_EQUAL, CompareOp::GREATER_THAN, CompareOp::GREATER_EQUAL};
+    auto expected = [](int order, CompareOp op) {
+        switch (op) {
+            case CompareOp::EQUAL: return order == 0;
+            case CompareOp::NOT_EQUAL: return order != 0;
+            case CompareOp::LESS_THAN: return order < 0;
+            case CompareOp::LESS_EQUAL: return order <= 0;
+            case CompareOp::GREATER_THAN: return order > 0;
+            default: return order >= 0;
+        }
+    };
+
+    // A column mixing in-type values, NULLs, other types and NaN, with a
+    // length that is not a multiple of the SIMD width
+    std::mt19937 rng(7);
+    std::vector<Value> int_values;
+    std::vector<Value> real_values;
+    for (int i = 0; i < 1027; i++) {
+        int64_t v = static_cast<int64_t>(rng() % 21) - 10;
+        if (i % 97 == 0) {
+            int_values.push_back(Value());
+            real_values.push_back(Value(std::string("text")));
+        } else if (i % 89 == 0) {
+            int_values.push_back(Value(std::string("text")));
+            real_values.push_back(Value(std::nan("")));
+        } else {
+            int_values.push_back(Value(v));
+            real_values.push_back(Value(v * 0.5));
+        }
+    }
+
+    ColumnVector ints;
+    ints.reset(ColumnType::INTEGER);
+    for (const auto& v : int_values) ints.append(v);
+    ColumnVector reals;
+    reals.reset(ColumnType::REAL);
+    for (const auto& v : real_values) reals.append(v);
+
+    std::vector<uint32_t> selection;
+    for (CompareOp op : ops) {
+        for (int64_t literal = -11; literal <= 11; literal += 3) {
+            Value int_literal(literal);
+            select_rows(ints, op, int_literal, selection);
+            std::vector<uint32_t> reference;
+            for (size_t i = 0; i < int_values.size(); i++) {
+                if (expected(int_values[i].compare(int_literal), op)) reference.push_back(static_cast<uint32_t>(i));
+            }
+            if (selection != reference) return false;
+
+            Value real_literal(literal * 0.5);
+            select_rows(reals, op, real_literal, selection);
+            reference.clear();
+            for (size_t i = 0; i < real_values.size(); i++) {
+                if (expected(real_values[i].compare(real_literal), op)) reference.push_back(static_cast<uint32_t>(i));
+            }
+            if (selection != reference) return false;
+        }
+    }
+
+    // Batched scans agree with evaluating the predicate row by row
+    PageManager page_manager;
+    TableSchema schema("M");
+    schema.add_column(Column("A", ColumnType::INTEGER));
+    schema.add_column(Column("B", ColumnType::TEXT));
+    Table table(schema, &page_manager);
+    for (int i = 0; i < 3000; i++) {
+        Row row;
+        row.add_value(i % 50 == 0 ? Value() : Value(static_cast<int64_t>(i % 300)));
+        row.add_value(Value("k" + std::to_string(i % 13)));
+        if (table.insert_row(row) == 0) return false;
+    }
+
+    Parser parser;
+    const char* queries[] = {"SELECT * FROM m WHERE a < 17", "SELECT * FROM m WHERE 250 <= a",
+                             "SELECT * FROM m WHERE a != 3", "SELECT * FROM m WHERE b = 'k7'",
+                             "SELECT * FROM m WHERE b > 'k5'", "SELECT * FROM m WHERE a = 'k1'"};
+    for (const char* sql : queries) {
+        auto stmt = parser.parse(sql);
+        if (!stmt) return false;
+        const Expression* where = static_cast<const SelectStatement*>(stmt.get())->get_where_clause();
+
+        std::vector<uint64_t> reference;
+        table.scan([&](const Row& row) {
+            Value result = where->evaluate(row, table.get_schema());
+            if (result.get_type() == ColumnType::INTEGER && result.get_int() != 0) {
+                reference.push_back(row.get_id());
+            }
+            return true;
+        });
+        std::sort(reference.begin(), reference.end());
+
+        TableScanNode scan(&table, where->clone());
+        if (sorted_ids(scan.execute()) != reference) return false;
+    }
+
+    return true;
+}
+
+bool test_compiled_predicates() {
+    TableSchema schema("C");
+    schema.add_column(Column("I", ColumnType::INTEGER));
+    schema.add_column(Column("R", ColumnType::REAL));
+    schema.add_column(Column("S", ColumnType::TEXT));
+
+    // Values of every type in every column, plus NULLs, NaN and short rows
+    const std::vector<Value> pool = {Value(), Value(static_cast<int64_t>(-3)), Value(static_cast<int64_t>(0)),
+                                     Value(static_cast<int64_t>(7)), Value(-1.5), Value(0.0), Value(std::nan("")),
+                                     Value(std::string("")), Value(std::string("m")), Value(std::string("zz"))};
+    std::mt19937 rng(11);
+    std::vector<Row> rows;
+    for (int i = 0; i < 400; i++) {
+        Row row;
+        size_t width = i % 37 == 0 ? 1 : 3;
+        for (size_t c = 0; c < width; c++) {
+            row.add_value(pool[rng() % pool.size()]);
+        }
+        rows.push_back(row);
+    }
+
+    const char* ops[] = {"=", "!=", "<", "<=", ">", ">="};
+    const char* operands[] = {"i", "r", "s", "missing", "7", "0.0", "3", "'m'", "''", "NULL"};
+    Parser parser;
+    size_t compared = 0;
+    for (const char* op : ops) {
+        for (const char* left : operands) {
+            for (const char* right : operands) {
+                std::string sql = std::string("SELECT * FROM c WHERE ") + left + " " + op + " " + right;
+                auto stmt = parser.parse(sql);
+                if (!stmt) continue;  // Not every combination parses
+                const Expression* where = static_cast<const SelectStatement*>(stmt.get())->get_where_clause();
+                if (!where) continue;
+
+                CompiledPredicate predicate = CompiledPredicate::compile(where, schema);
+                for (const auto& row : rows) {
+                    Value expected = where->evaluate(row, schema);
+                    bool matches = expected.get_type() == ColumnType::INTEGER && expected.get_int() != 0;
+                    if (predicate(row) != matches) return false;
+                }
+                compared++;
+            }
+        }
+    }
+    if (compared < 6 * 16) return false;
+
+    // No expression accepts everything, and generic predicates own their
+    // expression so they outlive the statement they were compiled from
+    if (!CompiledPredicate()(rows[0])) return false;
+    CompiledPredicate bare;
+    {
+        auto stmt = parser.parse("SELECT * FROM c WHERE i");
+        if (!stmt) return false;
+        bare = CompiledPredicate::compile(static_cast<const SelectStatement*>(stmt.get())->get_where_clause(), schema);
+    }
+    Row one;
+    one.add_value(Value(static_cast<int64_t>(1)));
+    Row zero;
+    zero.add_value(Value(static_cast<int64_t>(0)));
+    if (!bare(one) || bare(zero)) return false;
+
+    return true;
+}
+
+bool test_parallel_scan() {
+    // Every index runs exactly once, whatever the thread count
+    minidb::utils::ThreadPool pool(3);
+    for (size_t threads : {1, 2, 4, 8}) {
+        std::vector<std::atomic<int>> hits(1000);
+        pool.parallel_for(hits.size(), threads, [&hits](size_t i) { hits[i]++; });
+        for (const auto& hit : hits) {
+            if (hit != 1) return false;
+        }
+    }
+
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE p (id INTEGER, grp INTEGER, name TEXT)").is_success()) return false;
+    if (!executor.execute_sql("CREATE TABLE pc (id INTEGER, grp INTEGER, name TEXT) USING COLUMNAR").is_success()) {
+        return false;
+    }
+    Table* rows = executor.get_table("P");
+    Table* columns = executor.get_table("PC");
+    for (int64_t i = 0; i < 40000; i++) {
+        Row row;
+        row.add_value(Value(i));
+        row.add_value(i % 101 == 0 ? Value() : Value(i % 17));
+        row.add_value(Value("name_" + std::to_string(i % 1000)));
+        if (rows->insert_row(row) == 0 || columns->insert_row(row) == 0) return false;
+    }
+    if (rows->page_count() < 16 || columns->page_count() < 16) return false;
+
+    // Parallel results match the serial scan row for row, in order
+    const char* queries[] = {"SELECT * FROM %s", "SELECT * FROM %s WHERE grp < 5",
+                             "SELECT name, id FROM %s WHERE grp = 3", "SELECT id FROM %s WHERE name > 'name_5'",
+                             "SELECT grp FROM %s WHERE 39990 <= id", "SELECT * FROM %s WHERE grp = name"};
+    for (const char* table_name : {"p", "pc"}) {
+        for (const char* query : queries) {
+            char sql[128];
+            std::snprintf(sql, sizeof(sql), query, table_name);
+
+            executor.set_parallelism(1);
+            QueryResult serial = executor.execute_sql(sql);
+            executor.set_parallelism(6);
+            QueryResult parallel = executor.execute_sql(sql);
+            if (!serial.is_success() || !parallel.is_success()) return false;
+            if (serial.get_column_names() != parallel.get_column_names()) return false;
+            if (serial.row_count() != parallel.row_count()) return false;
+            for (size_t i = 0; i < serial.row_count(); i++) {
+                const Row& a = serial.get_rows()[i];
+                const Row& b = parallel.get_rows()[i];
+                if (a.get_id() != b.get_id() || a.get_values() != b.get_values()) return false;
+            }
+        }
+    }
+
+    // Streaming stops early without losing order
+    executor.set_parallelism(4);
+    CountingSink sink(10);
+    if (!executor.execute_sql("SELECT * FROM p WHERE grp = 1", &sink).is_success()) return false;
+    if (sink.rows() != 10) return false;
+
+    return true;
+}
+
+namespace {
+
+    std::vector<std::vector<Value>> sorted_rows(const QueryResult& result) {
+        std::vector<std::vector<Value>> rows;
+        for (const auto& row : result.get_rows()) {
+            rows.push_back(row.get_values());
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    // Brute-force inner join of two row sets
+    template<typename Condition>
+    std::vector<std::vector<Value>> nested_join(const std::vector<std::vector<Value>>& left,
+                                                const std::vector<std::vector<Value>>& right,
+                                                Condition condition) {
+        std::vector<std::vector<Value>> rows;
+        for (const auto& l : left) {
+            for (const auto& r : right) {
+                if (condition(l, r)) {
+                    std::vector<Value> row = l;
+                    row.insert(row.end(), r.begin(), r.end());
+                    rows.push_back(row);
+                }
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    bool joins(const Value& a, const Value& b) {
+        return !a.is_null() && !b.is_null() && a == b;
+    }
+
+} // namespace
+
+bool test_joins() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE users (id INTEGER, name TEXT)").is_success()) return false;
+    if (!executor.execute_sql("CREATE TABLE orders (id INTEGER, user_id INTEGER, amount INTEGER)").is_success()) {
+        return false;
+    }
+    if (!executor.execute_sql("CREATE TABLE items (order_id INTEGER, sku TEXT)").is_success()) return false;
+    Table* users = executor.get_table("USERS");
+    Table* orders = executor.get_table("ORDERS");
+    Table* items = executor.get_table("ITEMS");
+
+    std::mt19937 rng(16);
+    for (int64_t i = 0; i < 500; i++) {
+        // One user without an id, which must never join
+        if (users->insert_row(Row({i == 250 ? Value() : Value(i), Value("user_" + std::to_string(i))})) == 0) {
+            return false;
+        }
+    }
+    for (int64_t i = 0; i < 2000; i++) {
+        Value user_id = i % 97 == 0 ? Value() : Value(static_cast<int64_t>(rng() % 600));
+        if (orders->insert_row(Row({Value(i), user_id, Value(static_cast<int64_t>(rng() % 1000))})) == 0) {
+            return false;
+        }
+    }
+    for (int64_t i = 0; i < 300; i++) {
+        if (items->insert_row(Row({Value(static_cast<int64_t>(rng() % 2500)), Value("sku_" + std::to_string(i))})) == 0) {
+            return false;
+        }
+    }
+    auto all_rows = [&executor](const std::string& table) {
+        return sorted_rows(executor.execute_sql("SELECT * FROM " + table));
+    };
+    auto user_rows = all_rows("users");
+    auto order_rows = all_rows("orders");
+    auto item_rows = all_rows("items");
+
+    std::unordered_map<std::string, Table*> tables{{"USERS", users}, {"ORDERS", orders}, {"ITEMS", items}};
+    QueryPlanner planner(&tables);
+    Parser parser;
+    auto plan = [&](const std::string& sql) {
+        auto stmt = parser.parse(sql);
+        return stmt ? planner.create_plan(stmt.get()) : nullptr;
+    };
+
+    // Without indexes an equi-join hashes the smaller side
+    const std::string user_orders = "SELECT * FROM users u JOIN orders o ON u.id = o.user_id";
+    auto hash_join = plan(user_orders);
+    auto* hash_node = dynamic_cast<HashJoinNode*>(hash_join.get());
+    if (!hash_node || !hash_node->builds_left()) return false;
+    auto expected = nested_join(user_rows, order_rows, [](const auto& u, const auto& o) { return joins(u[0], o[1]); });
+    QueryResult result = executor.execute_sql(user_orders);
+    if (!result.is_success() || expected.empty() || sorted_rows(result) != expected) return false;
+    std::vector<std::string> all_columns{"U.ID", "U.NAME", "O.ID", "O.USER_ID", "O.AMOUNT"};
+    if (result.get_column_names() != all_columns) return false;
+
+    auto swapped = plan("SELECT * FROM orders JOIN users ON orders.user_id = users.id");
+    auto* swapped_node = dynamic_cast<HashJoinNode*>(swapped.get());
+    if (!swapped_node || swapped_node->builds_left()) return false;
+    auto swapped_expected = nested_join(order_rows, user_rows, [](const auto& o, const auto& u) { return joins(o[1], u[0]); });
+    if (sorted_rows(swapped->execute()) != swapped_expected) return false;
+
+    // A selective outer side probes the inner table's index instead
+    if (!users->create_index("ID", "hash")) return false;
+    if (!orders->create_index("ID", "btree")) return false;
+    const std::string one_order = "SELECT o.amount, name FROM orders AS o INNER JOIN users u ON o.user_id = u.id "
+                                  "WHERE o.id = 7";
+    auto index_join = plan("SELECT * FROM orders o JOIN users u ON o.user_id = u.id WHERE o.id = 7");
+    if (!dynamic_cast<IndexNestedLoopJoinNode*>(index_join.get())) return false;
+    result = executor.execute_sql(one_order);
+    if (!result.is_success()) return false;
+    if (result.get_column_names() != std::vector<std::string>{"O.AMOUNT", "U.NAME"}) return false;
+    std::vector<std::vector<Value>> one_expected;
+    for (const auto& row : swapped_expected) {
+        if (row[0] == Value(int64_t(7))) one_expected.push_back({row[2], row[4]});
+    }
+    if (sorted_rows(result) != one_expected) return false;
+
+    // The index path and the hash path agree when applied to everything
+    IndexNestedLoopJoinNode probe_all(std::make_unique<TableScanNode>(orders), users, "ID", 1, nullptr,
+                                      {"O.ID", "O.USER_ID", "O.AMOUNT", "U.ID", "U.NAME"});
+    if (sorted_rows(probe_all.execute()) != swapped_expected) return false;
+    // It costs the outer side plus one index probe per estimated outer row
+    double outer_rows = static_cast<double>(orders->row_count());
+    double probe_cost = 1.0 + std::log2(static_cast<double>(users->row_count()) + 1.0);
+    if (std::abs(probe_all.get_cost() - (outer_rows + outer_rows * probe_cost)) > 1e-9) return false;
+    // ... and a pushed-down filter on the inner side still applies
+    IndexNestedLoopJoinNode probe_filtered(
+        std::make_unique<TableScanNode>(orders), users, "ID", 1,
+        std::make_unique<BinaryExpression>(std::make_unique<ColumnExpression>("NAME"),
+                                           std::make_unique<LiteralExpression>(Value("user_3")), Operator::EQUAL),
+        {"O.ID", "O.USER_ID", "O.AMOUNT", "U.ID", "U.NAME"});
+    auto filtered_expected = nested_join(order_rows, user_rows, [](const auto& o, const auto& u) {
+        return joins(o[1], u[0]) && u[1] == Value("user_3");
+    });
+    if (sorted_rows(probe_filtered.execute()) != filtered_expected) return false;
+
+    // Conditions other than column equality compare every pair
+    const std::string cheap = "SELECT * FROM users u JOIN orders o ON o.amount < u.id WHERE u.id < 4";
+    auto loop_join = plan(cheap);
+    if (!dynamic_cast<NestedLoopJoinNode*>(loop_join.get())) return false;
+    auto loop_expected = nested_join(user_rows, order_rows, [](const auto& u, const auto& o) {
+        return u[0] < Value(int64_t(4)) && o[2] < u[0];
+    });
+    if (loop_expected.empty() || sorted_rows(loop_join->execute()) != loop_expected) return false;
+
+    // WHERE across two inputs filters the joined rows
+    result = executor.execute_sql("SELECT * FROM users u JOIN orders o ON u.id = o.user_id WHERE o.amount < u.id");
+    auto cross_expected = nested_join(user_rows, order_rows, [](const auto& u, const auto& o) {
+        return joins(u[0], o[1]) && o[2] < u[0];
+    });
+    if (!result.is_success() || sorted_rows(result) != cross_expected) return false;
+
+    // Chains join left-deep; self-joins need aliases
+    result = executor.execute_sql("SELECT u.name, sku FROM users u JOIN orders o ON u.id = o.user_id "
+                                  "JOIN items i ON i.order_id = o.id");
+    std::vector<std::vector<Value>> chain_expected;
+    for (const auto& row : nested_join(expected, item_rows, [](const auto& l, const auto& i) { return joins(l[2], i[0]); })) {
+        chain_expected.push_back({row[1], row[6]});
+    }
+    std::sort(chain_expected.begin(), chain_expected.end());
+    if (!result.is_success() || sorted_rows(result) != chain_expected) return false;
+
+    result = executor.execute_sql("SELECT a.id, b.name FROM users a JOIN users b ON a.id = b.id");
+    if (!result.is_success() || result.row_count() != 499) return false;
+
+    // Names must resolve to exactly one input
+    const char* invalid[] = {"SELECT id FROM users u JOIN orders o ON u.id = o.user_id",
+                             "SELECT * FROM users JOIN users ON users.id = users.id",
+                             "SELECT * FROM users u JOIN orders o ON x.id = o.user_id",
+                             "SELECT * FROM users u JOIN missing m ON u.id = m.id",
+                             "SELECT * FROM users u JOIN orders o ON u.id = o.nothing"};
+    for (const char* sql : invalid) {
+        if (executor.execute_sql(sql).is_success()) return false;
+    }
+
+    return true;
+}
+
+bool test_aggregates() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE sales (id INTEGER, region TEXT, amount INTEGER, price REAL)").is_success()) {
+        return false;
+    }
+    Table* sales = executor.get_table("SALES");
+
+    // Reference aggregates, computed by hand per region
+    struct Expected {
+        int64_t rows = 0;
+        int64_t amounts = 0;
+        int64_t sum = 0;
+        Value min;
+        Value max;
+        double price_sum = 0.0;
+        int64_t prices = 0;
+    };
+    std::map<std::vector<Value>, Expected> expected;
+    std::mt19937 rng(17);
+    const char* regions[] = {"north", "south", "east", "west"};
+    for (int64_t i = 0; i < 3000; i++) {
+        Value region = i % 41 == 0 ? Value() : Value(std::string(regions[rng() % 4]));
+        Value amount = i % 13 == 0 ? Value() : Value(static_cast<int64_t>(rng() % 500));
+        Value price = i % 7 == 0 ? Value() : Value(static_cast<double>(rng() % 1000) / 8.0);
+        if (sales->insert_row(Row({Value(i), region, amount, price})) == 0) return false;
+
+        Expected& e = expected[{region}];
+        e.rows++;
+        if (!amount.is_null()) {
+            e.sum += amount.get_int();
+            if (e.amounts++ == 0 || amount < e.min) e.min = amount;
+            if (e.amounts == 1 || amount > e.max) e.max = amount;
+        }
+        if (!price.is_null()) {
+            e.price_sum += price.get_real();
+            e.prices++;
+        }
+    }
+
+    const std::string grouped = "SELECT region, COUNT(*), SUM(amount), MIN(amount), MAX(amount), AVG(price), "
+                                "COUNT(price) FROM sales GROUP BY region";
+    auto check_grouped = [&](const QueryResult& result, bool ordered) {
+        std::vector<std::string> columns{"REGION", "COUNT(*)", "SUM(AMOUNT)", "MIN(AMOUNT)", "MAX(AMOUNT)",
+                                         "AVG(PRICE)", "COUNT(PRICE)"};
+        if (!result.is_success() || result.get_column_names() != columns) return false;
+        if (result.row_count() != expected.size()) return false;
+        for (size_t i = 0; i < result.row_count(); i++) {
+            const auto& values = result.get_rows()[i].get_values();
+            if (ordered && i > 0 && !(result.get_rows()[i - 1].get_value(0) < values[0])) return false;
+            auto it = expected.find({values[0]});
+            if (it == expected.end()) return false;
+            const Expected& e = it->second;
+            if (values[1] != Value(e.rows) || values[2] != Value(e.sum)) return false;
+            if (values[3] != e.min || values[4] != e.max || values[6] != Value(e.prices)) return false;
+            if (values[5].get_type() != ColumnType::REAL ||
+                std::abs(values[5].get_real() - e.price_sum / static_cast<double>(e.prices)) > 1e-9) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Hash aggregation, with and without an index on the grouped column
+    if (!check_grouped(executor.execute_sql(grouped), false)) return false;
+    if (!sales->create_index("REGION", "btree")) return false;
+    if (!check_grouped(executor.execute_sql(grouped), false)) return false;
+
+    // Walking the whole index costs more than a scan; a bounded walk does not
+    std::unordered_map<std::string, Table*> tables{{"SALES", sales}};
+    QueryPlanner planner(&tables);
+    Parser parser;
+    std::vector<std::unique_ptr<Statement>> statements;
+    auto plan_of = [&](const std::string& sql) {
+        statements.push_back(parser.parse(sql));
+        return statements.back() ? planner.create_plan(statements.back().get()) : nullptr;
+    };
+    const std::string bounded = "SELECT region, COUNT(*) FROM sales WHERE region >= 'south' GROUP BY region";
+    auto unbounded_walk = plan_of(grouped);
+    auto bounded_walk = plan_of(bounded);
+    if (!unbounded_walk || !dynamic_cast<HashAggregateNode*>(unbounded_walk->children()[0]->get())) return false;
+    if (!bounded_walk || !dynamic_cast<StreamAggregateNode*>(bounded_walk->children()[0]->get())) return false;
+    QueryResult bounded_groups = executor.execute_sql(bounded);
+    if (bounded_groups.row_count() != 2) return false;
+    for (size_t i = 0; i < 2; i++) {
+        Value region(std::string(i == 0 ? "south" : "west"));
+        if (bounded_groups.get_rows()[i].get_value(0) != region) return false;
+        if (bounded_groups.get_rows()[i].get_value(1) != Value(expected[{region}].rows)) return false;
+    }
+
+    auto stmt = parser.parse("SELECT COUNT(*), MAX(price) FROM sales WHERE region < 'south' GROUP BY region");
+    if (!stmt) return false;
+    auto streaming = planner.create_plan(stmt.get());
+    if (!streaming) return false;
+    QueryResult streamed = streaming->execute();
+    if (!sales->drop_index("REGION")) return false;
+    auto hashed = planner.create_plan(stmt.get());
+    if (!hashed || sorted_rows(hashed->execute()) != sorted_rows(streamed)) return false;
+
+    // Both operators agree on empty input: no groups, or one row without GROUP BY
+    for (bool stream : {false, true}) {
+        std::vector<AggregateSpec> aggregates{{AggregateFunction::COUNT, "", "N"},
+                                              {AggregateFunction::SUM, "AMOUNT", "S"}};
+        auto input = std::make_unique<TableScanNode>(
+            sales, std::make_unique<BinaryExpression>(std::make_unique<ColumnExpression>("ID"),
+                                                      std::make_unique<LiteralExpression>(Value(int64_t(5000))),
+                                                      Operator::GREATER_THAN));
+        std::unique_ptr<PlanNode> node;
+        if (stream) {
+            node = std::make_unique<StreamAggregateNode>(std::move(input), std::vector<std::string>(), aggregates);
+        } else {
+            node = std::make_unique<HashAggregateNode>(std::move(input), std::vector<std::string>(), aggregates);
+        }
+        QueryResult result = node->execute();
+        if (result.row_count() != 1) return false;
+        if (result.get_rows()[0].get_value(0) != Value(int64_t(0)) || !result.get_rows()[0].get_value(1).is_null()) {
+            return false;
+        }
+    }
+    QueryResult empty_groups = executor.execute_sql("SELECT region FROM sales WHERE id > 5000 GROUP BY region");
+    if (!empty_groups.is_success() || empty_groups.row_count() != 0) return false;
+
+    // COUNT(*) and MIN/MAX over an ordered index skip the rows entirely
+    if (!sales->create_index("AMOUNT", "btree")) return false;
+    IndexAggregateNode from_index(sales, {{AggregateFunction::COUNT, "", "COUNT(*)"},
+                                          {AggregateFunction::MIN, "AMOUNT", "MIN(AMOUNT)"},
+                                          {AggregateFunction::MAX, "AMOUNT", "MAX(AMOUNT)"}});
+    QueryResult metadata = from_index.execute();
+    QueryResult totals = executor.execute_sql("SELECT COUNT(*), MIN(amount), MAX(amount) FROM sales");
+    QueryResult scanned = executor.execute_sql("SELECT COUNT(*), MIN(amount), MAX(amount) FROM sales WHERE id >= 0");
+    if (!metadata.is_success() || !totals.is_success() || !scanned.is_success()) return false;
+    if (sorted_rows(metadata) != sorted_rows(scanned) || sorted_rows(totals) != sorted_rows(scanned)) return false;
+    if (metadata.get_rows()[0].get_value(0) != Value(int64_t(3000))) return false;
+    auto totals_plan = planner.create_plan(parser.parse("SELECT COUNT(*), MIN(amount), MAX(amount) FROM sales").get());
+    if (!totals_plan || totals_plan->get_cost() >= 100.0) return false;
+
+    // Integer sums that overflow carry on in REAL
+    if (!executor.execute_sql("CREATE TABLE big (v INTEGER)").is_success()) return false;
+    Table* big = executor.get_table("BIG");
+    if (big->insert_row(Row({Value(INT64_MAX)})) == 0 || big->insert_row(Row({Value(int64_t(INT64_MAX))})) == 0) {
+        return false;
+    }
+    QueryResult overflow = executor.execute_sql("SELECT SUM(v), MIN(v) FROM big");
+    if (!overflow.is_success() || overflow.get_rows()[0].get_value(0).get_type() != ColumnType::REAL) return false;
+    if (overflow.get_rows()[0].get_value(0).get_real() != 2.0 * static_cast<double>(INT64_MAX)) return false;
+
+    // Aggregates over a join read qualified columns
+    if (!executor.execute_sql("CREATE TABLE regions (name TEXT, manager TEXT)").is_success()) return false;
+    if (!executor.execute_sql("INSERT INTO regions VALUES ('north', 'ann')").is_success()) return false;
+    if (!executor.execute_sql("INSERT INTO regions VALUES ('south', 'bo')").is_success()) return false;
+    QueryResult joined = executor.execute_sql("SELECT r.manager, COUNT(*), SUM(s.amount) FROM sales s "
+                                              "JOIN regions r ON s.region = r.name GROUP BY r.manager");
+    if (!joined.is_success() || joined.row_count() != 2) return false;
+    if (joined.get_column_names() != std::vector<std::string>{"R.MANAGER", "COUNT(*)", "SUM(S.AMOUNT)"}) return false;
+    for (const auto& row : joined.get_rows()) {
+        const Expected& e = expected[{Value(std::string(row.get_value(0) == Value("ann") ? "north" : "south"))}];
+        if (row.get_value(1) != Value(e.rows) || row.get_value(2) != Value(e.sum)) return false;
+    }
+
+    const char* invalid[] = {"SELECT region, amount FROM sales GROUP BY region", "SELECT * FROM sales GROUP BY region",
+                             "SELECT COUNT(nothing) FROM sales", "SELECT SUM(*) FROM sales",
+                             "SELECT MEDIAN(amount) FROM sales", "SELECT region FROM sales GROUP BY"};
+    for (const char* sql : invalid) {
+        if (executor.execute_sql(sql).is_success()) return false;
+    }
+
+    return true;
+}
+
+bool test_prepared_statements() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE t (id INTEGER, name TEXT)").is_success()) return false;
+
+    // One parse and one plan per statement, however many rows go through it
+    std::string error;
+    auto insert = executor.prepare("INSERT INTO t VALUES (?, ?)", error);
+    if (!insert || insert->parameter_count() != 2) return false;
+    if (executor.execute(*insert).is_success()) return false;  // Nothing bound yet
+    if (insert->bind(2, Value(int64_t(0)))) return false;
+    for (int64_t i = 0; i < 500; i++) {
+        if (!insert->bind(0, Value(i)) || !insert->bind(1, Value("row_" + std::to_string(i)))) return false;
+        if (executor.execute(*insert).get_affected_rows() != 1) return false;
+    }
+    if (executor.get_table("T")->row_count() != 500) return false;
+
+    // Bound values plan as literals, so the index is still used
+    if (!executor.get_table("T")->create_index("ID", "hash")) return false;
+    auto select = executor.prepare("SELECT name FROM t WHERE id = ?", error);
+    if (!select || select->parameter_count() != 1) return false;
+    for (int64_t i : {7, 123, 499}) {
+        select->bind(0, Value(i));
+        QueryResult result = executor.execute(*select);
+        if (!result.is_success() || result.row_count() != 1) return false;
+        if (result.get_rows()[0].get_value(0) != Value("row_" + std::to_string(i))) return false;
+    }
+    select->clear_bindings();
+    if (executor.execute(*select).is_success()) return false;
+    if (executor.prepare("SELECT FROM", error) || error.empty()) return false;
+
+    // Repeated SQL hits the cache whatever its spacing, case or semicolon
+    if (PlanCache::normalize("  select *\n from  t where name = 'a  B';; ") != "SELECT * FROM T WHERE NAME = 'a  B'") {
+        return false;
+    }
+    uint64_t hits = executor.plan_cache().hits();
+    if (executor.execute_sql("SELECT * FROM t WHERE id = 5").row_count() != 1) return false;
+    if (executor.execute_sql("select * from t where id = 5;").row_count() != 1) return false;
+    if (executor.plan_cache().hits() != hits + 1) return false;
+
+    // Index and table changes invalidate the cached plans
+    if (!executor.get_table("T")->drop_index("ID")) return false;
+    if (executor.execute_sql("SELECT * FROM t WHERE id = 5").row_count() != 1) return false;
+    if (!executor.execute_sql("DROP TABLE t").is_success()) return false;
+    if (!executor.execute_sql("CREATE TABLE t (id INTEGER, name TEXT)").is_success()) return false;
+    if (executor.execute_sql("SELECT * FROM t WHERE id = 5").row_count() != 0) return false;
+    select->bind(0, Value(int64_t(5)));
+    if (!executor.execute(*select).is_success() || executor.execute(*select).row_count() != 0) return false;
+
+    // The cache stays within its capacity, least recently used first out
+    executor.plan_cache().set_capacity(2);
+    for (int i = 0; i < 5; i++) {
+        executor.execute_sql("SELECT * FROM t WHERE id = " + std::to_string(i));
+    }
+    if (executor.plan_cache().size() != 2) return false;
+    hits = executor.plan_cache().hits();
+    executor.execute_sql("SELECT * FROM t WHERE id = 4");
+    executor.execute_sql("SELECT * FROM t WHERE id = 0");
+    if (executor.plan_cache().hits() != hits + 1) return false;
+
+    return true;
+}
+
+bool test_tokenizer() {
+    // Keywords are recognized in any case; near misses are identifiers
+    if (lookup_keyword("select") != Keyword::SELECT || lookup_keyword("CoLuMnAr") != Keyword::COLUMNAR) return false;
+    if (lookup_keyword("int") != Keyword::INT || lookup_keyword("integer") != Keyword::INTEGER) return false;
+    if (lookup_keyword("selects") != Keyword::NONE || lookup_keyword("") != Keyword::NONE) return false;
+
+    // Tokens are views into the input, classified as they are cut
+    std::string sql = "select t.Name, 'it''s' FROM t WHERE id >= 1.5 AND x != ?";
+    Tokenizer tokenizer;
+    if (!tokenizer.tokenize(sql)) return false;
+    std::vector<Token> tokens;
+    for (; !tokenizer.at_end(); tokenizer.next_token()) {
+        tokens.push_back(tokenizer.current_token());
+    }
+    for (const auto& token : tokens) {
+        if (token.text.data() < sql.data() || token.text.data() + token.text.size() > sql.data() + sql.size()) {
+            return false;
+        }
+    }
+    if (tokens.size() != 15 || tokens[0].keyword != Keyword::SELECT || tokens[1].text != "t.Name") return false;
+    if (tokens[1].kind != TokenKind::IDENTIFIER || tokens[1].keyword != Keyword::NONE) return false;
+    if (tokens[3].kind != TokenKind::STRING || tokens[3].text != "'it'") return false;
+    if (tokens[9].kind != TokenKind::SYMBOL || tokens[9].text != ">=") return false;
+    if (tokens[10].kind != TokenKind::NUMBER || tokens[10].text != "1.5") return false;
+    if (tokens[14].text != "?" || tokenizer.current_token().kind != TokenKind::END) return false;
+
+    // Identifiers still come out upper-case, and keywords can name columns
+    Parser parser;
+    auto stmt = parser.parse("Select count, Sum(Total) From Orders o Where o.Id = 3 Group By count");
+    auto* select = dynamic_cast<SelectStatement*>(stmt.get());
+    if (!select || select->get_table_name() != "ORDERS" || select->get_table_alias() != "O") return false;
+    if (select->get_columns() != std::vector<std::string>{"COUNT", "SUM(TOTAL)"}) return false;
+    if (select->get_group_by() != std::vector<std::string>{"COUNT"}) return false;
+    auto create = parser.parse("create table t (a int, b varchar, c double) using columnar");
+    auto* create_stmt = dynamic_cast<CreateTableStatement*>(create.get());
+    if (!create_stmt || create_stmt->get_storage_format() != StorageFormat::COLUMNAR) return false;
+    if (create_stmt->get_columns()[0].type != ColumnType::INTEGER || create_stmt->get_columns()[2].type != ColumnType::REAL) {
+        return false;
+    }
+    if (parser.parse("SELECT * FORM t") || parser.get_error() != "Expected 'FROM', got 'FORM'") return false;
+
+    // A minus sign before a digit belongs to the number; "--" starts a comment
+    if (!tokenizer.tokenize("x >= -12.5 -- the rest is ignored") || tokenizer.current_token().text != "x") return false;
+    tokenizer.next_token();
+    tokenizer.next_token();
+    if (tokenizer.current_token().kind != TokenKind::NUMBER || tokenizer.current_token().text != "-12.5") return false;
+    if (tokenizer.next_token()) return false;
+    auto negative = parser.parse("SELECT * FROM t WHERE id > -3");
+    auto* negative_select = dynamic_cast<SelectStatement*>(negative.get());
+    const auto* comparison =
+        negative_select ? dynamic_cast<const BinaryExpression*>(negative_select->get_where_clause()) : nullptr;
+    const auto* literal = comparison ? dynamic_cast<const LiteralExpression*>(comparison->get_right()) : nullptr;
+    if (!literal || literal->get_value() != Value(int64_t(-3))) return false;
+
+    // Clause keywords are never taken for a table alias
+    for (const char* sql : {"SELECT * FROM t ORDER BY id", "SELECT * FROM t LIMIT 10", "SELECT * FROM t OFFSET 5"}) {
+        auto clause = parser.parse(sql);
+        auto* clause_select = dynamic_cast<SelectStatement*>(clause.get());
+        if (!clause_select || !clause_select->get_table_alias().empty()) return false;
+    }
+
+    // Whatever follows a complete statement is an error, not ignored
+    if (!parser.parse("DROP TABLE t;") || !parser.parse("SELECT * FROM t u;")) return false;
+    if (parser.parse("SELECT * FROM t WHERE id = 1 AND id = 2")) return false;
+    if (parser.get_error() != "Unexpected 'AND' after statement") return false;
+    if (parser.parse("SELECT * FROM t u v") || parser.parse("DROP TABLE t t") || parser.parse("SELECT * FROM t; x")) {
+        return false;
+    }
+    if (parser.parse("SELECT * FROM t LIMIT -1") || parser.parse("SELECT * FROM t WHERE id = - 1")) return false;
+    
+    // Literals that don't fit their type are parse errors rather than exceptions
+    if (parser.parse("INSERT INTO t VALUES (99999999999999999999)")) return false;
+    if (parser.get_error() != "Number out of range: 99999999999999999999") return false;
+    if (parser.parse("SELECT * FROM t WHERE x = 1" + std::string(400, '0') + ".5")) return false;
+    if (parser.parse("SELECT * FROM t WHERE x = 1.2.3")) return false;
+    if (parser.get_error() != "Invalid number: 1.2.3") return false;
+    if (!parser.parse("INSERT INTO t VALUES (-9223372036854775808, 1.5)")) return false;
+
+    return true;
+}
+
+bool test_bulk_load() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE t (id INTEGER, name TEXT, score REAL)").is_success()) return false;
+    if (!executor.get_table("T")->create_index("ID", "btree")) return false;
+    if (!executor.get_table("T")->create_index("NAME", "hash")) return false;
+    
+    // Multi-row VALUES, literal and parameterized
+    QueryResult inserted = executor.execute_sql("INSERT INTO t VALUES (1, 'a', 1.5), (2, 'b', 2.5), (3, 'c', 3.5)");
+    if (!inserted.is_success() || inserted.get_affected_rows() != 3) return false;
+    if (executor.execute_sql("INSERT INTO t VALUES (4, 'd', 1.0), (5, 'e')").is_success()) return false;
+    
+    std::string error;
+    auto insert = executor.prepare("INSERT INTO t VALUES (?, ?, 0.5), (?, 'y', ?)", error);
+    if (!insert || insert->parameter_count() != 4) return false;
+    insert->bind(0, Value(int64_t(10)));
+    insert->bind(1, Value("x"));
+    insert->bind(2, Value(int64_t(11)));
+    insert->bind(3, Value(9.5));
+    if (executor.execute(*insert).get_affected_rows() != 2) return false;
+    if (executor.get_table("T")->row_count() != 5) return false;
+    
+    // Batched index loads find the new rows
+    QueryResult found = executor.execute_sql("SELECT name FROM t WHERE id = 11");
+    if (found.row_count() != 1 || found.get_rows()[0].get_value(0) != Value("y")) return false;
+    if (executor.execute_sql("SELECT id FROM t WHERE name = 'b'").row_count() != 1) return false;
+    
+    // COPY: header, quoting, NULLs and empty strings
+    const std::string path = "test_bulk_load.csv";
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+    std::fputs("id,name,score\n", file);
+    std::fputs("100,\"comma, \"\"quoted\"\"\",1.25\r\n", file);
+    std::fputs("101,,\n", file);
+    std::fputs("102,\"\",-2\n\n", file);
+    for (int i = 0; i < 10000; i++) {
+        std::fprintf(file, "%d,name_%d,%d.5\n", 1000 + i, i, i);
+    }
+    std::fclose(file);
+    
+    QueryResult copied = executor.execute_sql("COPY t FROM '" + path + "' WITH HEADER");
+    if (!copied.is_success() || copied.get_affected_rows() != 10003) return false;
+    
+    found = executor.execute_sql("SELECT name, score FROM t WHERE id = 100");
+    if (found.row_count() != 1 || found.get_rows()[0].get_value(0) != Value("comma, \"quoted\"")) return false;
+    found = executor.execute_sql("SELECT name, score FROM t WHERE id = 101");
+    if (found.row_count() != 1 || !found.get_rows()[0].get_value(0).is_null()) return false;
+    if (!found.get_rows()[0].get_value(1).is_null()) return false;
+    found = executor.execute_sql("SELECT name FROM t WHERE id = 102");
+    if (found.row_count() != 1 || found.get_rows()[0].get_value(0) != Value("")) return false;
+    if (sorted_ids(executor.execute_sql("SELECT id FROM t WHERE id >= 10990")).size() != 10) return false;
+    if (executor.execute_sql("SELECT id FROM t WHERE name = 'name_9999'").row_count() != 1) return false;
+    
+    // A bad record stops the load; with no transaction manager to undo
+    // them, the rows before it stay
+    file = std::fopen(path.c_str(), "w");
+    std::fputs("20000,ok,1\n20001,bad,not_a_number\n20002,never,3\n", file);
+    std::fclose(file);
+    QueryResult failed = executor.execute_sql("COPY t FROM '" + path + "'");
+    if (failed.is_success() || failed.get_error().find("line 2") == std::string::npos) return false;
+    if (executor.execute_sql("SELECT id FROM t WHERE id >= 20000").row_count() != 1) return false;
+    
+    std::remove(path.c_str());
+    if (executor.execute_sql("COPY t FROM '" + path + "'").is_success()) return false;
+    if (executor.execute_sql("COPY t FROM missing").is_success()) return false;
+    
+    return true;
+}
+
+bool test_update_delete() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE t (id INTEGER, name TEXT, score INTEGER)").is_success()) return false;
+    Table* table = executor.get_table("T");
+    if (!table->create_index("ID", "btree") || !table->create_index("NAME", "hash")) return false;
+
+    std::string values;
+    for (int i = 0; i < 200; i++) {
+        values += (i == 0 ? "(" : ", (") + std::to_string(i) + ", 'n" + std::to_string(i % 10) + "', 0)";
+    }
+    if (executor.execute_sql("INSERT INTO t VALUES " + values).get_affected_rows() != 200) return false;
+
+    // A point update through the index; both indexes follow the new keys
+    QueryResult updated = executor.execute_sql("UPDATE t SET name = 'moved', id = 1000 WHERE id = 5");
+    if (!updated.is_success() || updated.get_affected_rows() != 1) return false;
+    if (executor.execute_sql("SELECT * FROM t WHERE id = 5").row_count() != 0) return false;
+    QueryResult found = executor.execute_sql("SELECT id FROM t WHERE name = 'moved'");
+    if (found.row_count() != 1 || found.get_rows()[0].get_value(0) != Value(int64_t(1000))) return false;
+    if (executor.execute_sql("SELECT id FROM t WHERE name = 'n5'").row_count() != 19) return false;
+
+    // A range update over its own index column changes each row once
+    updated = executor.execute_sql("UPDATE t SET id = 2000 WHERE id > 150");
+    if (updated.get_affected_rows() != 50) return false;
+    if (executor.execute_sql("SELECT id FROM t WHERE id = 2000").row_count() != 50) return false;
+
+    // Assignments read the row as it was before the update
+    if (executor.execute_sql("UPDATE t SET score = id WHERE id < 3").get_affected_rows() != 3) return false;
+    found = executor.execute_sql("SELECT score FROM t WHERE id = 2");
+    if (found.row_count() != 1 || found.get_rows()[0].get_value(0) != Value(int64_t(2))) return false;
+
+    // Prepared updates are planned once and rerun with new values
+    std::string error;
+    auto update = executor.prepare("UPDATE t SET score = ? WHERE id = ?", error);
+    if (!update || update->parameter_count() != 2) return false;
+    for (int64_t id : {10, 11}) {
+        update->bind(0, Value(id * 2));
+        update->bind(1, Value(id));
+        if (executor.execute(*update).get_affected_rows() != 1) return false;
+    }
+    found = executor.execute_sql("SELECT score FROM t WHERE id = 11");
+    if (found.row_count() != 1 || found.get_rows()[0].get_value(0) != Value(int64_t(22))) return false;
+
+    // Deletes, through the hash index and then of everything left
+    QueryResult deleted = executor.execute_sql("DELETE FROM t WHERE name = 'n0'");
+    if (!deleted.is_success() || deleted.get_affected_rows() != 20 || table->row_count() != 180) return false;
+    if (executor.execute_sql("SELECT id FROM t WHERE id = 2000").row_count() != 46) return false;
+    if (executor.execute_sql("DELETE FROM t WHERE id = 12345").get_affected_rows() != 0) return false;
+    if (executor.execute_sql("DELETE FROM t").get_affected_rows() != 180 || table->row_count() != 0) return false;
+    if (executor.execute_sql("SELECT * FROM t WHERE name = 'n1'").row_count() != 0) return false;
+
+    // Unknown tables and columns, and malformed statements
+    if (executor.execute_sql("UPDATE t SET missing = 1").is_success()) return false;
+    if (executor.execute_sql("UPDATE missing SET id = 1").is_success()) return false;
+    if (executor.execute_sql("UPDATE t id = 1").is_success()) return false;
+    if (executor.execute_sql("DELETE t WHERE id = 1").is_success()) return false;
+
+    return true;
+}
+
+bool test_order_by_limit() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE t (id INTEGER, grp TEXT, score INTEGER)").is_success()) return false;
+    Table* table = executor.get_table("T");
+
+    // Scores repeat, so a second key is needed for a total order
+    const int64_t count = 12000;
+    for (int64_t i = 0; i < count; i++) {
+        Value score = i % 101 == 0 ? Value() : Value((i * 7919) % 1000);
+        if (table->insert_row(Row({Value(i), Value("g" + std::to_string(i % 7)), score})) == 0) return false;
+    }
+    std::vector<std::pair<Value, int64_t>> expected;
+    for (const auto& row : executor.execute_sql("SELECT score, id FROM t").get_rows()) {
+        expected.emplace_back(row.get_value(0), row.get_value(1).get_int());
+    }
+    if (expected.size() != static_cast<size_t>(count)) return false;
+    std::sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        int order = a.first.compare(b.first);
+        return order > 0 || (order == 0 && a.second < b.second);  // score DESC, id ASC
+    });
+    auto matches = [&](const QueryResult& result, size_t offset, size_t rows) {
+        if (!result.is_success() || result.row_count() != rows) return false;
+        for (size_t i = 0; i < rows; i++) {
+            const Row& row = result.get_rows()[i];
+            if (row.get_value(0).compare(expected[offset + i].first) != 0) return false;
+            if (row.get_value(1) != Value(expected[offset + i].second)) return false;
+        }
+        return true;
+    };
+
+    // A full sort, then the bounded heap behind a small LIMIT and OFFSET
+    const std::string ordered = "SELECT score, id FROM t ORDER BY score DESC, id";
+    if (!matches(executor.execute_sql(ordered), 0, count)) return false;
+    if (!matches(executor.execute_sql(ordered + " LIMIT 10"), 0, 10)) return false;
+    if (!matches(executor.execute_sql(ordered + " LIMIT 25 OFFSET 100"), 100, 25)) return false;
+    if (!matches(executor.execute_sql(ordered + " LIMIT 11000 OFFSET 500"), 500, 11000)) return false;
+    if (!matches(executor.execute_sql(ordered + " LIMIT 10 OFFSET 11995"), 11995, 5)) return false;
+    if (executor.execute_sql(ordered + " LIMIT 0").row_count() != 0) return false;
+    if (executor.execute_sql("SELECT * FROM t LIMIT 30").row_count() != 30) return false;
+
+    // Ascending puts NULLs first, and the cached plan gives the same rows again
+    QueryResult ascending = executor.execute_sql("SELECT score FROM t ORDER BY score ASC LIMIT 3");
+    if (ascending.row_count() != 3 || !ascending.get_rows()[2].get_value(0).is_null()) return false;
+    if (!executor.execute_sql("SELECT score FROM t ORDER BY score ASC LIMIT 3").get_rows()[2].get_value(0).is_null()) {
+        return false;
+    }
+
+    // A budget far below the input forces sorted runs out to pages, which
+    // are merged back in order
+    executor.set_sort_memory(64 * 1024);
+    if (!matches(executor.execute_sql(ordered), 0, count)) return false;
+    if (!matches(executor.execute_sql(ordered + " LIMIT 11500 OFFSET 200"), 200, 11500)) return false;
+    executor.set_sort_memory(0);
+
+    // "The latest 50": an ordered index is walked backwards instead of sorted
+    if (!table->create_index("ID", "btree")) return false;
+    std::unordered_map<std::string, Table*> tables{{"T", table}};
+    QueryPlanner planner(&tables);
+    Parser parser;
+    auto stmt = parser.parse("SELECT * FROM t ORDER BY id DESC");
+    auto plan = stmt ? planner.create_plan(stmt.get()) : nullptr;
+    if (!dynamic_cast<IndexRangeScanNode*>(plan.get())) return false;
+
+    // Sorts are costed on the rows they read; a top-N heap costs less than a full sort
+    auto full_stmt = parser.parse("SELECT * FROM t ORDER BY score");
+    auto top_stmt = parser.parse("SELECT * FROM t ORDER BY score LIMIT 10");
+    auto full_plan = full_stmt ? planner.create_plan(full_stmt.get()) : nullptr;
+    auto top_plan = top_stmt ? planner.create_plan(top_stmt.get()) : nullptr;
+    if (!full_plan || !top_plan || top_plan->get_cost() >= full_plan->get_cost()) return false;
+    if (std::abs(top_plan->estimate_rows() - 10.0) > 0.5) return false;
+    QueryResult latest = executor.execute_sql("SELECT id FROM t ORDER BY id DESC LIMIT 50");
+    if (latest.row_count() != 50) return false;
+    for (size_t i = 0; i < 50; i++) {
+        if (latest.get_rows()[i].get_value(0) != Value(count - 1 - static_cast<int64_t>(i))) return false;
+    }
+    QueryResult bounded = executor.execute_sql("SELECT id FROM t WHERE id < 100 ORDER BY id DESC LIMIT 5 OFFSET 1");
+    if (bounded.row_count() != 5 || bounded.get_rows()[0].get_value(0) != Value(int64_t(98))) return false;
+    QueryResult filtered = executor.execute_sql("SELECT id FROM t WHERE grp = 'g3' ORDER BY id LIMIT 3");
+    if (filtered.row_count() != 3 || filtered.get_rows()[2].get_value(0) != Value(int64_t(17))) return false;
+
+    // Aggregates sort by the name they were written with
+    QueryResult groups = executor.execute_sql("SELECT grp, COUNT(*) FROM t GROUP BY grp ORDER BY COUNT(*) DESC, grp");
+    if (groups.row_count() != 7) return false;
+    for (size_t i = 0; i < 7; i++) {
+        int64_t rows = count / 7 + (static_cast<int64_t>(i) < count % 7 ? 1 : 0);
+        if (groups.get_rows()[i].get_value(0) != Value("g" + std::to_string(i))) return false;
+        if (groups.get_rows()[i].get_value(1) != Value(rows)) return false;
+    }
+
+    // Joined rows sort on columns of either side
+    if (!executor.execute_sql("CREATE TABLE labels (grp TEXT, label TEXT)").is_success()) return false;
+    for (int i = 0; i < 7; i++) {
+        std::string grp = "g" + std::to_string(i);
+        if (!executor.execute_sql("INSERT INTO labels VALUES ('" + grp + "', 'label_" + grp + "')").is_success()) {
+            return false;
+        }
+    }
+    QueryResult joined = executor.execute_sql(
+        "SELECT l.label, t.id FROM t JOIN labels l ON t.grp = l.grp ORDER BY label DESC, t.id DESC LIMIT 2");
+    if (joined.row_count() != 2 || joined.get_rows()[0].get_value(0) != Value(std::string("label_g6"))) return false;
+    if (joined.get_rows()[0].get_value(1) != Value(int64_t(11997))) return false;
+    if (joined.get_rows()[1].get_value(1) != Value(int64_t(11990))) return false;
+
+    // Unknown sort columns and malformed clauses
+    if (executor.execute_sql("SELECT * FROM t ORDER BY missing").is_success()) return false;
+    if (executor.execute_sql("SELECT * FROM t ORDER id").is_success()) return false;
+    if (executor.execute_sql("SELECT * FROM t LIMIT ten").is_success()) return false;
+    if (executor.execute_sql("SELECT * FROM t LIMIT -1").is_success()) return false;
+
+    return true;
+}
+
+bool test_cost_based_planning() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE events (id INTEGER, kind TEXT, ts INTEGER)").is_success()) return false;
+    Table* events = executor.get_table("EVENTS");
+
+    // Nearly every event is a click; every twentieth has a kind of its own
+    const int64_t count = 10000;
+    for (int64_t i = 0; i < count; i++) {
+        std::string kind = i % 20 == 0 ? "kind_" + std::to_string(i) : "click";
+        if (events->insert_row(Row({Value(i), Value(kind), Value(i)})) == 0) return false;
+    }
+    if (!events->create_index("KIND", "hash") || !events->create_index("TS", "btree")) return false;
+
+    std::unordered_map<std::string, Table*> tables{{"EVENTS", events}};
+    QueryPlanner planner(&tables);
+    Parser parser;
+    std::vector<std::unique_ptr<Statement>> statements;
+    auto plan = [&](const std::string& sql) {
+        statements.push_back(parser.parse(sql));
+        return statements.back() ? planner.create_plan(statements.back().get()) : nullptr;
+    };
+    auto is_scan = [](const std::unique_ptr<PlanNode>& node) { return dynamic_cast<TableScanNode*>(node.get()); };
+
+    // Unanalyzed, any indexed key looks selective
+    const std::string clicks = "SELECT * FROM events WHERE kind = 'click'";
+    if (!dynamic_cast<IndexLookupNode*>(plan(clicks).get())) return false;
+    if (!dynamic_cast<IndexRangeScanNode*>(plan("SELECT * FROM events WHERE ts >= 100").get())) return false;
+    if (executor.execute_sql(clicks).row_count() != 9500) return false;
+
+    // With statistics the common key is scanned and the rare one looked up
+    if (!executor.execute_sql("ANALYZE events").is_success()) return false;
+    auto click_plan = plan(clicks);
+    if (!is_scan(click_plan) || std::abs(click_plan->estimate_rows() - 9500.0) > 95.0) return false;
+    if (!dynamic_cast<IndexLookupNode*>(plan("SELECT * FROM events WHERE kind = 'kind_40'").get())) return false;
+    if (!is_scan(plan("SELECT * FROM events WHERE ts >= 100"))) return false;
+    if (!dynamic_cast<IndexRangeScanNode*>(plan("SELECT * FROM events WHERE ts >= 9950").get())) return false;
+    if (!is_scan(plan("SELECT * FROM events WHERE ts < 5000"))) return false;
+    if (executor.execute_sql(clicks).row_count() != 9500) return false;
+    if (executor.execute_sql("SELECT id FROM events WHERE kind = 'kind_40'").row_count() != 1) return false;
+
+    // Walking an index in order is weighed against scanning and sorting
+    if (!dynamic_cast<SortNode*>(plan("SELECT * FROM events WHERE id = 40 ORDER BY ts").get())) return false;
+    if (!dynamic_cast<IndexRangeScanNode*>(plan("SELECT * FROM events ORDER BY ts LIMIT 5").get())) return false;
+    if (executor.execute_sql("SELECT ts FROM events WHERE id = 40 ORDER BY ts").row_count() != 1) return false;
+
+    // Three-way joins start from the smallest input once all are analyzed
+    if (!executor.execute_sql("CREATE TABLE orders (id INTEGER, customer_id INTEGER)").is_success()) return false;
+    if (!executor.execute_sql("CREATE TABLE customers (id INTEGER, region INTEGER)").is_success()) return false;
+    if (!executor.execute_sql("CREATE TABLE regions (id INTEGER, name TEXT)").is_success()) return false;
+    Table* orders = executor.get_table("ORDERS");
+    Table* customers = executor.get_table("CUSTOMERS");
+    Table* regions = executor.get_table("REGIONS");
+    for (int64_t i = 0; i < 5000; i++) {
+        if (orders->insert_row(Row({Value(i), Value(i % 1000)})) == 0) return false;
+    }
+    for (int64_t i = 0; i < 1000; i++) {
+        if (customers->insert_row(Row({Value(i), Value(i % 10)})) == 0) return false;
+    }
+    for (int64_t i = 0; i < 10; i++) {
+        if (regions->insert_row(Row({Value(i), Value("r" + std::to_string(i))})) == 0) return false;
+    }
+    const std::string joined = "SELECT * FROM orders o JOIN customers c ON o.customer_id = c.id "
+                               "JOIN regions r ON c.region = r.id WHERE r.name = 'r3'";
+    QueryResult written = executor.execute_sql(joined);
+    if (!written.is_success() || written.row_count() != 500) return false;
+
+    if (!executor.execute_sql("ANALYZE").is_success()) return false;
+    std::unordered_map<std::string, Table*> join_tables{{"ORDERS", orders}, {"CUSTOMERS", customers}, {"REGIONS", regions}};
+    QueryPlanner join_planner(&join_tables);
+    auto join_stmt = parser.parse(joined);
+    auto join_plan = join_stmt ? join_planner.create_plan(join_stmt.get()) : nullptr;
+    if (!dynamic_cast<ProjectionNode*>(join_plan.get())) return false;  // Columns put back in written order
+    QueryResult reordered = executor.execute_sql(joined);
+    if (reordered.get_column_names() != written.get_column_names()) return false;
+    if (sorted_rows(reordered) != sorted_rows(written)) return false;
+    QueryResult projected = executor.execute_sql("SELECT o.id, r.name FROM orders o JOIN customers c ON "
+                                                 "o.customer_id = c.id JOIN regions r ON c.region = r.id "
+                                                 "WHERE r.name = 'r3' ORDER BY o.id LIMIT 3");
+    if (projected.row_count() != 3 || projected.get_rows()[2].get_value(0) != Value(int64_t(23))) return false;
+
+    // Unknown tables, and tables created since, which go unanalyzed
+    if (executor.execute_sql("ANALYZE missing").is_success()) return false;
+    if (!executor.execute_sql("CREATE TABLE later (id INTEGER)").is_success()) return false;
+    return executor.get_table("LATER")->get_schema().get_statistics() == nullptr;
+}
+
+bool test_explain() {
+    PageManager page_manager;
+    QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE items (id INTEGER, qty INTEGER)").is_success()) return false;
+    Table* items = executor.get_table("ITEMS");
+    for (int64_t i = 0; i < 200; i++) {
+        if (items->insert_row(Row({Value(i), Value(i % 10)})) == 0) return false;
+    }
+    if (!items->create_index("ID", "btree")) return false;
+    auto plan_text = [](const QueryResult& result) {
+        std::string text;
+        for (const auto& row : result.get_rows()) {
+            text += row.get_value(0).get_string() + "\n";
+        }
+        return text;
+    };
+
+    // Plans are described without running them
+    QueryResult plan = executor.execute_sql("EXPLAIN SELECT id FROM items WHERE id = 7");
+    if (!plan.is_success() || plan.get_column_names() != std::vector<std::string>{"QUERY PLAN"}) return false;
+    if (plan_text(plan).find("Index Lookup on ITEMS using ID = 7") == std::string::npos) return false;
+    if (plan_text(plan).find("actual") != std::string::npos) return false;
+
+    // ANALYZE runs the plan and reports what each node did
+    auto& lookups = minidb::utils::MetricsRegistry::global().counter("index.lookups");
+    uint64_t lookups_before = lookups.value();
+    QueryResult analyzed = executor.execute_sql("EXPLAIN ANALYZE SELECT id FROM items WHERE qty = 3");
+    if (!analyzed.is_success() || analyzed.row_count() < 3) return false;
+    std::string text = plan_text(analyzed);
+    if (text.find("actual rows=20 ") == std::string::npos) return false;
+    if (text.find("Planning time: ") == std::string::npos || text.find("Execution time: ") == std::string::npos) {
+        return false;
+    }
+    if (!executor.execute_sql("EXPLAIN ANALYZE SELECT * FROM items WHERE id = 7").is_success()) return false;
+    if (lookups.value() != lookups_before + 1) return false;
+
+    // Changes made under ANALYZE are kept, and counted as the node's rows
+    QueryResult updated = executor.execute_sql("EXPLAIN ANALYZE UPDATE items SET qty = 99 WHERE qty = 4");
+    if (plan_text(updated).find("Update ITEMS set QTY") == std::string::npos) return false;
+    if (executor.execute_sql("SELECT id FROM items WHERE qty = 99").row_count() != 20) return false;
+
+    // Only planned statements can be explained
+    Parser parser;
+    if (parser.parse("EXPLAIN EXPLAIN SELECT * FROM items") || parser.parse("EXPLAIN ANALYZE")) return false;
+    if (executor.execute_sql("EXPLAIN CREATE TABLE other (id INTEGER)").is_success()) return false;
+    if (executor.get_table("OTHER") != nullptr) return false;
+    return !executor.execute_sql("EXPLAIN SELECT * FROM missing").is_success();
+}
+
+bool test_metrics_registry() {
+    minidb::utils::MetricsRegistry registry;
+    minidb::utils::Counter& counter = registry.counter("test.events");
+    if (&registry.counter("test.events") != &counter) return false;
+    counter.add(3);
+
+    // Histograms keep exact counts and maxima; percentiles are bucket bounds
+    minidb::utils::LatencyHistogram& histogram = registry.histogram("test.latency");
+    for (int i = 1; i <= 100; i++) {
+        histogram.record(std::chrono::microseconds(i));
+    }
+    uint64_t source_value = 5;
+    registry.add_source(&source_value, [&](minidb::utils::MetricsSnapshot& snapshot) {
+        snapshot.counters["test.source"] += source_value;
+    });
+
+    minidb::utils::MetricsSnapshot snapshot = registry.snapshot();
+    if (snapshot.counters["test.events"] != 3 || snapshot.counters["test.source"] != 5) return false;
+    const auto& summary = snapshot.histograms["test.latency"];
+    if (summary.count != 100 || summary.max_us != 100.0 || std::abs(summary.mean_us - 50.5) > 0.01) return false;
+    if (summary.p50_us < 50.0 || summary.p50_us > 100.0 || summary.p99_us < 99.0 || summary.p99_us > 100.0) {
+        return false;
+    }
+    if (snapshot.to_string().find("test.latency") == std::string::npos) return false;
+
+    // Reset zeroes registered metrics; removed sources stop contributing
+    registry.reset();
+    registry.remove_source(&source_value);
+    snapshot = registry.snapshot();
+    return snapshot.counters["test.events"] == 0 && snapshot.counters.count("test.source") == 0 &&
+           snapshot.histograms["test.latency"].count == 0;
+}
@@ -0,0 +1,269 @@
+/**
+ * @file test_server.cpp
+ * @brief Network server tests
+ */
+
+#include "minidb/minidb.h"
+#include "minidb/server/server.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace minidb;
+
+namespace {
+
+    // Blocking line-protocol client
+    class TestClient {
+    public:
+        TestClient() : fd_(-1) {}
+        ~TestClient() { disconnect(); }
+        
+        bool connect_to(uint16_t port) {
+            fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            ::inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+            return fd_ >= 0 && ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        }
+        
+        void disconnect() {
+            if (fd_ >= 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+        }
+        
+        bool send_text(const std::string& text) {
+            size_t sent = 0;
+            while (sent < text.size()) {
+                ssize_t written = ::send(fd_, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) return false;
+                sent += static_cast<size_t>(written);
+            }
+            return true;
+        }
+        
+        // Lines of the next reply, its final OK or ERROR line included
+        std::vector<std::string> read_reply() {
+            std::vector<std::string> lines;
+            while (true) {
+                size_t end = buffer_.find('\n');
+                if (end == std::string::npos) {
+                    char chunk[4096];
+                    ssize_t received = ::recv(fd_, chunk, sizeof(chunk), 0);
+                    if (received <= 0) return lines;
+                    buffer_.append(chunk, static_cast<size_t>(received));
+                    continue;
+                }
+                lines.push_back(buffer_.substr(0, end));
+                buffer_.erase(0, end + 1);
+                if (lines.back().rfind("OK ", 0) == 0 || lines.back().rfind("ERROR ", 0) == 0) {
+                    return lines;
+                }
+            }
+        }
+        
+        std::vector<std::string> query(const std::string& sql) {
+            return send_text(sql + "\n") ? read_reply() : std::vector<std::string>();
+        }
+    
+    private:
+        int fd_;
+        std::string buffer_;
+    };
+    
+    bool is_ok(const std::vector<std::string>& reply) {
+        return !reply.empty() && reply.back().rfind("OK ", 0) == 0;
+    }
+    
+    long long count_items(TestClient& client) {
+        std::vector<std::string> reply = client.query("SELECT COUNT(*) FROM items");
+        if (reply.size() != 3 || !is_ok(reply) || reply[1].rfind("ROW ", 0) != 0) return -1;
+        return std::stoll(reply[1].substr(4));
+    }
+    
+    void remove_database_files(const std::string& name) {
+        std::remove((name + ".db").c_str());
+        std::remove((name + ".wal").c_str());
+        std::remove((name + ".snap").c_str());
+    }
+
+} // anonymous namespace
+
+bool test_server_pipelining() {
+    const std::string name = "test_server_pipelining";
+    remove_database_files(name);
+    Database db(name);
+    if (!db.open()) return false;
+    
+    server::ServerConfig config;
+    config.port = 0;
+    config.workers = 4;
+    server::Server server(db, config);
+    if (!server.start()) return false;
+    
+    bool passed = [&]() {
+        // A whole script in one write; replies come back one per line, in order
+        TestClient client;
+        if (!client.connect_to(server.port())) return false;
+        std::string script = "CREATE TABLE items (id INTEGER, name TEXT)\n";
+        for (int i = 0; i < 100; i++) {
+            script += "INSERT INTO items VALUES (" + std::to_string(i) + ", 'item" + std::to_string(i) + "');\r\n";
+        }
+        script += "SELECT name FROM items WHERE id = 42\nSELECT * FROM missing\n";
+        if (!client.send_text(script)) return false;
+        for (int i = 0; i < 101; i++) {
+            if (client.read_reply() != std::vector<std::string>({i == 0 ? "OK 0" : "OK 1"})) return false;
+        }
+        std::vector<std::string> rows = client.read_reply();
+        if (rows.size() != 3 || rows[0].rfind("COLUMNS ", 0) != 0 || rows[1] != "ROW item42" || rows[2] != "OK 1") {
+            return false;
+        }
+        std::vector<std::string> error = client.read_reply();
+        if (error.size() != 1 || error[0].rfind("ERROR ", 0) != 0) return false;
+        
+        // Text is escaped so a row is always one line
+        if (!is_ok(client.query("INSERT INTO items VALUES (100, 'tab\there')"))) return false;
+        std::vector<std::string> reply = client.query("SELECT name FROM items WHERE id = 100");
+        if (reply.size() != 3 || reply[1] != "ROW tab\\there") return false;
+        
+        // Clients on their own connections run side by side
+        const int clients = 8;
+        const int rows_each = 50;
+        std::vector<std::thread> threads;
+        std::vector<char> loaded(clients, 0);  // One byte per thread, so no shared words
+        for (int c = 0; c < clients; c++) {
+            threads.emplace_back([&, c]() {
+                TestClient writer;
+                if (!writer.connect_to(server.port())) return;
+                std::string batch;
+                for (int i = 0; i < rows_each; i++) {
+                    batch += "INSERT INTO items VALUES (" + std::to_string(1000 + c * rows_each + i) + ", 'x')\n";
+                }
+                if (!writer.send_text(batch)) return;
+                bool ok = true;
+                for (int i = 0; i < rows_each; i++) {
+                    ok = is_ok(writer.read_reply()) && ok;
+                }
+                loaded[c] = ok;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (char ok : loaded) {
+            if (!ok) return false;
+        }
+        return count_items(client) == 101 + clients * rows_each;
+    }();
+    
+    server.stop();
+    db.close();
+    remove_database_files(name);
+    return passed;
+}
+
+bool test_server_sessions() {
+    const std::string name = "test_server_sessions";
+    remove_database_files(name);
+    Database db(name);
+    if (!db.open()) return false;
+    
+    server::ServerConfig config;
+    config.port = 0;
+    config.workers = 2;
+    server::Server server(db, config);
+    if (!server.start()) return false;
+    
+    bool passed = [&]() {
+        TestClient first;
+        TestClient second;
+        if (!first.connect_to(server.port()) || !second.connect_to(server.port())) return false;
+        if (!is_ok(first.query("CREATE TABLE items (id INTEGER, name TEXT)"))) return false;
+        if (!is_ok(first.query("INSERT INTO items VALUES (1, 'one')"))) return false;
+        
+        // Each connection has its own transaction
+        if (!is_ok(first.query("BEGIN"))) return false;
+        if (!is_ok(first.query("INSERT INTO items VALUES (2, 'two')"))) return false;
+        if (count_items(first) != 2 || count_items(second) != 1) return false;
+        if (!is_ok(first.query("COMMIT"))) return false;
+        if (count_items(second) != 2) return false;
+        
+        // Hanging up rolls back whatever the client left open
+        {
+            TestClient quitter;
+            if (!quitter.connect_to(server.port())) return false;
+            if (!is_ok(quitter.query("BEGIN"))) return false;
+            if (!is_ok(quitter.query("INSERT INTO items VALUES (3, 'three')"))) return false;
+        }
+        Table* items = db.get_table("ITEMS");
+        for (int attempt = 0; attempt < 200 && items->has_uncommitted_writes(); attempt++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (items->has_uncommitted_writes() || count_items(second) != 2) return false;
+        
+        server::Server::Stats stats = server.get_stats();
+        return stats.connections_accepted == 3 && stats.statements == 11;
+    }();
+    
+    server.stop();
+    db.close();
+    remove_database_files(name);
+    return passed;
+}
+
+bool test_server_stalled_client() {
+    const std::string name = "test_server_stalled_client";
+    remove_database_files(name);
+    Database db(name);
+    if (!db.open()) return false;
+    if (!db.execute_query("CREATE TABLE items (id INTEGER, name TEXT)").is_success()) return false;
+    std::string padding(200, 'x');
+    for (int batch = 0; batch < 100; batch++) {
+        std::string values;
+        for (int i = 0; i < 1000; i++) {
+            values += (i == 0 ? "(" : ", (") + std::to_string(batch * 1000 + i) + ", '" + padding + "')";
+        }
+        if (!db.execute_query("INSERT INTO items VALUES " + values).is_success()) return false;
+    }
+    
+    server::ServerConfig config;
+    config.port = 0;
+    config.workers = 1;
+    config.max_output_bytes = 64 * 1024;
+    config.stall_timeout = std::chrono::milliseconds(200);
+    server::Server server(db, config);
+    if (!server.start()) return false;
+    
+    bool passed = [&]() {
+        // A client that never reads its result is cut off, and what it had
+        // open is rolled back, instead of holding the only worker
+        TestClient staller;
+        if (!staller.connect_to(server.port())) return false;
+        if (!is_ok(staller.query("BEGIN"))) return false;
+        if (!is_ok(staller.query("INSERT INTO items VALUES (-1, 'open')"))) return false;
+        if (!staller.send_text("SELECT * FROM items\n")) return false;
+        
+        Table* items = db.get_table("ITEMS");
+        for (int attempt = 0; attempt < 500 && items->has_uncommitted_writes(); attempt++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (items->has_uncommitted_writes()) return false;
+        
+        TestClient other;
+        return other.connect_to(server.port()) && count_items(other) == 100000;
+    }();
+    
+    server.stop();
+    db.close();
+    remove_database_files(name);
+    return passed;
+}
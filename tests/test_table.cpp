@@ -0,0 +1,394 @@
+/**
+ * @file test_table.cpp
+ * @brief Table storage tests
+ */
+
+#include "minidb/query/executor.h"
+#include "minidb/storage/serialization.h"
+#include "minidb/storage/statistics.h"
+#include "minidb/storage/table.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+
+using namespace minidb::storage;
+
+static TableSchema make_test_schema() {
+    TableSchema schema("people");
+    schema.add_column(Column("id", ColumnType::INTEGER));
+    schema.add_column(Column("name", ColumnType::TEXT));
+    schema.add_column(Column("score", ColumnType::REAL));
+    return schema;
+}
+
+static Row make_test_row(int64_t id, const std::string& name, double score) {
+    Row row;
+    row.add_value(Value(id));
+    row.add_value(Value(name));
+    row.add_value(Value(score));
+    return row;
+}
+
+bool test_table_heap_storage() {
+    PageManager page_manager;
+    Table table(make_test_schema(), &page_manager);
+    
+    // Enough rows to spill over several heap pages
+    const int64_t row_total = 500;
+    for (int64_t i = 0; i < row_total; i++) {
+        uint64_t row_id = table.insert_row(make_test_row(i, "name_" + std::to_string(i), i * 0.5));
+        if (row_id != static_cast<uint64_t>(i + 1)) return false;
+    }
+    if (table.row_count() != static_cast<size_t>(row_total)) return false;
+    if (page_manager.get_stats().used_pages < 2) return false;
+    
+    Row row;
+    if (!table.get_row(42, row)) return false;
+    if (row.get_id() != 42 || row.get_value(0).get_int() != 41) return false;
+    if (row.get_value(1).get_string() != "name_41") return false;
+    
+    // Growing a row past its slot still keeps the row id
+    std::string long_name(1500, 'x');
+    if (!table.update_row(42, make_test_row(41, long_name, 1.0))) return false;
+    if (!table.get_row(42, row) || row.get_value(1).get_string() != long_name) return false;
+    
+    if (!table.delete_row(10)) return false;
+    if (table.get_row(10, row)) return false;
+    if (table.delete_row(10)) return false;
+    
+    size_t scanned = 0;
+    table.scan([&scanned](const Row&) {
+        scanned++;
+        return true;
+    });
+    if (scanned != static_cast<size_t>(row_total - 1)) return false;
+    if (table.row_count() != scanned) return false;
+    
+    // Wrong arity is rejected
+    Row short_row;
+    short_row.add_value(Value(static_cast<int64_t>(1)));
+    if (table.insert_row(short_row) != 0) return false;
+    
+    return true;
+}
+
+bool test_btree_index_range_query() {
+    PageManager page_manager;
+    Table table(make_test_schema(), &page_manager);
+    if (!table.create_index("score", "btree")) return false;
+    
+    // Scores repeat, so the index holds duplicate keys
+    for (int64_t i = 0; i < 100; i++) {
+        table.insert_row(make_test_row(i, "name_" + std::to_string(i), static_cast<double>(i % 10)));
+    }
+    
+    BTreeIndex index;
+    for (int64_t i = 0; i < 100; i++) {
+        index.insert(Value(static_cast<double>(i % 10)), static_cast<uint64_t>(i + 1));
+    }
+    
+    std::vector<uint64_t> row_ids = index.range_query(Value(3.0), Value(4.0));
+    if (row_ids.size() != 20) return false;
+    for (uint64_t row_id : row_ids) {
+        Row row;
+        if (!table.get_row(row_id, row)) return false;
+        double score = row.get_value(2).get_real();
+        if (score < 3.0 || score > 4.0) return false;
+    }
+    
+    if (!index.range_query(Value(20.0), Value(30.0)).empty()) return false;
+    if (index.range_query(Value(0.0), Value(9.0)).size() != 100) return false;
+    
+    return true;
+}
+
+bool test_btree_index_maintenance() {
+    PageManager page_manager;
+    Table table(make_test_schema(), &page_manager);
+    if (!table.create_index("name", "btree")) return false;
+    
+    Index* index = table.get_index("name");
+    if (index == nullptr) return false;
+    
+    // Three rows share a name; the index keeps one entry per row
+    for (int64_t i = 0; i < 30; i++) {
+        table.insert_row(make_test_row(i, "group_" + std::to_string(i % 10), 0.0));
+    }
+    std::vector<uint64_t> row_ids = index->find_all(Value(std::string("group_3")));
+    if (row_ids != std::vector<uint64_t>({4, 14, 24})) return false;
+    if (index->find(Value(std::string("group_3"))) != 4) return false;
+    if (index->find(Value(std::string("missing"))) != 0) return false;
+    
+    // Updating and deleting rows moves and drops exactly their entries
+    if (!table.update_row(14, make_test_row(13, "renamed", 0.0))) return false;
+    if (!table.delete_row(4)) return false;
+    if (index->find_all(Value(std::string("group_3"))) != std::vector<uint64_t>({24})) return false;
+    if (index->find(Value(std::string("renamed"))) != 14) return false;
+    
+    for (uint64_t row_id = 1; row_id <= 30; row_id++) {
+        table.delete_row(row_id);
+    }
+    if (!index->range_query(Value(std::string("")), Value(std::string("zzz"))).empty()) return false;
+    
+    return true;
+}
+
+static std::map<uint64_t, std::vector<Value>> table_contents(const Table& table) {
+    std::map<uint64_t, std::vector<Value>> contents;
+    table.scan([&contents](const Row& row) {
+        contents[row.get_id()] = row.get_values();
+        return true;
+    });
+    return contents;
+}
+
+bool test_columnar_table() {
+    PageManager page_manager;
+    TableSchema row_schema = make_test_schema();
+    TableSchema columnar_schema = make_test_schema();
+    columnar_schema.set_storage_format(StorageFormat::COLUMNAR);
+    Table rows(row_schema, &page_manager);
+    Table columns(columnar_schema, &page_manager);
+    if (!columns.create_index("name", "hash")) return false;
+    
+    // The same random mix of writes must leave both formats equal. NULLs
+    // and values of the wrong type go through the exception paths, and
+    // enough deletes happen to trigger compaction.
+    std::mt19937 rng(3);
+    auto random_row = [&rng](int64_t i) {
+        Row row = make_test_row(i, "name_" + std::to_string(rng() % 40), i * 0.25);
+        if (rng() % 11 == 0) row.set_value(0, Value());
+        if (rng() % 13 == 0) row.set_value(2, Value(std::string("not a real")));
+        if (rng() % 17 == 0) row.set_value(1, Value(static_cast<int64_t>(i)));
+        return row;
+    };
+    for (int64_t i = 0; i < 5000; i++) {
+        Row row = random_row(i);
+        if (rows.insert_row(row) != columns.insert_row(row)) return false;
+    }
+    for (int i = 0; i < 4000; i++) {
+        uint64_t row_id = 1 + rng() % 5000;
+        if (rng() % 3 == 0) {
+            Row row = random_row(i);
+            if (rows.update_row(row_id, row) != columns.update_row(row_id, row)) return false;
+        } else if (rows.delete_row(row_id) != columns.delete_row(row_id)) {
+            return false;
+        }
+    }
+    if (rows.row_count() != columns.row_count()) return false;
+    if (table_contents(rows) != table_contents(columns)) return false;
+    
+    Row expected;
+    Row actual;
+    for (uint64_t row_id = 1; row_id <= 5000; row_id += 7) {
+        bool found = rows.get_row(row_id, expected);
+        if (found != columns.get_row(row_id, actual)) return false;
+        if (found && expected.get_values() != actual.get_values()) return false;
+    }
+    
+    // The index stays in step with the store across compaction
+    std::vector<Row> matches;
+    if (!columns.index_lookup("name", Value(std::string("name_5")), matches)) return false;
+    size_t expected_matches = 0;
+    for (const auto& [row_id, values] : table_contents(rows)) {
+        if (values[1] == Value(std::string("name_5"))) expected_matches++;
+    }
+    if (matches.size() != expected_matches) return false;
+    
+    // Segments only materialize the requested columns
+    std::vector<size_t> wanted = {2};
+    std::vector<Row> segment;
+    if (!columns.read_page_rows(0, segment, &wanted) || segment.empty()) return false;
+    for (const auto& row : segment) {
+        if (row.size() != 3 || !row.get_value(0).is_null() || !row.get_value(1).is_null()) return false;
+        if (!columns.get_row(row.get_id(), actual) || actual.get_value(2) != row.get_value(2)) return false;
+    }
+    
+    // The format survives the schema encoding used by the log
+    std::vector<char> encoded;
+    encode_schema(columnar_schema, encoded);
+    TableSchema decoded;
+    if (!decode_schema(encoded.data(), encoded.size(), decoded)) return false;
+    if (decoded.get_storage_format() != StorageFormat::COLUMNAR) return false;
+    
+    // CREATE TABLE ... USING COLUMNAR, and a projection over it
+    minidb::query::QueryExecutor executor(&page_manager);
+    if (!executor.execute_sql("CREATE TABLE wide (a INTEGER, b TEXT, c REAL) USING COLUMNAR").is_success()) return false;
+    if (executor.execute_sql("CREATE TABLE bad (a INTEGER) USING SIDEWAYS").is_success()) return false;
+    for (int i = 0; i < 50; i++) {
+        std::string sql = "INSERT INTO wide VALUES (" + std::to_string(i) + ", 'b" + std::to_string(i % 4) + "', 1.5)";
+        if (!executor.execute_sql(sql).is_success()) return false;
+    }
+    Table* wide = executor.get_table("WIDE");
+    if (wide == nullptr || wide->get_schema().get_storage_format() != StorageFormat::COLUMNAR) return false;
+    auto result = executor.execute_sql("SELECT a FROM wide WHERE b = 'b2'");
+    if (!result.is_success() || result.row_count() != 12) return false;
+    for (const auto& row : result.get_rows()) {
+        if (row.size() != 1 || row.get_value(0).get_int() % 4 != 2) return false;
+    }
+    
+    return true;
+}
+
+bool test_row_directory() {
+    PageManager page_manager;
+    Table table(make_test_schema(), &page_manager);
+    if (!table.create_index("name", "hash")) return false;
+    
+    // Reference copy of every live row; updates often outgrow their slot
+    std::map<uint64_t, Row> expected;
+    std::mt19937 rng(18);
+    for (int64_t i = 0; i < 20000; i++) {
+        Row row = make_test_row(i, "name_" + std::to_string(i % 50), i * 0.25);
+        uint64_t row_id = table.insert_row(row);
+        if (row_id == 0) return false;
+        row.set_id(row_id);
+        expected[row_id] = row;
+    }
+    for (int step = 0; step < 20000; step++) {
+        uint64_t row_id = rng() % 20000 + 1;
+        bool present = expected.count(row_id) > 0;
+        if (rng() % 2 == 0) {
+            if (table.delete_row(row_id) != present) return false;
+            expected.erase(row_id);
+        } else {
+            Row row = make_test_row(step, "name_" + std::to_string(step % 50) + std::string(rng() % 400, 'y'), 0.5);
+            if (table.update_row(row_id, row) != present) return false;
+            if (present) {
+                row.set_id(row_id);
+                expected[row_id] = row;
+            }
+        }
+    }
+    
+    Row row;
+    for (uint64_t row_id = 1; row_id <= 20000; row_id++) {
+        auto it = expected.find(row_id);
+        if (table.get_row(row_id, row) != (it != expected.end())) return false;
+        if (it != expected.end() && (row.get_id() != row_id || row.get_values() != it->second.get_values())) {
+            return false;
+        }
+    }
+    if (table.row_count() != expected.size()) return false;
+    
+    // Index lookups fetch their rows through the directory too
+    std::vector<Row> found;
+    if (!table.index_lookup("name", Value(std::string("name_7")), found)) return false;
+    size_t matches = 0;
+    for (const auto& [row_id, live] : expected) {
+        matches += live.get_value(1) == Value(std::string("name_7"));
+    }
+    if (found.size() != matches) return false;
+    for (const auto& match : found) {
+        if (expected.at(match.get_id()).get_values() != match.get_values()) return false;
+    }
+    
+    // A row id is only ever stored once
+    if (table.restore_row(expected.begin()->second)) return false;
+    
+    table.clear();
+    if (table.get_row(expected.begin()->first, row) || table.row_count() != 0) return false;
+    if (table.insert_row(make_test_row(1, "again", 1.0)) != 1 || !table.get_row(1, row)) return false;
+    
+    return true;
+}
+
+bool test_value_representation() {
+    // Numbers and short text need no allocation, and every value stays small
+    static_assert(sizeof(Value) <= 24, "Value should stay three words");
+    std::string short_text(Value::INLINE_TEXT, 's');
+    std::string long_text(Value::INLINE_TEXT + 1, 'l');
+
+    std::vector<Value> values{Value(), Value(int64_t(-7)), Value(2.5), Value(short_text), Value(long_text), Value("")};
+    std::vector<Value> copies = values;
+    std::vector<Value> moved = std::move(copies);
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i].compare(moved[i]) != 0 || values[i].get_type() != moved[i].get_type()) return false;
+        if (values[i].hash() != moved[i].hash()) return false;
+    }
+    if (moved[3].get_string() != short_text || moved[4].get_string() != long_text) return false;
+    if (!moved[0].is_null() || moved[1].get_int() != -7 || moved[2].get_real() != 2.5) return false;
+    if (!moved[5].get_string().empty() || moved[5].is_null()) return false;
+
+    // Assignment across representations releases what was there
+    Value value(long_text);
+    value = Value(int64_t(1));
+    if (value.get_type() != ColumnType::INTEGER || !value.get_string().empty()) return false;
+    value = moved[4];
+    const Value& self = value;
+    value = self;
+    if (value.get_string() != long_text) return false;
+    value = Value(short_text);
+    if (value.to_string() != short_text) return false;
+
+    // Equal values hash alike, including zeros of either sign
+    if (Value(0.0).compare(Value(-0.0)) != 0 || Value(0.0).hash() != Value(-0.0).hash()) return false;
+    if (Value(long_text).compare(Value(short_text)) <= 0 || Value("a").compare(Value("b")) >= 0) return false;
+
+    // Text survives the row codec, which decodes straight from the record
+    Row row({Value(int64_t(3)), Value(long_text), Value(), Value(short_text)});
+    std::vector<char> record;
+    encode_row(row, 9, record);
+    Row decoded;
+    if (!decode_row(record.data(), record.size(), decoded) || decoded.get_values() != row.get_values()) return false;
+
+    return true;
+}
+
+bool test_table_statistics() {
+    PageManager page_manager;
+    Table table(make_test_schema(), &page_manager);
+
+    // Skewed names: most rows share one, the rest are unique. Every tenth
+    // score is NULL.
+    const int64_t count = 10000;
+    for (int64_t i = 0; i < count; i++) {
+        Row row = make_test_row(i, i % 4 == 0 ? "name" + std::to_string(i) : "common", static_cast<double>(i) / 2);
+        if (i % 10 == 0) {
+            row = Row({Value(i), row.get_value(1), Value()});
+        }
+        if (table.insert_row(row) == 0) return false;
+    }
+
+    auto statistics = table.collect_statistics(nullptr);
+    if (statistics->row_count != count || statistics->columns.size() != 3) return false;
+    auto near = [](double estimate, double actual) { return std::abs(estimate - actual) <= 0.01; };
+
+    // Unique integers: exact bounds, ranges from the histogram
+    const ColumnStatistics& ids = statistics->columns[0];
+    if (ids.distinct_count != count || ids.null_fraction != 0.0 || !ids.most_common.empty()) return false;
+    if (ids.min != Value(int64_t(0)) || ids.max != Value(count - 1)) return false;
+    if (ids.histogram.size() != StatisticsBuilder::DEFAULT_HISTOGRAM_BUCKETS + 1) return false;
+    Value low(int64_t(2000));
+    Value high(int64_t(2999));
+    if (!near(ids.range_fraction(&low, &high), 0.1) || !near(ids.range_fraction(nullptr, &low), 0.2)) return false;
+    if (!near(ids.equal_fraction(low), 1.0 / count) || ids.equal_fraction(Value(count)) != 0.0) return false;
+
+    // The common name is known exactly; the rest share what is left
+    const ColumnStatistics& names = statistics->columns[1];
+    if (names.distinct_count != count / 4 + 1 || names.most_common.size() != 1) return false;
+    if (names.most_common[0].first != Value("common") || !near(names.equal_fraction(Value("common")), 0.75)) return false;
+    if (!near(names.equal_fraction(Value("name8")), 0.25 / (count / 4))) return false;
+
+    // NULLs are in no range and equal nothing
+    const ColumnStatistics& scores = statistics->columns[2];
+    if (!near(scores.null_fraction, 0.1) || scores.equal_fraction(Value()) != 0.0) return false;
+    if (!near(scores.range_fraction(nullptr, nullptr), 0.9)) return false;
+
+    // Statistics travel with the schema, through its encoding too
+    if (table.get_schema().get_statistics() != nullptr || !table.set_statistics(statistics)) return false;
+    std::vector<char> encoded;
+    encode_schema(table.get_schema(), encoded);
+    TableSchema decoded;
+    if (!decode_schema(encoded.data(), encoded.size(), decoded) || decoded.get_statistics() == nullptr) return false;
+    const ColumnStatistics& copy = decoded.get_statistics()->columns[1];
+    if (copy.distinct_count != names.distinct_count || copy.histogram != names.histogram) return false;
+    if (copy.most_common != names.most_common || copy.max != names.max) return false;
+
+    // Nor can statistics of another shape be attached
+    auto other = std::make_shared<TableStatistics>();
+    other->columns.resize(2);
+    return !table.set_statistics(other) && table.get_schema().get_statistics() == statistics.get();
+}
@@ -0,0 +1,271 @@
+/**
+ * @file test_transaction.cpp
+ * @brief Multi-version concurrency control and transaction tests
+ */
+
+#include "minidb/minidb.h"
+#include "minidb/storage/table.h"
+#include "minidb/storage/transaction.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace minidb;
+using namespace minidb::storage;
+
+static TableSchema make_account_schema() {
+    TableSchema schema("accounts");
+    schema.add_column(Column("id", ColumnType::INTEGER));
+    schema.add_column(Column("balance", ColumnType::INTEGER));
+    return schema;
+}
+
+static Row make_account(int64_t id, int64_t balance) {
+    return Row({Value(id), Value(balance)});
+}
+
+static int64_t balance_of(const Table& table, uint64_t row_id, const Transaction* reader) {
+    Row row;
+    return table.get_row(row_id, row, reader) ? row.get_value(1).get_int() : -1;
+}
+
+bool test_snapshot_isolation() {
+    PageManager page_manager;
+    Table table(make_account_schema(), &page_manager);
+    TransactionManager transactions;
+    table.attach_transactions(&transactions);
+    if (!table.create_index("balance", "btree")) return false;
+    
+    // Rows written outside a transaction commit on their own
+    for (int64_t i = 0; i < 10; i++) {
+        if (table.insert_row(make_account(i, 100 + i)) == 0) return false;
+    }
+    
+    auto reader = transactions.begin();
+    auto writer = transactions.begin();
+    if (!table.update_row(1, make_account(0, 500), writer.get())) return false;
+    if (!table.delete_row(2, writer.get())) return false;
+    uint64_t added = table.insert_row(make_account(10, 110), writer.get());
+    if (added == 0) return false;
+    
+    // Nobody else sees uncommitted changes; the writer sees all of its own
+    const Transaction* outsiders[] = {reader.get(), nullptr};
+    for (const Transaction* txn : outsiders) {
+        if (balance_of(table, 1, txn) != 100 || balance_of(table, 2, txn) != 101) return false;
+        if (balance_of(table, added, txn) != -1 || table.count_rows(txn) != 10) return false;
+    }
+    if (balance_of(table, 1, writer.get()) != 500 || balance_of(table, 2, writer.get()) != -1) return false;
+    if (table.count_rows(writer.get()) != 10) return false;
+    
+    std::vector<Row> rows;
+    if (!table.index_lookup("balance", Value(int64_t{500}), rows, reader.get()) || !rows.empty()) return false;
+    if (!table.index_lookup("balance", Value(int64_t{500}), rows, writer.get()) || rows.size() != 1) return false;
+    Value min;
+    Value max;
+    if (!table.index_bounds("balance", min, max, reader.get()) || max.get_int() != 109) return false;
+    if (!table.index_bounds("balance", min, max, writer.get()) || max.get_int() != 500) return false;
+    
+    // First updater wins: a row changed by a transaction still running is off limits
+    auto loser = transactions.begin();
+    if (table.update_row(1, make_account(0, 1), loser.get()) || !loser->has_conflict()) return false;
+    transactions.rollback(*loser);
+    
+    // A write of its own that conflicts part-way is undone as a whole
+    std::vector<Row> batch = {make_account(2, 7), make_account(0, 7)};
+    batch[0].set_id(3);
+    batch[1].set_id(1);
+    if (table.update_rows(batch, nullptr) != 0 || balance_of(table, 3, nullptr) != 102) return false;
+    
+    if (!transactions.commit(*writer)) return false;
+    if (balance_of(table, 1, nullptr) != 500 || balance_of(table, 2, nullptr) != -1) return false;
+    if (table.count_rows(nullptr) != 10) return false;
+    
+    // The reader's snapshot survives the commit and a collection
+    table.collect_garbage(transactions.horizon());
+    if (balance_of(table, 1, reader.get()) != 100 || balance_of(table, 2, reader.get()) != 101) return false;
+    if (!table.index_range("balance", nullptr, nullptr, rows, reader.get()) || rows.size() != 10) return false;
+    if (rows.front().get_value(1).get_int() != 100 || rows.back().get_value(1).get_int() != 109) return false;
+    
+    // Changing a row changed since the snapshot was taken is a conflict too
+    if (!table.update_row(3, make_account(2, 0), reader.get())) return false;
+    if (table.update_row(1, make_account(0, 0), reader.get()) || !reader->has_conflict()) return false;
+    transactions.rollback(*reader);
+    if (balance_of(table, 3, nullptr) != 102) return false;
+    
+    // With no reader left, old versions go and indexes forget their keys
+    if (table.collect_garbage(transactions.horizon()) == 0) return false;
+    if (!table.index_lookup("balance", Value(int64_t{100}), rows, nullptr) || !rows.empty()) return false;
+    if (!table.index_range("balance", nullptr, nullptr, rows, nullptr) || rows.size() != 10) return false;
+    if (table.has_uncommitted_writes()) return false;
+    
+    // Rollback puts back every version it replaced
+    auto undone = transactions.begin();
+    if (table.insert_row(make_account(11, 111), undone.get()) == 0) return false;
+    if (!table.update_row(4, make_account(3, 7), undone.get())) return false;
+    if (!table.update_row(4, make_account(3, 8), undone.get())) return false;
+    if (!table.delete_row(5, undone.get())) return false;
+    if (!table.has_uncommitted_writes()) return false;
+    transactions.rollback(*undone);
+    if (table.count_rows(nullptr) != 10 || table.row_count() != 10) return false;
+    if (balance_of(table, 4, nullptr) != 103 || balance_of(table, 5, nullptr) != 104) return false;
+    if (!table.index_lookup("balance", Value(int64_t{8}), rows, nullptr) || !rows.empty()) return false;
+    
+    table.collect_garbage(transactions.horizon());
+    size_t scanned = 0;
+    table.scan([&scanned](const Row&) {
+        scanned++;
+        return true;
+    });
+    return scanned == 10;
+}
+
+bool test_concurrent_transfers() {
+    PageManager page_manager;
+    Table table(make_account_schema(), &page_manager);
+    TransactionManager transactions;
+    table.attach_transactions(&transactions);
+    if (table.insert_row(make_account(0, 0)) == 0) return false;
+    
+    transactions.start_collector([&]() { table.collect_garbage(transactions.horizon()); },
+                                 std::chrono::milliseconds(1));
+    
+    // Read-modify-write increments; a lost update would show in the total
+    const int threads = 4;
+    const int increments = 100;
+    std::atomic<int> conflicts(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for (int done = 0; done < increments;) {
+                auto txn = transactions.begin();
+                int64_t balance = balance_of(table, 1, txn.get());
+                if (table.update_row(1, make_account(0, balance + 1), txn.get()) && transactions.commit(*txn)) {
+                    done++;
+                } else {
+                    transactions.rollback(*txn);
+                    conflicts++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    transactions.stop_collector();
+    
+    if (balance_of(table, 1, nullptr) != threads * increments) return false;
+    if (transactions.active_count() != 0) return false;
+    
+    TransactionManager::Stats stats = transactions.get_stats();
+    return stats.committed >= static_cast<size_t>(threads * increments) &&
+           stats.rolled_back == static_cast<size_t>(conflicts.load());
+}
+
+bool test_commit_durable_before_visible() {
+    const std::string path = "test_commit_durable.wal";
+    std::remove(path.c_str());
+    
+    bool durable = false;
+    {
+        // The background flusher is too slow to be what syncs the commit
+        WriteAheadLog wal;
+        wal.set_flush_interval(std::chrono::hours(1));
+        if (!wal.open(path)) return false;
+        PageManager page_manager;
+        Table table(make_account_schema(), &page_manager);
+        TransactionManager transactions;
+        transactions.set_wal(&wal);
+        table.attach_wal(&wal, "accounts");
+        table.attach_transactions(&transactions);
+        
+        auto writer = transactions.begin();
+        uint64_t row_id = table.insert_row(make_account(1, 100), writer.get());
+        if (row_id == 0 || wal.get_last_lsn() != INVALID_LSN) return false;  // Logged at commit
+        if (!transactions.commit(*writer)) return false;
+        
+        // By the time anyone can read the row, its record is on disk
+        auto reader = transactions.begin();
+        durable = balance_of(table, row_id, reader.get()) == 100 && wal.get_last_lsn() != INVALID_LSN &&
+                  wal.get_durable_lsn() == wal.get_last_lsn();
+        transactions.rollback(*reader);
+    }
+    
+    std::remove(path.c_str());
+    return durable;
+}
+
+bool test_sql_transactions() {
+    const std::string name = "test_sql_transactions";
+    std::remove((name + ".db").c_str());
+    std::remove((name + ".wal").c_str());
+    std::remove((name + ".snap").c_str());
+    
+    auto count = [](Database& db) {
+        QueryResult result = db.execute_query("SELECT COUNT(*) FROM items");
+        return result.is_success() ? result.get_rows()[0].get_value(0).get_int() : -1;
+    };
+    
+    {
+        Database db(name);
+        if (!db.open()) return false;
+        if (!db.execute_query("CREATE TABLE items (id INTEGER, name TEXT)").is_success()) return false;
+        if (!db.execute_query("INSERT INTO items VALUES (1, 'one')").is_success()) return false;
+        
+        if (!db.execute_query("BEGIN").is_success()) return false;
+        if (db.execute_query("BEGIN").is_success()) return false;  // No nesting
+        if (!db.execute_query("INSERT INTO items VALUES (2, 'two'), (3, 'three')").is_success()) return false;
+        if (count(db) != 3) return false;
+        
+        // Outside the transaction nothing has changed yet
+        Row row;
+        Table* items = db.get_table("ITEMS");
+        if (items == nullptr || items->get_row(2, row) || items->count_rows(nullptr) != 1) return false;
+        
+        if (!db.execute_query("ROLLBACK").is_success()) return false;
+        if (count(db) != 1) return false;
+        if (db.execute_query("COMMIT").is_success()) return false;  // Nothing to commit
+        
+        if (!db.execute_query("BEGIN TRANSACTION").is_success()) return false;
+        if (!db.execute_query("INSERT INTO items VALUES (4, 'four')").is_success()) return false;
+        if (!db.execute_query("COMMIT TRANSACTION").is_success()) return false;
+        if (count(db) != 2) return false;
+        
+        // UPDATE and DELETE run in the session's transaction too
+        if (!db.execute_query("BEGIN").is_success()) return false;
+        if (db.execute_query("UPDATE items SET name = 'uno' WHERE id = 1").get_affected_rows() != 1) return false;
+        if (db.execute_query("DELETE FROM items WHERE id = 4").get_affected_rows() != 1) return false;
+        if (count(db) != 1 || items->count_rows(nullptr) != 2) return false;
+        if (!db.execute_query("ROLLBACK").is_success() || count(db) != 2) return false;
+        if (db.execute_query("UPDATE items SET name = 'FOUR' WHERE id = 4").get_affected_rows() != 1) return false;
+        
+        // A statement that fails on its own is rolled back, rows loaded before
+        // a bad record included
+        std::FILE* file = std::fopen((name + ".csv").c_str(), "w");
+        if (file == nullptr) return false;
+        std::fputs("6,six\nseven,7\n", file);
+        std::fclose(file);
+        QueryResult copied = db.execute_query("COPY items FROM '" + name + ".csv'");
+        std::remove((name + ".csv").c_str());
+        if (copied.is_success() || count(db) != 2) return false;
+        
+        // Left open at close, so rolled back
+        if (!db.execute_query("BEGIN").is_success()) return false;
+        if (!db.execute_query("INSERT INTO items VALUES (5, 'five')").is_success()) return false;
+        db.close();
+    }
+    
+    Database db(name);
+    if (!db.open()) return false;
+    QueryResult result = db.execute_query("SELECT name FROM items WHERE id = 4");
+    bool durable = result.is_success() && result.row_count() == 1 &&
+                   result.get_rows()[0].get_value(0) == Value("FOUR") && count(db) == 2;
+    db.close();
+    
+    std::remove((name + ".db").c_str());
+    std::remove((name + ".wal").c_str());
+    std::remove((name + ".snap").c_str());
+    return durable;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file test_wal.cpp
+ * @brief Write-ahead log and recovery tests
+ */
+
+#include "minidb/minidb.h"
+#include "minidb/storage/statistics.h"
+#include "minidb/storage/wal.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace minidb;
+using namespace minidb::storage;
+
+static void remove_database_files(const std::string& name) {
+    std::remove((name + ".db").c_str());
+    std::remove((name + ".wal").c_str());
+    std::remove((name + ".snap").c_str());
+}
+
+static size_t count_records(const std::string& path) {
+    WriteAheadLog wal;
+    size_t records = 0;
+    if (!wal.open(path)) return 0;
+    wal.replay([&records](const LogRecord&) {
+        records++;
+        return true;
+    });
+    return records;
+}
+
+bool test_wal_recovery() {
+    const std::string name = "test_wal_recovery";
+    remove_database_files(name);
+    
+    {
+        Database db(name);
+        if (!db.open()) return false;
+        if (!db.execute_query("CREATE TABLE users (id INTEGER, name TEXT)").is_success()) return false;
+        if (!db.execute_query("CREATE TABLE scratch (id INTEGER)").is_success()) return false;
+        for (int i = 1; i <= 20; i++) {
+            std::string sql = "INSERT INTO users VALUES (" + std::to_string(i) + ", 'user" + std::to_string(i) + "')";
+            if (!db.execute_query(sql).is_success()) return false;
+        }
+        if (!db.execute_query("DROP TABLE scratch").is_success()) return false;
+        
+        Table* users = db.get_table("USERS");
+        if (users == nullptr) return false;
+        
+        Row updated;
+        updated.add_value(Value(static_cast<int64_t>(5)));
+        updated.add_value(Value(std::string("renamed")));
+        if (!users->update_row(5, updated)) return false;
+        if (!users->delete_row(7)) return false;
+        if (!users->create_index("ID", "hash")) return false;
+        db.close();
+    }
+    
+    Database db(name);
+    if (!db.open()) return false;
+    if (db.get_table("SCRATCH") != nullptr) return false;
+    
+    Table* users = db.get_table("USERS");
+    if (users == nullptr || users->row_count() != 19) return false;
+    
+    Row row;
+    if (!users->get_row(5, row) || row.get_value(1).get_string() != "renamed") return false;
+    if (users->get_row(7, row)) return false;
+    if (!users->get_row(20, row) || row.get_value(1).get_string() != "user20") return false;
+    
+    // Row ids continue after the recovered ones, and the index came back
+    if (!db.execute_query("INSERT INTO users VALUES (21, 'user21')").is_success()) return false;
+    if (!users->get_row(21, row)) return false;
+    if (users->create_index("ID", "hash")) return false;
+    
+    db.close();
+    remove_database_files(name);
+    return true;
+}
+
+bool test_wal_torn_tail() {
+    const std::string path = "test_wal_torn_tail.wal";
+    std::remove(path.c_str());
+    
+    {
+        WriteAheadLog wal;
+        if (!wal.open(path)) return false;
+        for (int i = 0; i < 10; i++) {
+            std::vector<char> payload(100, static_cast<char>(i));
+            if (wal.append(LogRecordType::INSERT, "T", payload) == INVALID_LSN) return false;
+        }
+        if (!wal.commit()) return false;
+        if (wal.get_durable_lsn() != 10) return false;
+    }
+    
+    // Simulate a crash in the middle of writing another record
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        const char partial[] = {64, 0, 0, 0, 1, 2, 3, 4, 5, 6};
+        out.write(partial, sizeof(partial));
+    }
+    if (count_records(path) != 10) return false;
+    
+    // The torn tail is gone, so new records follow the intact ones
+    {
+        WriteAheadLog wal;
+        if (!wal.open(path)) return false;
+        if (wal.get_last_lsn() != 10) return false;
+        if (wal.append(LogRecordType::DELETE, "T", std::vector<char>(8, 0)) != 11) return false;
+    }
+    if (count_records(path) != 11) return false;
+    
+    std::remove(path.c_str());
+    return true;
+}
+
+bool test_wal_group_commit() {
+    const std::string path = "test_wal_group_commit.wal";
+    std::remove(path.c_str());
+    
+    const int thread_count = 8;
+    const int commits_per_thread = 50;
+    
+    {
+        WriteAheadLog wal;
+        if (!wal.open(path)) return false;
+        
+        std::vector<std::thread> threads;
+        std::vector<bool> ok(thread_count, true);
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&wal, &ok, t]() {
+                for (int i = 0; i < commits_per_thread; i++) {
+                    Lsn lsn = wal.append(LogRecordType::INSERT, "T", std::vector<char>(32, 'x'));
+                    if (!wal.commit(lsn) || wal.get_durable_lsn() < lsn) {
+                        ok[t] = false;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (bool thread_ok : ok) {
+            if (!thread_ok) return false;
+        }
+        
+        // Every commit was durable, yet waiting writers shared syncs
+        WriteAheadLog::Stats stats = wal.get_stats();
+        if (stats.commits != static_cast<size_t>(thread_count * commits_per_thread)) return false;
+        if (stats.syncs == 0 || stats.syncs > stats.commits) return false;
+    }
+    if (count_records(path) != static_cast<size_t>(thread_count * commits_per_thread)) return false;
+    
+    std::remove(path.c_str());
+    return true;
+}
+
+bool test_snapshot_reopen() {
+    const std::string name = "test_snapshot_reopen";
+    remove_database_files(name);
+    
+    {
+        Database db(name);
+        if (!db.open()) return false;
+        if (!db.execute_query("CREATE TABLE items (id INTEGER, name TEXT)").is_success()) return false;
+        if (!db.execute_query("CREATE TABLE events (id INTEGER, kind TEXT) USING COLUMNAR").is_success()) return false;
+        for (int i = 1; i <= 500; i++) {
+            std::string id = std::to_string(i);
+            if (!db.execute_query("INSERT INTO items VALUES (" + id + ", 'item" + id + "')").is_success()) return false;
+            if (!db.execute_query("INSERT INTO events VALUES (" + id + ", 'kind" + id + "')").is_success()) return false;
+        }
+        Table* items = db.get_table("ITEMS");
+        if (items == nullptr || !items->delete_row(10)) return false;
+        if (!items->create_index("ID", "btree") || !items->create_index("NAME", "hash")) return false;
+        if (!db.execute_query("ANALYZE items").is_success()) return false;
+        db.close();
+    }
+    
+    // A clean close leaves everything in the snapshot and nothing in the log
+    if (count_records(name + ".wal") != 0) return false;
+    
+    for (int reopen = 0; reopen < 2; reopen++) {
+        Database db(name);
+        if (!db.open()) return false;
+        
+        Table* items = db.get_table("ITEMS");
+        Table* events = db.get_table("EVENTS");
+        if (items == nullptr || events == nullptr) return false;
+        if (items->row_count() != 499 + reopen || events->row_count() != 500) return false;
+        
+        Row row;
+        if (!items->get_row(250, row) || row.get_value(1).get_string() != "item250") return false;
+        if (items->get_row(10, row)) return false;
+        if (!events->get_row(500, row) || row.get_value(1).get_string() != "kind500") return false;
+        
+        // Indexes came back and still answer lookups
+        QueryResult result = db.execute_query("SELECT name FROM items WHERE id = 321");
+        if (!result.is_success() || result.row_count() != 1) return false;
+        if (items->create_index("ID", "btree") || items->create_index("NAME", "hash")) return false;
+        
+        // So did the statistics, which are only ever written to the snapshot
+        const TableStatistics* statistics = items->get_schema().get_statistics();
+        if (statistics == nullptr || statistics->row_count != 499 || statistics->columns[1].distinct_count != 499) {
+            return false;
+        }
+        
+        if (reopen == 0) {
+            // Changes after the snapshot land in new pages and the log
+            if (!db.execute_query("INSERT INTO items VALUES (501, 'item501')").is_success()) return false;
+            Row updated;
+            updated.add_value(Value(static_cast<int64_t>(250)));
+            updated.add_value(Value(std::string("changed")));
+            if (!items->update_row(250, updated) || !items->get_row(501, row)) return false;
+        } else {
+            if (!items->get_row(250, row) || row.get_value(1).get_string() != "changed") return false;
+            if (!items->get_row(501, row) || row.get_value(1).get_string() != "item501") return false;
+        }
+        db.close();
+    }
+    
+    remove_database_files(name);
+    return true;
+}